@@ -0,0 +1,57 @@
+# This code snippet measures the per-dataset cost of reading properties.
+#
+# get_properties() reads all requested properties under a single libzfs
+# lock / GIL cycle. The per-property baseline reads the same set through a
+# lazy view (get_properties(lazy=True)), which takes one lock / GIL cycle
+# per attribute access. Both build one struct_zfs_property_data per
+# property, so the difference is the cost of the lock / GIL cycles rather
+# than of struct allocation.
+#
+
+import time
+import truenas_pylibzfs
+
+DATASET = 'dozer/MANY'
+ITERATIONS = 5
+PROPS = truenas_pylibzfs.property_sets.ZFS_FILESYSTEM_PROPERTIES
+
+
+def read_bulk(hdl, state):
+    hdl.get_properties(properties=PROPS)
+    state['count'] += 1
+    return True
+
+
+FIELDS = [prop.name.lower() for prop in PROPS]
+
+
+def read_single(hdl, state):
+    view = hdl.get_properties(properties=PROPS, lazy=True)
+    for field in FIELDS:
+        getattr(view, field)
+    state['count'] += 1
+    return True
+
+
+def run(rsrc, callback):
+    best = None
+    for _ in range(ITERATIONS):
+        state = {'count': 0}
+        start = time.perf_counter()
+        rsrc.iter_filesystems(callback=callback, state=state, recursive=True)
+        elapsed = time.perf_counter() - start
+        per_ds = elapsed / max(state['count'], 1)
+        best = per_ds if best is None else min(best, per_ds)
+
+    return state['count'], best
+
+
+lz = truenas_pylibzfs.open_handle()
+rsrc = lz.open_resource(name=DATASET)
+
+count, single = run(rsrc, read_single)
+count, bulk = run(rsrc, read_bulk)
+
+print(f'{count} datasets, {len(PROPS)} properties')
+print(f'per-property: {single * 1e6:.1f} us/dataset')
+print(f'bulk:         {bulk * 1e6:.1f} us/dataset ({single / bulk:.1f}x)')
@@ -0,0 +1,58 @@
+# This code snippet measures how property reads scale with the number of
+# threads for a single libzfs handle and for a pool of handles.
+#
+# With pool_size=1 every thread serializes on the one libzfs handle lock.
+# With pool_size=N resources opened by open_resource() are spread across N
+# handles, each with its own lock.
+#
+
+import threading
+import time
+import truenas_pylibzfs
+
+DATASET = 'dozer/MANY'
+THREADS = (1, 2, 4, 8)
+DURATION = 2.0
+PROPS = truenas_pylibzfs.property_sets.ZFS_FILESYSTEM_PROPERTIES
+
+
+def worker(lz, names, stop, counts, idx):
+    count = 0
+    while not stop.is_set():
+        for name in names:
+            rsrc = lz.open_resource(name=name)
+            rsrc.get_properties(properties=PROPS)
+            count += 1
+
+    counts[idx] = count
+
+
+def run(lz, names, nthreads):
+    stop = threading.Event()
+    counts = [0] * nthreads
+    threads = [
+        threading.Thread(target=worker, args=(lz, names, stop, counts, i))
+        for i in range(nthreads)
+    ]
+    for t in threads:
+        t.start()
+
+    time.sleep(DURATION)
+    stop.set()
+    for t in threads:
+        t.join()
+
+    return sum(counts) / DURATION
+
+
+lz = truenas_pylibzfs.open_handle()
+names = lz.open_resource(name=DATASET).list_filesystem_names(recursive=True)
+
+print(f'{len(names)} datasets, {len(PROPS)} properties')
+print(f'{"threads":>8} {"pool_size=1":>14} {"pool_size=N":>14}')
+for nthreads in THREADS:
+    single = run(lz, names, nthreads)
+    pooled = run(truenas_pylibzfs.open_handle(pool_size=nthreads),
+                 names, nthreads)
+    print(f'{nthreads:>8} {single:>12.0f}/s {pooled:>12.0f}/s '
+          f'({pooled / single:.2f}x)')
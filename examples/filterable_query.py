@@ -43,7 +43,7 @@ def generic_query_callback(hdl, state):
         # halt iterator
         return False
 
-    if state.recursive:
+    if state.recursive and state.iterator_fn_name != "iter_filesystems":
         getattr(hdl, state.iterator_fn_name)(
             callback=generic_query_callback, state=state
         )
@@ -75,7 +75,10 @@ def generic_query(
         results=[],
     )
 
-    # do iteration
+    # do iteration. iter_filesystems() can walk the whole tree in C.
+    if state.recursive and state.iterator_fn_name == "iter_filesystems":
+        zfs_options["recursive"] = True
+
     rsrc_iterator(callback=generic_query_callback, state=state, **zfs_options)
 
     # optimization where request is only for single result with no pagination
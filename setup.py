@@ -6,6 +6,7 @@ truenas_pylibzfs = Extension(
         'src/truenas_pylibzfs.c',
         'src/truenas_pylibzfs_state.c',
         'src/common/error.c',
+        'src/common/json_buf.c',
         'src/common/utils.c',
         'src/common/nvlist_utils.c',
         'src/common/nvlist_utils_nvl_to_dict.c',
@@ -18,6 +19,7 @@ truenas_pylibzfs = Extension(
         'src/libzfs/py_zfs_crypto.c',
         'src/libzfs/py_zfs_enum.c',
         'src/libzfs/py_zfs_events.c',
+        'src/libzfs/py_zfs_filter.c',
         'src/libzfs/py_zfs_history.c',
         'src/libzfs/py_zfs_iter.c',
         'src/libzfs/py_zfs_local_replicate.c',
@@ -30,13 +32,22 @@ truenas_pylibzfs = Extension(
         'src/libzfs/py_zfs_pool_prop.c',
         'src/libzfs/py_zfs_pool_status.c',
         'src/libzfs/py_zfs_prop.c',
+        'src/libzfs/py_zfs_prop_bulk.c',
+        'src/libzfs/py_zfs_prop_cache.c',
+        'src/libzfs/py_zfs_stats.c',
+        'src/libzfs/py_zfs_aio.c',
+        'src/libzfs/py_zfs_resource_alloc.c',
+        'src/libzfs/py_zfs_prop_selector.c',
+        'src/libzfs/py_zfs_query.c',
         'src/libzfs/py_libzfs_types_module.c',
         'src/libzfs/py_zfs_resource.c',
+        'src/libzfs/py_zfs_resource_iter.c',
         'src/libzfs/py_zfs_snapshot.c',
         'src/libzfs/py_zfs_userquota.c',
         'src/libzfs/py_zfs_volume.c',
         'src/libzfs_core/py_zfs_core_module.c',
         'src/libzfs_core/libzfs_core_replication.c',
+        'src/libzfs_core/libzfs_core_snaprange.c',
         'src/pyzfs_kstat/pyzfs_kstat.c',
         'src/pyzfs_kstat/arcstats.c',
         'src/pyzfs_kstat/zilstats.c',
@@ -0,0 +1,203 @@
+#include "../truenas_pylibzfs.h"
+
+/*
+ * Growable byte buffer used to serialize JSON directly from libzfs data
+ * (see ZFSResource.asdict_json() and ZFS.query_json()). None of the append
+ * functions require the GIL, so output may be generated while holding the
+ * libzfs handle lock. Allocation failure is recorded in the buffer and
+ * reported once by json_buf_to_bytes().
+ */
+
+#define	JSON_BUF_INITIAL_SIZE	4096
+
+void json_buf_append(py_json_buf_t *jb, const char *data, size_t len)
+{
+	if (jb->nomem)
+		return;
+
+	if (jb->used + len > jb->size) {
+		size_t new_size = jb->size ? jb->size : JSON_BUF_INITIAL_SIZE;
+		char *new_buf;
+
+		while (jb->used + len > new_size)
+			new_size *= 2;
+
+		new_buf = PyMem_RawRealloc(jb->buf, new_size);
+		if (new_buf == NULL) {
+			jb->nomem = B_TRUE;
+			return;
+		}
+
+		jb->buf = new_buf;
+		jb->size = new_size;
+	}
+
+	memcpy(jb->buf + jb->used, data, len);
+	jb->used += len;
+}
+
+/*
+ * Decode one UTF-8 sequence at p. Returns the sequence length and sets *cp,
+ * or returns 0 if the sequence is invalid (truncated, overlong, surrogate
+ * or beyond U+10FFFF).
+ */
+static
+size_t json_utf8_decode(const unsigned char *p, uint32_t *cp)
+{
+	uint32_t min, val;
+	size_t len, i;
+
+	if (p[0] < 0x80) {
+		*cp = p[0];
+		return 1;
+	} else if ((p[0] & 0xe0) == 0xc0) {
+		len = 2;
+		min = 0x80;
+		val = p[0] & 0x1f;
+	} else if ((p[0] & 0xf0) == 0xe0) {
+		len = 3;
+		min = 0x800;
+		val = p[0] & 0x0f;
+	} else if ((p[0] & 0xf8) == 0xf0) {
+		len = 4;
+		min = 0x10000;
+		val = p[0] & 0x07;
+	} else {
+		return 0;
+	}
+
+	for (i = 1; i < len; i++) {
+		// also stops at the terminating NUL
+		if ((p[i] & 0xc0) != 0x80)
+			return 0;
+		val = (val << 6) | (p[i] & 0x3f);
+	}
+
+	if ((val < min) || (val > 0x10ffff) ||
+	    ((val >= 0xd800) && (val <= 0xdfff)))
+		return 0;
+
+	*cp = val;
+	return len;
+}
+
+static
+void json_buf_u16(py_json_buf_t *jb, uint32_t val)
+{
+	char esc[7];
+
+	snprintf(esc, sizeof(esc), "\\u%04x", (unsigned int)val);
+	json_buf_append(jb, esc, 6);
+}
+
+/*
+ * Append str as a quoted JSON string. Output is ASCII and matches
+ * json.dumps() with its default ensure_ascii=True: code points outside
+ * the printable ASCII range are written as \uXXXX escapes (as a
+ * surrogate pair above U+FFFF). Invalid UTF-8 sequences are replaced
+ * with U+FFFD one byte at a time.
+ */
+void json_buf_str(py_json_buf_t *jb, const char *str)
+{
+	const unsigned char *start = (const unsigned char *)str;
+	const unsigned char *p = start;
+
+	json_buf_lit(jb, "\"");
+
+	while (*p != '\0') {
+		uint32_t cp;
+		size_t len;
+
+		if ((*p >= 0x20) && (*p < 0x7f) && (*p != '"') &&
+		    (*p != '\\')) {
+			p++;
+			continue;
+		}
+
+		json_buf_append(jb, (const char *)start, p - start);
+
+		len = json_utf8_decode(p, &cp);
+		if (len == 0) {
+			cp = 0xfffd;
+			len = 1;
+		}
+		p += len;
+		start = p;
+
+		switch (cp) {
+		case '"':
+			json_buf_lit(jb, "\\\"");
+			break;
+		case '\\':
+			json_buf_lit(jb, "\\\\");
+			break;
+		case '\b':
+			json_buf_lit(jb, "\\b");
+			break;
+		case '\f':
+			json_buf_lit(jb, "\\f");
+			break;
+		case '\n':
+			json_buf_lit(jb, "\\n");
+			break;
+		case '\r':
+			json_buf_lit(jb, "\\r");
+			break;
+		case '\t':
+			json_buf_lit(jb, "\\t");
+			break;
+		default:
+			if (cp >= 0x10000) {
+				cp -= 0x10000;
+				json_buf_u16(jb, 0xd800 | (cp >> 10));
+				json_buf_u16(jb, 0xdc00 | (cp & 0x3ff));
+			} else {
+				json_buf_u16(jb, cp);
+			}
+			break;
+		}
+	}
+
+	json_buf_append(jb, (const char *)start, p - start);
+	json_buf_lit(jb, "\"");
+}
+
+/* Append `"key":`. Output is compact (no whitespace between tokens) */
+void json_buf_key(py_json_buf_t *jb, const char *key)
+{
+	json_buf_str(jb, key);
+	json_buf_lit(jb, ":");
+}
+
+void json_buf_u64(py_json_buf_t *jb, uint64_t val)
+{
+	char buf[21];
+	int len;
+
+	len = snprintf(buf, sizeof(buf), "%" PRIu64, val);
+	json_buf_append(jb, buf, len);
+}
+
+void json_buf_free(py_json_buf_t *jb)
+{
+	PyMem_RawFree(jb->buf);
+	jb->buf = NULL;
+	jb->used = jb->size = 0;
+}
+
+/*
+ * Convert buffer contents to python bytes and free the buffer. GIL must be
+ * held.
+ */
+PyObject *json_buf_to_bytes(py_json_buf_t *jb)
+{
+	PyObject *out = NULL;
+
+	if (jb->nomem)
+		PyErr_NoMemory();
+	else
+		out = PyBytes_FromStringAndSize(jb->buf, jb->used);
+
+	json_buf_free(jb);
+	return out;
+}
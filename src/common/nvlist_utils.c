@@ -48,6 +48,33 @@ PyObject *user_props_nvlist_to_py_dict(nvlist_t *userprops)
 	return d;
 }
 
+void user_props_nvlist_to_json(py_json_buf_t *jb, nvlist_t *userprops)
+{
+	nvpair_t *elem;
+	boolean_t first = B_TRUE;
+
+	json_buf_lit(jb, "{");
+	for (elem = nvlist_next_nvpair(userprops, NULL);
+	    elem != NULL;
+	    elem = nvlist_next_nvpair(userprops, elem)) {
+		nvlist_t *nvl;
+
+		PYZFS_ASSERT(
+			(nvpair_type(elem) == DATA_TYPE_NVLIST),
+			"Unexpected nvpair data type in user props"
+		);
+
+		nvl = fnvpair_value_nvlist(elem);
+		if (!first)
+			json_buf_lit(jb, ",");
+		first = B_FALSE;
+
+		json_buf_key(jb, nvpair_name(elem));
+		json_buf_str(jb, fnvlist_lookup_string(nvl, ZPROP_VALUE));
+	}
+	json_buf_lit(jb, "}");
+}
+
 /*
  * Convert a python dictionary of user props into an nvlist
  * for insertion as user properties.
@@ -1,7 +1,5 @@
 #include "../truenas_pylibzfs.h"
 
-#define PYMAXHISTORYLEN 4096
-
 const char* get_dataset_type(zfs_type_t type) {
 	const char *ret;
 	switch(type) {
@@ -41,12 +39,23 @@ PyObject *py_empty_str(void)
  */
 PyObject *py_repr_zfs_obj_impl(py_zfs_obj_t *obj, const char *fmt)
 {
-	return PyUnicode_FromFormat(
+	PyObject *name = py_zfs_obj_name_ref(obj);
+	PyObject *out;
+
+	if (name == Py_None) {
+		Py_SETREF(name, py_empty_str());
+		if (name == NULL)
+			return NULL;
+	}
+
+	out = PyUnicode_FromFormat(
 		fmt,
-		obj->name ? obj->name : py_empty_str(),
+		name,
 		obj->pool_name ? obj->pool_name : py_empty_str(),
 		obj->type ? obj->type : py_empty_str()
 	);
+	Py_DECREF(name);
+	return out;
 }
 
 PyObject *
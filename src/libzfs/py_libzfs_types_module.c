@@ -17,13 +17,18 @@ types_add_to_submodule(PyObject *m)
 		PyTypeObject *type;
 	} type_exports[] = {
 		{ "ZFS", &ZFS },
+		{ "ZFSAio", &ZFSAio },
 		{ "ZFSCrypto", &ZFSCrypto },
 		{ "ZFSDataset", &ZFSDataset },
 		{ "ZFSEventIterator", &ZFSEventIterator },
+		{ "ZFSFilter", &ZFSFilter },
 		{ "ZFSHistoryIterator", &ZFSHistoryIterator },
 		{ "ZFSObject", &ZFSObject },
 		{ "ZFSPool", &ZFSPool },
+		{ "ZFSPropertySelector", &ZFSPropertySelector },
+		{ "ZFSPropertyView", &ZFSPropertyView },
 		{ "ZFSResource", &ZFSResource },
+		{ "ZFSResourceIterator", &ZFSResourceIterator },
 		{ "ZFSSnapshot", &ZFSSnapshot },
 		{ "ZFSVolume", &ZFSVolume },
 		{ NULL, NULL }
@@ -9,17 +9,164 @@ PyObject *py_zfs_str(PyObject *self) {
 	return (PyUnicode_FromFormat(ZFS_STR));
 }
 
+/*
+ * Create an additional py_zfs_t for the handle pool of `parent`. The new
+ * object shares the module and history settings of the parent but has its
+ * own libzfs_handle_t and lock.
+ */
+static py_zfs_t *
+py_zfs_new_pool_handle(py_zfs_t *parent)
+{
+	py_zfs_t *out = NULL;
+
+	out = (py_zfs_t *)Py_TYPE(parent)->tp_alloc(Py_TYPE(parent), 0);
+	if (out == NULL)
+		return NULL;
+
+	out->module = Py_NewRef(parent->module);
+	out->history = parent->history;
+	out->mnttab_cache_enable = parent->mnttab_cache_enable;
+	strlcpy(out->history_prefix, parent->history_prefix,
+		MAX_HISTORY_PREFIX_LEN);
+
+	if (PY_ZFS_LOCK_INIT(&out->zfs_lock)) {
+		PyErr_Format(PyExc_RuntimeError,
+			     "Failed to initialize mutex: %s",
+			     strerror(errno));
+		Py_DECREF(out);
+		return NULL;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	out->lzh = libzfs_init();
+	Py_END_ALLOW_THREADS
+
+	if (out->lzh == NULL) {
+		PyErr_SetString(PyExc_RuntimeError,
+				"Failed to initialize libzfs handle.");
+		Py_DECREF(out);
+		return NULL;
+	}
+
+	libzfs_mnttab_cache(out->lzh, out->mnttab_cache_enable);
+
+	return out;
+}
+
+static int
+py_zfs_init_handle_pool(py_zfs_t *zfs, Py_ssize_t pool_size)
+{
+	PyObject *pool = NULL;
+	Py_ssize_t i;
+
+	// The handle on which open_handle() was called is the first
+	// member of the pool and so is not stored in the tuple.
+	pool = PyTuple_New(pool_size - 1);
+	if (pool == NULL)
+		return (-1);
+
+	libzfs_mnttab_cache(zfs->lzh, zfs->mnttab_cache_enable);
+
+	for (i = 0; i < pool_size - 1; i++) {
+		py_zfs_t *hdl = py_zfs_new_pool_handle(zfs);
+		if (hdl == NULL) {
+			Py_DECREF(pool);
+			return (-1);
+		}
+
+		PyTuple_SET_ITEM(pool, i, (PyObject *)hdl);
+	}
+
+	zfs->handle_pool = pool;
+	return (0);
+}
+
+py_zfs_t *py_zfs_get_handle(py_zfs_t *plz)
+{
+	uint64_t idx;
+	Py_ssize_t cnt;
+
+	if (plz->handle_pool == NULL)
+		return plz;
+
+	cnt = PyTuple_GET_SIZE(plz->handle_pool) + 1;
+	idx = __atomic_fetch_add(&plz->handle_next, 1, __ATOMIC_RELAXED) %
+	    (uint64_t)cnt;
+	if (idx == 0)
+		return plz;
+
+	return (py_zfs_t *)PyTuple_GET_ITEM(plz->handle_pool, idx - 1);
+}
+
 int py_zfs_init(PyObject *type, PyObject *args, PyObject *kwds) {
 	int err;
 	py_zfs_t *zfs = (py_zfs_t *)type;
 	const char *history_prefix = DEFAULT_HISTORY_PREFIX;
-	char *kwlist[] = {"history", "history_prefix", "mnttab_cache", NULL};
+	double cache_ttl = 0;
+	Py_ssize_t pool_size = 1;
+	Py_ssize_t aio_workers = DEFAULT_AIO_WORKERS;
+	Py_ssize_t aio_queue_depth = DEFAULT_AIO_QUEUE_DEPTH;
+	PyObject *mnttab_cache = NULL;
+	char *kwlist[] = {"history", "history_prefix", "mnttab_cache",
+	    "property_cache_ttl", "pool_size", "aio_workers",
+	    "aio_queue_depth", NULL};
 
 	zfs->history = B_TRUE;
 	zfs->mnttab_cache_enable = B_TRUE;
 
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|psp", kwlist,
-	    &zfs->history, &history_prefix, &zfs->mnttab_cache_enable)) {
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "|psOdnnn", kwlist,
+	    &zfs->history, &history_prefix, &mnttab_cache,
+	    &cache_ttl, &pool_size, &aio_workers, &aio_queue_depth)) {
+		return (-1);
+	}
+
+	if (mnttab_cache != NULL) {
+		int enable = PyObject_IsTrue(mnttab_cache);
+		if (enable < 0)
+			return (-1);
+
+		zfs->mnttab_cache_enable = enable ? B_TRUE : B_FALSE;
+	}
+
+	if (!(cache_ttl >= 0)) {
+		PyErr_SetString(PyExc_ValueError,
+				"property_cache_ttl must not be negative.");
+		return (-1);
+	}
+	zfs->prop_cache.ttl_ns = (uint64_t)(cache_ttl * 1000000000.0);
+
+	if (pool_size < 1) {
+		PyErr_SetString(PyExc_ValueError,
+				"pool_size must be at least 1.");
+		return (-1);
+	}
+
+	// Each handle would have its own cache and changes made through
+	// one handle would not invalidate entries held by the others.
+	if ((pool_size > 1) && PY_ZFS_PROP_CACHE_ENABLED(zfs)) {
+		PyErr_SetString(PyExc_ValueError,
+				"property_cache_ttl may not be used with "
+				"pool_size greater than 1.");
+		return (-1);
+	}
+
+	// Likewise each handle would have its own mnttab cache, and mounts
+	// or unmounts through one handle would not be seen by the others.
+	// The cache is off by default in that case.
+	if (pool_size > 1) {
+		if ((mnttab_cache != NULL) && zfs->mnttab_cache_enable) {
+			PyErr_SetString(PyExc_ValueError,
+					"mnttab_cache may not be enabled with "
+					"pool_size greater than 1.");
+			return (-1);
+		}
+		zfs->mnttab_cache_enable = B_FALSE;
+	}
+
+	if ((aio_workers < 1) || (aio_queue_depth < 1)) {
+		PyErr_SetString(PyExc_ValueError,
+				"aio_workers and aio_queue_depth must be "
+				"at least 1.");
 		return (-1);
 	}
 
@@ -50,6 +197,15 @@ int py_zfs_init(PyObject *type, PyObject *args, PyObject *kwds) {
 		return (-1);
 	}
 
+	zfs->aio_pool = py_zfs_aio_pool_create(aio_workers, aio_queue_depth);
+	if (zfs->aio_pool == NULL) {
+		PyErr_NoMemory();
+		return (-1);
+	}
+
+	if (pool_size > 1)
+		return py_zfs_init_handle_pool(zfs, pool_size);
+
 	return (0);
 }
 
@@ -60,6 +216,11 @@ void py_zfs_dealloc(py_zfs_t *self) {
 		Py_END_ALLOW_THREADS
 	}
 
+	py_zfs_aio_pool_destroy(self->aio_pool);
+	self->aio_pool = NULL;
+	py_zfs_prop_cache_clear(self);
+	Py_CLEAR(self->pool_name_cache);
+	Py_CLEAR(self->handle_pool);
 	Py_CLEAR(self->module);
 	self->lzh = NULL;
 	PY_ZFS_LOCK_DESTROY(&self->zfs_lock);
@@ -299,14 +460,44 @@ PyObject *py_zfs_resource_create(PyObject *self,
 	Py_RETURN_NONE;
 }
 
+/*
+ * Create the python object for an open ZFS handle of the given type.
+ * Caller must close `zfsp` on failure.
+ */
+static PyObject *
+py_zfs_resource_from_handle(py_zfs_t *plz,
+			    zfs_handle_t *zfsp,
+			    zfs_type_t type)
+{
+	PyObject *out = NULL;
+
+	switch (type) {
+	case ZFS_TYPE_FILESYSTEM:
+		out = (PyObject *)init_zfs_dataset(plz, zfsp, B_FALSE);
+		break;
+	case ZFS_TYPE_VOLUME:
+		out = (PyObject *)init_zfs_volume(plz, zfsp, B_FALSE);
+		break;
+	case ZFS_TYPE_SNAPSHOT:
+		out = (PyObject *)init_zfs_snapshot(plz, zfsp, B_FALSE);
+		break;
+	default:
+		PyErr_SetString(PyExc_RuntimeError,
+				"Unsupported ZFS type");
+	}
+
+	return out;
+}
+
 PyObject *py_zfs_resource_open(PyObject *self,
 			       PyObject *args_unused,
 			       PyObject *kwargs)
 {
 	PyObject *out = NULL;
-	py_zfs_t *plz = (py_zfs_t *)self;
+	py_zfs_t *plz = py_zfs_get_handle((py_zfs_t *)self);
 	zfs_handle_t *zfsp = NULL;
 	zfs_type_t type;
+	uint64_t op_start;
 	char *name = NULL;
 	py_zfs_error_t zfs_err;
 
@@ -334,7 +525,9 @@ PyObject *py_zfs_resource_open(PyObject *self,
 
 	Py_BEGIN_ALLOW_THREADS
 	PY_ZFS_LOCK(plz);
+	op_start = py_zfs_stats_now();
 	zfsp = zfs_open(plz->lzh, name, SUPPORTED_RESOURCES);
+	py_zfs_stats_op(plz, PY_ZFS_OP_OPEN, op_start);
 	if (zfsp == NULL) {
 		py_get_zfs_error(plz->lzh, &zfs_err);
 	} else {
@@ -348,20 +541,7 @@ PyObject *py_zfs_resource_open(PyObject *self,
 		return NULL;
 	}
 
-	switch (type) {
-	case ZFS_TYPE_FILESYSTEM:
-		out = (PyObject *)init_zfs_dataset(plz, zfsp, B_FALSE);
-		break;
-	case ZFS_TYPE_VOLUME:
-		out = (PyObject *)init_zfs_volume(plz, zfsp, B_FALSE);
-		break;
-	case ZFS_TYPE_SNAPSHOT:
-		out = (PyObject *)init_zfs_snapshot(plz, zfsp, B_FALSE);
-		break;
-	default:
-		PyErr_SetString(PyExc_RuntimeError,
-				"Unsupported ZFS type");
-	}
+	out = py_zfs_resource_from_handle(plz, zfsp, type);
 	if (out == NULL) {
 		// We encountered an error generating python object
 		// and so we need to close the ZFS handle before
@@ -371,6 +551,178 @@ PyObject *py_zfs_resource_open(PyObject *self,
 	return out;
 }
 
+PyDoc_STRVAR(py_zfs_resources_open__doc__,
+"open_resources(*, names, missing_ok=True) -> tuple\n\n"
+"--------------------------------------------------\n\n"
+"Open many ZFS resources in one call. All resources are opened with the\n"
+"libzfs handle lock taken once and the GIL released.\n\n"
+"Parameters\n"
+"----------\n"
+"names: iterable of str, required\n"
+"    Names of the filesystems, volumes, or snapshots to open.\n\n"
+"missing_ok: bool, optional, default=True\n"
+"    If True then names that do not exist are returned in the list of\n"
+"    missing names. If False then a missing name raises ZFSException.\n\n"
+"Returns\n"
+"-------\n"
+"tuple (dict, list)\n"
+"    Dictionary mapping name to truenas_pylibzfs.ZFSDataset, ZFSVolume, or\n"
+"    ZFSSnapshot, and list of names that do not exist.\n\n"
+"Raises:\n"
+"-------\n"
+"TypeError:\n"
+"    \"names\" is not an iterable of strings.\n\n"
+"truenas_pylibzfs.ZFSException:\n"
+"    Opening a resource failed for a reason other than it not existing\n"
+"    (or for any reason if missing_ok is False). No resources are\n"
+"    returned in this case.\n"
+);
+static
+PyObject *py_zfs_resources_open(PyObject *self,
+				PyObject *args_unused,
+				PyObject *kwargs)
+{
+	py_zfs_t *plz = py_zfs_get_handle((py_zfs_t *)self);
+	PyObject *pynames = NULL;
+	PyObject *names = NULL;
+	PyObject *resources = NULL;
+	PyObject *missing = NULL;
+	PyObject *out = NULL;
+	zfs_handle_t **handles = NULL;
+	const char **cnames = NULL;
+	boolean_t failed = B_FALSE;
+	int missing_ok = B_TRUE;
+	py_zfs_error_t zfs_err;
+	Py_ssize_t cnt, i;
+
+	char *kwnames [] = { "names", "missing_ok", NULL };
+
+	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
+					 "|$Op",
+					 kwnames,
+					 &pynames,
+					 &missing_ok)) {
+		return NULL;
+	}
+
+	if (pynames == NULL) {
+		PyErr_SetString(PyExc_ValueError,
+				"The names of the resources to open must be "
+				"passed to this method through the "
+				"\"names\" keyword argument.");
+		return NULL;
+	}
+
+	names = PySequence_Fast(pynames, "names must be an iterable.");
+	if (names == NULL)
+		return NULL;
+
+	cnt = PySequence_Fast_GET_SIZE(names);
+	handles = PyMem_Calloc(cnt ? cnt : 1, sizeof (zfs_handle_t *));
+	cnames = PyMem_Calloc(cnt ? cnt : 1, sizeof (char *));
+	if ((handles == NULL) || (cnames == NULL)) {
+		PyErr_NoMemory();
+		goto out;
+	}
+
+	for (i = 0; i < cnt; i++) {
+		PyObject *name = PySequence_Fast_GET_ITEM(names, i);
+
+		if (!PyUnicode_Check(name)) {
+			PyErr_Format(PyExc_TypeError,
+				     "%R: resource name must be a string.",
+				     name);
+			goto out;
+		}
+
+		// `names` holds a reference to the string
+		cnames[i] = PyUnicode_AsUTF8(name);
+		if (cnames[i] == NULL)
+			goto out;
+	}
+
+	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".open_resources", "O",
+			names) < 0) {
+		goto out;
+	}
+
+	resources = PyDict_New();
+	missing = PyList_New(0);
+	if ((resources == NULL) || (missing == NULL))
+		goto out;
+
+	Py_BEGIN_ALLOW_THREADS
+	PY_ZFS_LOCK(plz);
+	for (i = 0; i < cnt; i++) {
+		uint64_t op_start = py_zfs_stats_now();
+
+		handles[i] = zfs_open(plz->lzh, cnames[i], SUPPORTED_RESOURCES);
+		py_zfs_stats_op(plz, PY_ZFS_OP_OPEN, op_start);
+		if (handles[i] != NULL)
+			continue;
+
+		// Missing names are collected after the GIL is retaken
+		if (missing_ok && (libzfs_errno(plz->lzh) == EZFS_NOENT))
+			continue;
+
+		py_get_zfs_error(plz->lzh, &zfs_err);
+		failed = B_TRUE;
+		break;
+	}
+	PY_ZFS_UNLOCK(plz);
+	Py_END_ALLOW_THREADS
+
+	if (failed) {
+		set_exc_from_libzfs(&zfs_err, "zfs_open() failed");
+		goto out;
+	}
+
+	for (i = 0; i < cnt; i++) {
+		PyObject *name = PySequence_Fast_GET_ITEM(names, i);
+		PyObject *rsrc = NULL;
+		int err;
+
+		if (handles[i] == NULL) {
+			if (PyList_Append(missing, name) < 0)
+				goto out;
+			continue;
+		}
+
+		rsrc = py_zfs_resource_from_handle(plz, handles[i],
+						   zfs_get_type(handles[i]));
+		if (rsrc == NULL)
+			goto out;
+
+		// Handle is now owned by the python object
+		handles[i] = NULL;
+		err = PyDict_SetItem(resources, name, rsrc);
+		Py_DECREF(rsrc);
+		if (err)
+			goto out;
+	}
+
+	out = PyTuple_Pack(2, resources, missing);
+
+out:
+	if (handles != NULL) {
+		Py_BEGIN_ALLOW_THREADS
+		PY_ZFS_LOCK(plz);
+		for (i = 0; i < cnt; i++) {
+			if (handles[i] != NULL)
+				zfs_close(handles[i]);
+		}
+		PY_ZFS_UNLOCK(plz);
+		Py_END_ALLOW_THREADS
+	}
+
+	PyMem_Free(handles);
+	PyMem_Free(cnames);
+	Py_XDECREF(resources);
+	Py_XDECREF(missing);
+	Py_DECREF(names);
+	return out;
+}
+
 PyDoc_STRVAR(py_zfs_resource_destroy__doc__,
 "destroy_resource(*, name) -> bool\n\n"
 "----------------------------------------------\n\n"
@@ -437,6 +789,7 @@ PyObject *py_zfs_resource_destroy(PyObject *self,
 		if (err) {
 			py_get_zfs_error(plz->lzh, &zfs_err);
 		} else {
+			py_zfs_prop_cache_invalidate(plz, name);
 			destroyed = B_TRUE;
 		}
 		zfs_close(zfsp);
@@ -462,8 +815,9 @@ PyObject *py_zfs_pool_open(PyObject *self,
                              PyObject *kwargs)
 {
 	PyObject *out = NULL;
-	py_zfs_t *plz = (py_zfs_t *)self;
+	py_zfs_t *plz = py_zfs_get_handle((py_zfs_t *)self);
 	zpool_handle_t *zhp = NULL;
+	uint64_t op_start;
 	char *name = NULL;
 	py_zfs_error_t zfs_err;
 
@@ -491,7 +845,9 @@ PyObject *py_zfs_pool_open(PyObject *self,
 
 	Py_BEGIN_ALLOW_THREADS
 	PY_ZFS_LOCK(plz);
+	op_start = py_zfs_stats_now();
 	zhp = zpool_open(plz->lzh, name);
+	py_zfs_stats_op(plz, PY_ZFS_OP_OPEN, op_start);
 	if (zhp == NULL) {
 			py_get_zfs_error(plz->lzh, &zfs_err);
 	}
@@ -663,21 +1019,25 @@ PyObject *py_zfs_export_pool(PyObject *self, PyObject *args, PyObject *kwargs)
 }
 
 PyDoc_STRVAR(py_zfs_iter_root_filesystems__doc__,
-"iter_root_filesystems(*, callback, state) -> bool\n\n"
+"iter_root_filesystems(*, callback, state, batch_size=0) -> bool\n\n"
 "----------------------------------------------\n\n"
 "Iterate root filesystems for all imported zpools\n\n"
 "Parameters\n"
 "----------\n"
-"callback: callable\n"
+"callback: callable, optional\n"
 "    Callback function that will be called for every child dataset.\n\n"
 "state: object, optional\n"
 "    Optional python object (for example dictionary) passed as an argument\n"
 "    to the callback function for each root dataset.\n\n"
+"batch_size: int, optional, default=0\n"
+"    If non-zero then the callback function is called with a list of up to\n"
+"    batch_size datasets rather than once per dataset.\n\n"
 "Returns\n"
 "-------\n"
-"bool\n"
+"bool or truenas_pylibzfs.ZFSResourceIterator\n"
 "    Value indicates that iteration completed without being stopped by the\n"
-"    callback fuction returning False.\n\n"
+"    callback fuction returning False. If \"callback\" is omitted then an\n"
+"    iterator yielding datasets is returned instead.\n\n"
 "Raises:\n"
 "-------\n"
 "truenas_pylibzfs.ZFSError:\n"
@@ -688,7 +1048,8 @@ PyDoc_STRVAR(py_zfs_iter_root_filesystems__doc__,
 "Minimally the function signature must take a single argument for each ZFS\n"
 "object. If the \"state\" keyword is specified then the callback function\n"
 "should take two arguments. The callback function must return bool value\n"
-"indicating whether iteration should continue.\n\n"
+"indicating whether iteration should continue. If \"batch_size\" is\n"
+"specified then the first argument is a list of datasets.\n\n"
 "Example \"callback\":\n"
 "-------------------\n"
 "def my_callback(ds, state):\n"
@@ -701,41 +1062,53 @@ PyObject *py_zfs_iter_root_filesystems(PyObject *self,
 				       PyObject *kwargs)
 {
 	int err;
-	py_zfs_t *plz = (py_zfs_t *)self;
+	Py_ssize_t batch_size = 0;
+	py_zfs_t *plz = py_zfs_get_handle((py_zfs_t *)self);
 
 	py_iter_state_t iter_state = (py_iter_state_t){
 		.pylibzfsp = plz,
 	};
 
-	char *kwnames [] = {"callback", "state", NULL};
+	char *kwnames [] = {"callback", "state", "batch_size", NULL};
 
 	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
-					 "|$OO",
+					 "|$OOn",
 					 kwnames,
 					 &iter_state.callback_fn,
-					 &iter_state.private_data)) {
+					 &iter_state.private_data,
+					 &batch_size)) {
 		return NULL;
 
 	}
 
-	if (!iter_state.callback_fn) {
-		PyErr_SetString(PyExc_ValueError,
-				"`callback` keyword argument is required.");
-		return NULL;
-	}
-
-	if (!PyCallable_Check(iter_state.callback_fn)) {
+	if (iter_state.callback_fn == NULL) {
+		// No callback means caller wants a ZFSResourceIterator
+		if ((iter_state.private_data != NULL) || batch_size) {
+			PyErr_SetString(PyExc_ValueError,
+					"`state` and `batch_size` require a "
+					"`callback` keyword argument.");
+			return NULL;
+		}
+	} else if (!PyCallable_Check(iter_state.callback_fn)) {
 		PyErr_SetString(PyExc_TypeError,
 				"callback function must be callable.");
 		return NULL;
 	}
 
+	if (py_iter_set_batch_size(&iter_state, batch_size) < 0)
+		return NULL;
+
 	// There aren't any useful arguments we can pass to sys.audit
 	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".iter_root_filesystems",
 			"O", Py_None) < 0) {
 		return NULL;
 	}
 
+	if (iter_state.callback_fn == NULL) {
+		return py_zfs_resource_iter_create(&iter_state, NULL,
+						   PY_ITER_ROOT_FILESYSTEMS);
+	}
+
 	err = py_iter_root_filesystems(&iter_state);
 	if ((err == ITER_RESULT_ERROR) || (err == ITER_RESULT_IOCTL_ERROR)) {
 		// Exception is set by callback function
@@ -750,21 +1123,25 @@ PyObject *py_zfs_iter_root_filesystems(PyObject *self,
 }
 
 PyDoc_STRVAR(py_zfs_iter_pools__doc__,
-"iter_pools(*, callback, state) -> bool\n\n"
+"iter_pools(*, callback, state, batch_size=0) -> bool\n\n"
 "----------------------------------------------\n\n"
 "Iterate all pools on the system.\n\n"
 "Parameters\n"
 "----------\n"
-"callback: callable\n"
+"callback: callable, optional\n"
 "    Callback function that will be called for every pool.\n\n"
 "state: object, optional\n"
 "    Optional python object (for example dictionary) passed as an argument\n"
 "    to the callback function for each pool.\n\n"
+"batch_size: int, optional, default=0\n"
+"    If non-zero then the callback function is called with a list of up to\n"
+"    batch_size pools rather than once per pool.\n\n"
 "Returns\n"
 "-------\n"
-"bool\n"
+"bool or truenas_pylibzfs.ZFSResourceIterator\n"
 "    Value indicates that iteration completed without being stopped by the\n"
-"    callback fuction returning False.\n\n"
+"    callback fuction returning False. If \"callback\" is omitted then an\n"
+"    iterator yielding pools is returned instead.\n\n"
 "Raises:\n"
 "-------\n"
 "truenas_pylibzfs.ZFSError:\n"
@@ -775,7 +1152,8 @@ PyDoc_STRVAR(py_zfs_iter_pools__doc__,
 "Minimally the function signature must take a single argument for each zpool\n"
 "object. If the \"state\" keyword is specified then the callback function\n"
 "should take two arguments. The callback function must return bool value\n"
-"indicating whether iteration should continue.\n\n"
+"indicating whether iteration should continue. If \"batch_size\" is\n"
+"specified then the first argument is a list of pools.\n\n"
 "Example \"callback\":\n"
 "-------------------\n"
 "def my_callback(pool, state):\n"
@@ -788,40 +1166,52 @@ PyObject *py_zfs_iter_pools(PyObject *self,
 			    PyObject *kwargs)
 {
 	int err;
-	py_zfs_t *plz = (py_zfs_t *)self;
+	Py_ssize_t batch_size = 0;
+	py_zfs_t *plz = py_zfs_get_handle((py_zfs_t *)self);
 
 	py_iter_state_t iter_state = (py_iter_state_t){
 		.pylibzfsp = plz,
 	};
 
-	char *kwnames [] = {"callback", "state", NULL};
+	char *kwnames [] = {"callback", "state", "batch_size", NULL};
 
 	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
-					 "|$OO",
+					 "|$OOn",
 					 kwnames,
 					 &iter_state.callback_fn,
-					 &iter_state.private_data)) {
+					 &iter_state.private_data,
+					 &batch_size)) {
 		return NULL;
 	}
 
-	if (!iter_state.callback_fn) {
-		PyErr_SetString(PyExc_ValueError,
-				"`callback` keyword argument is required.");
-		return NULL;
-	}
-
-	if (!PyCallable_Check(iter_state.callback_fn)) {
+	if (iter_state.callback_fn == NULL) {
+		// No callback means caller wants a ZFSResourceIterator
+		if ((iter_state.private_data != NULL) || batch_size) {
+			PyErr_SetString(PyExc_ValueError,
+					"`state` and `batch_size` require a "
+					"`callback` keyword argument.");
+			return NULL;
+		}
+	} else if (!PyCallable_Check(iter_state.callback_fn)) {
 		PyErr_SetString(PyExc_TypeError,
 				"callback function must be callable.");
 		return NULL;
 	}
 
+	if (py_iter_set_batch_size(&iter_state, batch_size) < 0)
+		return NULL;
+
 	// There aren't any useful arguments we can pass to sys.audit
 	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".iter_pools",
 			"O", Py_None) < 0) {
 		return NULL;
 	}
 
+	if (iter_state.callback_fn == NULL) {
+		return py_zfs_resource_iter_create(&iter_state, NULL,
+						   PY_ITER_POOLS);
+	}
+
 	err = py_iter_pools(&iter_state);
 	if ((err == ITER_RESULT_ERROR) || (err == ITER_RESULT_IOCTL_ERROR)) {
 		// Exception is set by callback function
@@ -1060,6 +1450,169 @@ py_zfs_create_pool(PyObject *self, PyObject *args, PyObject *kwargs)
 	return py_zfs_do_create_pool(plz, &cpa);
 }
 
+PyDoc_STRVAR(py_zfs_query__doc__,
+"query(*, root=None, properties=None, get_source=False,\n"
+"      get_user_properties=False, recursive=False, types=None,\n"
+"      select=None, filter=None) -> list[dict]\n"
+"-------------------------------------------------------------\n\n"
+"Walk the ZFS dataset tree and return a list of dictionaries describing\n"
+"the ZFS resources found. The walk, property retrieval, and dictionary\n"
+"construction are performed in a single call under one acquisition of the\n"
+"libzfs handle lock, and no ZFSDataset / ZFSVolume / ZFSSnapshot objects\n"
+"are created.\n\n"
+"Parameters\n"
+"----------\n"
+"root: str, optional\n"
+"    Name of filesystem or volume at which to start. The root is included\n"
+"    in the results. If omitted then the root filesystems of all imported\n"
+"    pools are used.\n\n"
+"properties: set | truenas_pylibzfs.ZFSPropertySelector, optional\n"
+"    Set of truenas_pylibzfs.ZFSProperty properties (or a selector) to\n"
+"    retrieve. Properties that do not apply to a resource's type are\n"
+"    omitted for that resource.\n\n"
+"get_source: bool, optional, default=False\n"
+"    Include the source information for the returned properties.\n\n"
+"get_user_properties: bool, optional, default=False\n"
+"    Include user properties.\n\n"
+"recursive: bool, optional, default=False\n"
+"    Include all descendants of the root(s) rather than only the root(s).\n\n"
+"types: iterable of truenas_pylibzfs.ZFSType, optional\n"
+"    Types of ZFS resources to include. Defaults to filesystems and\n"
+"    volumes. Include ZFS_TYPE_SNAPSHOT to also list snapshots of every\n"
+"    dataset visited.\n\n"
+"select: iterable of str, optional\n"
+"    Keys to include in each dictionary. Defaults to all of: name, pool,\n"
+"    type, type_enum, createtxg, guid, properties, user_properties.\n\n"
+"filter: truenas_pylibzfs.libzfs_types.ZFSFilter, optional\n"
+"    Filter created by truenas_pylibzfs.create_filter(). Children of\n"
+"    resources that do not match are still visited.\n\n"
+"Returns\n"
+"-------\n"
+"list of dictionaries with the same keys and values as those returned by\n"
+"ZFSResource.asdict() (excluding \"crypto\").\n\n"
+"Raises:\n"
+"-------\n"
+"truenas_pylibzfs.ZFSError:\n"
+"    The root could not be opened or an error occurred during iteration.\n\n"
+"ValueError:\n"
+"    An invalid type or select field was specified.\n\n"
+"TypeError:\n"
+"    An argument has an unexpected type.\n"
+);
+static PyObject *
+py_zfs_query_impl(PyObject *self, PyObject *args, PyObject *kwargs,
+    boolean_t json)
+{
+	py_zfs_t *plz = py_zfs_get_handle((py_zfs_t *)self);
+	py_zfs_query_args_t qa = { .json = json };
+	char *kwnames[] = {
+		"root", "properties", "get_source", "get_user_properties",
+		"recursive", "types", "select", "filter",
+		NULL
+	};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$zOpppOOO",
+	    kwnames,
+	    &qa.root, &qa.properties, &qa.get_source,
+	    &qa.get_user_properties, &qa.recursive, &qa.types,
+	    &qa.select, &qa.filter))
+		return NULL;
+
+	if (PySys_Audit(json ? PYLIBZFS_MODULE_NAME ".query_json" :
+	    PYLIBZFS_MODULE_NAME ".query", "O", kwargs ? kwargs : Py_None) < 0)
+		return NULL;
+
+	return py_zfs_do_query(plz, &qa);
+}
+
+static PyObject *
+py_zfs_query(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	return py_zfs_query_impl(self, args, kwargs, B_FALSE);
+}
+
+PyDoc_STRVAR(py_zfs_query_json__doc__,
+"query_json(*, root=None, properties=None, get_source=False,\n"
+"           get_user_properties=False, recursive=False, types=None,\n"
+"           select=None, filter=None) -> bytes\n"
+"------------------------------------------------------------------\n\n"
+"Same as query() except that the result is returned as UTF-8 encoded JSON.\n"
+"Entries are written directly from libzfs data during the walk and the\n"
+"GIL is not re-acquired per resource.\n\n"
+"Parameters\n"
+"----------\n"
+"Same as query().\n\n"
+"Returns\n"
+"-------\n"
+"bytes containing a compact JSON array equal to json.dumps() of the list\n"
+"returned by query(). Enums (type_enum, property source type) are written\n"
+"as their integer values.\n\n"
+"Raises:\n"
+"-------\n"
+"Same as query().\n"
+);
+static PyObject *
+py_zfs_query_json(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	return py_zfs_query_impl(self, args, kwargs, B_TRUE);
+}
+
+PyDoc_STRVAR(py_zfs_set_properties_bulk__doc__,
+"set_properties_bulk(*, properties, remount=True) -> dict\n"
+"--------------------------------------------------------\n\n"
+"Set ZFS properties on many filesystems and volumes in a single call.\n"
+"All datasets are opened, updated, and closed with one acquisition of the\n"
+"libzfs handle lock per pass rather than one per dataset.\n\n"
+"Parameters\n"
+"----------\n"
+"properties: dict, required\n"
+"    Dictionary mapping dataset name to the properties to set on it. The\n"
+"    properties for each dataset take any form accepted by\n"
+"    ZFSResource.set_properties().\n\n"
+"remount: bool, optional, default=True\n"
+"    Automatically remount datasets on change of the mountpoint, sharenfs,\n"
+"    or sharesmb properties.\n\n"
+"Returns\n"
+"-------\n"
+"dict mapping the name of each dataset that could not be opened or\n"
+"updated to a tuple of (truenas_pylibzfs.ZFSError code, description).\n"
+"An empty dict is returned if all updates succeeded. A failure for one\n"
+"dataset does not prevent updates to the others.\n\n"
+"Raises:\n"
+"-------\n"
+"TypeError:\n"
+"    properties is not a dictionary or contains unexpected types.\n\n"
+"ValueError:\n"
+"    A property is readonly or not valid for the type of the dataset. No\n"
+"    changes are made in this case.\n\n"
+"RuntimeError:\n"
+"    Writing zpool history failed for one or more datasets. This is raised\n"
+"    after all updates are attempted, and the properties of the named\n"
+"    datasets were updated.\n\n"
+"NOTE: updates are not atomic across datasets. ZFS channel programs only\n"
+"support setting user properties and so are not used here.\n"
+);
+static PyObject *
+py_zfs_set_properties_bulk(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	py_zfs_t *plz = (py_zfs_t *)self;
+	PyObject *pyprops = NULL;
+	boolean_t remount = B_TRUE;
+	char *kwnames[] = { "properties", "remount", NULL };
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$Op",
+					 kwnames, &pyprops, &remount))
+		return NULL;
+
+	if (pyprops == NULL) {
+		PyErr_SetString(PyExc_ValueError,
+				"properties keyword argument is required.");
+		return NULL;
+	}
+
+	return py_zfs_do_set_properties_bulk(plz, pyprops, remount);
+}
+
 PyDoc_STRVAR(py_zfs_import_pool_find__doc__,
 "import_pool_find(*, cache_file=None, device=None) -> list[struct_zpool_status]\n\n"
 "-------------------------------------------------------------------------------\n\n"
@@ -1533,7 +2086,138 @@ PyObject *py_zfs_import_pool(PyObject *self,
 	return out;
 }
 
+PyDoc_STRVAR(py_zfs_property_cache_stats__doc__,
+"property_cache_stats() -> dict\n"
+"------------------------------\n\n"
+"Return counters for the property cache enabled through\n"
+"open_handle(property_cache_ttl=...).\n\n"
+""
+"Returns\n"
+"-------\n"
+"dict\n"
+"    ttl: float - entry lifetime in seconds (0 if the cache is disabled)\n"
+"    entries: int - number of datasets currently cached\n"
+"    hits: int - get_properties() / asdict() calls served from the cache\n"
+"    misses: int - calls that had to read from ZFS\n"
+"    invalidations: int - entries dropped due to changes or clear\n"
+);
+static PyObject *
+py_zfs_property_cache_stats(PyObject *self, PyObject *args_unused)
+{
+	py_zfs_t *plz = (py_zfs_t *)self;
+	py_zfs_prop_cache_t cache;
+	uint64_t nentries = 0;
+
+	Py_BEGIN_ALLOW_THREADS
+	PY_ZFS_LOCK(plz);
+	cache = plz->prop_cache;
+	if (cache.entries != NULL)
+		nentries = fnvlist_num_pairs(cache.entries);
+	PY_ZFS_UNLOCK(plz);
+	Py_END_ALLOW_THREADS
+
+	return Py_BuildValue("{s:d,s:K,s:K,s:K,s:K}",
+			     "ttl", (double)cache.ttl_ns / 1000000000.0,
+			     "entries", (unsigned long long)nentries,
+			     "hits", (unsigned long long)cache.hits,
+			     "misses", (unsigned long long)cache.misses,
+			     "invalidations",
+			     (unsigned long long)cache.invalidations);
+}
+
+PyDoc_STRVAR(py_zfs_clear_property_cache__doc__,
+"clear_property_cache() -> None\n"
+"------------------------------\n\n"
+"Drop all entries from the property cache of this handle.\n"
+);
+static PyObject *
+py_zfs_clear_property_cache(PyObject *self, PyObject *args_unused)
+{
+	py_zfs_t *plz = (py_zfs_t *)self;
+
+	Py_BEGIN_ALLOW_THREADS
+	PY_ZFS_LOCK(plz);
+	py_zfs_prop_cache_clear(plz);
+	PY_ZFS_UNLOCK(plz);
+	Py_END_ALLOW_THREADS
+
+	Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(py_zfs_stats__doc__,
+"stats() -> dict\n"
+"---------------\n\n"
+"Return lock contention and operation timing counters for this handle.\n"
+"If the handle was opened with pool_size > 1 then the counters of all\n"
+"handles in the pool are combined. All times are in nanoseconds.\n\n"
+""
+"Returns\n"
+"-------\n"
+"dict\n"
+"    handles: int - number of libzfs handles included\n"
+"    lock: dict\n"
+"        acquisitions: int - number of times the handle lock was taken\n"
+"        wait_total_ns / wait_max_ns: int - time spent waiting for the lock\n"
+"        hold_total_ns / hold_max_ns: int - time the lock was held\n"
+"        wait_histogram / hold_histogram: tuple of int - log2 histogram.\n"
+"            Index 0 counts times under 1 microsecond, index N counts\n"
+"            times in [2^(N-1), 2^N) microseconds. The last index also\n"
+"            counts all longer times.\n"
+"    operations: dict keyed by \"open\", \"prop_get\", \"prop_set\",\n"
+"        \"iter\", \"mount\", and \"send\". Each value is a dict with\n"
+"        count, total_ns, and max_ns of the libzfs calls made by the\n"
+"        corresponding methods while the lock was held. Iteration times\n"
+"        include time spent in callback functions. Send times cover\n"
+"        the entire local_replicate() call.\n"
+);
+static PyObject *
+py_zfs_stats(PyObject *self, PyObject *args_unused)
+{
+	return py_zfs_stats_dict((py_zfs_t *)self);
+}
+
+PyDoc_STRVAR(py_zfs_reset_stats__doc__,
+"reset_stats() -> None\n"
+"---------------------\n\n"
+"Reset all counters reported by stats() to zero.\n"
+);
+static PyObject *
+py_zfs_reset_stats(PyObject *self, PyObject *args_unused)
+{
+	py_zfs_stats_reset((py_zfs_t *)self);
+	Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(py_zfs_get_aio__doc__,
+"Awaitable variants of frequently used methods for use with asyncio.\n\n"
+"Each method returns an asyncio.Future of the running event loop. A pool\n"
+"of aio_workers threads (see open_handle()) calls the synchronous method\n"
+"with the GIL held, which in turn releases it around libzfs calls. This\n"
+"is equivalent to loop.run_in_executor() with a bounded queue: if more\n"
+"than aio_queue_depth requests are waiting for a worker then further\n"
+"calls raise BlockingIOError. Cancelling the future only prevents a\n"
+"request that has not been picked up by a worker yet from running.\n"
+);
+static PyObject *
+py_zfs_get_aio(PyObject *self, void *extra)
+{
+	py_zfs_t *plz = (py_zfs_t *)self;
+
+	if (plz->aio_pool == NULL) {
+		PyErr_SetString(PyExc_RuntimeError,
+				"aio is not available on this handle.");
+		return NULL;
+	}
+
+	return py_zfs_aio_new(plz);
+}
+
 PyGetSetDef zfs_getsetters[] = {
+	{
+		.name	= "aio",
+		.get	= (getter)py_zfs_get_aio,
+		.doc	= py_zfs_get_aio__doc__,
+	},
 	{ .name = NULL }
 };
 
@@ -1549,6 +2233,12 @@ PyMethodDef zfs_methods[] = {
 		.ml_meth = (PyCFunction)py_zfs_resource_open,
 		.ml_flags = METH_VARARGS | METH_KEYWORDS
 	},
+	{
+		.ml_name = "open_resources",
+		.ml_meth = (PyCFunction)py_zfs_resources_open,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_resources_open__doc__
+	},
 	{
 		.ml_name = "destroy_resource",
 		.ml_meth = (PyCFunction)py_zfs_resource_destroy,
@@ -1602,6 +2292,24 @@ PyMethodDef zfs_methods[] = {
 		.ml_flags = METH_VARARGS | METH_KEYWORDS,
 		.ml_doc = py_zfs_create_pool__doc__
 	},
+	{
+		.ml_name = "query",
+		.ml_meth = (PyCFunction)py_zfs_query,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_query__doc__
+	},
+	{
+		.ml_name = "query_json",
+		.ml_meth = (PyCFunction)py_zfs_query_json,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_query_json__doc__
+	},
+	{
+		.ml_name = "set_properties_bulk",
+		.ml_meth = (PyCFunction)py_zfs_set_properties_bulk,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_set_properties_bulk__doc__
+	},
 	{
 		.ml_name = "import_pool_find",
 		.ml_meth = (PyCFunction)py_zfs_import_pool_find,
@@ -1614,6 +2322,30 @@ PyMethodDef zfs_methods[] = {
 		.ml_flags = METH_VARARGS | METH_KEYWORDS,
 		.ml_doc = py_zfs_import_pool__doc__
 	},
+	{
+		.ml_name = "property_cache_stats",
+		.ml_meth = py_zfs_property_cache_stats,
+		.ml_flags = METH_NOARGS,
+		.ml_doc = py_zfs_property_cache_stats__doc__
+	},
+	{
+		.ml_name = "clear_property_cache",
+		.ml_meth = py_zfs_clear_property_cache,
+		.ml_flags = METH_NOARGS,
+		.ml_doc = py_zfs_clear_property_cache__doc__
+	},
+	{
+		.ml_name = "stats",
+		.ml_meth = py_zfs_stats,
+		.ml_flags = METH_NOARGS,
+		.ml_doc = py_zfs_stats__doc__
+	},
+	{
+		.ml_name = "reset_stats",
+		.ml_meth = py_zfs_reset_stats,
+		.ml_flags = METH_NOARGS,
+		.ml_doc = py_zfs_reset_stats__doc__
+	},
 	{ NULL, NULL, 0, NULL }
 };
 
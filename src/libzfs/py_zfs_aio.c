@@ -0,0 +1,779 @@
+#include "../truenas_pylibzfs.h"
+#include <pthread.h>
+
+/*
+ * Implementation of ZFS.aio
+ *
+ * Methods of ZFSAio return an asyncio.Future created on the running event
+ * loop and queue a job for a pool of native worker threads owned by the
+ * ZFS handle. A worker takes the GIL, skips the job if the future has
+ * already been cancelled, and otherwise calls the synchronous method of
+ * the ZFS / ZFSResource / ZFSPool object. Those release the GIL and take
+ * the zfs_lock around libzfs calls as usual. The result or exception is
+ * passed back to the event loop with loop.call_soon_threadsafe(), and the
+ * future is completed on the loop thread unless it was cancelled
+ * meanwhile.
+ *
+ * This does not move any libzfs work off the GIL beyond what the
+ * synchronous methods already do, so it has no advantage over
+ * loop.run_in_executor() other than the bounded queue and not needing a
+ * concurrent.futures executor. Cancellation only takes effect for jobs
+ * that a worker has not picked up yet.
+ *
+ * Workers are started on the first submission. The number of jobs that
+ * are queued but not yet running is bounded by aio_queue_depth. Submitting
+ * to a full queue raises BlockingIOError rather than blocking the event
+ * loop. asyncio.get_running_loop and the completion callable are looked up
+ * once and kept in the module state.
+ *
+ * Workers are detached. Queued and running jobs hold references to the
+ * objects they operate on and therefore to the ZFS handle, so the pool is
+ * idle when py_zfs_aio_pool_destroy() is called from py_zfs_dealloc().
+ * The exception is when a worker drops the last reference to the handle
+ * itself while cleaning up a job. In that case destroy does not wait and
+ * the last worker to exit frees the pool.
+ */
+
+typedef struct aio_job {
+	PyObject *fn;
+	PyObject *kwargs;
+	PyObject *loop;
+	PyObject *future;
+	PyObject *complete;
+	boolean_t to_list;
+} aio_job_t;
+
+struct py_zfs_aio_pool {
+	pthread_mutex_t lock;
+	pthread_cond_t work_cv;
+	pthread_cond_t exit_cv;
+	aio_job_t **queue;
+	size_t depth;
+	size_t head;
+	size_t count;
+	size_t nworkers;
+	size_t nstarted;
+	size_t nalive;
+	pthread_t *threads;
+	boolean_t started;
+	boolean_t shutdown;
+	boolean_t orphaned;
+};
+
+typedef struct {
+	PyObject_HEAD
+	py_zfs_t *pylibzfsp;
+} py_zfs_aio_t;
+
+static void
+aio_job_free(aio_job_t *job)
+{
+	// GIL required
+	Py_XDECREF(job->fn);
+	Py_XDECREF(job->kwargs);
+	Py_XDECREF(job->loop);
+	Py_XDECREF(job->future);
+	Py_XDECREF(job->complete);
+	PyMem_RawFree(job);
+}
+
+static void
+aio_pool_free(py_zfs_aio_pool_t *pool)
+{
+	pthread_cond_destroy(&pool->exit_cv);
+	pthread_cond_destroy(&pool->work_cv);
+	pthread_mutex_destroy(&pool->lock);
+	PyMem_RawFree(pool->threads);
+	PyMem_RawFree(pool->queue);
+	PyMem_RawFree(pool);
+}
+
+/*
+ * Called on the event loop thread through call_soon_threadsafe().
+ * args: (future, result, exception)
+ */
+static PyObject *
+aio_complete(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+{
+	PyObject *done;
+	int is_done;
+
+	if (nargs != 3) {
+		PyErr_SetString(PyExc_TypeError, "expected 3 arguments.");
+		return NULL;
+	}
+
+	done = PyObject_CallMethod(args[0], "done", NULL);
+	if (done == NULL)
+		return NULL;
+
+	is_done = PyObject_IsTrue(done);
+	Py_DECREF(done);
+	if (is_done < 0)
+		return NULL;
+
+	// Future was cancelled while the job was running
+	if (is_done)
+		Py_RETURN_NONE;
+
+	if (args[2] != Py_None)
+		return PyObject_CallMethod(args[0], "set_exception", "O", args[2]);
+
+	return PyObject_CallMethod(args[0], "set_result", "O", args[1]);
+}
+
+static PyMethodDef aio_complete_def = {
+	.ml_name = "_aio_complete",
+	.ml_meth = (PyCFunction)aio_complete,
+	.ml_flags = METH_FASTCALL,
+};
+
+/*
+ * Store `obj` in `*slot` unless another thread got there first. Steals the
+ * reference to `obj`.
+ */
+static void
+aio_state_publish(PyObject **slot, PyObject *obj)
+{
+	PyObject *expected = NULL;
+
+	if (!__atomic_compare_exchange_n(slot, &expected, obj, B_FALSE,
+					 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+		Py_DECREF(obj);
+}
+
+/*
+ * Look up asyncio.get_running_loop and create the completion callable on
+ * the first submission and keep them in the module state.
+ */
+static int
+aio_state_init(pylibzfs_state_t *state)
+{
+	PyObject *asyncio = NULL;
+	PyObject *obj = NULL;
+
+	if (__atomic_load_n(&state->aio_complete, __ATOMIC_ACQUIRE) != NULL)
+		return 0;
+
+	asyncio = PyImport_ImportModule("asyncio");
+	if (asyncio == NULL)
+		return -1;
+
+	obj = PyObject_GetAttrString(asyncio, "get_running_loop");
+	Py_DECREF(asyncio);
+	if (obj == NULL)
+		return -1;
+
+	aio_state_publish(&state->aio_get_running_loop, obj);
+
+	obj = PyCFunction_New(&aio_complete_def, NULL);
+	if (obj == NULL)
+		return -1;
+
+	aio_state_publish(&state->aio_complete, obj);
+	return 0;
+}
+
+static void
+aio_run_job(aio_job_t *job)
+{
+	PyGILState_STATE gstate;
+	PyObject *cancelled = NULL;
+	PyObject *result = NULL;
+	PyObject *exc = NULL;
+	PyObject *ret = NULL;
+	int is_cancelled;
+
+	gstate = PyGILState_Ensure();
+
+	cancelled = PyObject_CallMethod(job->future, "cancelled", NULL);
+	if (cancelled == NULL) {
+		PyErr_WriteUnraisable(job->future);
+		goto out;
+	}
+
+	is_cancelled = PyObject_IsTrue(cancelled);
+	Py_DECREF(cancelled);
+	if (is_cancelled) {
+		if (is_cancelled < 0)
+			PyErr_WriteUnraisable(job->future);
+		goto out;
+	}
+
+	result = PyObject_VectorcallDict(job->fn, NULL, 0, job->kwargs);
+	if ((result != NULL) && job->to_list)
+		Py_SETREF(result, PySequence_List(result));
+
+	if (result == NULL)
+		exc = PyErr_GetRaisedException();
+
+	ret = PyObject_CallMethod(job->loop, "call_soon_threadsafe", "OOOO",
+				  job->complete, job->future,
+				  result ? result : Py_None,
+				  exc ? exc : Py_None);
+	if (ret == NULL) {
+		// Most likely the event loop was closed. There is nobody
+		// left to receive the result.
+		PyErr_WriteUnraisable(job->loop);
+	}
+
+out:
+	Py_XDECREF(ret);
+	Py_XDECREF(result);
+	Py_XDECREF(exc);
+	aio_job_free(job);
+	PyGILState_Release(gstate);
+}
+
+static void *
+aio_worker(void *arg)
+{
+	py_zfs_aio_pool_t *pool = arg;
+	boolean_t orphaned;
+
+	pthread_mutex_lock(&pool->lock);
+	for (;;) {
+		aio_job_t *job;
+
+		while ((pool->count == 0) && !pool->shutdown)
+			pthread_cond_wait(&pool->work_cv, &pool->lock);
+
+		if (pool->shutdown)
+			break;
+
+		job = pool->queue[pool->head];
+		pool->queue[pool->head] = NULL;
+		pool->head = (pool->head + 1) % pool->depth;
+		pool->count--;
+
+		pthread_mutex_unlock(&pool->lock);
+		aio_run_job(job);
+		pthread_mutex_lock(&pool->lock);
+	}
+
+	pool->nalive--;
+	orphaned = pool->orphaned && (pool->nalive == 0);
+	pthread_cond_broadcast(&pool->exit_cv);
+	pthread_mutex_unlock(&pool->lock);
+
+	if (orphaned)
+		aio_pool_free(pool);
+
+	return NULL;
+}
+
+py_zfs_aio_pool_t *
+py_zfs_aio_pool_create(size_t nworkers, size_t depth)
+{
+	py_zfs_aio_pool_t *pool = NULL;
+
+	pool = PyMem_RawCalloc(1, sizeof (py_zfs_aio_pool_t));
+	if (pool == NULL)
+		return NULL;
+
+	pool->queue = PyMem_RawCalloc(depth, sizeof (aio_job_t *));
+	pool->threads = PyMem_RawCalloc(nworkers, sizeof (pthread_t));
+	if ((pool->queue == NULL) || (pool->threads == NULL)) {
+		PyMem_RawFree(pool->threads);
+		PyMem_RawFree(pool->queue);
+		PyMem_RawFree(pool);
+		return NULL;
+	}
+
+	pool->depth = depth;
+	pool->nworkers = nworkers;
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->work_cv, NULL);
+	pthread_cond_init(&pool->exit_cv, NULL);
+	return pool;
+}
+
+static boolean_t
+aio_pool_is_worker(py_zfs_aio_pool_t *pool)
+{
+	size_t i;
+
+	for (i = 0; i < pool->nstarted; i++) {
+		if (pthread_equal(pool->threads[i], pthread_self()))
+			return B_TRUE;
+	}
+
+	return B_FALSE;
+}
+
+void
+py_zfs_aio_pool_destroy(py_zfs_aio_pool_t *pool)
+{
+	boolean_t wait;
+
+	if (pool == NULL)
+		return;
+
+	pthread_mutex_lock(&pool->lock);
+	if (pool->nalive == 0) {
+		pthread_mutex_unlock(&pool->lock);
+		aio_pool_free(pool);
+		return;
+	}
+
+	pool->shutdown = B_TRUE;
+	pthread_cond_broadcast(&pool->work_cv);
+
+	wait = !aio_pool_is_worker(pool);
+	if (!wait)
+		pool->orphaned = B_TRUE;
+	pthread_mutex_unlock(&pool->lock);
+
+	if (!wait)
+		return;
+
+	Py_BEGIN_ALLOW_THREADS
+	pthread_mutex_lock(&pool->lock);
+	while (pool->nalive != 0)
+		pthread_cond_wait(&pool->exit_cv, &pool->lock);
+	pthread_mutex_unlock(&pool->lock);
+	Py_END_ALLOW_THREADS
+
+	aio_pool_free(pool);
+}
+
+/*
+ * Start workers if needed and queue the job. Returns 0 on success,
+ * EAGAIN if the queue is full, or the pthread_create() error if no
+ * worker could be started. Called with pool->lock held.
+ */
+static int
+aio_pool_enqueue_locked(py_zfs_aio_pool_t *pool, aio_job_t *job)
+{
+	if (!pool->started) {
+		pthread_attr_t attr;
+		size_t i;
+		int err = 0;
+
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+		for (i = 0; i < pool->nworkers; i++) {
+			err = pthread_create(&pool->threads[i], &attr,
+					     aio_worker, pool);
+			if (err)
+				break;
+			pool->nalive++;
+		}
+		pool->nstarted = pool->nalive;
+		pthread_attr_destroy(&attr);
+
+		// Run with however many workers could be started
+		if (pool->nalive == 0)
+			return err;
+
+		pool->started = B_TRUE;
+	}
+
+	if (pool->count == pool->depth)
+		return EAGAIN;
+
+	pool->queue[(pool->head + pool->count) % pool->depth] = job;
+	pool->count++;
+	pthread_cond_signal(&pool->work_cv);
+	return 0;
+}
+
+static PyObject *
+aio_submit(py_zfs_aio_t *self,
+	   PyObject *target,
+	   const char *method,
+	   PyObject *kwargs,
+	   boolean_t to_list)
+{
+	py_zfs_aio_pool_t *pool = self->pylibzfsp->aio_pool;
+	pylibzfs_state_t *state = py_get_module_state(self->pylibzfsp);
+	aio_job_t *job = NULL;
+	PyObject *out = NULL;
+	int err;
+
+	job = PyMem_RawCalloc(1, sizeof (aio_job_t));
+	if (job == NULL)
+		return PyErr_NoMemory();
+
+	job->to_list = to_list;
+	job->kwargs = Py_XNewRef(kwargs);
+
+	job->fn = PyObject_GetAttrString(target, method);
+	if (job->fn == NULL)
+		goto out;
+
+	if (aio_state_init(state) < 0)
+		goto out;
+
+	job->complete = Py_NewRef(state->aio_complete);
+
+	// Raises RuntimeError if called outside of a coroutine
+	job->loop = PyObject_CallNoArgs(state->aio_get_running_loop);
+	if (job->loop == NULL)
+		goto out;
+
+	job->future = PyObject_CallMethod(job->loop, "create_future", NULL);
+	if (job->future == NULL)
+		goto out;
+
+	out = Py_NewRef(job->future);
+
+	pthread_mutex_lock(&pool->lock);
+	err = aio_pool_enqueue_locked(pool, job);
+	pthread_mutex_unlock(&pool->lock);
+
+	if (err == 0) {
+		job = NULL;
+	} else if (err == EAGAIN) {
+		Py_CLEAR(out);
+		PyErr_Format(PyExc_BlockingIOError,
+			     "aio queue is full (%zu requests pending).",
+			     pool->depth);
+	} else {
+		Py_CLEAR(out);
+		errno = err;
+		PyErr_SetFromErrno(PyExc_OSError);
+	}
+
+out:
+	if (job != NULL)
+		aio_job_free(job);
+	return out;
+}
+
+/*
+ * Submit a method call on the object passed in the keyword argument
+ * `target_kw`. Remaining keyword arguments are passed to the method.
+ */
+static PyObject *
+aio_submit_on(py_zfs_aio_t *self,
+	      PyObject *args,
+	      PyObject *kwargs,
+	      const char *target_kw,
+	      PyTypeObject *target_type,
+	      const char *method,
+	      boolean_t to_list)
+{
+	PyObject *target = NULL;
+	PyObject *kw = NULL;
+	PyObject *out = NULL;
+
+	if (PyTuple_GET_SIZE(args) != 0) {
+		PyErr_SetString(PyExc_TypeError,
+				"arguments are keyword-only.");
+		return NULL;
+	}
+
+	if (kwargs != NULL) {
+		target = PyDict_GetItemString(kwargs, target_kw);
+	}
+
+	if (target == NULL) {
+		PyErr_Format(PyExc_ValueError,
+			     "\"%s\" keyword argument is required.",
+			     target_kw);
+		return NULL;
+	}
+
+	if (!PyObject_TypeCheck(target, target_type)) {
+		PyErr_Format(PyExc_TypeError,
+			     "%s: expected %s object.",
+			     target_kw, target_type->tp_name);
+		return NULL;
+	}
+
+	if (to_list && PyDict_GetItemString(kwargs, "callback") != NULL) {
+		PyErr_SetString(PyExc_ValueError,
+				"\"callback\" may not be used with "
+				"ZFS.aio iteration methods.");
+		return NULL;
+	}
+
+	kw = PyDict_Copy(kwargs);
+	if (kw == NULL)
+		return NULL;
+
+	if (PyDict_DelItemString(kw, target_kw) == 0)
+		out = aio_submit(self, target, method, kw, to_list);
+
+	Py_DECREF(kw);
+	return out;
+}
+
+static PyObject *
+aio_submit_on_handle(py_zfs_aio_t *self,
+		     PyObject *args,
+		     PyObject *kwargs,
+		     const char *method,
+		     boolean_t to_list)
+{
+	if (PyTuple_GET_SIZE(args) != 0) {
+		PyErr_SetString(PyExc_TypeError,
+				"arguments are keyword-only.");
+		return NULL;
+	}
+
+	if (to_list && (kwargs != NULL) &&
+	    (PyDict_GetItemString(kwargs, "callback") != NULL)) {
+		PyErr_SetString(PyExc_ValueError,
+				"\"callback\" may not be used with "
+				"ZFS.aio iteration methods.");
+		return NULL;
+	}
+
+	return aio_submit(self, (PyObject *)self->pylibzfsp, method, kwargs,
+			  to_list);
+}
+
+PyDoc_STRVAR(py_zfs_aio_open_resource__doc__,
+"open_resource(*, name) -> asyncio.Future\n"
+"----------------------------------------\n\n"
+"Awaitable variant of ZFS.open_resource(). Keyword arguments are the same.\n"
+);
+static PyObject *
+py_zfs_aio_open_resource(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	return aio_submit_on_handle((py_zfs_aio_t *)self, args, kwargs,
+				    "open_resource", B_FALSE);
+}
+
+PyDoc_STRVAR(py_zfs_aio_open_pool__doc__,
+"open_pool(*, name) -> asyncio.Future\n"
+"------------------------------------\n\n"
+"Awaitable variant of ZFS.open_pool(). Keyword arguments are the same.\n"
+);
+static PyObject *
+py_zfs_aio_open_pool(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	return aio_submit_on_handle((py_zfs_aio_t *)self, args, kwargs,
+				    "open_pool", B_FALSE);
+}
+
+PyDoc_STRVAR(py_zfs_aio_query__doc__,
+"query(**kwargs) -> asyncio.Future\n"
+"---------------------------------\n\n"
+"Awaitable variant of ZFS.query(). Keyword arguments are the same.\n"
+);
+static PyObject *
+py_zfs_aio_query(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	return aio_submit_on_handle((py_zfs_aio_t *)self, args, kwargs,
+				    "query", B_FALSE);
+}
+
+PyDoc_STRVAR(py_zfs_aio_iter_root_filesystems__doc__,
+"iter_root_filesystems() -> asyncio.Future\n"
+"-----------------------------------------\n\n"
+"Awaitable variant of ZFS.iter_root_filesystems(). The result is a list\n"
+"of the root filesystems of all imported pools.\n"
+);
+static PyObject *
+py_zfs_aio_iter_root_filesystems(PyObject *self,
+				 PyObject *args,
+				 PyObject *kwargs)
+{
+	return aio_submit_on_handle((py_zfs_aio_t *)self, args, kwargs,
+				    "iter_root_filesystems", B_TRUE);
+}
+
+PyDoc_STRVAR(py_zfs_aio_iter_pools__doc__,
+"iter_pools() -> asyncio.Future\n"
+"------------------------------\n\n"
+"Awaitable variant of ZFS.iter_pools(). The result is a list of\n"
+"truenas_pylibzfs.ZFSPool objects.\n"
+);
+static PyObject *
+py_zfs_aio_iter_pools(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	return aio_submit_on_handle((py_zfs_aio_t *)self, args, kwargs,
+				    "iter_pools", B_TRUE);
+}
+
+PyDoc_STRVAR(py_zfs_aio_get_properties__doc__,
+"get_properties(*, resource, **kwargs) -> asyncio.Future\n"
+"-------------------------------------------------------\n\n"
+"Awaitable variant of ZFSResource.get_properties(). Remaining keyword\n"
+"arguments are passed to resource.get_properties().\n"
+);
+static PyObject *
+py_zfs_aio_get_properties(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	return aio_submit_on((py_zfs_aio_t *)self, args, kwargs, "resource",
+			     &ZFSResource, "get_properties", B_FALSE);
+}
+
+PyDoc_STRVAR(py_zfs_aio_asdict__doc__,
+"asdict(*, resource, **kwargs) -> asyncio.Future\n"
+"-----------------------------------------------\n\n"
+"Awaitable variant of ZFSResource.asdict(). Remaining keyword arguments\n"
+"are passed to resource.asdict().\n"
+);
+static PyObject *
+py_zfs_aio_asdict(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	return aio_submit_on((py_zfs_aio_t *)self, args, kwargs, "resource",
+			     &ZFSResource, "asdict", B_FALSE);
+}
+
+PyDoc_STRVAR(py_zfs_aio_iter_filesystems__doc__,
+"iter_filesystems(*, resource, **kwargs) -> asyncio.Future\n"
+"---------------------------------------------------------\n\n"
+"Awaitable variant of ZFSResource.iter_filesystems(). The result is a\n"
+"list of child filesystems and volumes. \"callback\" may not be used.\n"
+);
+static PyObject *
+py_zfs_aio_iter_filesystems(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	return aio_submit_on((py_zfs_aio_t *)self, args, kwargs, "resource",
+			     &ZFSResource, "iter_filesystems", B_TRUE);
+}
+
+PyDoc_STRVAR(py_zfs_aio_iter_snapshots__doc__,
+"iter_snapshots(*, resource, **kwargs) -> asyncio.Future\n"
+"-------------------------------------------------------\n\n"
+"Awaitable variant of ZFSResource.iter_snapshots(). The result is a list\n"
+"of snapshots. \"callback\" may not be used.\n"
+);
+static PyObject *
+py_zfs_aio_iter_snapshots(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	return aio_submit_on((py_zfs_aio_t *)self, args, kwargs, "resource",
+			     &ZFSResource, "iter_snapshots", B_TRUE);
+}
+
+PyDoc_STRVAR(py_zfs_aio_pool_status__doc__,
+"pool_status(*, pool, **kwargs) -> asyncio.Future\n"
+"------------------------------------------------\n\n"
+"Awaitable variant of ZFSPool.status(). Remaining keyword arguments are\n"
+"passed to pool.status().\n"
+);
+static PyObject *
+py_zfs_aio_pool_status(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	return aio_submit_on((py_zfs_aio_t *)self, args, kwargs, "pool",
+			     &ZFSPool, "status", B_FALSE);
+}
+
+PyDoc_STRVAR(py_zfs_aio_local_replicate__doc__,
+"local_replicate(*, resource, **kwargs) -> asyncio.Future\n"
+"--------------------------------------------------------\n\n"
+"Awaitable variant of ZFSDataset.local_replicate() and\n"
+"ZFSVolume.local_replicate(). Remaining keyword arguments are passed to\n"
+"resource.local_replicate(). If a progress callback is given it is called\n"
+"from a thread other than the event loop thread.\n"
+);
+static PyObject *
+py_zfs_aio_local_replicate(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	return aio_submit_on((py_zfs_aio_t *)self, args, kwargs, "resource",
+			     &ZFSResource, "local_replicate", B_FALSE);
+}
+
+static PyMethodDef zfs_aio_methods[] = {
+	{
+		.ml_name = "open_resource",
+		.ml_meth = (PyCFunction)py_zfs_aio_open_resource,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_aio_open_resource__doc__
+	},
+	{
+		.ml_name = "open_pool",
+		.ml_meth = (PyCFunction)py_zfs_aio_open_pool,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_aio_open_pool__doc__
+	},
+	{
+		.ml_name = "query",
+		.ml_meth = (PyCFunction)py_zfs_aio_query,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_aio_query__doc__
+	},
+	{
+		.ml_name = "iter_root_filesystems",
+		.ml_meth = (PyCFunction)py_zfs_aio_iter_root_filesystems,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_aio_iter_root_filesystems__doc__
+	},
+	{
+		.ml_name = "iter_pools",
+		.ml_meth = (PyCFunction)py_zfs_aio_iter_pools,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_aio_iter_pools__doc__
+	},
+	{
+		.ml_name = "get_properties",
+		.ml_meth = (PyCFunction)py_zfs_aio_get_properties,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_aio_get_properties__doc__
+	},
+	{
+		.ml_name = "asdict",
+		.ml_meth = (PyCFunction)py_zfs_aio_asdict,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_aio_asdict__doc__
+	},
+	{
+		.ml_name = "iter_filesystems",
+		.ml_meth = (PyCFunction)py_zfs_aio_iter_filesystems,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_aio_iter_filesystems__doc__
+	},
+	{
+		.ml_name = "iter_snapshots",
+		.ml_meth = (PyCFunction)py_zfs_aio_iter_snapshots,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_aio_iter_snapshots__doc__
+	},
+	{
+		.ml_name = "pool_status",
+		.ml_meth = (PyCFunction)py_zfs_aio_pool_status,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_aio_pool_status__doc__
+	},
+	{
+		.ml_name = "local_replicate",
+		.ml_meth = (PyCFunction)py_zfs_aio_local_replicate,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_aio_local_replicate__doc__
+	},
+	{ NULL, NULL, 0, NULL }
+};
+
+static void
+py_zfs_aio_dealloc(py_zfs_aio_t *self)
+{
+	Py_CLEAR(self->pylibzfsp);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+py_zfs_aio_repr(PyObject *self)
+{
+	return PyUnicode_FromFormat("<" PYLIBZFS_TYPES_MODULE_NAME
+				    ".ZFSAio(%R)>",
+				    ((py_zfs_aio_t *)self)->pylibzfsp);
+}
+
+PyObject *
+py_zfs_aio_new(py_zfs_t *plz)
+{
+	py_zfs_aio_t *out;
+
+	out = (py_zfs_aio_t *)ZFSAio.tp_alloc(&ZFSAio, 0);
+	if (out == NULL)
+		return NULL;
+
+	out->pylibzfsp = (py_zfs_t *)Py_NewRef(plz);
+	return (PyObject *)out;
+}
+
+PyTypeObject ZFSAio = {
+	.tp_name = PYLIBZFS_TYPES_MODULE_NAME ".ZFSAio",
+	.tp_basicsize = sizeof (py_zfs_aio_t),
+	.tp_methods = zfs_aio_methods,
+	.tp_new = py_no_new_impl,
+	.tp_doc = "Awaitable variants of ZFS methods. See ZFS.aio.",
+	.tp_dealloc = (destructor)py_zfs_aio_dealloc,
+	.tp_repr = py_zfs_aio_repr,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+};
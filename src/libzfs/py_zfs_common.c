@@ -5,10 +5,14 @@ PyObject *py_zfs_promote(py_zfs_obj_t *obj)
 {
 	int err;
 	py_zfs_error_t zfs_err;
+	PyObject *py_name = NULL;
 
 
-	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSResource.promote",
-			"O", obj->name) < 0) {
+	py_name = py_zfs_obj_name_ref(obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSResource.promote",
+			  "O", py_name);
+	Py_DECREF(py_name);
+	if (err < 0) {
 		return NULL;
 	}
 
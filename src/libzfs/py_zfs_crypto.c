@@ -603,6 +603,57 @@ PyObject *py_zfs_crypto_info_dict(py_zfs_obj_t *obj)
 	return out;
 }
 
+/*
+ * Append crypto information as JSON, same as json.dumps() of
+ * py_zfs_crypto_info_dict(). GIL must be held.
+ */
+boolean_t py_zfs_crypto_info_json(py_zfs_obj_t *obj, py_json_buf_t *jb)
+{
+	char keylocation[ZFS_MAXPROPLEN];
+	char encroot[ZFS_MAXPROPLEN];
+	boolean_t is_encroot, is_loaded;
+
+	if (obj->encrypted == Py_False) {
+		json_buf_lit(jb, "null");
+		return B_TRUE;
+	}
+
+	if (!zfs_obj_crypto_info(obj,
+				 encroot, sizeof(encroot),
+				 keylocation, sizeof(keylocation),
+				 &is_encroot, &is_loaded)) {
+		return B_FALSE;
+	}
+
+	json_buf_lit(jb, "{");
+	json_buf_key(jb, struct_zfs_crypto_info[0].name);
+	if (is_encroot)
+		json_buf_lit(jb, "true");
+	else
+		json_buf_lit(jb, "false");
+
+	json_buf_lit(jb, ",");
+	json_buf_key(jb, struct_zfs_crypto_info[1].name);
+	json_buf_str(jb, encroot);
+
+	json_buf_lit(jb, ",");
+	json_buf_key(jb, struct_zfs_crypto_info[2].name);
+	if (is_encroot)
+		json_buf_str(jb, keylocation);
+	else
+		json_buf_lit(jb, "null");
+
+	json_buf_lit(jb, ",");
+	json_buf_key(jb, struct_zfs_crypto_info[3].name);
+	if (is_loaded)
+		json_buf_lit(jb, "true");
+	else
+		json_buf_lit(jb, "false");
+	json_buf_lit(jb, "}");
+
+	return B_TRUE;
+}
+
 #define ZFS_MEM_KEYFILE "truenas_pylibzfs_keyfile"
 static
 FILE *get_mem_keyfile(void)
@@ -1372,14 +1423,12 @@ PyObject *init_zfs_crypto(zfs_type_t type, PyObject *rsrc)
 	switch(type) {
 	case ZFS_TYPE_FILESYSTEM:
 		out->rsrc_obj.ds = (py_zfs_dataset_t *)rsrc;
-		if (out->rsrc_obj.ds->rsrc.is_simple)
-			py_zfs_props_refresh(&out->rsrc_obj.ds->rsrc);
+		py_zfs_props_load(&out->rsrc_obj.ds->rsrc);
 
 		break;
 	case ZFS_TYPE_VOLUME:
 		out->rsrc_obj.vol = (py_zfs_volume_t *)rsrc;
-		if (out->rsrc_obj.vol->rsrc.is_simple)
-			py_zfs_props_refresh(&out->rsrc_obj.vol->rsrc);
+		py_zfs_props_load(&out->rsrc_obj.vol->rsrc);
 		break;
 	default:
 		PyErr_Format(PyExc_TypeError,
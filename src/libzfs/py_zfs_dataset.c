@@ -7,7 +7,7 @@
 static
 void py_zfs_dataset_dealloc(py_zfs_dataset_t *self) {
 	free_py_zfs_obj(RSRC_TO_ZFS(self));
-	Py_TYPE(self)->tp_free((PyObject *)self);
+	py_zfs_resource_free((PyObject *)self);
 }
 
 static
@@ -63,6 +63,7 @@ PyObject *py_zfs_dataset_iter_userspace(PyObject *self,
 	pylibzfs_state_t *state = py_get_module_state(obj->pylibzfsp);
 	long qtype;
 	PyObject *pyqtype = NULL;
+	PyObject *py_name = NULL;
 
 	py_iter_state_t iter_state = (py_iter_state_t){
 		.pylibzfsp = obj->pylibzfsp,
@@ -121,8 +122,11 @@ PyObject *py_zfs_dataset_iter_userspace(PyObject *self,
 		.pyuserquota_struct = state->struct_zfs_userquota_type,
 	};
 
-	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSDataset.iter_userspace",
-                        "OO", obj->name, pyqtype) < 0) {
+	py_name = py_zfs_obj_name_ref(obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSDataset.iter_userspace",
+			  "OO", py_name, pyqtype);
+	Py_DECREF(py_name);
+	if (err < 0) {
 		return NULL;
 	}
 
@@ -139,6 +143,168 @@ PyObject *py_zfs_dataset_iter_userspace(PyObject *self,
 	Py_RETURN_FALSE;
 }
 
+PyDoc_STRVAR(py_zfs_dataset_get_userspace_columns__doc__,
+"get_userspace_columns(*, quota_types=None) -> dict\n\n"
+"----------------------------------------------------\n\n"
+"Collect userspace accounting for several quota types in a single pass\n"
+"and return it in columnar form. Arguments are keyword-only.\n\n"
+"Parameters\n"
+"----------\n"
+"quota_types: iterable of truenas_pylibzfs.ZFSUserQuota, optional\n"
+"    Quota types to collect. All types must refer to the same id space\n"
+"    (user, group, or project). Defaults to USER_USED, USER_QUOTA,\n"
+"    USEROBJ_USED and USEROBJ_QUOTA.\n\n"
+"Returns\n"
+"-------\n"
+"dict\n"
+"    Key \"xid\" plus one key per requested quota type (\"used\", \"quota\",\n"
+"    \"objused\", \"objquota\"). Each value is a read-only memoryview of\n"
+"    unsigned 64-bit integers (format \"Q\"); all columns have the same\n"
+"    length and row N of every column refers to xid[N]. A zero entry means\n"
+"    that the id has no value for that quota type.\n\n"
+"Raises:\n"
+"-------\n"
+"TypeError:\n"
+"    quota_types contains an item that is not a ZFSUserQuota.\n\n"
+"ValueError:\n"
+"    quota_types is empty or mixes user, group and project quota types.\n\n"
+"truenas_pylibzfs.ZFSError:\n"
+"    An error occurred while retrieving userspace accounting.\n\n"
+"Example:\n"
+"--------\n"
+"cols = ds.get_userspace_columns()\n"
+"used = numpy.frombuffer(cols['used'], dtype=numpy.uint64)\n"
+);
+
+/*
+ * Id space of a quota type. Columns returned by get_userspace_columns()
+ * are only meaningful when all quota types share the same id space.
+ */
+static int
+userspace_id_space(zfs_userquota_prop_t qtype)
+{
+	switch (qtype) {
+	case ZFS_PROP_USERUSED:
+	case ZFS_PROP_USERQUOTA:
+	case ZFS_PROP_USEROBJUSED:
+	case ZFS_PROP_USEROBJQUOTA:
+		return 0;
+	case ZFS_PROP_GROUPUSED:
+	case ZFS_PROP_GROUPQUOTA:
+	case ZFS_PROP_GROUPOBJUSED:
+	case ZFS_PROP_GROUPOBJQUOTA:
+		return 1;
+	default:
+		break;
+	}
+
+	return 2;
+}
+
+static
+PyObject *py_zfs_dataset_get_userspace_columns(PyObject *self,
+					       PyObject *args_unused,
+					       PyObject *kwargs)
+{
+	py_zfs_obj_t *obj = RSRC_TO_ZFS(((py_zfs_dataset_t *)self));
+	pylibzfs_state_t *state = py_get_module_state(obj->pylibzfsp);
+	PyObject *pyqtypes = NULL;
+	PyObject *iter = NULL;
+	PyObject *item = NULL;
+	zfs_userquota_prop_t qtypes[USERSPACE_NCOLS] = {
+		ZFS_PROP_USERUSED,
+		ZFS_PROP_USERQUOTA,
+		ZFS_PROP_USEROBJUSED,
+		ZFS_PROP_USEROBJQUOTA,
+	};
+	size_t nqtypes = USERSPACE_NCOLS;
+	boolean_t seen[USERSPACE_NCOLS] = { B_FALSE };
+	PyObject *py_name = NULL;
+	int err;
+
+	py_iter_state_t iter_state = (py_iter_state_t){
+		.pylibzfsp = obj->pylibzfsp,
+		.target = obj->zhp
+	};
+
+	char *kwnames [] = {
+		"quota_types",
+		NULL
+	};
+
+	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
+					 "|$O",
+					 kwnames,
+					 &pyqtypes)) {
+		return NULL;
+	}
+
+	if ((pyqtypes != NULL) && (pyqtypes != Py_None)) {
+		iter = PyObject_GetIter(pyqtypes);
+		if (iter == NULL)
+			return NULL;
+
+		nqtypes = 0;
+		while ((item = PyIter_Next(iter)) != NULL) {
+			long qtype;
+			int col;
+
+			if (!PyObject_IsInstance(item, state->zfs_uquota_enum)) {
+				PyErr_SetString(PyExc_TypeError,
+						"Not a valid ZFSUserQuota");
+				Py_DECREF(item);
+				Py_DECREF(iter);
+				return NULL;
+			}
+
+			qtype = PyLong_AsLong(item);
+			Py_DECREF(item);
+			PYZFS_ASSERT(
+				((qtype >= 0) && (qtype < ZFS_NUM_USERQUOTA_PROPS)),
+				"Invalid quota type"
+			);
+
+			if ((nqtypes > 0) &&
+			    (userspace_id_space(qtype) !=
+			     userspace_id_space(qtypes[0]))) {
+				PyErr_SetString(PyExc_ValueError,
+						"quota_types may not mix user, "
+						"group and project quota types.");
+				Py_DECREF(iter);
+				return NULL;
+			}
+
+			col = userspace_qtype_column(qtype);
+			if (seen[col])
+				continue;
+
+			seen[col] = B_TRUE;
+			qtypes[nqtypes++] = qtype;
+		}
+		Py_DECREF(iter);
+
+		if (PyErr_Occurred())
+			return NULL;
+
+		if (nqtypes == 0) {
+			PyErr_SetString(PyExc_ValueError,
+					"quota_types may not be empty.");
+			return NULL;
+		}
+	}
+
+	py_name = py_zfs_obj_name_ref(obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSDataset.get_userspace_columns",
+			  "OO", py_name,
+			  pyqtypes ? pyqtypes : Py_None);
+	Py_DECREF(py_name);
+	if (err < 0) {
+		return NULL;
+	}
+
+	return py_iter_userspace_columns(&iter_state, qtypes, nqtypes);
+}
+
 PyDoc_STRVAR(py_zfs_dataset_set_userquotas__doc__,
 "set_userquotas(*, quotas) -> None\n"
 "---------------------------------\n"
@@ -177,6 +343,7 @@ PyObject *py_zfs_dataset_set_userquotas(PyObject *self,
 	py_zfs_error_t zfs_err;
 	nvlist_t *nvl = NULL;
 	PyObject *pyquotas = NULL;
+	PyObject *py_name = NULL;
 
 	char *kwnames [] = {"quotas", NULL};
 
@@ -198,8 +365,11 @@ PyObject *py_zfs_dataset_set_userquotas(PyObject *self,
 	if (nvl == NULL)
 		return NULL;
 
-	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSDataset.set_userquotas",
-                        "OO", obj->name, pyquotas) < 0) {
+	py_name = py_zfs_obj_name_ref(obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSDataset.set_userquotas",
+			  "OO", py_name, pyquotas);
+	Py_DECREF(py_name);
+	if (err < 0) {
 		fnvlist_free(nvl);
 		return NULL;
 	}
@@ -305,6 +475,12 @@ PyMethodDef zfs_dataset_methods[] = {
 		.ml_flags = METH_VARARGS | METH_KEYWORDS,
 		.ml_doc = py_zfs_dataset_iter_userspace__doc__
 	},
+	{
+		.ml_name = "get_userspace_columns",
+		.ml_meth = (PyCFunction)py_zfs_dataset_get_userspace_columns,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_dataset_get_userspace_columns__doc__
+	},
 	{
 		.ml_name = "set_userquotas",
 		.ml_meth = (PyCFunction)py_zfs_dataset_set_userquotas,
@@ -355,7 +531,7 @@ py_zfs_dataset_t *init_zfs_dataset(py_zfs_t *lzp, zfs_handle_t *zfsp, boolean_t
 	uint64_t guid, createtxg;
 	boolean_t is_encrypted = B_FALSE;
 
-	out = (py_zfs_dataset_t *)ZFSDataset.tp_alloc(&ZFSDataset, 0);
+	out = (py_zfs_dataset_t *)py_zfs_resource_alloc(&ZFSDataset);
 	if (out == NULL)
 		return NULL;
 	out->rsrc.is_simple = simple;
@@ -376,7 +552,7 @@ py_zfs_dataset_t *init_zfs_dataset(py_zfs_t *lzp, zfs_handle_t *zfsp, boolean_t
 	if (obj->name == NULL)
 		goto error;
 
-	obj->pool_name = PyUnicode_FromString(pool_name);
+	obj->pool_name = py_zfs_pool_name_str(lzp, pool_name);
 	if (obj->pool_name == NULL)
 		goto error;
 
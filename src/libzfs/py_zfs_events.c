@@ -137,6 +137,14 @@ py_zfs_event_iter_next(PyObject *self_obj)
 		return NULL;
 	}
 
+	if (PY_ZFS_PROP_CACHE_ENABLED(self->pylibzfsp)) {
+		Py_BEGIN_ALLOW_THREADS
+		PY_ZFS_LOCK(self->pylibzfsp);
+		py_zfs_prop_cache_event(self->pylibzfsp, nvl);
+		PY_ZFS_UNLOCK(self->pylibzfsp);
+		Py_END_ALLOW_THREADS
+	}
+
 	event_dict = py_nvlist_to_dict(nvl);
 
 	Py_BEGIN_ALLOW_THREADS
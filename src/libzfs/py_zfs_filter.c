@@ -0,0 +1,499 @@
+#include "../truenas_pylibzfs.h"
+#include <fnmatch.h>
+
+/*
+ * ZFSFilter
+ *
+ * Compiled filter that may be passed to ZFSResource.iter_filesystems() and
+ * ZFSResource.iter_snapshots(). The filter is evaluated in the zfs_iter_f
+ * callbacks in py_zfs_iter.c against the zfs_handle_t (and its cached
+ * property nvlist) before any python object is created for the handle,
+ * so that datasets and snapshots that do not match never become python
+ * objects.
+ *
+ * Everything needed to evaluate the filter is converted to C types when the
+ * filter is created (create_filter()) so that py_zfs_filter_match() may be
+ * called without the GIL.
+ */
+
+static const struct {
+	const char *name;
+	py_zfs_filter_op_t op;
+} filter_op_table[] = {
+	{ "==", FILTER_OP_EQ },
+	{ "!=", FILTER_OP_NE },
+	{ "<", FILTER_OP_LT },
+	{ "<=", FILTER_OP_LE },
+	{ ">", FILTER_OP_GT },
+	{ ">=", FILTER_OP_GE },
+};
+
+static boolean_t
+filter_op_result(py_zfs_filter_op_t op, int cmp)
+{
+	switch (op) {
+	case FILTER_OP_EQ:
+		return (cmp == 0);
+	case FILTER_OP_NE:
+		return (cmp != 0);
+	case FILTER_OP_LT:
+		return (cmp < 0);
+	case FILTER_OP_LE:
+		return (cmp <= 0);
+	case FILTER_OP_GT:
+		return (cmp > 0);
+	case FILTER_OP_GE:
+		return (cmp >= 0);
+	}
+
+	return B_FALSE;
+}
+
+static boolean_t
+filter_prop_match(const py_zfs_filter_prop_t *fp, zfs_handle_t *zhp)
+{
+	char buf[ZFS_MAXPROPLEN];
+	uint64_t val;
+	int cmp;
+
+	if (!zfs_prop_valid_for_type(fp->prop, zfs_get_type(zhp), B_FALSE))
+		return B_FALSE;
+
+	if (fp->numeric) {
+		if (zfs_prop_get_numeric(zhp, fp->prop, &val, NULL, NULL, 0) != 0)
+			return B_FALSE;
+
+		cmp = (val > fp->ival) - (val < fp->ival);
+	} else {
+		// literal matches the values returned by get_properties()
+		if (zfs_prop_get(zhp, fp->prop, buf, sizeof (buf),
+		    NULL, NULL, 0, B_TRUE) != 0)
+			return B_FALSE;
+
+		cmp = strcmp(buf, fp->sval);
+	}
+
+	return filter_op_result(fp->op, cmp);
+}
+
+static boolean_t
+filter_user_prop_match(const py_zfs_filter_user_prop_t *fu, nvlist_t *uprops)
+{
+	nvlist_t *propval = NULL;
+	const char *value = NULL;
+
+	if (nvlist_lookup_nvlist(uprops, fu->name, &propval) != 0)
+		return B_FALSE;
+
+	if (nvlist_lookup_string(propval, ZPROP_VALUE, &value) != 0)
+		return B_FALSE;
+
+	return (strcmp(value, fu->value) == 0);
+}
+
+/*
+ * Evaluate filter against ZFS handle. This does not require the GIL but the
+ * libzfs handle lock must be held (as is the case in zfs_iter_f callbacks).
+ */
+boolean_t
+py_zfs_filter_match(const py_zfs_filter_t *filter, zfs_handle_t *zhp)
+{
+	const char *name = zfs_get_name(zhp);
+	nvlist_t *uprops = NULL;
+	size_t i;
+
+	if (filter->types && ((zfs_get_type(zhp) & filter->types) == 0))
+		return B_FALSE;
+
+	if (filter->name_prefix &&
+	    strncmp(name, filter->name_prefix, strlen(filter->name_prefix)) != 0)
+		return B_FALSE;
+
+	if (filter->name_glob && (fnmatch(filter->name_glob, name, 0) != 0))
+		return B_FALSE;
+
+	for (i = 0; i < filter->nprops; i++) {
+		if (!filter_prop_match(&filter->props[i], zhp))
+			return B_FALSE;
+	}
+
+	if (filter->nuser_props == 0)
+		return B_TRUE;
+
+	uprops = zfs_get_user_props(zhp);
+	if (uprops == NULL)
+		return B_FALSE;
+
+	for (i = 0; i < filter->nuser_props; i++) {
+		if (!filter_user_prop_match(&filter->user_props[i], uprops))
+			return B_FALSE;
+	}
+
+	return B_TRUE;
+}
+
+static void
+py_zfs_filter_dealloc(py_zfs_filter_t *self)
+{
+	size_t i;
+
+	PyMem_Free(self->name_glob);
+	PyMem_Free(self->name_prefix);
+
+	for (i = 0; i < self->nprops; i++)
+		PyMem_Free(self->props[i].sval);
+	PyMem_Free(self->props);
+
+	for (i = 0; i < self->nuser_props; i++) {
+		PyMem_Free(self->user_props[i].name);
+		PyMem_Free(self->user_props[i].value);
+	}
+	PyMem_Free(self->user_props);
+
+	Py_CLEAR(self->repr);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+py_zfs_filter_repr(PyObject *self)
+{
+	py_zfs_filter_t *filter = (py_zfs_filter_t *)self;
+
+	return PyUnicode_FromFormat("<" PYLIBZFS_TYPES_MODULE_NAME
+				    ".ZFSFilter(%S)>", filter->repr);
+}
+
+PyDoc_STRVAR(py_zfs_filter__doc__,
+"ZFSFilter\n"
+"---------\n\n"
+"Compiled dataset / snapshot filter created by\n"
+"truenas_pylibzfs.create_filter().\n\n"
+"The filter is evaluated in C before python objects are created for the\n"
+"ZFS resources being iterated, so non-matching resources are skipped\n"
+"cheaply.\n"
+);
+
+PyTypeObject ZFSFilter = {
+	.tp_name      = PYLIBZFS_TYPES_MODULE_NAME ".ZFSFilter",
+	.tp_basicsize = sizeof (py_zfs_filter_t),
+	.tp_itemsize  = 0,
+	.tp_dealloc   = (destructor)py_zfs_filter_dealloc,
+	.tp_new       = py_no_new_impl,
+	.tp_repr      = py_zfs_filter_repr,
+	.tp_flags     = Py_TPFLAGS_DEFAULT,
+	.tp_doc       = py_zfs_filter__doc__,
+};
+
+boolean_t
+py_zfs_types_to_mask(pylibzfs_state_t *state, PyObject *py_types,
+    zfs_type_t *types_out)
+{
+	PyObject *iterator = NULL;
+	PyObject *item = NULL;
+	zfs_type_t types = 0;
+
+	iterator = PyObject_GetIter(py_types);
+	if (iterator == NULL)
+		return B_FALSE;
+
+	while ((item = PyIter_Next(iterator))) {
+		long ztype;
+
+		if (!PyObject_IsInstance(item, state->zfs_type_enum)) {
+			PyErr_Format(PyExc_TypeError,
+				     "%R: not a valid ZFSType", item);
+			Py_DECREF(item);
+			Py_DECREF(iterator);
+			return B_FALSE;
+		}
+
+		ztype = PyLong_AsLong(item);
+		Py_DECREF(item);
+		types |= (zfs_type_t)ztype;
+	}
+
+	Py_DECREF(iterator);
+	if (PyErr_Occurred())
+		return B_FALSE;
+
+	*types_out = types;
+	return B_TRUE;
+}
+
+static boolean_t
+py_filter_parse_prop(pylibzfs_state_t *state, PyObject *item,
+    py_zfs_filter_prop_t *fp)
+{
+	PyObject *py_prop, *py_op, *py_value;
+	const char *op, *sval;
+	size_t i;
+
+	if (!PyTuple_Check(item) || PyTuple_GET_SIZE(item) != 3) {
+		PyErr_Format(PyExc_TypeError,
+			     "%R: expected tuple of (property, operator, value).",
+			     item);
+		return B_FALSE;
+	}
+
+	py_prop = PyTuple_GET_ITEM(item, 0);
+	py_op = PyTuple_GET_ITEM(item, 1);
+	py_value = PyTuple_GET_ITEM(item, 2);
+
+	if (!py_object_to_zfs_prop_t(state->zfs_property_enum, py_prop,
+	    &fp->prop))
+		return B_FALSE;
+
+	if (fp->prop == ZPROP_INVAL) {
+		PyErr_Format(PyExc_ValueError,
+			     "%R: not a valid ZFS property.", py_prop);
+		return B_FALSE;
+	}
+
+	op = PyUnicode_Check(py_op) ? PyUnicode_AsUTF8(py_op) : NULL;
+	if (op == NULL) {
+		if (!PyErr_Occurred()) {
+			PyErr_Format(PyExc_TypeError,
+				     "%R: operator must be a string.", py_op);
+		}
+		return B_FALSE;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(filter_op_table); i++) {
+		if (strcmp(op, filter_op_table[i].name) == 0)
+			break;
+	}
+
+	if (i == ARRAY_SIZE(filter_op_table)) {
+		PyErr_Format(PyExc_ValueError,
+			     "%s: invalid operator. Expected one of "
+			     "==, !=, <, <=, >, >=", op);
+		return B_FALSE;
+	}
+	fp->op = filter_op_table[i].op;
+
+	if (PyLong_Check(py_value)) {
+		// bool is subclass of int and maps to index value 0 / 1
+		if (zfs_prop_get_type(fp->prop) == PROP_TYPE_STRING) {
+			PyErr_Format(PyExc_TypeError,
+				     "%s: string property may only be compared "
+				     "with a string value.",
+				     zfs_prop_to_name(fp->prop));
+			return B_FALSE;
+		}
+
+		fp->ival = PyLong_AsUnsignedLongLong(py_value);
+		if (PyErr_Occurred())
+			return B_FALSE;
+
+		fp->numeric = B_TRUE;
+		return B_TRUE;
+	}
+
+	if (!PyUnicode_Check(py_value)) {
+		PyErr_Format(PyExc_TypeError,
+			     "%R: value must be an int, bool, or str.",
+			     py_value);
+		return B_FALSE;
+	}
+
+	sval = PyUnicode_AsUTF8(py_value);
+	if (sval == NULL)
+		return B_FALSE;
+
+	fp->sval = pymem_strdup(sval);
+	if (fp->sval == NULL) {
+		PyErr_NoMemory();
+		return B_FALSE;
+	}
+
+	fp->numeric = B_FALSE;
+	return B_TRUE;
+}
+
+static boolean_t
+py_filter_parse_props(pylibzfs_state_t *state, PyObject *py_props,
+    py_zfs_filter_t *filter)
+{
+	PyObject *seq = NULL;
+	Py_ssize_t i, cnt;
+
+	seq = PySequence_Fast(py_props,
+			      "properties must be a sequence of "
+			      "(property, operator, value) tuples.");
+	if (seq == NULL)
+		return B_FALSE;
+
+	cnt = PySequence_Fast_GET_SIZE(seq);
+	if (cnt == 0) {
+		Py_DECREF(seq);
+		return B_TRUE;
+	}
+
+	filter->props = PyMem_Calloc(cnt, sizeof (py_zfs_filter_prop_t));
+	if (filter->props == NULL) {
+		Py_DECREF(seq);
+		PyErr_NoMemory();
+		return B_FALSE;
+	}
+
+	for (i = 0; i < cnt; i++) {
+		// nprops tracks entries to free on dealloc
+		filter->nprops++;
+		if (!py_filter_parse_prop(state,
+		    PySequence_Fast_GET_ITEM(seq, i), &filter->props[i])) {
+			Py_DECREF(seq);
+			return B_FALSE;
+		}
+	}
+
+	Py_DECREF(seq);
+	return B_TRUE;
+}
+
+static boolean_t
+py_filter_parse_user_props(PyObject *py_user_props, py_zfs_filter_t *filter)
+{
+	PyObject *key, *value;
+	Py_ssize_t pos = 0, cnt;
+
+	if (!PyDict_Check(py_user_props)) {
+		PyErr_SetString(PyExc_TypeError,
+				"user_properties must be a dictionary.");
+		return B_FALSE;
+	}
+
+	cnt = PyDict_Size(py_user_props);
+	if (cnt == 0)
+		return B_TRUE;
+
+	filter->user_props = PyMem_Calloc(cnt,
+	    sizeof (py_zfs_filter_user_prop_t));
+	if (filter->user_props == NULL) {
+		PyErr_NoMemory();
+		return B_FALSE;
+	}
+
+	while (PyDict_Next(py_user_props, &pos, &key, &value)) {
+		py_zfs_filter_user_prop_t *fu;
+		const char *cname, *cvalue;
+
+		if (!PyUnicode_Check(key) || !PyUnicode_Check(value)) {
+			PyErr_SetString(PyExc_TypeError,
+					"user_properties keys and values "
+					"must be strings.");
+			return B_FALSE;
+		}
+
+		cname = PyUnicode_AsUTF8(key);
+		if (cname == NULL)
+			return B_FALSE;
+
+		if (!zfs_prop_user(cname)) {
+			PyErr_Format(PyExc_ValueError,
+				     "%s: not a valid user property name.",
+				     cname);
+			return B_FALSE;
+		}
+
+		cvalue = PyUnicode_AsUTF8(value);
+		if (cvalue == NULL)
+			return B_FALSE;
+
+		fu = &filter->user_props[filter->nuser_props++];
+		fu->name = pymem_strdup(cname);
+		fu->value = pymem_strdup(cvalue);
+		if ((fu->name == NULL) || (fu->value == NULL)) {
+			PyErr_NoMemory();
+			return B_FALSE;
+		}
+	}
+
+	return B_TRUE;
+}
+
+static boolean_t
+py_filter_parse_str(PyObject *py_str, const char *what, char **out)
+{
+	const char *cstr;
+
+	if (py_str == NULL || py_str == Py_None)
+		return B_TRUE;
+
+	if (!PyUnicode_Check(py_str)) {
+		PyErr_Format(PyExc_TypeError, "%s must be a string.", what);
+		return B_FALSE;
+	}
+
+	cstr = PyUnicode_AsUTF8(py_str);
+	if (cstr == NULL)
+		return B_FALSE;
+
+	*out = pymem_strdup(cstr);
+	if (*out == NULL) {
+		PyErr_NoMemory();
+		return B_FALSE;
+	}
+
+	return B_TRUE;
+}
+
+/*
+ * Factory: create a ZFSFilter. Called by create_filter() in
+ * truenas_pylibzfs.c. NULL or None for any argument means that the
+ * corresponding criterion is not applied.
+ */
+PyObject *
+py_zfs_filter_create(pylibzfs_state_t *state,
+		     PyObject *py_glob,
+		     PyObject *py_prefix,
+		     PyObject *py_types,
+		     PyObject *py_props,
+		     PyObject *py_user_props)
+{
+	py_zfs_filter_t *filter = NULL;
+	PyObject *kwargs = NULL;
+
+	filter = (py_zfs_filter_t *)ZFSFilter.tp_alloc(&ZFSFilter, 0);
+	if (filter == NULL)
+		return NULL;
+
+	if (!py_filter_parse_str(py_glob, "name_glob", &filter->name_glob))
+		goto fail;
+
+	if (!py_filter_parse_str(py_prefix, "name_prefix", &filter->name_prefix))
+		goto fail;
+
+	if (!NULL_OR_NONE(py_types) &&
+	    !py_zfs_types_to_mask(state, py_types, &filter->types))
+		goto fail;
+
+	if (!NULL_OR_NONE(py_props) &&
+	    !py_filter_parse_props(state, py_props, filter))
+		goto fail;
+
+	if (!NULL_OR_NONE(py_user_props) &&
+	    !py_filter_parse_user_props(py_user_props, filter))
+		goto fail;
+
+	// Keep string representation of the filter criteria for repr()
+	kwargs = Py_BuildValue("{s:O,s:O,s:O,s:O,s:O}",
+			       "name_glob", py_glob ? py_glob : Py_None,
+			       "name_prefix", py_prefix ? py_prefix : Py_None,
+			       "types", py_types ? py_types : Py_None,
+			       "properties", py_props ? py_props : Py_None,
+			       "user_properties",
+			       py_user_props ? py_user_props : Py_None);
+	if (kwargs == NULL)
+		goto fail;
+
+	filter->repr = PyObject_Repr(kwargs);
+	Py_DECREF(kwargs);
+	if (filter->repr == NULL)
+		goto fail;
+
+	return (PyObject *)filter;
+
+fail:
+	Py_DECREF(filter);
+	return NULL;
+}
@@ -31,6 +31,7 @@ typedef struct {
 	boolean_t	 skip_internal;	  /* skip ZPOOL_HIST_INT_EVENT records        */
 	uint64_t	 since;		  /* 0 = no lower bound; skip rec if ts < since */
 	uint64_t	 until;		  /* 0 = no upper bound; skip rec if ts > until */
+	PyMutex		 next_lock;	  /* serializes __next__ (see below)          */
 } py_zfs_history_iter_t;
 
 
@@ -54,9 +55,8 @@ py_zfs_history_iter_iter(PyObject *self)
 }
 
 static PyObject *
-py_zfs_history_iter_next(PyObject *self_obj)
+py_zfs_history_iter_next_impl(py_zfs_history_iter_t *self)
 {
-	py_zfs_history_iter_t *self = (py_zfs_history_iter_t *)self_obj;
 	py_zfs_error_t zfs_err;
 	int err;
 
@@ -135,6 +135,25 @@ py_zfs_history_iter_next(PyObject *self_obj)
 	}
 }
 
+/*
+ * The batch cursor is updated while the GIL is released, so a critical
+ * section on the iterator would not be sufficient on free-threaded builds
+ * (it is suspended when the thread detaches). Use a dedicated mutex so that
+ * concurrent __next__ calls from different threads are serialized.
+ */
+static PyObject *
+py_zfs_history_iter_next(PyObject *self_obj)
+{
+	py_zfs_history_iter_t *self = (py_zfs_history_iter_t *)self_obj;
+	PyObject *out;
+
+	PyMutex_Lock(&self->next_lock);
+	out = py_zfs_history_iter_next_impl(self);
+	PyMutex_Unlock(&self->next_lock);
+
+	return out;
+}
+
 PyDoc_STRVAR(py_zfs_history_iter__doc__,
 "ZFSHistoryIterator\n"
 "------------------\n\n"
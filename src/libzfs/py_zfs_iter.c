@@ -67,6 +67,35 @@
  * 4. Within the function created in (1) call the new ZFS iterator (c)
  *    with parameters (2) that are provided in py_iter_state_t, and the
  *    callback function from (3).
+ *
+ * Batched iteration:
+ * -----------------
+ * If the python caller specified a non-zero `batch_size` then the flow
+ * above changes so that the GIL and libzfs lock are only toggled once per
+ * batch rather than once per handle:
+ *
+ * py_iter_filesystems()
+ *   ->iter_batch_init()
+ *   ->ITER_ALLOW_THREADS
+ *     ->zfs_iter_filesystems_v2()
+ *       ->filesystem_callback()
+ *         ->iter_batch_add()			(GIL not held)
+ *       ->filesystem_callback()
+ *         ->iter_batch_add()
+ *           ->iter_batch_flush()		(batch is full)
+ *             ->ITER_END_ALLOW_THREADS
+ *               ->common_callback([ds1, ds2, ...])
+ *             ->ITER_ALLOW_THREADS
+ *       ...
+ *     ->iter_batch_finish()			(flush remainder)
+ *   ->ITER_END_ALLOW_THREADS
+ *   ->iter_batch_free()
+ *
+ * New iterators that produce zfs_handle_t or zpool_handle_t handles can
+ * support batching by calling iter_batch_add() at the start of their
+ * zfs_iter_f callback when state->batch.size is non-zero, and by wrapping
+ * the libzfs iterator with iter_batch_init() / iter_batch_finish() /
+ * iter_batch_free() as py_iter_filesystems() does.
  */
 
 /*
@@ -139,6 +168,196 @@ common_callback(PyObject *new_hdl, py_iter_state_t *state)
 	return ITER_RESULT_ERROR;
 }
 
+/*
+ * Create python object for a libzfs handle produced by one of the iterators.
+ * The handle type is determined by state->batch.kind. GIL must be held.
+ * On failure the handle is *not* closed.
+ */
+PyObject *
+py_iter_hdl_to_py(py_iter_state_t *state, void *hdl)
+{
+	PyObject *out = NULL;
+	boolean_t simple;
+
+	switch (state->batch.kind) {
+	case ITER_BATCH_DATASET:
+		simple = (state->iter_config.filesystem.flags & ZFS_ITER_SIMPLE) ?
+		    B_TRUE : B_FALSE;
+
+		switch (zfs_get_type((zfs_handle_t *)hdl)) {
+		case ZFS_TYPE_FILESYSTEM:
+			out = (PyObject *)init_zfs_dataset(state->pylibzfsp,
+							   hdl, simple);
+			break;
+		case ZFS_TYPE_VOLUME:
+			out = (PyObject *)init_zfs_volume(state->pylibzfsp,
+							  hdl, simple);
+			break;
+		default:
+			PYZFS_ASSERT(B_FALSE, "Unexpected ZFS type");
+		}
+		break;
+	case ITER_BATCH_SNAPSHOT:
+		simple = (state->iter_config.snapshot.flags & ZFS_ITER_SIMPLE) ?
+		    B_TRUE : B_FALSE;
+		out = (PyObject *)init_zfs_snapshot(state->pylibzfsp,
+						    hdl, simple);
+		break;
+	case ITER_BATCH_POOL:
+		out = (PyObject *)init_zfs_pool(state->pylibzfsp, hdl);
+		break;
+	default:
+		PYZFS_ASSERT(B_FALSE, "Unexpected batch type");
+	}
+
+	return out;
+}
+
+void
+py_iter_close_hdl(iter_batch_kind_t kind, void *hdl)
+{
+	if (kind == ITER_BATCH_POOL)
+		zpool_close((zpool_handle_t *)hdl);
+	else
+		zfs_close((zfs_handle_t *)hdl);
+}
+
+/*
+ * Close any handles that were collected but not yet passed to python.
+ * This is used when iteration is aborted (error or stop request).
+ */
+static void
+iter_batch_discard(iter_batch_t *batch)
+{
+	size_t i;
+
+	for (i = 0; i < batch->count; i++)
+		py_iter_close_hdl(batch->kind, batch->hdls[i]);
+
+	batch->count = 0;
+}
+
+/**
+ * @brief Pass accumulated handles to python callback
+ *
+ * NOTE: must be called with libzfs lock held and GIL released (i.e. from
+ * within a zfs_iter_f callback or directly after the libzfs iterator
+ * returns).
+ *
+ * @param[in] state	py_zfs iterator state structure
+ *
+ * @return		int - same values as common_callback()
+ */
+static int
+iter_batch_flush(py_iter_state_t *state)
+{
+	int result = ITER_RESULT_ERROR;
+	iter_batch_t *batch = &state->batch;
+	PyObject *pylist = NULL;
+	size_t i;
+
+	if (batch->count == 0)
+		return ITER_RESULT_SUCCESS;
+
+	ITER_END_ALLOW_THREADS(state);
+
+	pylist = PyList_New(batch->count);
+	if (pylist == NULL) {
+		iter_batch_discard(batch);
+		goto out;
+	}
+
+	for (i = 0; i < batch->count; i++) {
+		PyObject *new = py_iter_hdl_to_py(state, batch->hdls[i]);
+		if (new == NULL) {
+			// close the handles that aren't owned by python
+			// objects yet. Items already in list are closed
+			// when the list is deallocated.
+			for (; i < batch->count; i++)
+				py_iter_close_hdl(batch->kind, batch->hdls[i]);
+
+			batch->count = 0;
+			Py_DECREF(pylist);
+			goto out;
+		}
+		PyList_SET_ITEM(pylist, i, new);
+	}
+
+	batch->count = 0;
+	result = common_callback(pylist, state);
+out:
+	ITER_ALLOW_THREADS(state);
+	return result;
+}
+
+/*
+ * Add handle to batch buffer. Called from within zfs_iter_f callback
+ * without the GIL. The python callback is only called once the
+ * buffer is full.
+ */
+static int
+iter_batch_add(py_iter_state_t *state, void *hdl)
+{
+	iter_batch_t *batch = &state->batch;
+
+	batch->hdls[batch->count++] = hdl;
+	if (batch->count < batch->size)
+		return ITER_RESULT_SUCCESS;
+
+	return iter_batch_flush(state);
+}
+
+/*
+ * Allocate batch buffer if batching was requested. GIL must be held.
+ * Returns -1 with python exception set on failure.
+ */
+static int
+iter_batch_init(py_iter_state_t *state, iter_batch_kind_t kind)
+{
+	iter_batch_t *batch = &state->batch;
+
+	batch->kind = kind;
+	batch->count = 0;
+	batch->hdls = NULL;
+
+	if (batch->size == 0)
+		return 0;
+
+	batch->hdls = PyMem_RawCalloc(batch->size, sizeof(void *));
+	if (batch->hdls == NULL) {
+		PyErr_NoMemory();
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Flush remaining handles once libzfs iterator completes. Must be called
+ * with libzfs lock held and GIL released. If the iterator did not complete
+ * successfully then unconsumed handles are closed instead.
+ */
+static int
+iter_batch_finish(py_iter_state_t *state, int iter_ret)
+{
+	if (state->batch.size == 0)
+		return iter_ret;
+
+	if (iter_ret != ITER_RESULT_SUCCESS) {
+		iter_batch_discard(&state->batch);
+		return iter_ret;
+	}
+
+	return iter_batch_flush(state);
+}
+
+static void
+iter_batch_free(py_iter_state_t *state)
+{
+	PyMem_RawFree(state->batch.hdls);
+	state->batch.hdls = NULL;
+}
+
 /**
  * @brief zfs_iter_f callback for zfs_iter_filesystems_*
  *
@@ -163,6 +382,14 @@ filesystem_callback(zfs_handle_t *zhp, void *private)
 	PyObject *new = NULL;
 	boolean_t simple = B_FALSE;
 
+	if (state->filter && !py_zfs_filter_match(state->filter, zhp)) {
+		zfs_close(zhp);
+		return ITER_RESULT_SUCCESS;
+	}
+
+	if (state->batch.size)
+		return iter_batch_add(state, zhp);
+
 	if (state->iter_config.filesystem.flags & ZFS_ITER_SIMPLE)
 		simple = B_TRUE;
 
@@ -203,6 +430,14 @@ snapshot_callback(zfs_handle_t *zhp, void *private)
 	py_zfs_snapshot_t *new_snap = NULL;
 	boolean_t simple = state->iter_config.snapshot.flags & ZFS_ITER_SIMPLE;
 
+	if (state->filter && !py_zfs_filter_match(state->filter, zhp)) {
+		zfs_close(zhp);
+		return ITER_RESULT_SUCCESS;
+	}
+
+	if (state->batch.size)
+		return iter_batch_add(state, zhp);
+
 	ITER_END_ALLOW_THREADS(state);
 
 	new_snap = init_zfs_snapshot(state->pylibzfsp, zhp, simple);
@@ -250,6 +485,9 @@ pool_callback(zpool_handle_t *hdl, void *private)
 	py_iter_state_t *state = (py_iter_state_t *)private;
 	py_zfs_pool_t *new_pool = NULL;
 
+	if (state->batch.size)
+		return iter_batch_add(state, hdl);
+
 	ITER_END_ALLOW_THREADS(state);
 
 	new_pool = init_zfs_pool(state->pylibzfsp, hdl);
@@ -287,10 +525,15 @@ int
 py_iter_filesystems(py_iter_state_t *state)
 {
 	int iter_ret;
+	uint64_t op_start;
 	py_zfs_error_t zfs_err;
 
+	if (iter_batch_init(state, ITER_BATCH_DATASET) < 0)
+		return ITER_RESULT_ERROR;
+
 	ITER_ALLOW_THREADS(state);
 	PY_ZFS_LOCK(state->pylibzfsp);
+	op_start = py_zfs_stats_now();
 
 	iter_ret = zfs_iter_filesystems_v2(state->target,
 					   state->iter_config.filesystem.flags,
@@ -300,8 +543,12 @@ py_iter_filesystems(py_iter_state_t *state)
 		py_get_zfs_error(state->pylibzfsp->lzh, &zfs_err);
 	}
 
+	iter_ret = iter_batch_finish(state, iter_ret);
+
+	py_zfs_stats_op(state->pylibzfsp, PY_ZFS_OP_ITER, op_start);
 	PY_ZFS_UNLOCK(state->pylibzfsp);
 	ITER_END_ALLOW_THREADS(state);
+	iter_batch_free(state);
 
 	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
 		set_exc_from_libzfs(&zfs_err, "zfs_iter_filesystems_v2() failed");
@@ -310,141 +557,1486 @@ py_iter_filesystems(py_iter_state_t *state)
 	return iter_ret;
 }
 
-int
-py_iter_snapshots(py_iter_state_t *state)
+/*
+ * Recursive filesystem walk
+ *
+ * py_iter_filesystems_recursive() performs the complete walk of the dataset
+ * tree below `target` under a single acquisition of the libzfs handle lock.
+ * walk_callback() is used as the zfs_iter_f for every level. It creates the
+ * python object for the new handle and, depending on traversal order,
+ * passes it to python callback and / or descends into it by calling
+ * zfs_iter_filesystems_v2() on the handle owned by the python object.
+ * A strong reference to the python object is held while its handle is being
+ * used for further iteration so that the python callback may safely drop
+ * its own reference.
+ *
+ * Datasets that do not match the filter never become python objects.
+ * walk_skip() visits their snapshots and children on the raw handle
+ * without taking the GIL, and closes it.
+ *
+ * BFS order uses a queue (iter_conf_filesystem_t.bfs_queue) of python
+ * objects, or raw handles of non-matching datasets, whose children have
+ * not yet been visited.
+ *
+ * walk_deliver(), walk_snapshots(), walk_children() and walk_enqueue() are
+ * called with GIL and libzfs lock held. The *_hdl() variants and
+ * walk_skip() are called with the libzfs lock held and GIL released.
+ */
+static int walk_callback(zfs_handle_t *zhp, void *private);
+
+static int
+walk_deliver(py_iter_state_t *state, PyObject *obj)
 {
-	int iter_ret;
-	py_zfs_error_t zfs_err;
-	iter_conf_snapshot_t conf = state->iter_config.snapshot;
+	// common_callback() consumes a reference
+	Py_INCREF(obj);
+	return common_callback(obj, state);
+}
 
-	ITER_ALLOW_THREADS(state);
-	PY_ZFS_LOCK(state->pylibzfsp);
+static int
+walk_snapshots_hdl(py_iter_state_t *state, zfs_handle_t *zhp)
+{
+	return zfs_iter_snapshots_sorted_v2(zhp,
+					    state->iter_config.filesystem.flags,
+					    walk_callback,
+					    (void *)state,
+					    0, 0);
+}
 
-	if (conf.sorted) {
-		iter_ret = zfs_iter_snapshots_sorted_v2(state->target,
-							conf.flags,
-							snapshot_callback,
-							(void *)state,
-							conf.min_txg,
-							conf.max_txg);
-	} else {
-		iter_ret = zfs_iter_snapshots_v2(state->target,
-						 conf.flags,
-						 snapshot_callback,
-						 (void *)state,
-						 conf.min_txg,
-						 conf.max_txg);
-	}
-	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
-		py_get_zfs_error(state->pylibzfsp->lzh, &zfs_err);
-	}
+static int
+walk_snapshots(py_iter_state_t *state, py_zfs_obj_t *obj)
+{
+	int ret;
 
-	PY_ZFS_UNLOCK(state->pylibzfsp);
+	ITER_ALLOW_THREADS(state);
+	ret = walk_snapshots_hdl(state, obj->zhp);
 	ITER_END_ALLOW_THREADS(state);
 
-	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
-		set_exc_from_libzfs(&zfs_err, "zfs_iter_snapshots() failed");
-	}
-
-	return iter_ret;
+	return ret;
 }
 
+static int
+walk_children_hdl(py_iter_state_t *state, zfs_handle_t *zhp, uint_t depth)
+{
+	iter_conf_filesystem_t *conf = &state->iter_config.filesystem;
+	int ret;
 
-#define MAX_ZFS_USERSPACE_RETRIES 50  // number of retries with 0.1 sec sleep
-int
-py_iter_userspace(py_iter_state_t *state)
+	conf->depth = depth + 1;
+	ret = zfs_iter_filesystems_v2(zhp,
+				      conf->flags,
+				      walk_callback,
+				      (void *)state);
+	conf->depth = depth;
+
+	return ret;
+}
+
+static int
+walk_children(py_iter_state_t *state, py_zfs_obj_t *obj, uint_t depth)
 {
-	int iter_ret, tries;
-	py_zfs_error_t zfs_err;
-	iter_conf_userspace_t conf = state->iter_config.userspace;
+	int ret;
 
 	ITER_ALLOW_THREADS(state);
-	PY_ZFS_LOCK(state->pylibzfsp);
+	ret = walk_children_hdl(state, obj->zhp, depth);
+	ITER_END_ALLOW_THREADS(state);
 
-	/*
-	 * zfs_ioctl() may fail with EBUSY if dataset is unmounted due to
-	 * zfsvfs_hold() return. In this case we can retry here a few
-	 * times while the GIL is released and the ZFS lock is held.
-	 */
-	for (tries = 0; tries < MAX_ZFS_USERSPACE_RETRIES; tries++) {
-		iter_ret = zfs_userspace(state->target,
-					 conf.qtype,
-					 userspace_callback,
-					 (void *)state);
+	return ret;
+}
 
-		if (iter_ret != ITER_RESULT_IOCTL_ERROR)
-			break;
+/*
+ * Return a free entry at the tail of the BFS queue, growing it if needed,
+ * or NULL if out of memory. GIL not required.
+ */
+static iter_bfs_entry_t *
+walk_queue_tail(iter_conf_filesystem_t *conf)
+{
+	iter_bfs_entry_t *entry;
 
-		// store libzfs error state in case this is our last retry
-		py_get_zfs_error(state->pylibzfsp->lzh, &zfs_err);
-		if (zfs_err.code != EZFS_BUSY) {
-			// only retry if failed with EBUSY
-			break;
+	if (conf->bfs_head + conf->bfs_count == conf->bfs_size) {
+		size_t new_size = conf->bfs_size ? conf->bfs_size * 2 : 64;
+		iter_bfs_entry_t *new_queue;
+
+		if (conf->bfs_head > 0) {
+			// reclaim space of entries already processed
+			memmove(conf->bfs_queue,
+				conf->bfs_queue + conf->bfs_head,
+				conf->bfs_count * sizeof(iter_bfs_entry_t));
+			conf->bfs_head = 0;
+			new_size = conf->bfs_size;
 		}
 
-		usleep(100000);
+		if (new_size != conf->bfs_size) {
+			new_queue = PyMem_RawRealloc(conf->bfs_queue,
+			    new_size * sizeof(iter_bfs_entry_t));
+			if (new_queue == NULL)
+				return NULL;
+			conf->bfs_queue = new_queue;
+			conf->bfs_size = new_size;
+		}
 	}
 
-	PY_ZFS_UNLOCK(state->pylibzfsp);
-	ITER_END_ALLOW_THREADS(state);
+	entry = &conf->bfs_queue[conf->bfs_head + conf->bfs_count];
+	conf->bfs_count++;
 
-	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
-		set_exc_from_libzfs(&zfs_err, "zfs_iter_userspace() failed");
+	return entry;
+}
+
+static int
+walk_enqueue(py_iter_state_t *state, PyObject *obj, uint_t depth)
+{
+	iter_bfs_entry_t *entry;
+
+	entry = walk_queue_tail(&state->iter_config.filesystem);
+	if (entry == NULL) {
+		PyErr_NoMemory();
+		return ITER_RESULT_ERROR;
 	}
 
-	return iter_ret;
+	entry->obj = Py_NewRef(obj);
+	entry->zhp = NULL;
+	entry->depth = depth;
+
+	return ITER_RESULT_SUCCESS;
 }
 
-int
-py_iter_root_filesystems(py_iter_state_t *state)
+/*
+ * Queue the raw handle of a non-matching dataset. The queue takes ownership
+ * of zhp on success.
+ */
+static int
+walk_enqueue_hdl(py_iter_state_t *state, zfs_handle_t *zhp, uint_t depth)
 {
-	int iter_ret;
-	py_zfs_error_t zfs_err;
-
-	ITER_ALLOW_THREADS(state);
-	PY_ZFS_LOCK(state->pylibzfsp);
+	iter_bfs_entry_t *entry;
 
-	// We can use our generic filesystem_callback here
-	// since we're producing only dataset handles
-	iter_ret = zfs_iter_root(state->pylibzfsp->lzh,
-				 filesystem_callback,
-				 (void *)state);
-	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
-		py_get_zfs_error(state->pylibzfsp->lzh, &zfs_err);
+	entry = walk_queue_tail(&state->iter_config.filesystem);
+	if (entry == NULL) {
+		// Only reached on allocation failure
+		ITER_END_ALLOW_THREADS(state);
+		PyErr_NoMemory();
+		ITER_ALLOW_THREADS(state);
+		return ITER_RESULT_ERROR;
 	}
 
-	PY_ZFS_UNLOCK(state->pylibzfsp);
-	ITER_END_ALLOW_THREADS(state);
+	entry->obj = NULL;
+	entry->zhp = zhp;
+	entry->depth = depth;
 
-	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
-		set_exc_from_libzfs(&zfs_err, "zfs_iter_root() failed");
+	return ITER_RESULT_SUCCESS;
+}
+
+/*
+ * Visit the snapshots and children of a dataset that did not match the
+ * filter in the same order as a matching one, without creating a python
+ * object for it. Consumes zhp.
+ */
+static int
+walk_skip(py_iter_state_t *state, zfs_handle_t *zhp, uint_t depth,
+	  boolean_t descend)
+{
+	iter_conf_filesystem_t *conf = &state->iter_config.filesystem;
+	int result = ITER_RESULT_SUCCESS;
+
+	switch (conf->order) {
+	case ITER_ORDER_PRE:
+		if (conf->snapshots)
+			result = walk_snapshots_hdl(state, zhp);
+		if ((result == ITER_RESULT_SUCCESS) && descend)
+			result = walk_children_hdl(state, zhp, depth);
+		break;
+	case ITER_ORDER_POST:
+		if (descend)
+			result = walk_children_hdl(state, zhp, depth);
+		if ((result == ITER_RESULT_SUCCESS) && conf->snapshots)
+			result = walk_snapshots_hdl(state, zhp);
+		break;
+	case ITER_ORDER_BFS:
+		if (conf->snapshots)
+			result = walk_snapshots_hdl(state, zhp);
+		if ((result == ITER_RESULT_SUCCESS) && descend) {
+			result = walk_enqueue_hdl(state, zhp, depth);
+			if (result == ITER_RESULT_SUCCESS)
+				return result;
+		}
+		break;
 	}
 
-	return iter_ret;
+	zfs_close(zhp);
+	return result;
 }
 
-int
-py_iter_pools(py_iter_state_t *state)
+static int
+walk_callback(zfs_handle_t *zhp, void *private)
 {
-	int iter_ret;
-	py_zfs_error_t zfs_err;
+	int result = ITER_RESULT_ERROR;
+	py_iter_state_t *state = (py_iter_state_t *)private;
+	iter_conf_filesystem_t *conf = &state->iter_config.filesystem;
+	boolean_t simple = (conf->flags & ZFS_ITER_SIMPLE) ? B_TRUE : B_FALSE;
+	uint_t depth = conf->depth;
+	boolean_t descend;
+	zfs_type_t type = zfs_get_type(zhp);
+	PyObject *new = NULL;
 
-	ITER_ALLOW_THREADS(state);
-	PY_ZFS_LOCK(state->pylibzfsp);
+	descend = (type == ZFS_TYPE_FILESYSTEM) &&
+	    ((conf->max_depth == 0) || (depth < conf->max_depth));
 
-	iter_ret = zpool_iter(state->pylibzfsp->lzh,
-			      pool_callback,
-			      (void *)state);
-	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
-		py_get_zfs_error(state->pylibzfsp->lzh, &zfs_err);
+	if (state->filter && !py_zfs_filter_match(state->filter, zhp)) {
+		/*
+		 * Non-matching datasets are not passed to the callback, but
+		 * their snapshots and children (which may match) are still
+		 * visited through the raw handle.
+		 */
+		if ((type == ZFS_TYPE_SNAPSHOT) ||
+		    (!descend && !conf->snapshots)) {
+			zfs_close(zhp);
+			return ITER_RESULT_SUCCESS;
+		}
+		return walk_skip(state, zhp, depth, descend);
 	}
 
-	PY_ZFS_UNLOCK(state->pylibzfsp);
 	ITER_END_ALLOW_THREADS(state);
 
-	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
-		set_exc_from_libzfs(&zfs_err, "zpool_iter() failed");
+	switch (type) {
+	case ZFS_TYPE_FILESYSTEM:
+		new = (PyObject *)init_zfs_dataset(state->pylibzfsp, zhp, simple);
+		break;
+	case ZFS_TYPE_VOLUME:
+		new = (PyObject *)init_zfs_volume(state->pylibzfsp, zhp, simple);
+		break;
+	case ZFS_TYPE_SNAPSHOT:
+		new = (PyObject *)init_zfs_snapshot(state->pylibzfsp, zhp, simple);
+		break;
+	default:
+		PYZFS_ASSERT(B_FALSE, "Unexpected ZFS type");
 	}
-
+	if (new == NULL) {
+		zfs_close(zhp);
+		goto out;
+	}
+
+	if (type == ZFS_TYPE_SNAPSHOT) {
+		result = common_callback(new, state);
+		goto out;
+	}
+
+	switch (conf->order) {
+	case ITER_ORDER_PRE:
+		result = walk_deliver(state, new);
+		if ((result == ITER_RESULT_SUCCESS) && conf->snapshots)
+			result = walk_snapshots(state, (py_zfs_obj_t *)new);
+		if ((result == ITER_RESULT_SUCCESS) && descend)
+			result = walk_children(state, (py_zfs_obj_t *)new, depth);
+		break;
+	case ITER_ORDER_POST:
+		result = ITER_RESULT_SUCCESS;
+		if (descend)
+			result = walk_children(state, (py_zfs_obj_t *)new, depth);
+		if ((result == ITER_RESULT_SUCCESS) && conf->snapshots)
+			result = walk_snapshots(state, (py_zfs_obj_t *)new);
+		if (result == ITER_RESULT_SUCCESS)
+			result = walk_deliver(state, new);
+		break;
+	case ITER_ORDER_BFS:
+		result = walk_deliver(state, new);
+		if ((result == ITER_RESULT_SUCCESS) && conf->snapshots)
+			result = walk_snapshots(state, (py_zfs_obj_t *)new);
+		if ((result == ITER_RESULT_SUCCESS) && descend)
+			result = walk_enqueue(state, new, depth);
+		break;
+	}
+
+	Py_DECREF(new);
+out:
+	ITER_ALLOW_THREADS(state);
+	return result;
+}
+
+/**
+ * @brief recursively iterate ZFS filesystems, zvols, and optionally snapshots
+ *
+ * This function walks the complete dataset tree below the zfs_handle_t
+ * specified as `target` in the py_iter_state_t struct (the target itself
+ * is not passed to the callback). Recursion options are taken from
+ * state->iter_config.filesystem (max_depth, order, snapshots).
+ *
+ * NOTE: GIL must be held before calling this function, and
+ * state->pylibzfsp->zfs_lock must *not* be held. Batching is not supported.
+ *
+ * @param[in] state	py_zfs iterator state structure
+ *
+ * @return		int - same values as py_iter_filesystems()
+ */
+int
+py_iter_filesystems_recursive(py_iter_state_t *state)
+{
+	int iter_ret;
+	uint64_t op_start;
+	py_zfs_error_t zfs_err;
+	iter_conf_filesystem_t *conf = &state->iter_config.filesystem;
+
+	conf->depth = 1;
+	conf->bfs_queue = NULL;
+	conf->bfs_head = conf->bfs_count = conf->bfs_size = 0;
+
+	ITER_ALLOW_THREADS(state);
+	PY_ZFS_LOCK(state->pylibzfsp);
+	op_start = py_zfs_stats_now();
+
+	iter_ret = zfs_iter_filesystems_v2(state->target,
+					   conf->flags,
+					   walk_callback,
+					   (void *)state);
+
+	while ((iter_ret == ITER_RESULT_SUCCESS) && (conf->bfs_count > 0)) {
+		iter_bfs_entry_t entry = conf->bfs_queue[conf->bfs_head];
+		zfs_handle_t *zhp = entry.zhp;
+
+		conf->bfs_head++;
+		conf->bfs_count--;
+		conf->depth = entry.depth + 1;
+
+		if (entry.obj != NULL)
+			zhp = ((py_zfs_obj_t *)entry.obj)->zhp;
+
+		iter_ret = zfs_iter_filesystems_v2(zhp,
+						   conf->flags,
+						   walk_callback,
+						   (void *)state);
+
+		if (entry.obj == NULL) {
+			zfs_close(entry.zhp);
+			continue;
+		}
+
+		ITER_END_ALLOW_THREADS(state);
+		Py_DECREF(entry.obj);
+		ITER_ALLOW_THREADS(state);
+	}
+
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		py_get_zfs_error(state->pylibzfsp->lzh, &zfs_err);
+	}
+
+	// Close raw handles left in queue if iteration was stopped early
+	for (size_t i = 0; i < conf->bfs_count; i++) {
+		iter_bfs_entry_t *entry = &conf->bfs_queue[conf->bfs_head + i];
+
+		if (entry->obj == NULL)
+			zfs_close(entry->zhp);
+	}
+
+	py_zfs_stats_op(state->pylibzfsp, PY_ZFS_OP_ITER, op_start);
+	PY_ZFS_UNLOCK(state->pylibzfsp);
+	ITER_END_ALLOW_THREADS(state);
+
+	// Release datasets left in queue if iteration was stopped early
+	while (conf->bfs_count > 0) {
+		Py_XDECREF(conf->bfs_queue[conf->bfs_head].obj);
+		conf->bfs_head++;
+		conf->bfs_count--;
+	}
+	PyMem_RawFree(conf->bfs_queue);
+	conf->bfs_queue = NULL;
+
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		set_exc_from_libzfs(&zfs_err, "zfs_iter_filesystems_v2() failed");
+	}
+
+	return iter_ret;
+}
+
+int
+py_iter_snapshots(py_iter_state_t *state)
+{
+	int iter_ret;
+	uint64_t op_start;
+	py_zfs_error_t zfs_err;
+	iter_conf_snapshot_t conf = state->iter_config.snapshot;
+
+	if (iter_batch_init(state, ITER_BATCH_SNAPSHOT) < 0)
+		return ITER_RESULT_ERROR;
+
+	ITER_ALLOW_THREADS(state);
+	PY_ZFS_LOCK(state->pylibzfsp);
+	op_start = py_zfs_stats_now();
+
+	if (conf.sorted) {
+		iter_ret = zfs_iter_snapshots_sorted_v2(state->target,
+							conf.flags,
+							snapshot_callback,
+							(void *)state,
+							conf.min_txg,
+							conf.max_txg);
+	} else {
+		iter_ret = zfs_iter_snapshots_v2(state->target,
+						 conf.flags,
+						 snapshot_callback,
+						 (void *)state,
+						 conf.min_txg,
+						 conf.max_txg);
+	}
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		py_get_zfs_error(state->pylibzfsp->lzh, &zfs_err);
+	}
+
+	iter_ret = iter_batch_finish(state, iter_ret);
+
+	py_zfs_stats_op(state->pylibzfsp, PY_ZFS_OP_ITER, op_start);
+	PY_ZFS_UNLOCK(state->pylibzfsp);
+	ITER_END_ALLOW_THREADS(state);
+	iter_batch_free(state);
+
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		set_exc_from_libzfs(&zfs_err, "zfs_iter_snapshots() failed");
+	}
+
+	return iter_ret;
+}
+
+
+#define MAX_ZFS_USERSPACE_RETRIES 50  // number of retries with 0.1 sec sleep
+
+/*
+ * Run zfs_userspace() for a single quota type. Must be called with the GIL
+ * released and the ZFS lock held. On ITER_RESULT_IOCTL_ERROR the libzfs error
+ * is stored in zfs_err.
+ */
+static int
+userspace_with_retry(py_zfs_t *pylibzfsp,
+		     zfs_handle_t *zhp,
+		     zfs_userquota_prop_t qtype,
+		     zfs_userspace_cb_t cb,
+		     void *private,
+		     py_zfs_error_t *zfs_err)
+{
+	int iter_ret, tries;
+
+	/*
+	 * zfs_ioctl() may fail with EBUSY if dataset is unmounted due to
+	 * zfsvfs_hold() return. In this case we can retry here a few
+	 * times while the GIL is released and the ZFS lock is held.
+	 */
+	for (tries = 0; tries < MAX_ZFS_USERSPACE_RETRIES; tries++) {
+		iter_ret = zfs_userspace(zhp, qtype, cb, private);
+
+		if (iter_ret != ITER_RESULT_IOCTL_ERROR)
+			break;
+
+		// store libzfs error state in case this is our last retry
+		py_get_zfs_error(pylibzfsp->lzh, zfs_err);
+		if (zfs_err->code != EZFS_BUSY) {
+			// only retry if failed with EBUSY
+			break;
+		}
+
+		usleep(100000);
+	}
+
+	return iter_ret;
+}
+
+int
+py_iter_userspace(py_iter_state_t *state)
+{
+	int iter_ret;
+	uint64_t op_start;
+	py_zfs_error_t zfs_err;
+	iter_conf_userspace_t conf = state->iter_config.userspace;
+
+	ITER_ALLOW_THREADS(state);
+	PY_ZFS_LOCK(state->pylibzfsp);
+	op_start = py_zfs_stats_now();
+
+	iter_ret = userspace_with_retry(state->pylibzfsp,
+					state->target,
+					conf.qtype,
+					userspace_callback,
+					(void *)state,
+					&zfs_err);
+
+	py_zfs_stats_op(state->pylibzfsp, PY_ZFS_OP_ITER, op_start);
+	PY_ZFS_UNLOCK(state->pylibzfsp);
+	ITER_END_ALLOW_THREADS(state);
+
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		set_exc_from_libzfs(&zfs_err, "zfs_iter_userspace() failed");
+	}
+
+	return iter_ret;
+}
+
+int
+py_iter_root_filesystems(py_iter_state_t *state)
+{
+	int iter_ret;
+	uint64_t op_start;
+	py_zfs_error_t zfs_err;
+
+	if (iter_batch_init(state, ITER_BATCH_DATASET) < 0)
+		return ITER_RESULT_ERROR;
+
+	ITER_ALLOW_THREADS(state);
+	PY_ZFS_LOCK(state->pylibzfsp);
+	op_start = py_zfs_stats_now();
+
+	// We can use our generic filesystem_callback here
+	// since we're producing only dataset handles
+	iter_ret = zfs_iter_root(state->pylibzfsp->lzh,
+				 filesystem_callback,
+				 (void *)state);
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		py_get_zfs_error(state->pylibzfsp->lzh, &zfs_err);
+	}
+
+	iter_ret = iter_batch_finish(state, iter_ret);
+
+	py_zfs_stats_op(state->pylibzfsp, PY_ZFS_OP_ITER, op_start);
+	PY_ZFS_UNLOCK(state->pylibzfsp);
+	ITER_END_ALLOW_THREADS(state);
+	iter_batch_free(state);
+
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		set_exc_from_libzfs(&zfs_err, "zfs_iter_root() failed");
+	}
+
+	return iter_ret;
+}
+
+int
+py_iter_pools(py_iter_state_t *state)
+{
+	int iter_ret;
+	uint64_t op_start;
+	py_zfs_error_t zfs_err;
+
+	if (iter_batch_init(state, ITER_BATCH_POOL) < 0)
+		return ITER_RESULT_ERROR;
+
+	ITER_ALLOW_THREADS(state);
+	PY_ZFS_LOCK(state->pylibzfsp);
+	op_start = py_zfs_stats_now();
+
+	iter_ret = zpool_iter(state->pylibzfsp->lzh,
+			      pool_callback,
+			      (void *)state);
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		py_get_zfs_error(state->pylibzfsp->lzh, &zfs_err);
+	}
+
+	iter_ret = iter_batch_finish(state, iter_ret);
+
+	py_zfs_stats_op(state->pylibzfsp, PY_ZFS_OP_ITER, op_start);
+	PY_ZFS_UNLOCK(state->pylibzfsp);
+	ITER_END_ALLOW_THREADS(state);
+	iter_batch_free(state);
+
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		set_exc_from_libzfs(&zfs_err, "zpool_iter() failed");
+	}
+
 	return iter_ret;
 }
+
+/*
+ * Name-only iteration
+ *
+ * py_iter_names() collects the names (and optionally createtxg) of child
+ * filesystems or snapshots into C arrays while the GIL is released and the
+ * libzfs handle lock is held. Simple ZFS handles are used and no python
+ * objects are created until the walk completes, at which point the names
+ * are converted to a tuple of str in one pass.
+ *
+ * names_add() and names_callback() are called without the GIL and so may
+ * only use the raw python memory allocator.
+ */
+typedef struct {
+	py_iter_state_t *state;
+	boolean_t snapshots;
+	boolean_t recursive;
+	boolean_t get_createtxg;
+	boolean_t nomem;
+	char **names;
+	uint64_t *txgs;
+	size_t count;
+	size_t size;
+} iter_names_t;
+
+static int
+names_add(iter_names_t *n, zfs_handle_t *zhp)
+{
+	const char *name = zfs_get_name(zhp);
+	size_t len = strlen(name) + 1;
+
+	if (n->count == n->size) {
+		size_t new_size = n->size ? n->size * 2 : 256;
+		char **new_names;
+
+		new_names = PyMem_RawRealloc(n->names, new_size * sizeof(char *));
+		if (new_names == NULL)
+			goto nomem;
+		n->names = new_names;
+
+		if (n->get_createtxg) {
+			uint64_t *new_txgs;
+
+			new_txgs = PyMem_RawRealloc(n->txgs,
+			    new_size * sizeof(uint64_t));
+			if (new_txgs == NULL)
+				goto nomem;
+			n->txgs = new_txgs;
+		}
+		n->size = new_size;
+	}
+
+	n->names[n->count] = PyMem_RawMalloc(len);
+	if (n->names[n->count] == NULL)
+		goto nomem;
+
+	memcpy(n->names[n->count], name, len);
+	if (n->get_createtxg)
+		n->txgs[n->count] = zfs_prop_get_int(zhp, ZFS_PROP_CREATETXG);
+
+	n->count++;
+	return ITER_RESULT_SUCCESS;
+
+nomem:
+	n->nomem = B_TRUE;
+	return ITER_RESULT_ERROR;
+}
+
+static int names_callback(zfs_handle_t *zhp, void *private);
+
+static int
+names_iter_snapshots(iter_names_t *n, zfs_handle_t *zhp)
+{
+	iter_conf_snapshot_t *conf = &n->state->iter_config.snapshot;
+
+	if (conf->sorted) {
+		return zfs_iter_snapshots_sorted_v2(zhp, ZFS_ITER_SIMPLE,
+						    names_callback, n,
+						    conf->min_txg,
+						    conf->max_txg);
+	}
+
+	return zfs_iter_snapshots_v2(zhp, ZFS_ITER_SIMPLE, names_callback, n,
+				     conf->min_txg, conf->max_txg);
+}
+
+static int
+names_callback(zfs_handle_t *zhp, void *private)
+{
+	iter_names_t *n = (iter_names_t *)private;
+	zfs_type_t type = zfs_get_type(zhp);
+	int ret = ITER_RESULT_SUCCESS;
+
+	if ((type == ZFS_TYPE_SNAPSHOT) == n->snapshots)
+		ret = names_add(n, zhp);
+
+	if ((ret == ITER_RESULT_SUCCESS) && (type != ZFS_TYPE_SNAPSHOT) &&
+	    n->recursive) {
+		if (n->snapshots)
+			ret = names_iter_snapshots(n, zhp);
+
+		if ((ret == ITER_RESULT_SUCCESS) && (type == ZFS_TYPE_FILESYSTEM))
+			ret = zfs_iter_filesystems_v2(zhp, ZFS_ITER_SIMPLE,
+						      names_callback, n);
+	}
+
+	zfs_close(zhp);
+	return ret;
+}
+
+static PyObject *
+names_to_py(iter_names_t *n)
+{
+	PyObject *names = NULL;
+	PyObject *txgs = NULL;
+	size_t i;
+
+	names = PyTuple_New(n->count);
+	if (names == NULL)
+		return NULL;
+
+	if (n->get_createtxg) {
+		txgs = PyTuple_New(n->count);
+		if (txgs == NULL)
+			goto fail;
+	}
+
+	for (i = 0; i < n->count; i++) {
+		PyObject *item = PyUnicode_FromString(n->names[i]);
+		if (item == NULL)
+			goto fail;
+
+		PyTuple_SET_ITEM(names, i, item);
+
+		if (txgs == NULL)
+			continue;
+
+		item = PyLong_FromUnsignedLongLong(n->txgs[i]);
+		if (item == NULL)
+			goto fail;
+
+		PyTuple_SET_ITEM(txgs, i, item);
+	}
+
+	if (txgs == NULL)
+		return names;
+
+	return Py_BuildValue("(NN)", names, txgs);
+
+fail:
+	Py_XDECREF(names);
+	Py_XDECREF(txgs);
+	return NULL;
+}
+
+/**
+ * @brief list names of child filesystems / volumes or snapshots
+ *
+ * Collect the names of filesystems and volumes (snapshots=B_FALSE) or
+ * snapshots (snapshots=B_TRUE) below state->target. If recursive is set
+ * then the entire tree below target is walked (and for snapshots, the
+ * snapshots of every descendant are included). Snapshot ordering and
+ * transaction group range are taken from state->iter_config.snapshot.
+ *
+ * NOTE: GIL must be held before calling this function, and
+ * state->pylibzfsp->zfs_lock must *not* be held.
+ *
+ * @param[in] state		py_zfs iterator state structure
+ * @param[in] snapshots		list snapshots rather than filesystems
+ * @param[in] recursive		walk entire tree below target
+ * @param[in] get_createtxg	also return tuple of createtxg values
+ *
+ * @return	tuple of names, or tuple of (names, createtxgs) if
+ *		get_createtxg is set. NULL with python exception on error.
+ */
+PyObject *
+py_iter_names(py_iter_state_t *state,
+	      boolean_t snapshots,
+	      boolean_t recursive,
+	      boolean_t get_createtxg)
+{
+	int iter_ret;
+	uint64_t op_start;
+	size_t i;
+	py_zfs_error_t zfs_err;
+	PyObject *out = NULL;
+	iter_names_t n = (iter_names_t) {
+		.state = state,
+		.snapshots = snapshots,
+		.recursive = recursive,
+		.get_createtxg = get_createtxg,
+	};
+
+	ITER_ALLOW_THREADS(state);
+	PY_ZFS_LOCK(state->pylibzfsp);
+	op_start = py_zfs_stats_now();
+
+	if (snapshots) {
+		iter_ret = names_iter_snapshots(&n, state->target);
+		if ((iter_ret == ITER_RESULT_SUCCESS) && recursive) {
+			iter_ret = zfs_iter_filesystems_v2(state->target,
+							   ZFS_ITER_SIMPLE,
+							   names_callback,
+							   &n);
+		}
+	} else {
+		iter_ret = zfs_iter_filesystems_v2(state->target,
+						   ZFS_ITER_SIMPLE,
+						   names_callback,
+						   &n);
+	}
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		py_get_zfs_error(state->pylibzfsp->lzh, &zfs_err);
+	}
+
+	py_zfs_stats_op(state->pylibzfsp, PY_ZFS_OP_ITER, op_start);
+	PY_ZFS_UNLOCK(state->pylibzfsp);
+	ITER_END_ALLOW_THREADS(state);
+
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		set_exc_from_libzfs(&zfs_err, "ZFS iteration failed");
+	} else if (n.nomem) {
+		PyErr_NoMemory();
+	} else {
+		out = names_to_py(&n);
+	}
+
+	for (i = 0; i < n.count; i++)
+		PyMem_RawFree(n.names[i]);
+	PyMem_RawFree(n.names);
+	PyMem_RawFree(n.txgs);
+
+	return out;
+}
+
+/*
+ * Subtree space summary
+ *
+ * py_iter_space_summary() walks the filesystems and volumes below (and
+ * including) state->target with the GIL released and the libzfs handle lock
+ * held. Space properties are read from each handle with zfs_prop_get_int()
+ * and stored in walk (pre-)order along with the index of the parent entry.
+ * Once the walk completes, subtree totals are computed in a single reverse
+ * pass by adding each entry into its parent, and only then are python
+ * objects created.
+ *
+ * Full handles are required for property access, but these are populated
+ * from the list ioctl used by the iterator and so do not cost an additional
+ * ioctl per dataset. Snapshots are only counted and so simple handles are
+ * used for them.
+ */
+PyStructSequence_Field struct_zfs_space_summary[] = {
+	{"datasets", "Number of filesystems and volumes in the subtree "
+	 "(including this one)."},
+	{"snapshots", "Number of snapshots of datasets in the subtree."},
+	{"used", "Value of the used property of this dataset."},
+	{"usedbychildren", "Value of the usedbychildren property of this "
+	 "dataset."},
+	{"referenced", "Sum of referenced over the subtree."},
+	{"usedbydataset", "Sum of usedbydataset over the subtree."},
+	{"usedbysnapshots", "Sum of usedbysnapshots over the subtree."},
+	{"usedbyrefreservation", "Sum of usedbyrefreservation over the "
+	 "subtree."},
+	{0},
+};
+
+PyStructSequence_Desc struct_zfs_space_summary_type_desc = {
+	.name = PYLIBZFS_TYPES_MODULE_NAME ".struct_zfs_space_summary",
+	.fields = struct_zfs_space_summary,
+	.doc = "Aggregated space accounting for a ZFS dataset subtree.",
+	.n_in_sequence = 8
+};
+
+void init_py_struct_space_summary_state(pylibzfs_state_t *state)
+{
+	PyTypeObject *obj;
+
+	obj = PyStructSequence_NewType(&struct_zfs_space_summary_type_desc);
+	PYZFS_ASSERT(obj, "Failed to create ZFS space summary type");
+
+	state->struct_zfs_space_summary_type = obj;
+}
+
+/* Properties summed over the subtree, in struct_zfs_space_summary order */
+static const zfs_prop_t space_summed_props[] = {
+	ZFS_PROP_REFERENCED,
+	ZFS_PROP_USEDDS,
+	ZFS_PROP_USEDSNAP,
+	ZFS_PROP_USEDREFRESERV,
+};
+
+#define	SPACE_NSUMMED	ARRAY_SIZE(space_summed_props)
+
+typedef struct {
+	char *name;
+	size_t parent;
+	uint64_t datasets;
+	uint64_t snapshots;
+	uint64_t used;
+	uint64_t usedbychildren;
+	uint64_t summed[SPACE_NSUMMED];
+} space_entry_t;
+
+typedef struct {
+	boolean_t snapshots;
+	boolean_t nomem;
+	space_entry_t *entries;
+	size_t count;
+	size_t size;
+	size_t parent;
+} iter_space_t;
+
+static int
+space_count_snapshot(zfs_handle_t *zhp, void *private)
+{
+	uint64_t *count = (uint64_t *)private;
+
+	(*count)++;
+	zfs_close(zhp);
+	return ITER_RESULT_SUCCESS;
+}
+
+static int
+space_add(iter_space_t *s, zfs_handle_t *zhp, size_t parent)
+{
+	const char *name = zfs_get_name(zhp);
+	size_t len = strlen(name) + 1;
+	uint64_t nsnaps = 0;
+	space_entry_t *e;
+	size_t i;
+
+	if (s->snapshots) {
+		int ret = zfs_iter_snapshots_v2(zhp, ZFS_ITER_SIMPLE,
+						space_count_snapshot, &nsnaps,
+						0, 0);
+		if (ret != ITER_RESULT_SUCCESS)
+			return ret;
+	}
+
+	if (s->count == s->size) {
+		size_t new_size = s->size ? s->size * 2 : 64;
+		space_entry_t *new_entries;
+
+		new_entries = PyMem_RawRealloc(s->entries,
+		    new_size * sizeof(space_entry_t));
+		if (new_entries == NULL)
+			goto nomem;
+		s->entries = new_entries;
+		s->size = new_size;
+	}
+
+	e = &s->entries[s->count];
+	e->name = PyMem_RawMalloc(len);
+	if (e->name == NULL)
+		goto nomem;
+
+	memcpy(e->name, name, len);
+	e->parent = parent;
+	e->datasets = 1;
+	e->snapshots = nsnaps;
+	e->used = zfs_prop_get_int(zhp, ZFS_PROP_USED);
+	e->usedbychildren = zfs_prop_get_int(zhp, ZFS_PROP_USEDCHILD);
+	for (i = 0; i < SPACE_NSUMMED; i++)
+		e->summed[i] = zfs_prop_get_int(zhp, space_summed_props[i]);
+
+	s->count++;
+	return ITER_RESULT_SUCCESS;
+
+nomem:
+	s->nomem = B_TRUE;
+	return ITER_RESULT_ERROR;
+}
+
+static int
+space_callback(zfs_handle_t *zhp, void *private)
+{
+	iter_space_t *s = (iter_space_t *)private;
+	size_t parent = s->parent;
+	int ret;
+
+	ret = space_add(s, zhp, parent);
+	if ((ret == ITER_RESULT_SUCCESS) &&
+	    (zfs_get_type(zhp) == ZFS_TYPE_FILESYSTEM)) {
+		s->parent = s->count - 1;
+		ret = zfs_iter_filesystems_v2(zhp, 0, space_callback, s);
+		s->parent = parent;
+	}
+
+	zfs_close(zhp);
+	return ret;
+}
+
+static PyObject *
+space_entry_to_py(PyTypeObject *type, space_entry_t *e)
+{
+	PyObject *out = NULL;
+	uint64_t vals[4 + SPACE_NSUMMED];
+	size_t i;
+
+	vals[0] = e->datasets;
+	vals[1] = e->snapshots;
+	vals[2] = e->used;
+	vals[3] = e->usedbychildren;
+	for (i = 0; i < SPACE_NSUMMED; i++)
+		vals[4 + i] = e->summed[i];
+
+	out = PyStructSequence_New(type);
+	if (out == NULL)
+		return NULL;
+
+	for (i = 0; i < ARRAY_SIZE(vals); i++) {
+		PyObject *val = PyLong_FromUnsignedLongLong(vals[i]);
+		if (val == NULL) {
+			Py_DECREF(out);
+			return NULL;
+		}
+		PyStructSequence_SET_ITEM(out, i, val);
+	}
+
+	return out;
+}
+
+static PyObject *
+space_to_py(py_iter_state_t *state, iter_space_t *s)
+{
+	pylibzfs_state_t *mstate = py_get_module_state(state->pylibzfsp);
+	PyObject *out = NULL;
+	size_t i;
+
+	out = PyDict_New();
+	if (out == NULL)
+		return NULL;
+
+	for (i = 0; i < s->count; i++) {
+		PyObject *item;
+		int err;
+
+		item = space_entry_to_py(mstate->struct_zfs_space_summary_type,
+					 &s->entries[i]);
+		if (item == NULL)
+			goto fail;
+
+		err = PyDict_SetItemString(out, s->entries[i].name, item);
+		Py_DECREF(item);
+		if (err)
+			goto fail;
+	}
+
+	return out;
+fail:
+	Py_DECREF(out);
+	return NULL;
+}
+
+/**
+ * @brief summarize space usage of a dataset subtree
+ *
+ * Read the space properties of state->target and (if recursive is set) of
+ * every filesystem and volume below it, and aggregate them per subtree.
+ * Snapshots of each dataset are counted if snapshots is set.
+ *
+ * NOTE: GIL must be held before calling this function, and
+ * state->pylibzfsp->zfs_lock must *not* be held. The target must be a
+ * filesystem or volume with properties loaded.
+ *
+ * @param[in] state		py_zfs iterator state structure
+ * @param[in] recursive		include all descendants of target
+ * @param[in] snapshots		count snapshots of each dataset
+ *
+ * @return	dict mapping dataset name to struct_zfs_space_summary for the
+ *		subtree rooted at that dataset. NULL with python exception
+ *		on error.
+ */
+PyObject *
+py_iter_space_summary(py_iter_state_t *state,
+		      boolean_t recursive,
+		      boolean_t snapshots)
+{
+	int iter_ret;
+	uint64_t op_start;
+	size_t i;
+	py_zfs_error_t zfs_err;
+	PyObject *out = NULL;
+	iter_space_t s = (iter_space_t) {
+		.snapshots = snapshots,
+	};
+
+	ITER_ALLOW_THREADS(state);
+	PY_ZFS_LOCK(state->pylibzfsp);
+	op_start = py_zfs_stats_now();
+
+	iter_ret = space_add(&s, state->target, 0);
+	if ((iter_ret == ITER_RESULT_SUCCESS) && recursive &&
+	    (zfs_get_type(state->target) == ZFS_TYPE_FILESYSTEM)) {
+		iter_ret = zfs_iter_filesystems_v2(state->target, 0,
+						   space_callback, &s);
+	}
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		py_get_zfs_error(state->pylibzfsp->lzh, &zfs_err);
+	}
+
+	py_zfs_stats_op(state->pylibzfsp, PY_ZFS_OP_ITER, op_start);
+	PY_ZFS_UNLOCK(state->pylibzfsp);
+	ITER_END_ALLOW_THREADS(state);
+
+	// Entries are in pre-order and so every child follows its parent.
+	// Entry 0 is the target and has no parent within the walk.
+	for (i = s.count; i > 1; i--) {
+		space_entry_t *e = &s.entries[i - 1];
+		space_entry_t *p = &s.entries[e->parent];
+		size_t j;
+
+		p->datasets += e->datasets;
+		p->snapshots += e->snapshots;
+		for (j = 0; j < SPACE_NSUMMED; j++)
+			p->summed[j] += e->summed[j];
+	}
+
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		set_exc_from_libzfs(&zfs_err, "ZFS iteration failed");
+	} else if (s.nomem) {
+		PyErr_NoMemory();
+	} else {
+		out = space_to_py(state, &s);
+	}
+
+	for (i = 0; i < s.count; i++)
+		PyMem_RawFree(s.entries[i].name);
+	PyMem_RawFree(s.entries);
+
+	return out;
+}
+
+/*
+ * Columnar userspace accounting
+ *
+ * py_iter_userspace_columns() runs zfs_userspace() once per requested quota
+ * type and merges the results into per-column uint64_t arrays keyed by xid.
+ * The whole collection happens with the GIL released and the ZFS lock held;
+ * rows are located through an open-addressing hash table on xid so that the
+ * merge stays linear for datasets with hundreds of thousands of ids. Each
+ * column is returned as a read-only memoryview of format "Q" so that no
+ * python object is created per entry.
+ *
+ * Column index for each quota type is provided by userspace_qtype_column().
+ */
+typedef struct {
+	boolean_t nomem;
+	int col;
+	uint64_t *xids;
+	uint64_t *cols[USERSPACE_NCOLS];
+	size_t count;
+	size_t size;
+	size_t *slots;
+	size_t nslots;
+} userspace_cols_t;
+
+static const char *userspace_col_names[USERSPACE_NCOLS] = {
+	"used",
+	"quota",
+	"objused",
+	"objquota",
+};
+
+int
+userspace_qtype_column(zfs_userquota_prop_t qtype)
+{
+	switch (qtype) {
+	case ZFS_PROP_USERUSED:
+	case ZFS_PROP_GROUPUSED:
+	case ZFS_PROP_PROJECTUSED:
+		return USERSPACE_COL_USED;
+	case ZFS_PROP_USERQUOTA:
+	case ZFS_PROP_GROUPQUOTA:
+	case ZFS_PROP_PROJECTQUOTA:
+		return USERSPACE_COL_QUOTA;
+	case ZFS_PROP_USEROBJUSED:
+	case ZFS_PROP_GROUPOBJUSED:
+	case ZFS_PROP_PROJECTOBJUSED:
+		return USERSPACE_COL_OBJUSED;
+	case ZFS_PROP_USEROBJQUOTA:
+	case ZFS_PROP_GROUPOBJQUOTA:
+	case ZFS_PROP_PROJECTOBJQUOTA:
+		return USERSPACE_COL_OBJQUOTA;
+	default:
+		break;
+	}
+
+	return -1;
+}
+
+static inline size_t
+userspace_hash(uint64_t xid, size_t nslots)
+{
+	return (size_t)((xid * 0x9E3779B97F4A7C15ULL) >> 32) & (nslots - 1);
+}
+
+/*
+ * Rebuild hash table with twice the number of slots. Slots hold row + 1 so
+ * that zero marks an empty slot.
+ */
+static boolean_t
+userspace_rehash(userspace_cols_t *u)
+{
+	size_t new_nslots = u->nslots ? u->nslots * 2 : 1024;
+	size_t *new_slots;
+	size_t i, h;
+
+	new_slots = PyMem_RawCalloc(new_nslots, sizeof(size_t));
+	if (new_slots == NULL)
+		return B_FALSE;
+
+	for (i = 0; i < u->count; i++) {
+		h = userspace_hash(u->xids[i], new_nslots);
+		while (new_slots[h] != 0)
+			h = (h + 1) & (new_nslots - 1);
+		new_slots[h] = i + 1;
+	}
+
+	PyMem_RawFree(u->slots);
+	u->slots = new_slots;
+	u->nslots = new_nslots;
+	return B_TRUE;
+}
+
+static boolean_t
+userspace_grow(userspace_cols_t *u)
+{
+	size_t new_size = u->size ? u->size * 2 : 256;
+	uint64_t *new_col;
+	int i;
+
+	new_col = PyMem_RawRealloc(u->xids, new_size * sizeof(uint64_t));
+	if (new_col == NULL)
+		return B_FALSE;
+	u->xids = new_col;
+
+	for (i = 0; i < USERSPACE_NCOLS; i++) {
+		if (u->cols[i] == NULL)
+			continue;
+
+		new_col = PyMem_RawRealloc(u->cols[i],
+		    new_size * sizeof(uint64_t));
+		if (new_col == NULL)
+			return B_FALSE;
+		u->cols[i] = new_col;
+	}
+
+	u->size = new_size;
+	return B_TRUE;
+}
+
+static int
+userspace_cols_callback(void *private,
+			const char *dom,
+			uid_t xid,
+			uint64_t val,
+			uint64_t default_quota)
+{
+	userspace_cols_t *u = (userspace_cols_t *)private;
+	size_t h, row;
+	int i;
+
+	if ((u->count + 1) * 2 > u->nslots) {
+		if (!userspace_rehash(u))
+			goto nomem;
+	}
+
+	// domain is intentionally omitted, see userspace_callback()
+	h = userspace_hash(xid, u->nslots);
+	while (u->slots[h] != 0) {
+		row = u->slots[h] - 1;
+		if (u->xids[row] == xid) {
+			u->cols[u->col][row] = val;
+			return ITER_RESULT_SUCCESS;
+		}
+		h = (h + 1) & (u->nslots - 1);
+	}
+
+	if ((u->count == u->size) && !userspace_grow(u))
+		goto nomem;
+
+	row = u->count++;
+	u->slots[h] = row + 1;
+	u->xids[row] = xid;
+	for (i = 0; i < USERSPACE_NCOLS; i++) {
+		if (u->cols[i] != NULL)
+			u->cols[i][row] = 0;
+	}
+	u->cols[u->col][row] = val;
+
+	return ITER_RESULT_SUCCESS;
+
+nomem:
+	u->nomem = B_TRUE;
+	return ITER_RESULT_ERROR;
+}
+
+static PyObject *
+userspace_column_to_py(const uint64_t *col, size_t count)
+{
+	PyObject *bytes = NULL;
+	PyObject *mv = NULL;
+	PyObject *out = NULL;
+
+	bytes = PyBytes_FromStringAndSize((const char *)col,
+					  count * sizeof(uint64_t));
+	if (bytes == NULL)
+		return NULL;
+
+	mv = PyMemoryView_FromObject(bytes);
+	Py_DECREF(bytes);
+	if (mv == NULL)
+		return NULL;
+
+	out = PyObject_CallMethod(mv, "cast", "s", "Q");
+	Py_DECREF(mv);
+	return out;
+}
+
+static PyObject *
+userspace_cols_to_py(userspace_cols_t *u)
+{
+	PyObject *out = NULL;
+	PyObject *col = NULL;
+	int i;
+
+	out = PyDict_New();
+	if (out == NULL)
+		return NULL;
+
+	col = userspace_column_to_py(u->xids, u->count);
+	if ((col == NULL) || (PyDict_SetItemString(out, "xid", col) < 0))
+		goto fail;
+	Py_CLEAR(col);
+
+	for (i = 0; i < USERSPACE_NCOLS; i++) {
+		if (u->cols[i] == NULL)
+			continue;
+
+		col = userspace_column_to_py(u->cols[i], u->count);
+		if ((col == NULL) ||
+		    (PyDict_SetItemString(out, userspace_col_names[i], col) < 0))
+			goto fail;
+		Py_CLEAR(col);
+	}
+
+	return out;
+
+fail:
+	Py_XDECREF(col);
+	Py_DECREF(out);
+	return NULL;
+}
+
+/**
+ * @brief collect userspace accounting for several quota types as columns
+ *
+ * Run zfs_userspace() for each of qtypes against state->target and merge
+ * the results by xid. Caller is responsible for ensuring that qtypes map
+ * to distinct columns (see userspace_qtype_column()) and that they all
+ * refer to the same id space (user, group or project).
+ *
+ * NOTE: GIL must be held before calling this function, and
+ * state->pylibzfsp->zfs_lock must *not* be held.
+ *
+ * @param[in] state	py_zfs iterator state structure
+ * @param[in] qtypes	quota types to collect
+ * @param[in] nqtypes	number of entries in qtypes
+ *
+ * @return	dict mapping "xid" and the column name of each quota type to
+ *		a memoryview of unsigned 64-bit integers. Rows without an
+ *		entry for a given quota type are zero. NULL with python
+ *		exception on error.
+ */
+PyObject *
+py_iter_userspace_columns(py_iter_state_t *state,
+			  const zfs_userquota_prop_t *qtypes,
+			  size_t nqtypes)
+{
+	int iter_ret = ITER_RESULT_SUCCESS;
+	uint64_t op_start;
+	size_t i;
+	py_zfs_error_t zfs_err;
+	PyObject *out = NULL;
+	userspace_cols_t u = (userspace_cols_t) { .nomem = B_FALSE };
+
+	/*
+	 * Columns are allocated lazily in userspace_grow(); mark the
+	 * requested ones with a zero-sized allocation so that they are
+	 * included.
+	 */
+	for (i = 0; i < nqtypes; i++) {
+		int col = userspace_qtype_column(qtypes[i]);
+		PYZFS_ASSERT((col >= 0), "Invalid quota type");
+
+		u.cols[col] = PyMem_RawMalloc(0);
+		if (u.cols[col] == NULL) {
+			PyErr_NoMemory();
+			goto out;
+		}
+	}
+
+	ITER_ALLOW_THREADS(state);
+	PY_ZFS_LOCK(state->pylibzfsp);
+	op_start = py_zfs_stats_now();
+
+	for (i = 0; i < nqtypes; i++) {
+		u.col = userspace_qtype_column(qtypes[i]);
+		iter_ret = userspace_with_retry(state->pylibzfsp,
+						state->target,
+						qtypes[i],
+						userspace_cols_callback,
+						&u,
+						&zfs_err);
+		if (iter_ret != ITER_RESULT_SUCCESS)
+			break;
+	}
+
+	py_zfs_stats_op(state->pylibzfsp, PY_ZFS_OP_ITER, op_start);
+	PY_ZFS_UNLOCK(state->pylibzfsp);
+	ITER_END_ALLOW_THREADS(state);
+
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		set_exc_from_libzfs(&zfs_err, "zfs_iter_userspace() failed");
+	} else if (u.nomem) {
+		PyErr_NoMemory();
+	} else {
+		out = userspace_cols_to_py(&u);
+	}
+
+out:
+	for (i = 0; i < USERSPACE_NCOLS; i++)
+		PyMem_RawFree(u.cols[i]);
+	PyMem_RawFree(u.xids);
+	PyMem_RawFree(u.slots);
+
+	return out;
+}
+
+/**
+ * @brief validate and set batch size for iterator
+ *
+ * Helper for python methods that accept the `batch_size` keyword
+ * argument. A batch size of zero means that callback is called once per
+ * ZFS object (legacy behavior).
+ *
+ * @param[in] state	py_zfs iterator state structure
+ * @param[in] batch_size	batch size requested by python caller
+ *
+ * @return		0 on success, -1 with python exception set on error.
+ */
+int
+py_iter_set_batch_size(py_iter_state_t *state, Py_ssize_t batch_size)
+{
+	if (batch_size < 0) {
+		PyErr_SetString(PyExc_ValueError,
+				"batch_size must be a non-negative integer.");
+		return -1;
+	}
+
+	state->batch.size = (size_t)batch_size;
+	return 0;
+}
+
+/**
+ * @brief validate and set filter for iterator
+ *
+ * Helper for python methods that accept the `filter` keyword argument.
+ * None means that no filter is applied. The reference to the filter is
+ * borrowed from the caller's arguments. Filters that evaluate properties
+ * require full (non-simple) ZFS handles.
+ *
+ * @param[in] state	py_zfs iterator state structure
+ * @param[in] py_filter	filter object passed by python caller. May be NULL.
+ * @param[in] simple	iteration uses simple handles (fast=True)
+ *
+ * @return		0 on success, -1 with python exception set on error.
+ */
+int
+py_iter_set_filter(py_iter_state_t *state, PyObject *py_filter,
+		   boolean_t simple)
+{
+	py_zfs_filter_t *filter;
+
+	if (NULL_OR_NONE(py_filter))
+		return 0;
+
+	if (!PyObject_TypeCheck(py_filter, &ZFSFilter)) {
+		PyErr_SetString(PyExc_TypeError,
+				"filter must be a ZFSFilter object created by "
+				"truenas_pylibzfs.create_filter().");
+		return -1;
+	}
+
+	filter = (py_zfs_filter_t *)py_filter;
+	if (simple && PY_ZFS_FILTER_NEEDS_PROPS(filter)) {
+		PyErr_SetString(PyExc_ValueError,
+				"filters on properties or user_properties "
+				"may not be combined with fast=True.");
+		return -1;
+	}
+
+	state->filter = filter;
+	return 0;
+}
@@ -13,8 +13,50 @@
 #define ITER_RESULT_STOP -2
 #define ITER_RESULT_ERROR -3
 
+/*
+ * Traversal order for recursive filesystem iteration
+ * PRE: parent is passed to callback before its children.
+ * POST: children are passed to callback before their parent.
+ * BFS: breadth-first (all datasets at depth N before depth N + 1).
+ */
+typedef enum {
+	ITER_ORDER_PRE,
+	ITER_ORDER_POST,
+	ITER_ORDER_BFS,
+} iter_order_t;
+
+/*
+ * obj: python object whose children are to be visited, or NULL if the
+ *     dataset did not match the filter, in which case zhp is owned by the
+ *     entry instead.
+ */
+typedef struct {
+	PyObject *obj;
+	zfs_handle_t *zhp;
+	uint_t depth;
+} iter_bfs_entry_t;
+
+/*
+ * flags: zfs_iter_f flags (ZFS_ITER_SIMPLE)
+ *
+ * The following are only used by py_iter_filesystems_recursive():
+ * max_depth: maximum depth of the walk relative to target (0 is unlimited,
+ *     1 is equivalent to non-recursive iteration).
+ * order: traversal order
+ * snapshots: also pass snapshots of each dataset to the callback.
+ * depth: depth of datasets currently being generated by libzfs.
+ * bfs_queue: datasets whose children still need to be visited for BFS.
+ */
 typedef struct {
 	int flags;
+	uint_t max_depth;
+	iter_order_t order;
+	boolean_t snapshots;
+	uint_t depth;
+	iter_bfs_entry_t *bfs_queue;
+	size_t bfs_head;
+	size_t bfs_count;
+	size_t bfs_size;
 } iter_conf_filesystem_t;
 
 typedef struct {
@@ -34,10 +76,48 @@ typedef struct {
 	PyTypeObject *pyuserquota_struct;
 } iter_conf_userspace_t;
 
+/* Columns returned by py_iter_userspace_columns() */
+typedef enum {
+	USERSPACE_COL_USED,
+	USERSPACE_COL_QUOTA,
+	USERSPACE_COL_OBJUSED,
+	USERSPACE_COL_OBJQUOTA,
+	USERSPACE_NCOLS
+} userspace_col_t;
+
 typedef struct {
 	int unused;  // for consistency with other iterators
 } iter_conf_pool_t;
 
+/*
+ * Batched iteration support
+ *
+ * When batch.size is non-zero the zfs_iter_f callbacks do not create python
+ * objects for every handle. Instead the raw libzfs handles are accumulated
+ * in `hdls` while the GIL is released and the libzfs lock is held. Once
+ * `size` handles have been collected (or the ZFS iterator completes) the
+ * GIL is re-acquired once, python objects are created for the whole batch,
+ * and the python callback is called a single time with a list of objects.
+ *
+ * kind: type of handle stored in hdls. Determines how python objects
+ *     are created and how unconsumed handles are closed.
+ * size: maximum number of handles per batch (0 disables batching).
+ * count: number of handles currently held in hdls.
+ * hdls: array of `size` zfs_handle_t or zpool_handle_t pointers.
+ */
+typedef enum {
+	ITER_BATCH_DATASET,
+	ITER_BATCH_SNAPSHOT,
+	ITER_BATCH_POOL,
+} iter_batch_kind_t;
+
+typedef struct {
+	iter_batch_kind_t kind;
+	size_t size;
+	size_t count;
+	void **hdls;
+} iter_batch_t;
+
 union iter_config {
 	iter_conf_filesystem_t filesystem;
 	iter_conf_snapshot_t snapshot;
@@ -63,6 +143,14 @@ union iter_config {
  *
  * iter_config: iterator-specific configuration options
  *
+ * batch: batching configuration / buffer. Callers only need to set
+ *     batch.size; the remaining fields are managed by py_zfs_iter.c.
+ *
+ * filter: optional compiled filter (see py_zfs_filter.c). Datasets and
+ *     snapshots that do not match are closed without creating python
+ *     objects. May be NULL. Only applied by the filesystem and snapshot
+ *     iterators.
+ *
  * _save - saved thread state to allow toggling GIL as part of iteration.
  */
 typedef struct {
@@ -71,13 +159,45 @@ typedef struct {
 	PyObject *callback_fn;
 	PyObject *private_data;
 	union iter_config iter_config;
+	iter_batch_t batch;
+	py_zfs_filter_t *filter;
 	PyThreadState *_save;
 } py_iter_state_t;
 
+/*
+ * libzfs iterator to run in the ZFSResourceIterator producer thread.
+ * See py_zfs_resource_iter.c.
+ */
+typedef enum {
+	PY_ITER_FILESYSTEMS,
+	PY_ITER_SNAPSHOTS,
+	PY_ITER_ROOT_FILESYSTEMS,
+	PY_ITER_POOLS,
+} py_iter_type_t;
+
 extern int py_iter_filesystems(py_iter_state_t *state);
+extern int py_iter_filesystems_recursive(py_iter_state_t *state);
 extern int py_iter_snapshots(py_iter_state_t *state);
 extern int py_iter_userspace(py_iter_state_t *state);
+extern PyObject *py_iter_userspace_columns(py_iter_state_t *state,
+					   const zfs_userquota_prop_t *qtypes,
+					   size_t nqtypes);
+extern int userspace_qtype_column(zfs_userquota_prop_t qtype);
 extern int py_iter_root_filesystems(py_iter_state_t *state);
 extern int py_iter_pools(py_iter_state_t *state);
+extern PyObject *py_iter_names(py_iter_state_t *state, boolean_t snapshots,
+			       boolean_t recursive, boolean_t get_createtxg);
+extern PyObject *py_iter_space_summary(py_iter_state_t *state,
+				       boolean_t recursive, boolean_t snapshots);
+extern int py_iter_set_batch_size(py_iter_state_t *state, Py_ssize_t batch_size);
+extern int py_iter_set_filter(py_iter_state_t *state, PyObject *py_filter,
+			      boolean_t simple);
+extern PyObject *py_iter_hdl_to_py(py_iter_state_t *state, void *hdl);
+extern void py_iter_close_hdl(iter_batch_kind_t kind, void *hdl);
+
+/* Provided by py_zfs_resource_iter.c */
+extern PyObject *py_zfs_resource_iter_create(py_iter_state_t *state,
+					     PyObject *source,
+					     py_iter_type_t type);
 
 #endif  /* _PY_ZFS_ITER_H */
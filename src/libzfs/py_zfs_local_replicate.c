@@ -41,12 +41,16 @@ py_zfs_local_replicate(py_zfs_resource_t *res, PyObject *args_unused,
 	PyObject *py_progress_cb = NULL;
 	PyObject *py_progress_state = NULL;
 	int progress_interval = 1;
+	PyObject *py_name = NULL;
+	int err;
 
 	py_zfs_obj_t *obj = &res->obj;
 	const char *src_name;
 	char source_buf[ZFS_MAX_DATASET_NAME_LEN];
 	char fromsnap_buf[ZFS_MAX_DATASET_NAME_LEN];
 	struct local_replicate_args la;
+	PyObject *out = NULL;
+	uint64_t op_start;
 	int n = 0;
 
 	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
@@ -70,17 +74,20 @@ py_zfs_local_replicate(py_zfs_resource_t *res, PyObject *args_unused,
 		return NULL;
 	}
 
-	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSResource.local_replicate",
-			"OssziOOOOOO", obj->name,
-			tosnap, dest,
-			fromsnap ? fromsnap : "",
-			send_flags_int,
-			force_int ? Py_True : Py_False,
-			raw_int ? Py_True : Py_False,
-			py_props ? py_props : Py_None,
-			py_exclude ? py_exclude : Py_None,
-			nomount_int ? Py_True : Py_False,
-			include_intermediates_int ? Py_True : Py_False) < 0)
+	py_name = py_zfs_obj_name_ref(obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSResource.local_replicate",
+			  "OssziOOOOOO", py_name,
+			  tosnap, dest,
+			  fromsnap ? fromsnap : "",
+			  send_flags_int,
+			  force_int ? Py_True : Py_False,
+			  raw_int ? Py_True : Py_False,
+			  py_props ? py_props : Py_None,
+			  py_exclude ? py_exclude : Py_None,
+			  nomount_int ? Py_True : Py_False,
+			  include_intermediates_int ? Py_True : Py_False);
+	Py_DECREF(py_name);
+	if (err < 0)
 		return NULL;
 
 	/*
@@ -130,5 +137,9 @@ py_zfs_local_replicate(py_zfs_resource_t *res, PyObject *args_unused,
 		.progress_interval_seconds = progress_interval,
 	};
 
-	return py_local_replicate(&la);
+	op_start = py_zfs_stats_now();
+	out = py_local_replicate(&la);
+	py_zfs_stats_op(obj->pylibzfsp, PY_ZFS_OP_SEND, op_start);
+
+	return out;
 }
@@ -138,6 +138,7 @@ PyObject *py_zfs_mount(py_zfs_resource_t *res,
 {
 	char mountpoint[ZFS_MAXPROPLEN];
 	char *mntopts = NULL;
+	uint64_t op_start;
 	int err;
 	py_zfs_error_t zfs_err;
 
@@ -193,10 +194,12 @@ PyObject *py_zfs_mount(py_zfs_resource_t *res,
 	/* Now do the actual mounting */
 	Py_BEGIN_ALLOW_THREADS
 	PY_ZFS_LOCK(res->obj.pylibzfsp);
+	op_start = py_zfs_stats_now();
 	err = zfs_mount_at(res->obj.zhp,
 			   mntopts,
 			   flags,
 			   mountpoint);
+	py_zfs_stats_op(res->obj.pylibzfsp, PY_ZFS_OP_MOUNT, op_start);
 	if (err)
 		py_get_zfs_error(res->obj.pylibzfsp->lzh, &zfs_err);
 	PY_ZFS_UNLOCK(res->obj.pylibzfsp);
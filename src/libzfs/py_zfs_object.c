@@ -25,6 +25,22 @@ void free_py_zfs_obj(py_zfs_obj_t *self)
 	Py_CLEAR(self->encrypted);
 }
 
+/*
+ * The name is replaced by rename() and so a borrowed reference may be freed
+ * by another thread. Callers that need the name should use this instead of
+ * reading obj->name directly.
+ */
+PyObject *py_zfs_obj_name_ref(py_zfs_obj_t *obj)
+{
+	PyObject *out;
+
+	Py_BEGIN_CRITICAL_SECTION(obj);
+	out = Py_NewRef(obj->name ? obj->name : Py_None);
+	Py_END_CRITICAL_SECTION();
+
+	return out;
+}
+
 static
 void py_zfs_obj_dealloc(py_zfs_obj_t *self) {
 	free_py_zfs_obj(self);
@@ -96,6 +112,7 @@ PyObject *py_zfs_obj_rename(PyObject *self,
 	char orig_name[ZFS_MAX_DATASET_NAME_LEN];
 	py_zfs_error_t zfs_err;
 	renameflags_t flags;
+	PyObject *py_name = NULL;
 
 	char *kwnames [] = {
 		"new_name",
@@ -151,8 +168,11 @@ PyObject *py_zfs_obj_rename(PyObject *self,
 		.forceunmount = forceunmount
 	};
 
-	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSObject.rename", "OO",
-			obj->name, kwargs) < 0) {
+	py_name = py_zfs_obj_name_ref(obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSObject.rename", "OO",
+			  py_name, kwargs);
+	Py_DECREF(py_name);
+	if (err < 0) {
 		return NULL;
 	}
 
@@ -183,8 +203,9 @@ PyObject *py_zfs_obj_rename(PyObject *self,
 	}
 
 	// swap out our name with new one even if we failed to write history
-	Py_CLEAR(obj->name);
-	obj->name = PyUnicode_FromString(new_name);
+	Py_BEGIN_CRITICAL_SECTION(obj);
+	Py_XSETREF(obj->name, PyUnicode_FromString(new_name));
+	Py_END_CRITICAL_SECTION();
 
 	if (err) {
 		// writing the zpool history failed which means
@@ -210,7 +231,7 @@ PyDoc_STRVAR(py_zfs_obj_name__doc__,
 );
 static
 PyObject *py_zfs_obj_get_name(py_zfs_obj_t *self, void *extra) {
-	return py_get_prop(self->name);
+	return py_zfs_obj_name_ref(self);
 }
 
 PyDoc_STRVAR(py_zfs_obj_type__doc__,
@@ -40,7 +40,8 @@
 
 PyStructSequence_Field struct_zfs_prop [] = {
 	{"value", "Parsed value of the ZFS property"},
-	{"raw", "Raw value of the ZFS property (string)"},
+	{"raw", "Raw value of the ZFS property (string), or None if numeric "
+		"value was read with raw=False"},
 	{"source", "Source dataset of the property"},
 	{0},
 };
@@ -198,6 +199,18 @@ void init_py_struct_prop_state(pylibzfs_state_t *state)
 	PYZFS_ASSERT(obj, "Failed to allocate struct_zfs_props_type");
 	state->struct_zfs_props_type = obj;
 
+	state->zfs_prop_field_idx = PyDict_New();
+	PYZFS_ASSERT(state->zfs_prop_field_idx, "Failed to allocate dict");
+
+	for (i = 0; i < ARRAY_SIZE(zfs_prop_table); i++) {
+		PyObject *pyidx = PyLong_FromSize_t(i);
+		PYZFS_ASSERT(pyidx, "Failed to allocate index");
+		PYZFS_ASSERT((PyDict_SetItemString(state->zfs_prop_field_idx,
+		    state->struct_prop_fields[i].name, pyidx) == 0),
+		    "Failed to add property field index");
+		Py_DECREF(pyidx);
+	}
+
 	obj = PyStructSequence_NewType(&struct_zfs_prop_type_desc);
 	PYZFS_ASSERT(obj, "Failed to allocate struct_zfs_prop_type");
 
@@ -322,22 +335,26 @@ PyObject *py_parse_zfs_prop(zfs_prop_t prop, char *propbuf, PyObject *raw)
 	return out;
 }
 
+/*
+ * Read a single property value (and source) from libzfs into the provided
+ * buffers. Values that libzfs fails to provide for expected reasons are
+ * remapped to the special strings handled by py_parse_zfs_prop().
+ *
+ * Returns 0 on success, or -1 on unexpected error with errno set (possibly
+ * to zero). The caller must hold the libzfs handle lock. Does not require
+ * the GIL.
+ */
 static
-PyObject* py_zfs_get_prop(pylibzfs_state_t *state,
-			  py_zfs_obj_t *pyzfs,
-			  zfs_prop_t prop,
-			  boolean_t get_source)
+int py_zfs_prop_read(zfs_handle_t *zhp,
+		     zfs_prop_t prop,
+		     char *propbuf,
+		     size_t proplen,
+		     zprop_source_t *sourcetype,
+		     char *sourcebuf,
+		     size_t sourcelen)
 {
-	PyObject *out = NULL;
-	PyObject *raw = NULL;
-	PyObject *parsed = NULL;
-	PyObject *source = NULL;
-	zprop_source_t sourcetype;
-	char propbuf[ZFS_MAXPROPLEN];
-	char sourcebuf[ZFS_MAX_DATASET_NAME_LEN] = {0};
 	int err;
 
-	Py_BEGIN_ALLOW_THREADS
 	/*
 	 * The below libzfs API calls do not properly set
 	 * errno in some cases. We want to catch case where
@@ -345,35 +362,14 @@ PyObject* py_zfs_get_prop(pylibzfs_state_t *state,
 	 * dds_inconsistent
 	 */
 	errno = 0;
-	/*
-	 * In some edge cases this libzfs function call
-	 * will write a generally useless message into libzfs
-	 * error buffer. This means we need to take lock
-	 * in order to prevent corruption, but we don't need
-	 * to actually look at it.
-	 */
-	PY_ZFS_LOCK(pyzfs->pylibzfsp);
-	if (get_source) {
-		err = zfs_prop_get(pyzfs->zhp,
-				   prop,
-				   propbuf,
-				   sizeof(propbuf),
-				   &sourcetype,
-				   sourcebuf,
-				   sizeof(sourcebuf),
-				   B_TRUE);
-	} else {
-		err = zfs_prop_get(pyzfs->zhp,
-				   prop,
-				   propbuf,
-				   sizeof(propbuf),
-				   &sourcetype,
-				   sourcebuf,
-				   sizeof(sourcebuf),
-				   B_TRUE);
-	}
-	PY_ZFS_UNLOCK(pyzfs->pylibzfsp);
-	Py_END_ALLOW_THREADS
+	err = zfs_prop_get(zhp,
+			   prop,
+			   propbuf,
+			   proplen,
+			   sourcetype,
+			   sourcebuf,
+			   sourcelen,
+			   B_TRUE);
 
 	if ((err == -1) && (
 	    (prop == ZFS_PROP_SNAPSHOTS_CHANGED) ||
@@ -397,7 +393,7 @@ PyObject* py_zfs_get_prop(pylibzfs_state_t *state,
 		 */
 
 		/* set value to "none" to ensure it's parsed to None type */
-		strlcpy(propbuf, LIBZFS_NONE_VALUE, sizeof(propbuf));
+		strlcpy(propbuf, LIBZFS_NONE_VALUE, proplen);
 
 		/*
 		 * Make sure that our source buf is empty string.
@@ -405,7 +401,7 @@ PyObject* py_zfs_get_prop(pylibzfs_state_t *state,
 		 * to be extra sure.
 		 */
 		*sourcebuf = '\0';
-		sourcetype = ZPROP_SRC_NONE;
+		*sourcetype = ZPROP_SRC_NONE;
 	} else if (err && (errno == ENOENT)) {
 		/*
 		 * We may have in-progress replication and the property is
@@ -428,7 +424,7 @@ PyObject* py_zfs_get_prop(pylibzfs_state_t *state,
 		 * There is an open ticket (NAS-137848) to at least not
 		 * fail for immutable properties (e.g. ZFS_PROP_CASE)
 		 */
-		strlcpy(propbuf, LIBZFS_INCONSISTENT_VALUE, sizeof(propbuf));
+		strlcpy(propbuf, LIBZFS_INCONSISTENT_VALUE, proplen);
 
 		/*
 		 * Make sure that our source buf is empty string.
@@ -436,45 +432,65 @@ PyObject* py_zfs_get_prop(pylibzfs_state_t *state,
 		 * to be extra sure.
 		 */
 		*sourcebuf = '\0';
-		sourcetype = ZPROP_SRC_NONE;
+		*sourcetype = ZPROP_SRC_NONE;
 	} else if (err && (errno == EIO)) {
 		/*
 		 * There may be pool corruption present that is triggering
 		 * I/O errors on ZFS ioctls (NAS-138625)
 		 */
 
-		strlcpy(propbuf, LIBZFS_IOERROR_VALUE, sizeof(propbuf));
+		strlcpy(propbuf, LIBZFS_IOERROR_VALUE, proplen);
 		*sourcebuf = '\0';
-		sourcetype = ZPROP_SRC_NONE;
+		*sourcetype = ZPROP_SRC_NONE;
 	} else if (err) {
-		if (!py_zfs_prop_valid_for_type(prop, pyzfs->ctype))
-			return NULL;
-
-		/*
-		 * We cannot raise a ZFSException here since zfs_prop_get
-		 * does not reliably set the libzfs error information.
-		 *
-		 * Instead we raise a RuntimeError based on what errno info
-		 * we have.
-		 */
-		PyErr_Format(
-			PyExc_RuntimeError,
-			"%s: failed to get property on resource (%U): %s.",
-			zfs_prop_to_name(prop), pyzfs->name,
-			errno ? strerror(errno) : "<UNKNOWN>"
-		);
-		return NULL;
+		return -1;
 	}
 
-	raw = PyUnicode_FromString(propbuf);
-	if (raw == NULL)
-		return NULL;
+	return 0;
+}
 
-	parsed = py_parse_zfs_prop(prop, propbuf, raw);
-	if (parsed == NULL) {
-		Py_DECREF(raw);
-		return NULL;
-	}
+/*
+ * Set python exception for failure of py_zfs_prop_read(). GIL must be held.
+ */
+static
+void py_zfs_prop_read_exc(zfs_prop_t prop,
+			  zfs_type_t ctype,
+			  const char *name,
+			  int err_errno)
+{
+	if (!py_zfs_prop_valid_for_type(prop, ctype))
+		return;
+
+	/*
+	 * We cannot raise a ZFSException here since zfs_prop_get
+	 * does not reliably set the libzfs error information.
+	 *
+	 * Instead we raise a RuntimeError based on what errno info
+	 * we have.
+	 */
+	PyErr_Format(
+		PyExc_RuntimeError,
+		"%s: failed to get property on resource (%s): %s.",
+		zfs_prop_to_name(prop), name,
+		err_errno ? strerror(err_errno) : "<UNKNOWN>"
+	);
+}
+
+/*
+ * Build struct_zfs_property_data from parsed value and raw string. References
+ * to parsed and raw are stolen (also on failure). GIL must be held.
+ */
+static
+PyObject *py_zfs_prop_struct(pylibzfs_state_t *state,
+			     py_zfs_obj_t *pyzfs,
+			     PyObject *parsed,
+			     PyObject *raw,
+			     zprop_source_t sourcetype,
+			     const char *sourcebuf,
+			     boolean_t get_source)
+{
+	PyObject *out = NULL;
+	PyObject *source = NULL;
 
 	if (get_source) {
 		source = py_zfs_parse_source(state, pyzfs, sourcetype, sourcebuf);
@@ -508,14 +524,593 @@ PyObject* py_zfs_get_prop(pylibzfs_state_t *state,
 	return out;
 }
 
-PyObject *py_zfs_get_properties(py_zfs_obj_t *pyzfs,
-			        PyObject *prop_set,
-			        boolean_t get_source)
+/*
+ * Build struct_zfs_property_data from the buffers filled in by
+ * py_zfs_prop_read(). GIL must be held.
+ */
+static
+PyObject *py_zfs_prop_from_buf(pylibzfs_state_t *state,
+			       py_zfs_obj_t *pyzfs,
+			       zfs_prop_t prop,
+			       char *propbuf,
+			       zprop_source_t sourcetype,
+			       const char *sourcebuf,
+			       boolean_t get_source)
 {
-	pylibzfs_state_t *state = py_get_module_state(pyzfs->pylibzfsp);
+	PyObject *raw = NULL;
+	PyObject *parsed = NULL;
+
+	raw = PyUnicode_FromString(propbuf);
+	if (raw == NULL)
+		return NULL;
+
+	parsed = py_parse_zfs_prop(prop, propbuf, raw);
+	if (parsed == NULL) {
+		Py_DECREF(raw);
+		return NULL;
+	}
+
+	return py_zfs_prop_struct(state, pyzfs, parsed, raw, sourcetype,
+				  sourcebuf, get_source);
+}
+
+/*
+ * Numeric properties that may be read with zfs_prop_get_numeric() when the
+ * caller does not want the raw string. Ratios are excluded since the string
+ * form is a float, as is snapshots_changed, which is not initialized on
+ * older datasets and is reported as None by the string path.
+ */
+static
+boolean_t py_zfs_prop_numeric_ok(zfs_prop_t prop)
+{
+	if (zfs_prop_get_type(prop) != PROP_TYPE_NUMBER)
+		return B_FALSE;
+
+	switch (prop) {
+	case ZFS_PROP_COMPRESSRATIO:
+	case ZFS_PROP_REFRATIO:
+	case ZFS_PROP_SNAPSHOTS_CHANGED:
+		return B_FALSE;
+	default:
+		break;
+	}
+
+	return B_TRUE;
+}
+
+/*
+ * Whether numeric value is displayed as "none" by zfs_prop_get() with
+ * literal set, in which case py_parse_zfs_prop() would return None. A zero
+ * quota or reservation is only "none" in the non-literal form and is
+ * reported as 0 by the string path.
+ */
+static
+boolean_t py_zfs_prop_numeric_is_none(zfs_prop_t prop, uint64_t val)
+{
+	switch (prop) {
+	case ZFS_PROP_FILESYSTEM_LIMIT:
+	case ZFS_PROP_SNAPSHOT_LIMIT:
+	case ZFS_PROP_FILESYSTEM_COUNT:
+	case ZFS_PROP_SNAPSHOT_COUNT:
+		return (val == UINT64_MAX);
+	default:
+		break;
+	}
+
+	return B_FALSE;
+}
+
+/*
+ * Build struct_zfs_property_data from a value read with
+ * zfs_prop_get_numeric(). The raw member is None. GIL must be held.
+ */
+static
+PyObject *py_zfs_prop_from_num(pylibzfs_state_t *state,
+			       py_zfs_obj_t *pyzfs,
+			       zfs_prop_t prop,
+			       uint64_t val,
+			       zprop_source_t sourcetype,
+			       const char *sourcebuf,
+			       boolean_t get_source)
+{
+	PyObject *parsed = NULL;
+
+	if (py_zfs_prop_numeric_is_none(prop, val)) {
+		parsed = Py_NewRef(Py_None);
+	} else {
+		parsed = PyLong_FromUnsignedLongLong(val);
+		if (parsed == NULL)
+			return NULL;
+	}
+
+	return py_zfs_prop_struct(state, pyzfs, parsed, Py_NewRef(Py_None),
+				  sourcetype, sourcebuf, get_source);
+}
+
+/*
+ * As py_zfs_prop_from_buf() but with a raw member of None. Used for numeric
+ * properties that were read as strings (for instance served from the
+ * property cache) when the caller did not request raw values. GIL must be
+ * held.
+ */
+static
+PyObject *py_zfs_prop_from_buf_noraw(pylibzfs_state_t *state,
+				     py_zfs_obj_t *pyzfs,
+				     zfs_prop_t prop,
+				     char *propbuf,
+				     zprop_source_t sourcetype,
+				     const char *sourcebuf,
+				     boolean_t get_source)
+{
+	PyObject *raw = NULL;
+	PyObject *parsed = NULL;
+
+	raw = PyUnicode_FromString(propbuf);
+	if (raw == NULL)
+		return NULL;
+
+	parsed = py_parse_zfs_prop(prop, propbuf, raw);
+	Py_DECREF(raw);
+	if (parsed == NULL)
+		return NULL;
+
+	return py_zfs_prop_struct(state, pyzfs, parsed, Py_NewRef(Py_None),
+				  sourcetype, sourcebuf, get_source);
+}
+
+static
+PyObject* py_zfs_get_prop(pylibzfs_state_t *state,
+			  py_zfs_obj_t *pyzfs,
+			  zfs_prop_t prop,
+			  boolean_t get_source)
+{
+	zprop_source_t sourcetype;
+	char propbuf[ZFS_MAXPROPLEN];
+	char sourcebuf[ZFS_MAX_DATASET_NAME_LEN] = {0};
+	uint64_t op_start;
+	int err, err_errno;
+
+	Py_BEGIN_ALLOW_THREADS
+	/*
+	 * In some edge cases this libzfs function call
+	 * will write a generally useless message into libzfs
+	 * error buffer. This means we need to take lock
+	 * in order to prevent corruption, but we don't need
+	 * to actually look at it.
+	 */
+	PY_ZFS_LOCK(pyzfs->pylibzfsp);
+	op_start = py_zfs_stats_now();
+	err = py_zfs_prop_read(pyzfs->zhp,
+			       prop,
+			       propbuf,
+			       sizeof(propbuf),
+			       &sourcetype,
+			       sourcebuf,
+			       sizeof(sourcebuf));
+	err_errno = errno;
+	py_zfs_stats_op(pyzfs->pylibzfsp, PY_ZFS_OP_PROP_GET, op_start);
+	PY_ZFS_UNLOCK(pyzfs->pylibzfsp);
+	Py_END_ALLOW_THREADS
+
+	if (err) {
+		py_zfs_prop_read_exc(prop, pyzfs->ctype,
+				     zfs_get_name(pyzfs->zhp), err_errno);
+		return NULL;
+	}
+
+	return py_zfs_prop_from_buf(state, pyzfs, prop, propbuf, sourcetype,
+				    sourcebuf, get_source);
+}
+
+/*
+ * Build the dictionary form of a property ({"value": ..., "raw": ...,
+ * "source": {"type": ..., "value": ...} | None}) from entry i of an arena
+ * filled by prop_arena_fill() with get_raw, without allocating the
+ * intermediate struct sequence objects. This is the same output as
+ * py_zfs_prop_to_dict(py_zfs_get_prop(...)).
+ *
+ * GIL must be held. libzfs handle lock not required.
+ */
+PyObject *py_zfs_prop_arena_dict(py_zfs_t *plz,
+				 pylibzfs_state_t *state,
+				 prop_arena_t *arena,
+				 size_t i,
+				 boolean_t get_source)
+{
+	prop_arena_entry_t *entry = &arena->entries[i];
+	zfs_prop_t prop = state->zfs_prop_enum_tbl[entry->idx].type;
+	char *propbuf = arena->buf + entry->value_off;
+	const char *sourcebuf = arena->buf + entry->source_off;
+	zprop_source_t sourcetype = entry->sourcetype;
 	PyObject *out = NULL;
+	PyObject *raw = NULL;
+	PyObject *parsed = NULL;
+	PyObject *source = NULL;
+
+	raw = PyUnicode_FromString(propbuf);
+	if (raw == NULL)
+		return NULL;
+
+	parsed = py_parse_zfs_prop(prop, propbuf, raw);
+	if (parsed == NULL)
+		goto out;
+
+	if (get_source) {
+		PyObject *srctype = py_get_property_source(plz, sourcetype);
+
+		source = Py_BuildValue("{s:N,s:s}",
+				       "type", srctype,
+				       "value", (sourcetype == ZPROP_SRC_INHERITED) ?
+				       sourcebuf : NULL);
+		if (source == NULL)
+			goto out;
+	}
+
+	out = Py_BuildValue("{s:O,s:O,s:O}",
+			    "value", parsed,
+			    "raw", raw,
+			    "source", source ? source : Py_None);
+out:
+	Py_XDECREF(raw);
+	Py_XDECREF(parsed);
+	Py_XDECREF(source);
+	return out;
+}
+
+/*
+ * Append the JSON form of a property to jb. The output is the same as
+ * json.dumps() of py_zfs_prop_to_dict() for a property read by
+ * py_zfs_get_properties() with the same get_source / get_raw, except that
+ * the source type is written as its integer value (as json.dumps() does
+ * for the ZFSPropertySource IntEnum).
+ *
+ * PY_ZFS_LOCK must be held. GIL not required.
+ *
+ * Returns 0 on success, PROP_JSON_READ_ERROR if the property could not be
+ * read (*err_errno is set), or PROP_JSON_PARSE_ERROR if a numeric value
+ * could not be parsed. Use py_zfs_prop_json_exc() to set the exception.
+ */
+int py_zfs_prop_json_locked(py_json_buf_t *jb,
+			    zfs_handle_t *zhp,
+			    zfs_prop_t prop,
+			    boolean_t get_source,
+			    boolean_t get_raw,
+			    int *err_errno)
+{
+	zprop_source_t sourcetype;
+	char propbuf[ZFS_MAXPROPLEN];
+	char sourcebuf[ZFS_MAX_DATASET_NAME_LEN] = {0};
+	boolean_t numeric_ok = !get_raw && py_zfs_prop_numeric_ok(prop);
+	uint64_t val;
+
+	json_buf_lit(jb, "{\"value\":");
+
+	if (numeric_ok && (zfs_prop_get_numeric(zhp, prop, &val, &sourcetype,
+	    sourcebuf, sizeof(sourcebuf)) == 0)) {
+		if (py_zfs_prop_numeric_is_none(prop, val))
+			json_buf_lit(jb, "null");
+		else
+			json_buf_u64(jb, val);
+	} else {
+		sourcebuf[0] = '\0';
+		if (py_zfs_prop_read(zhp, prop, propbuf, sizeof(propbuf),
+		    &sourcetype, sourcebuf, sizeof(sourcebuf))) {
+			*err_errno = errno;
+			return PROP_JSON_READ_ERROR;
+		}
+
+		// Same rules as py_parse_zfs_prop()
+		if ((strcmp(propbuf, LIBZFS_NONE_VALUE) == 0) ||
+		    (strcmp(propbuf, LIBZFS_INCONSISTENT_VALUE) == 0) ||
+		    (strcmp(propbuf, LIBZFS_IOERROR_VALUE) == 0)) {
+			json_buf_lit(jb, "null");
+		} else if (prop == ZFS_PROP_MOUNTED) {
+			if (strcmp(propbuf, "yes") == 0)
+				json_buf_lit(jb, "true");
+			else
+				json_buf_lit(jb, "false");
+		} else if (zfs_prop_is_string(prop)) {
+			json_buf_str(jb, propbuf);
+		} else {
+			char *pend = NULL;
+
+			if (strstr(propbuf, "."))
+				(void) strtod(propbuf, &pend);
+			else
+				(void) strtoull(propbuf, &pend, 10);
+
+			if ((pend == propbuf) || (*pend != '\0')) {
+				*err_errno = EINVAL;
+				return PROP_JSON_PARSE_ERROR;
+			}
+
+			json_buf_append(jb, propbuf, pend - propbuf);
+		}
+
+		if (!numeric_ok) {
+			json_buf_lit(jb, ",\"raw\":");
+			json_buf_str(jb, propbuf);
+			goto source;
+		}
+	}
+
+	json_buf_lit(jb, ",\"raw\":null");
+
+source:
+	json_buf_lit(jb, ",\"source\":");
+	if (get_source) {
+		json_buf_lit(jb, "{\"type\":");
+		json_buf_u64(jb, sourcetype);
+		json_buf_lit(jb, ",\"value\":");
+		if (sourcetype == ZPROP_SRC_INHERITED)
+			json_buf_str(jb, sourcebuf);
+		else
+			json_buf_lit(jb, "null");
+		json_buf_lit(jb, "}");
+	} else {
+		json_buf_lit(jb, "null");
+	}
+	json_buf_lit(jb, "}");
+
+	return 0;
+}
+
+/*
+ * Set python exception for failure of py_zfs_prop_json_locked(). GIL must
+ * be held.
+ */
+void py_zfs_prop_json_exc(zfs_prop_t prop,
+			  zfs_type_t ctype,
+			  const char *name,
+			  int err,
+			  int err_errno)
+{
+	if (err == PROP_JSON_PARSE_ERROR) {
+		PyErr_Format(PyExc_ValueError,
+			     "%s: failed to parse value as a numeric value.",
+			     zfs_prop_to_name(prop));
+		return;
+	}
+
+	py_zfs_prop_read_exc(prop, ctype, name, err_errno);
+}
+
+/* GIL not required */
+static
+boolean_t prop_arena_add_str(prop_arena_t *arena, const char *str,
+			     size_t *offset)
+{
+	size_t len = strlen(str) + 1;
+
+	if (arena->used + len > arena->size) {
+		size_t new_size = arena->size ? arena->size : 1024;
+		char *new_buf;
+
+		while (arena->used + len > new_size)
+			new_size *= 2;
+
+		new_buf = PyMem_RawRealloc(arena->buf, new_size);
+		if (new_buf == NULL)
+			return B_FALSE;
+
+		arena->buf = new_buf;
+		arena->size = new_size;
+	}
+
+	memcpy(arena->buf + arena->used, str, len);
+	*offset = arena->used;
+	arena->used += len;
+	return B_TRUE;
+}
+
+/*
+ * Read every property in arena->entries. The caller must hold the libzfs
+ * handle lock. GIL not required.
+ *
+ * If get_raw is B_FALSE then numeric properties are read directly with
+ * zfs_prop_get_numeric() rather than being formatted as a string. Should
+ * that fail the regular string path is used so that errors are handled
+ * in the same way.
+ *
+ * Returns 0 on success. On failure returns -1 with *failed set to the
+ * entry that could not be read (or to arena->nentries on allocation
+ * failure) and *err_errno set to the errno from py_zfs_prop_read().
+ */
+int prop_arena_fill(prop_arena_t *arena,
+		    pylibzfs_state_t *state,
+		    zfs_handle_t *zhp,
+		    boolean_t get_raw,
+		    size_t *failed,
+		    int *err_errno)
+{
+	char propbuf[ZFS_MAXPROPLEN];
+	char sourcebuf[ZFS_MAX_DATASET_NAME_LEN];
+	size_t i;
+
+	for (i = 0; i < arena->nentries; i++) {
+		prop_arena_entry_t *entry = &arena->entries[i];
+		zfs_prop_t prop = state->zfs_prop_enum_tbl[entry->idx].type;
+
+		sourcebuf[0] = '\0';
+		entry->numeric = B_FALSE;
+		if (!get_raw && py_zfs_prop_numeric_ok(prop) &&
+		    (zfs_prop_get_numeric(zhp, prop, &entry->ival,
+					  &entry->sourcetype, sourcebuf,
+					  sizeof(sourcebuf)) == 0)) {
+			entry->numeric = B_TRUE;
+			if (!prop_arena_add_str(arena, sourcebuf,
+			    &entry->source_off)) {
+				*err_errno = ENOMEM;
+				*failed = arena->nentries;
+				return -1;
+			}
+			continue;
+		}
+
+		sourcebuf[0] = '\0';
+		if (py_zfs_prop_read(zhp,
+				     prop,
+				     propbuf,
+				     sizeof(propbuf),
+				     &entry->sourcetype,
+				     sourcebuf,
+				     sizeof(sourcebuf))) {
+			*err_errno = errno;
+			*failed = i;
+			return -1;
+		}
+
+		if (!prop_arena_add_str(arena, propbuf, &entry->value_off) ||
+		    !prop_arena_add_str(arena, sourcebuf, &entry->source_off)) {
+			*err_errno = ENOMEM;
+			*failed = arena->nentries;
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Set python exception for failure of prop_arena_fill(). GIL must be held.
+ */
+void prop_arena_exc(prop_arena_t *arena,
+		    pylibzfs_state_t *state,
+		    size_t failed,
+		    zfs_type_t ctype,
+		    const char *name,
+		    int err_errno)
+{
 	size_t idx;
-	int rv;
+
+	if (failed == arena->nentries) {
+		PyErr_NoMemory();
+		return;
+	}
+
+	idx = arena->entries[failed].idx;
+	py_zfs_prop_read_exc(state->zfs_prop_enum_tbl[idx].type, ctype, name,
+			     err_errno);
+}
+
+#define	PROP_CACHE_VALUE	"value"
+#define	PROP_CACHE_SOURCE	"source"
+#define	PROP_CACHE_SRCTYPE	"srctype"
+
+/*
+ * Fill the arena from the handle's property cache. Returns B_TRUE only if
+ * every entry was found in a live cache entry. Updates the cache hit / miss
+ * counters. PY_ZFS_LOCK must be held. GIL not required.
+ */
+static
+boolean_t prop_arena_from_cache(prop_arena_t *arena,
+				pylibzfs_state_t *state,
+				py_zfs_t *plz,
+				uint64_t guid)
+{
+	nvlist_t *props = NULL;
+	size_t i;
+
+	props = py_zfs_prop_cache_lookup(plz, guid);
+	if (props == NULL)
+		goto miss;
+
+	for (i = 0; i < arena->nentries; i++) {
+		prop_arena_entry_t *entry = &arena->entries[i];
+		zfs_prop_t prop = state->zfs_prop_enum_tbl[entry->idx].type;
+		nvlist_t *cached = NULL;
+
+		if (nvlist_lookup_nvlist(props, zfs_prop_to_name(prop),
+		    &cached) != 0)
+			goto miss;
+
+		entry->numeric = B_FALSE;
+		entry->sourcetype = fnvlist_lookup_uint64(cached,
+		    PROP_CACHE_SRCTYPE);
+		if (!prop_arena_add_str(arena,
+		    fnvlist_lookup_string(cached, PROP_CACHE_VALUE),
+		    &entry->value_off) ||
+		    !prop_arena_add_str(arena,
+		    fnvlist_lookup_string(cached, PROP_CACHE_SOURCE),
+		    &entry->source_off))
+			goto miss;
+	}
+
+	plz->prop_cache.hits++;
+	return B_TRUE;
+
+miss:
+	arena->used = 0;
+	plz->prop_cache.misses++;
+	return B_FALSE;
+}
+
+/*
+ * Store the string values in the arena in the handle's property cache.
+ * PY_ZFS_LOCK must be held. GIL not required.
+ */
+static
+void prop_arena_to_cache(prop_arena_t *arena,
+			 pylibzfs_state_t *state,
+			 py_zfs_t *plz,
+			 uint64_t guid,
+			 const char *name)
+{
+	nvlist_t *props = fnvlist_alloc();
+	size_t i;
+
+	for (i = 0; i < arena->nentries; i++) {
+		prop_arena_entry_t *entry = &arena->entries[i];
+		zfs_prop_t prop = state->zfs_prop_enum_tbl[entry->idx].type;
+		nvlist_t *cached = NULL;
+
+		if (entry->numeric)
+			continue;
+
+		cached = fnvlist_alloc();
+		fnvlist_add_string(cached, PROP_CACHE_VALUE,
+		    arena->buf + entry->value_off);
+		fnvlist_add_string(cached, PROP_CACHE_SOURCE,
+		    arena->buf + entry->source_off);
+		fnvlist_add_uint64(cached, PROP_CACHE_SRCTYPE, entry->sourcetype);
+		fnvlist_add_nvlist(props, zfs_prop_to_name(prop), cached);
+		fnvlist_free(cached);
+	}
+
+	py_zfs_prop_cache_insert(plz, guid, name, props);
+	fnvlist_free(props);
+}
+
+PyObject *py_zfs_get_properties(py_zfs_resource_t *res,
+			        PyObject *prop_set,
+			        boolean_t get_source,
+			        boolean_t get_raw)
+{
+	py_zfs_obj_t *pyzfs = &res->obj;
+	py_zfs_t *plz = pyzfs->pylibzfsp;
+	pylibzfs_state_t *state = py_get_module_state(plz);
+	prop_arena_entry_t entries[ARRAY_SIZE(zfs_prop_table)];
+	prop_arena_t arena = (prop_arena_t) {
+		.entries = entries,
+		.nentries = 0,
+	};
+	py_zfs_prop_selector_t *sel = NULL;
+	PyObject *out = NULL;
+	boolean_t use_cache = PY_ZFS_PROP_CACHE_ENABLED(plz);
+	boolean_t cached = B_FALSE;
+	uint64_t guid = 0;
+	uint64_t op_start;
+	size_t idx, i, failed;
+	int rv, err = 0, err_errno;
+
+	if (PyObject_TypeCheck(prop_set, &ZFSPropertySelector))
+		sel = (py_zfs_prop_selector_t *)prop_set;
+
+	if (use_cache) {
+		guid = PyLong_AsUnsignedLongLong(pyzfs->guid);
+		if (PyErr_Occurred())
+			return NULL;
+	}
 
 	out = PyStructSequence_New(state->struct_zfs_props_type);
 	if (out == NULL)
@@ -526,13 +1121,16 @@ PyObject *py_zfs_get_properties(py_zfs_obj_t *pyzfs,
 	 * whether the properties set contains the property. This means
 	 * that set contents that are the wrong type are ignored, and was
 	 * a deliberate choice to simplify logic and speed up the function.
+	 * If a ZFSPropertySelector was provided then its precomputed bitmap
+	 * is used instead of a set lookup.
 	 *
 	 * The key thing we want to avoid here is having any of the struct
 	 * members set to NULL (since that will eventually cause a crash).
+	 * Unrequested members are set to None here, requested members are
+	 * filled in below once all values have been read.
 	 */
 	for (idx = 0; idx < ARRAY_SIZE(zfs_prop_table); idx++) {
 		PyObject *enum_obj = state->zfs_prop_enum_tbl[idx].obj;
-		PyObject *pyprop;
 
 		/*
 		 * Requested properties will have type struct_zfs_property_data
@@ -551,7 +1149,11 @@ PyObject *py_zfs_get_properties(py_zfs_obj_t *pyzfs,
 			continue;
 		}
 
-		rv = PySet_Contains(prop_set, enum_obj);
+		if (sel != NULL)
+			rv = PY_ZFS_PROP_SELECTED(sel, idx);
+		else
+			rv = PySet_Contains(prop_set, enum_obj);
+
 		if (rv == -1) {
 			goto fail;
 		} else if (rv == 0) {
@@ -561,19 +1163,99 @@ PyObject *py_zfs_get_properties(py_zfs_obj_t *pyzfs,
 		}
 
 		// At this point the set contains the property
-		pyprop = py_zfs_get_prop(state,
-					 pyzfs,
-					 state->zfs_prop_enum_tbl[idx].type,
-					 get_source);
-		if (pyprop == NULL) {
-			goto fail;
+		entries[arena.nentries++].idx = idx;
+	}
+
+	if (arena.nentries == 0)
+		return out;
+
+	/*
+	 * Read all requested properties with a single lock / GIL cycle
+	 * rather than one per property. See comment in py_zfs_get_prop()
+	 * regarding why the lock is required.
+	 *
+	 * If the property cache is enabled and can provide every requested
+	 * property then neither the handle refresh nor zfs_prop_get() is
+	 * needed. Otherwise values are read as strings so that they can be
+	 * cached regardless of get_raw.
+	 */
+	Py_BEGIN_ALLOW_THREADS
+	PY_ZFS_LOCK(plz);
+	op_start = py_zfs_stats_now();
+	if (use_cache)
+		cached = prop_arena_from_cache(&arena, state, plz, guid);
+
+	if (!cached) {
+		if (res->is_simple) {
+			zfs_refresh_properties(pyzfs->zhp);
+			res->is_simple = B_FALSE;
 		}
 
-		PyStructSequence_SET_ITEM(out, idx, pyprop);
+		err = prop_arena_fill(&arena, state, pyzfs->zhp,
+				      get_raw || use_cache, &failed,
+				      &err_errno);
+		if ((err == 0) && use_cache) {
+			prop_arena_to_cache(&arena, state, plz, guid,
+					    zfs_get_name(pyzfs->zhp));
+		}
 	}
+	py_zfs_stats_op(plz, PY_ZFS_OP_PROP_GET, op_start);
+	PY_ZFS_UNLOCK(plz);
+	Py_END_ALLOW_THREADS
 
+	if (err) {
+		prop_arena_exc(&arena, state, failed, pyzfs->ctype,
+			       zfs_get_name(pyzfs->zhp), err_errno);
+		goto fail;
+	}
+
+	for (i = 0; i < arena.nentries; i++) {
+		prop_arena_entry_t *entry = &entries[i];
+		zfs_prop_t prop = state->zfs_prop_enum_tbl[entry->idx].type;
+		PyObject *pyprop;
+
+		if (entry->numeric) {
+			pyprop = py_zfs_prop_from_num(
+			    state,
+			    pyzfs,
+			    prop,
+			    entry->ival,
+			    entry->sourcetype,
+			    arena.buf + entry->source_off,
+			    get_source);
+		} else if (!get_raw && py_zfs_prop_numeric_ok(prop)) {
+			pyprop = py_zfs_prop_from_buf_noraw(
+			    state,
+			    pyzfs,
+			    prop,
+			    arena.buf + entry->value_off,
+			    entry->sourcetype,
+			    arena.buf + entry->source_off,
+			    get_source);
+		} else {
+			pyprop = py_zfs_prop_from_buf(
+			    state,
+			    pyzfs,
+			    prop,
+			    arena.buf + entry->value_off,
+			    entry->sourcetype,
+			    arena.buf + entry->source_off,
+			    get_source);
+		}
+		if (pyprop == NULL)
+			goto fail;
+
+		PyStructSequence_SET_ITEM(out, entry->idx, pyprop);
+	}
+
+	PyMem_RawFree(arena.buf);
 	return out;
 fail:
+	/*
+	 * Members not yet filled in are NULL, which is handled by struct
+	 * sequence deallocation.
+	 */
+	PyMem_RawFree(arena.buf);
 	Py_XDECREF(out);
 	return NULL;
 }
@@ -723,7 +1405,499 @@ void py_zfs_props_refresh(py_zfs_resource_t *res)
 	Py_BEGIN_ALLOW_THREADS
 	PY_ZFS_LOCK(res->obj.pylibzfsp);
 	zfs_refresh_properties(res->obj.zhp);
-	PY_ZFS_UNLOCK(res->obj.pylibzfsp);
 	res->is_simple = B_FALSE;
+	PY_ZFS_UNLOCK(res->obj.pylibzfsp);
 	Py_END_ALLOW_THREADS
 }
+
+/*
+ * Change indicator for refresh_properties(if_changed=True)
+ *
+ * zfs_refresh_properties() fetches every property of the dataset with
+ * ZFS_IOC_OBJSET_STATS. Most datasets polled by middleware are idle, so
+ * before doing that we compare a cheap indicator with the one recorded at
+ * the last full refresh:
+ *
+ * - the write and unlink counters of the dataset's objset kstat, which
+ *   move when data in the dataset changes (used, written, referenced...)
+ * - py_zfs_prop_change_gen(), which moves whenever a property is changed
+ *   through this module or a ZFSEventIterator reports a history event
+ * - the last committed txg of the pool that wrote anything, from the
+ *   pool's txgs kstat. Space accounting (including available and changes
+ *   in descendants), snapshots and properties set by other processes only
+ *   become visible through such a txg. An idle pool still syncs empty
+ *   txgs every zfs_txg_timeout, but those write nothing and so do not move
+ *   the indicator. Sync tasks such as snapshots do not dirty data, so
+ *   nwritten is used rather than ndirty.
+ *
+ * A dataset is only skipped once two consecutive full refreshes saw the
+ * same indicator (`stable`).
+ *
+ * The objset kstat only exists for mounted filesystems and for volumes,
+ * and the txgs kstat is empty if zfs_txg_history is 0. Without either, or
+ * for a simple handle, a full refresh is always done. State that changes
+ * without writing a txg, such as the mounted property after a mount or
+ * unmount by another process, is not detected, so callers may bound
+ * staleness with max_age_ns.
+ *
+ * The kstats are read without holding the handle lock.
+ */
+#define	OBJSET_KSTAT_FMT	"/proc/spl/kstat/zfs/%s/objset-0x%" PRIx64
+#define	TXGS_KSTAT_FMT		"/proc/spl/kstat/zfs/%s/txgs"
+
+static const char *objset_counter_names[PY_ZFS_OBJSET_COUNTERS] = {
+	"writes",
+	"nwritten",
+	"nunlinks",
+	"nunlinked",
+};
+
+/* GIL and handle lock not required */
+static boolean_t
+objset_kstat_read(const char *pool, uint64_t objsetid, const char *name,
+		  uint64_t *counters)
+{
+	char path[MAXPATHLEN];
+	char line[ZFS_MAX_DATASET_NAME_LEN + 64];
+	char value[ZFS_MAX_DATASET_NAME_LEN];
+	char field[64];
+	boolean_t name_ok = B_FALSE;
+	int found = 0;
+	FILE *f;
+
+	snprintf(path, sizeof (path), OBJSET_KSTAT_FMT, pool, objsetid);
+
+	f = fopen(path, "re");
+	if (f == NULL)
+		return B_FALSE;
+
+	while (fgets(line, sizeof (line), f) != NULL) {
+		int type, i;
+
+		if (sscanf(line, "%63s %d %255s", field, &type, value) != 3)
+			continue;
+
+		// Objset ids may be reused after a dataset is destroyed
+		if (strcmp(field, "dataset_name") == 0) {
+			name_ok = (strcmp(value, name) == 0);
+			continue;
+		}
+
+		for (i = 0; i < PY_ZFS_OBJSET_COUNTERS; i++) {
+			if (strcmp(field, objset_counter_names[i]) == 0) {
+				counters[i] = strtoull(value, NULL, 10);
+				found++;
+				break;
+			}
+		}
+	}
+
+	fclose(f);
+	return name_ok && (found == PY_ZFS_OBJSET_COUNTERS);
+}
+
+/*
+ * Find the most recent committed txg that wrote anything. Rows are
+ * "txg birth state ndirty nread nwritten ...", oldest first. If no such
+ * txg is left in the history then *txg is 0, which is stable as long as
+ * the pool stays idle. GIL and handle lock not required.
+ */
+static boolean_t
+pool_txg_read(const char *pool, uint64_t *txg)
+{
+	char path[MAXPATHLEN];
+	char line[512];
+	boolean_t found = B_FALSE;
+	FILE *f;
+
+	snprintf(path, sizeof (path), TXGS_KSTAT_FMT, pool);
+
+	f = fopen(path, "re");
+	if (f == NULL)
+		return B_FALSE;
+
+	*txg = 0;
+	while (fgets(line, sizeof (line), f) != NULL) {
+		uint64_t row_txg, nwritten;
+		char state;
+
+		// skips the header line
+		if (sscanf(line, "%" SCNu64 " %*u %c %*u %*u %" SCNu64,
+		    &row_txg, &state, &nwritten) != 3)
+			continue;
+
+		found = B_TRUE;
+		if ((state == 'C') && (nwritten > 0))
+			*txg = row_txg;
+	}
+
+	fclose(f);
+	return found;
+}
+
+/*
+ * Refresh properties unless the change indicator matches the one recorded
+ * at the last full refresh and that refresh is not older than max_age_ns
+ * (0 means no limit). Returns B_TRUE if a full refresh was done.
+ */
+boolean_t py_zfs_props_refresh_if_changed(py_zfs_resource_t *res,
+					  uint64_t max_age_ns)
+{
+	py_zfs_t *plz = res->obj.pylibzfsp;
+	py_zfs_refresh_state_t *st = &res->refresh;
+	uint64_t counters[PY_ZFS_OBJSET_COUNTERS];
+	char name[ZFS_MAX_DATASET_NAME_LEN];
+	char pool[ZFS_MAX_DATASET_NAME_LEN];
+	boolean_t have = B_FALSE;
+	boolean_t is_simple;
+	boolean_t unchanged;
+	boolean_t refreshed = B_TRUE;
+	uint64_t gen, now, objsetid = 0, txg = 0;
+
+	Py_BEGIN_ALLOW_THREADS
+	// Read before the kstats so that a change racing with them is seen
+	// next time.
+	gen = py_zfs_prop_change_gen();
+	now = py_zfs_stats_now();
+
+	// Only copy what is needed to locate the kstats under the lock. The
+	// objset id is only known once properties are loaded.
+	PY_ZFS_LOCK(plz);
+	is_simple = res->is_simple;
+	if (!is_simple) {
+		objsetid = zfs_prop_get_int(res->obj.zhp, ZFS_PROP_OBJSETID);
+		strlcpy(name, zfs_get_name(res->obj.zhp), sizeof (name));
+		strlcpy(pool, zfs_get_pool_name(res->obj.zhp), sizeof (pool));
+	}
+	PY_ZFS_UNLOCK(plz);
+
+	if (!is_simple) {
+		have = objset_kstat_read(pool, objsetid, name, counters) &&
+		    pool_txg_read(pool, &txg);
+	}
+
+	PY_ZFS_LOCK(plz);
+	unchanged = have && st->valid && (st->change_gen == gen) &&
+	    (st->pool_txg == txg) &&
+	    (memcmp(st->counters, counters, sizeof (counters)) == 0);
+
+	if (unchanged && st->stable &&
+	    ((max_age_ns == 0) || (now - st->refreshed_ns < max_age_ns))) {
+		refreshed = B_FALSE;
+	} else {
+		zfs_refresh_properties(res->obj.zhp);
+		res->is_simple = B_FALSE;
+
+		// Values read before the refresh are recorded so that a
+		// change racing with the refresh is seen next time. A simple
+		// handle has none and is compared from the next call on.
+		st->valid = have;
+		st->stable = unchanged;
+		st->change_gen = gen;
+		st->pool_txg = txg;
+		st->refreshed_ns = now;
+		memcpy(st->counters, counters, sizeof (counters));
+	}
+	PY_ZFS_UNLOCK(plz);
+	Py_END_ALLOW_THREADS
+
+	return refreshed;
+}
+
+/*
+ * Sometimes API users will set all ZFS properties in a request.
+ * If we include the volsize property on a readonly dataset, this
+ * will cause spurious failures with EZFS_DSREADONLY. So we pop
+ * that key out of payload if it matches what's already on disk.
+ *
+ * PY_ZFS_LOCK must be held. GIL not required.
+ */
+void py_zfs_prop_drop_unchanged_volsize(zfs_handle_t *zhp, nvlist_t *nvl)
+{
+	const char *volsz = zfs_prop_to_name(ZFS_PROP_VOLSIZE);
+	const char *cval = NULL;
+	char vsz[ZFS_MAXPROPLEN];
+
+	if ((zfs_get_type(zhp) != ZFS_TYPE_VOLUME) ||
+	    (nvlist_lookup_string(nvl, volsz, &cval) != 0))
+		return;
+
+	// propsize present in nvl payload. This property is problematic
+	// because it can't be set when zvol is readonly
+	if (zfs_prop_get(zhp, ZFS_PROP_VOLSIZE,
+	    vsz, sizeof(vsz), NULL, NULL, 0, B_TRUE) == 0) {
+		if (strcmp(vsz, cval) == 0) {
+			//propsize hasn't changed so let's just remove it
+			fnvlist_remove(nvl, volsz);
+		}
+	}
+}
+
+/*
+ * Load properties of a simple handle. is_simple is checked under the lock
+ * since another thread may be using the same resource.
+ */
+void py_zfs_props_load(py_zfs_resource_t *res)
+{
+	Py_BEGIN_ALLOW_THREADS
+	PY_ZFS_LOCK(res->obj.pylibzfsp);
+	if (res->is_simple) {
+		zfs_refresh_properties(res->obj.zhp);
+		res->is_simple = B_FALSE;
+	}
+	PY_ZFS_UNLOCK(res->obj.pylibzfsp);
+	Py_END_ALLOW_THREADS
+}
+
+/*
+ * ZFSPropertyView
+ *
+ * Lazy alternative to struct_zfs_property returned by
+ * get_properties(lazy=True). Attributes have the same names as those of
+ * struct_zfs_property, but a property value is only read from libzfs (and
+ * its struct_zfs_property_data built) when the attribute is first accessed.
+ * The result is cached on the view. Unrequested properties are None.
+ *
+ * The view holds a reference to the ZFS resource rather than to the bare
+ * zfs_handle_t so that the handle remains valid for the lifetime of the view.
+ */
+typedef struct {
+	PyObject_HEAD
+	py_zfs_resource_t *rsrc;
+	boolean_t get_source;
+	boolean_t get_raw;
+	uint64_t mask[PROP_SELECTOR_MASK_WORDS];
+	PyObject *cache[ARRAY_SIZE(zfs_prop_table)];
+} py_zfs_prop_view_t;
+
+static void
+py_zfs_prop_view_dealloc(py_zfs_prop_view_t *self)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(zfs_prop_table); i++)
+		Py_CLEAR(self->cache[i]);
+
+	Py_CLEAR(self->rsrc);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+py_zfs_prop_view_load(py_zfs_prop_view_t *view,
+		      pylibzfs_state_t *state,
+		      size_t idx)
+{
+	py_zfs_resource_t *res = view->rsrc;
+	zfs_prop_t prop = state->zfs_prop_enum_tbl[idx].type;
+	zprop_source_t sourcetype;
+	char sourcebuf[ZFS_MAX_DATASET_NAME_LEN] = {0};
+	uint64_t val;
+	int err = -1;
+
+	Py_BEGIN_ALLOW_THREADS
+	PY_ZFS_LOCK(res->obj.pylibzfsp);
+	if (res->is_simple) {
+		zfs_refresh_properties(res->obj.zhp);
+		res->is_simple = B_FALSE;
+	}
+
+	if (!view->get_raw && py_zfs_prop_numeric_ok(prop)) {
+		err = zfs_prop_get_numeric(res->obj.zhp, prop, &val,
+					   &sourcetype, sourcebuf,
+					   sizeof(sourcebuf));
+	}
+	PY_ZFS_UNLOCK(res->obj.pylibzfsp);
+	Py_END_ALLOW_THREADS
+
+	if (err == 0) {
+		return py_zfs_prop_from_num(state, &res->obj, prop, val,
+					    sourcetype, sourcebuf,
+					    view->get_source);
+	}
+
+	return py_zfs_get_prop(state, &res->obj, prop, view->get_source);
+}
+
+/*
+ * Return new reference to the cached value of the property at `idx`,
+ * loading it if required. The cache slot is only accessed within a
+ * critical section. The value is loaded outside of it since loading
+ * releases the GIL, and so if two threads race the first stored value wins.
+ */
+static PyObject *
+py_zfs_prop_view_get(py_zfs_prop_view_t *view,
+		     pylibzfs_state_t *state,
+		     size_t idx)
+{
+	PyObject *out = NULL;
+
+	Py_BEGIN_CRITICAL_SECTION(view);
+	out = Py_XNewRef(view->cache[idx]);
+	Py_END_CRITICAL_SECTION();
+
+	if (out != NULL)
+		return out;
+
+	out = py_zfs_prop_view_load(view, state, idx);
+	if (out == NULL)
+		return NULL;
+
+	Py_BEGIN_CRITICAL_SECTION(view);
+	if (view->cache[idx] == NULL)
+		view->cache[idx] = Py_NewRef(out);
+	else
+		Py_SETREF(out, Py_NewRef(view->cache[idx]));
+	Py_END_CRITICAL_SECTION();
+
+	return out;
+}
+
+static PyObject *
+py_zfs_prop_view_getattro(PyObject *self, PyObject *name)
+{
+	py_zfs_prop_view_t *view = (py_zfs_prop_view_t *)self;
+	pylibzfs_state_t *state = py_get_module_state(view->rsrc->obj.pylibzfsp);
+	PyObject *pyidx = NULL;
+	size_t idx;
+
+	pyidx = PyDict_GetItemWithError(state->zfs_prop_field_idx, name);
+	if (pyidx == NULL) {
+		if (PyErr_Occurred())
+			return NULL;
+
+		return PyObject_GenericGetAttr(self, name);
+	}
+
+	idx = PyLong_AsSize_t(pyidx);
+	if ((state->zfs_prop_enum_tbl[idx].obj == NULL) ||
+	    !PY_ZFS_PROP_SELECTED(view, idx))
+		Py_RETURN_NONE;
+
+	return py_zfs_prop_view_get(view, state, idx);
+}
+
+static PyObject *
+py_zfs_prop_view_repr(PyObject *self)
+{
+	py_zfs_prop_view_t *view = (py_zfs_prop_view_t *)self;
+	PyObject *name = py_zfs_obj_name_ref(&view->rsrc->obj);
+	PyObject *out;
+
+	out = PyUnicode_FromFormat("<" PYLIBZFS_TYPES_MODULE_NAME
+				   ".ZFSPropertyView(name=%S)>", name);
+	Py_DECREF(name);
+	return out;
+}
+
+PyDoc_STRVAR(py_zfs_prop_view_materialize__doc__,
+"materialize() -> truenas_pylibzfs.struct_zfs_property\n\n"
+"-----------------------------------------------------\n\n"
+"Read all requested properties that have not been accessed yet and return\n"
+"the equivalent of get_properties(lazy=False).\n"
+);
+static PyObject *
+py_zfs_prop_view_materialize(PyObject *self, PyObject *Py_UNUSED(ignored))
+{
+	py_zfs_prop_view_t *view = (py_zfs_prop_view_t *)self;
+	pylibzfs_state_t *state = py_get_module_state(view->rsrc->obj.pylibzfsp);
+	PyObject *out = NULL;
+	size_t idx;
+
+	out = PyStructSequence_New(state->struct_zfs_props_type);
+	if (out == NULL)
+		return NULL;
+
+	for (idx = 0; idx < ARRAY_SIZE(zfs_prop_table); idx++) {
+		if ((state->zfs_prop_enum_tbl[idx].obj == NULL) ||
+		    !PY_ZFS_PROP_SELECTED(view, idx)) {
+			PyStructSequence_SET_ITEM(out, idx, Py_NewRef(Py_None));
+			continue;
+		}
+
+		PyObject *val = py_zfs_prop_view_get(view, state, idx);
+		if (val == NULL) {
+			Py_DECREF(out);
+			return NULL;
+		}
+
+		PyStructSequence_SET_ITEM(out, idx, val);
+	}
+
+	return out;
+}
+
+static PyMethodDef py_zfs_prop_view_methods[] = {
+	{
+		.ml_name = "materialize",
+		.ml_meth = py_zfs_prop_view_materialize,
+		.ml_flags = METH_NOARGS,
+		.ml_doc = py_zfs_prop_view_materialize__doc__
+	},
+	{ NULL, NULL, 0, NULL }
+};
+
+PyDoc_STRVAR(py_zfs_prop_view__doc__,
+"ZFSPropertyView\n"
+"---------------\n\n"
+"Lazy view of ZFS properties returned by get_properties(lazy=True).\n\n"
+"Attribute names match those of truenas_pylibzfs.struct_zfs_property.\n"
+"A requested property is read when its attribute is first accessed and\n"
+"the resulting struct_zfs_property_data is cached. Unrequested properties\n"
+"are None. Since values are read on access, they reflect the state of\n"
+"the resource at that time rather than when the view was created.\n"
+);
+
+PyTypeObject ZFSPropertyView = {
+	.tp_name      = PYLIBZFS_TYPES_MODULE_NAME ".ZFSPropertyView",
+	.tp_basicsize = sizeof (py_zfs_prop_view_t),
+	.tp_itemsize  = 0,
+	.tp_dealloc   = (destructor)py_zfs_prop_view_dealloc,
+	.tp_new       = py_no_new_impl,
+	.tp_repr      = py_zfs_prop_view_repr,
+	.tp_getattro  = py_zfs_prop_view_getattro,
+	.tp_methods   = py_zfs_prop_view_methods,
+	.tp_flags     = Py_TPFLAGS_DEFAULT,
+	.tp_doc       = py_zfs_prop_view__doc__,
+};
+
+PyObject *py_zfs_get_properties_lazy(py_zfs_resource_t *res,
+				     PyObject *prop_set,
+				     boolean_t get_source,
+				     boolean_t get_raw)
+{
+	pylibzfs_state_t *state = py_get_module_state(res->obj.pylibzfsp);
+	py_zfs_prop_view_t *view = NULL;
+	size_t idx;
+
+	view = (py_zfs_prop_view_t *)ZFSPropertyView.tp_alloc(&ZFSPropertyView, 0);
+	if (view == NULL)
+		return NULL;
+
+	view->rsrc = (py_zfs_resource_t *)Py_NewRef((PyObject *)res);
+	view->get_source = get_source;
+	view->get_raw = get_raw;
+
+	if (PyObject_TypeCheck(prop_set, &ZFSPropertySelector)) {
+		py_zfs_prop_selector_t *sel = (py_zfs_prop_selector_t *)prop_set;
+		memcpy(view->mask, sel->mask, sizeof(view->mask));
+		return (PyObject *)view;
+	}
+
+	for (idx = 0; idx < ARRAY_SIZE(zfs_prop_table); idx++) {
+		PyObject *enum_obj = state->zfs_prop_enum_tbl[idx].obj;
+		int rv;
+
+		if (enum_obj == NULL)
+			continue;
+
+		rv = PySet_Contains(prop_set, enum_obj);
+		if (rv == -1) {
+			Py_DECREF(view);
+			return NULL;
+		} else if (rv == 1) {
+			view->mask[idx / 64] |= (1ULL << (idx % 64));
+		}
+	}
+
+	return (PyObject *)view;
+}
@@ -0,0 +1,289 @@
+#include "../truenas_pylibzfs.h"
+
+/*
+ * Implementation of ZFS.set_properties_bulk()
+ *
+ * Apply property changes to many datasets in one call. Work is done in
+ * three passes so that the libzfs handle lock and the GIL are each taken a
+ * fixed number of times regardless of the number of datasets:
+ *
+ * 1. Open all datasets (lock held, GIL released).
+ * 2. Convert the python properties for each dataset to an nvlist using the
+ *    dataset's type for validation (GIL held). Argument errors are raised
+ *    here before any change is made.
+ * 3. Set the properties and write history (lock held, GIL released).
+ *
+ * Failure to open or update a dataset does not stop the remaining updates.
+ * Such failures are returned to the caller keyed by dataset name. Failure
+ * to write history is raised as RuntimeError once all updates are done,
+ * in the same way as ZFSResource.set_properties() (see
+ * py_log_history_impl()).
+ *
+ * NOTE: ZFS channel programs can not be used for this since
+ * zfs.sync.set_prop() only supports user properties.
+ */
+
+typedef struct {
+	PyObject *name;
+	const char *cname;
+	zfs_handle_t *zhp;
+	nvlist_t *props;
+	char *json_str;
+	boolean_t failed;
+	py_zfs_error_t zfs_err;
+	int history_errno;
+} bulk_set_entry_t;
+
+/*
+ * History must be written directly after the ioctl that permits it (see
+ * py_log_history_impl()), and so it is written here rather than after all
+ * datasets have been updated. Errors are recorded in the entry and raised
+ * by bulk_set_history_exc(). PY_ZFS_LOCK must be held. GIL not required.
+ */
+static void
+bulk_set_log_history(py_zfs_t *plz, bulk_set_entry_t *entry)
+{
+	char histbuf[PYMAXHISTORYLEN];
+	int err;
+
+	if (entry->json_str) {
+		snprintf(histbuf, sizeof(histbuf),
+			 "%szfs update %s with properties: %s",
+			 plz->history_prefix, entry->cname, entry->json_str);
+	} else {
+		snprintf(histbuf, sizeof(histbuf), "%szfs update %s",
+			 plz->history_prefix, entry->cname);
+	}
+
+	do {
+		err = zpool_log_history(plz->lzh, histbuf);
+	} while (err < 0 && errno == EINTR);
+
+	if (err)
+		entry->history_errno = errno;
+}
+
+/*
+ * Raise RuntimeError naming the datasets whose history could not be
+ * written. Returns B_TRUE if an exception was set.
+ */
+static boolean_t
+bulk_set_history_exc(bulk_set_entry_t *entries, Py_ssize_t cnt)
+{
+	bulk_set_entry_t *first = NULL;
+	PyObject *names = NULL;
+	Py_ssize_t i;
+
+	for (i = 0; i < cnt; i++) {
+		if (entries[i].history_errno == 0)
+			continue;
+
+		if (names == NULL) {
+			first = &entries[i];
+			names = PyList_New(0);
+			if (names == NULL)
+				return B_TRUE;
+		}
+
+		if (PyList_Append(names, entries[i].name) < 0) {
+			Py_DECREF(names);
+			return B_TRUE;
+		}
+	}
+
+	if (names == NULL)
+		return B_FALSE;
+
+	PyErr_Format(PyExc_RuntimeError,
+		     "%R: attempt to log action to zpool history failed with "
+		     "error [%d]: %s. Since logging occurs after the action "
+		     "completes, this means that the properties were updated "
+		     "successfully; however the update will not be logged in "
+		     "the normal zpool history log.",
+		     names, first->history_errno,
+		     strerror(first->history_errno));
+	Py_DECREF(names);
+	return B_TRUE;
+}
+
+static PyObject *
+bulk_set_errors(bulk_set_entry_t *entries, Py_ssize_t cnt)
+{
+	PyObject *out = NULL;
+	Py_ssize_t i;
+
+	out = PyDict_New();
+	if (out == NULL)
+		return NULL;
+
+	for (i = 0; i < cnt; i++) {
+		bulk_set_entry_t *entry = &entries[i];
+		PyObject *errtup = NULL;
+		PyObject *desc = NULL;
+		int err;
+
+		if (!entry->failed)
+			continue;
+
+		// libzfs may place invalid UTF-8 in descriptions (see
+		// _set_exc_from_libzfs()).
+		desc = PyUnicode_DecodeUTF8(entry->zfs_err.description,
+		    strlen(entry->zfs_err.description), "replace");
+		if (desc == NULL)
+			goto fail;
+
+		errtup = Py_BuildValue("(iN)", entry->zfs_err.code, desc);
+		if (errtup == NULL)
+			goto fail;
+
+		err = PyDict_SetItem(out, entry->name, errtup);
+		Py_DECREF(errtup);
+		if (err)
+			goto fail;
+	}
+
+	return out;
+fail:
+	Py_DECREF(out);
+	return NULL;
+}
+
+PyObject *py_zfs_do_set_properties_bulk(py_zfs_t *plz,
+					PyObject *pyprops,
+					boolean_t remount)
+{
+	pylibzfs_state_t *state = py_get_module_state(plz);
+	bulk_set_entry_t *entries = NULL;
+	PyObject *key, *value;
+	PyObject *out = NULL;
+	Py_ssize_t cnt, pos = 0, i = 0;
+
+	if (!PyDict_Check(pyprops)) {
+		PyErr_SetString(PyExc_TypeError,
+				"properties must be a dictionary mapping "
+				"dataset names to properties.");
+		return NULL;
+	}
+
+	cnt = PyDict_Size(pyprops);
+	if (cnt == 0)
+		return PyDict_New();
+
+	entries = PyMem_Calloc(cnt, sizeof (bulk_set_entry_t));
+	if (entries == NULL)
+		return PyErr_NoMemory();
+
+	while (PyDict_Next(pyprops, &pos, &key, &value)) {
+		if (!PyUnicode_Check(key)) {
+			PyErr_Format(PyExc_TypeError,
+				     "%R: dataset name must be a string.", key);
+			goto out;
+		}
+
+		entries[i].cname = PyUnicode_AsUTF8(key);
+		if (entries[i].cname == NULL)
+			goto out;
+
+		// Keep the name alive while the GIL is released
+		entries[i].name = Py_NewRef(key);
+		i++;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	PY_ZFS_LOCK(plz);
+	for (i = 0; i < cnt; i++) {
+		bulk_set_entry_t *entry = &entries[i];
+
+		entry->zhp = zfs_open(plz->lzh, entry->cname,
+				      ZFS_TYPE_FILESYSTEM | ZFS_TYPE_VOLUME);
+		if (entry->zhp == NULL) {
+			py_get_zfs_error(plz->lzh, &entry->zfs_err);
+			entry->failed = B_TRUE;
+		}
+	}
+	PY_ZFS_UNLOCK(plz);
+	Py_END_ALLOW_THREADS
+
+	for (i = 0; i < cnt; i++) {
+		bulk_set_entry_t *entry = &entries[i];
+
+		if (entry->zhp == NULL)
+			continue;
+
+		value = PyDict_GetItemWithError(pyprops, entry->name);
+		if (value == NULL) {
+			if (!PyErr_Occurred()) {
+				PyErr_Format(PyExc_RuntimeError,
+					     "%U: dataset removed from properties "
+					     "during update.", entry->name);
+			}
+			goto out;
+		}
+
+		entry->props = py_zfsprops_to_nvlist(state, value,
+						     zfs_get_type(entry->zhp),
+						     B_FALSE);
+		if (entry->props == NULL)
+			goto out;
+	}
+
+	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".set_properties_bulk", "O",
+			pyprops) < 0)
+		goto out;
+
+	Py_BEGIN_ALLOW_THREADS
+	PY_ZFS_LOCK(plz);
+	for (i = 0; i < cnt; i++) {
+		bulk_set_entry_t *entry = &entries[i];
+		uint64_t op_start;
+		int err;
+
+		if (entry->zhp == NULL)
+			continue;
+
+		py_zfs_prop_drop_unchanged_volsize(entry->zhp, entry->props);
+
+		op_start = py_zfs_stats_now();
+		err = zfs_prop_set_list_flags(entry->zhp, entry->props,
+					      remount ? 0 : ZFS_SET_NOMOUNT);
+		py_zfs_stats_op(plz, PY_ZFS_OP_PROP_SET, op_start);
+		if (err) {
+			py_get_zfs_error(plz->lzh, &entry->zfs_err);
+			entry->failed = B_TRUE;
+			continue;
+		}
+
+		py_zfs_prop_cache_invalidate(plz, entry->cname);
+		if (plz->history) {
+			// Generated after volsize may have been dropped so
+			// that it matches what was set.
+			entry->json_str = nvlist_to_json_str(entry->props);
+			bulk_set_log_history(plz, entry);
+		}
+	}
+	PY_ZFS_UNLOCK(plz);
+	Py_END_ALLOW_THREADS
+
+	if (bulk_set_history_exc(entries, cnt))
+		goto out;
+
+	out = bulk_set_errors(entries, cnt);
+
+out:
+	Py_BEGIN_ALLOW_THREADS
+	PY_ZFS_LOCK(plz);
+	for (i = 0; i < cnt; i++) {
+		if (entries[i].zhp != NULL)
+			zfs_close(entries[i].zhp);
+		fnvlist_free(entries[i].props);
+		PyMem_RawFree(entries[i].json_str);
+	}
+	PY_ZFS_UNLOCK(plz);
+	Py_END_ALLOW_THREADS
+
+	for (i = 0; i < cnt; i++)
+		Py_XDECREF(entries[i].name);
+
+	PyMem_Free(entries);
+	return out;
+}
@@ -0,0 +1,217 @@
+#include "../truenas_pylibzfs.h"
+#include <time.h>
+
+/*
+ * Per-handle ZFS property cache
+ *
+ * When enabled through open_handle(property_cache_ttl=...), the values read
+ * by ZFSResource.get_properties() / asdict() are stored in an nvlist on the
+ * py_zfs_t keyed by dataset guid. Subsequent requests for properties that
+ * are present in a live entry are answered without zfs_refresh_properties()
+ * or zfs_prop_get().
+ *
+ * Layout of prop_cache.entries:
+ *
+ * "<guid>": {
+ *     "name": "<dataset name>",
+ *     "expires": <CLOCK_MONOTONIC ns>,
+ *     "props": {"<prop>": {"value": str, "source": str, "srctype": uint64}}
+ * }
+ *
+ * Entries are dropped when they expire, when this handle changes properties
+ * of the dataset or a related dataset, and when a ZFSEventIterator created
+ * from this handle sees a history or pool event for it. The TTL bounds
+ * staleness for changes made by other processes when events are not being
+ * consumed.
+ *
+ * All functions below require PY_ZFS_LOCK to be held. GIL not required
+ * unless otherwise noted.
+ */
+
+#define	PROP_CACHE_NAME		"name"
+#define	PROP_CACHE_EXPIRES	"expires"
+#define	PROP_CACHE_PROPS	"props"
+
+#define	EV_CLASS		"class"
+#define	EV_SYSEVENT_PREFIX	"sysevent.fs.zfs."
+#define	EV_HISTORY		"sysevent.fs.zfs.history_event"
+#define	EV_HISTORY_DSNAME	"history_dsname"
+#define	EV_POOL_NAME		"pool_name"
+
+static uint64_t
+prop_cache_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+/*
+ * Whether a change to `changed` may affect cached properties of `cached`.
+ * This is the case if the names are equal or one is an ancestor of the
+ * other (inherited properties flow down, space accounting flows up).
+ */
+static boolean_t
+prop_cache_related(const char *cached, const char *changed)
+{
+	size_t clen = strlen(cached);
+	size_t nlen = strlen(changed);
+	const char *longer = clen > nlen ? cached : changed;
+	size_t shorter = clen > nlen ? nlen : clen;
+
+	if (strncmp(cached, changed, shorter) != 0)
+		return B_FALSE;
+
+	return (longer[shorter] == '\0' || longer[shorter] == '/' ||
+	    longer[shorter] == '@');
+}
+
+/*
+ * Return the cached properties nvlist for guid, or NULL if there is no live
+ * entry. The returned nvlist is owned by the cache and is only valid until
+ * the cache is next modified. The caller is responsible for updating the
+ * hit / miss counters since a live entry need not contain every property
+ * that was requested.
+ */
+nvlist_t *
+py_zfs_prop_cache_lookup(py_zfs_t *plz, uint64_t guid)
+{
+	py_zfs_prop_cache_t *cache = &plz->prop_cache;
+	char key[21];
+	nvlist_t *entry = NULL;
+
+	if (cache->entries == NULL)
+		return NULL;
+
+	snprintf(key, sizeof(key), "%" PRIu64, guid);
+	if (nvlist_lookup_nvlist(cache->entries, key, &entry) != 0)
+		return NULL;
+
+	if (fnvlist_lookup_uint64(entry, PROP_CACHE_EXPIRES) <= prop_cache_now()) {
+		fnvlist_remove(cache->entries, key);
+		return NULL;
+	}
+
+	return fnvlist_lookup_nvlist(entry, PROP_CACHE_PROPS);
+}
+
+/*
+ * Add freshly read properties for guid to the cache. If there is a live
+ * entry the properties are merged into it without extending its lifetime,
+ * otherwise a new entry is created. props is copied.
+ */
+void
+py_zfs_prop_cache_insert(py_zfs_t *plz, uint64_t guid, const char *name,
+    nvlist_t *props)
+{
+	py_zfs_prop_cache_t *cache = &plz->prop_cache;
+	char key[21];
+	nvlist_t *entry = NULL;
+	nvlist_t *existing = NULL;
+
+	existing = py_zfs_prop_cache_lookup(plz, guid);
+	if (existing != NULL) {
+		fnvlist_merge(existing, props);
+		return;
+	}
+
+	if (cache->entries == NULL)
+		cache->entries = fnvlist_alloc();
+
+	snprintf(key, sizeof(key), "%" PRIu64, guid);
+
+	entry = fnvlist_alloc();
+	fnvlist_add_string(entry, PROP_CACHE_NAME, name);
+	fnvlist_add_uint64(entry, PROP_CACHE_EXPIRES,
+	    prop_cache_now() + cache->ttl_ns);
+	fnvlist_add_nvlist(entry, PROP_CACHE_PROPS, props);
+
+	fnvlist_add_nvlist(cache->entries, key, entry);
+	fnvlist_free(entry);
+}
+
+/*
+ * Process-wide count of invalidations, whether or not the cache is enabled.
+ * refresh_properties(if_changed=True) uses it to detect property changes
+ * that objset kstats do not reflect. Updated with relaxed atomics and so
+ * may be read without the lock.
+ */
+static uint64_t prop_change_gen;
+
+uint64_t
+py_zfs_prop_change_gen(void)
+{
+	return __atomic_load_n(&prop_change_gen, __ATOMIC_RELAXED);
+}
+
+/*
+ * Drop entries of datasets related to `name` (see prop_cache_related()).
+ */
+void
+py_zfs_prop_cache_invalidate(py_zfs_t *plz, const char *name)
+{
+	py_zfs_prop_cache_t *cache = &plz->prop_cache;
+	nvpair_t *pair = NULL;
+	nvpair_t *next = NULL;
+
+	__atomic_add_fetch(&prop_change_gen, 1, __ATOMIC_RELAXED);
+
+	if (cache->entries == NULL)
+		return;
+
+	for (pair = nvlist_next_nvpair(cache->entries, NULL); pair != NULL;
+	    pair = next) {
+		nvlist_t *entry = fnvpair_value_nvlist(pair);
+		const char *cached = fnvlist_lookup_string(entry,
+		    PROP_CACHE_NAME);
+
+		next = nvlist_next_nvpair(cache->entries, pair);
+		if (!prop_cache_related(cached, name))
+			continue;
+
+		fnvlist_remove_nvpair(cache->entries, pair);
+		cache->invalidations++;
+	}
+}
+
+/*
+ * Invalidate entries affected by a zevent. History events (property set,
+ * snapshot, destroy, rename, etc.) name the dataset that changed. Other
+ * ZFS sysevents carry the name of the pool, in which case all entries for
+ * the pool are dropped.
+ */
+void
+py_zfs_prop_cache_event(py_zfs_t *plz, nvlist_t *event)
+{
+	const char *class = NULL;
+	const char *name = NULL;
+
+	if (nvlist_lookup_string(event, EV_CLASS, &class) != 0)
+		return;
+
+	if (strncmp(class, EV_SYSEVENT_PREFIX, strlen(EV_SYSEVENT_PREFIX)) != 0)
+		return;
+
+	if ((strcmp(class, EV_HISTORY) == 0) &&
+	    (nvlist_lookup_string(event, EV_HISTORY_DSNAME, &name) == 0)) {
+		py_zfs_prop_cache_invalidate(plz, name);
+		return;
+	}
+
+	if (nvlist_lookup_string(event, EV_POOL_NAME, &name) == 0)
+		py_zfs_prop_cache_invalidate(plz, name);
+}
+
+void
+py_zfs_prop_cache_clear(py_zfs_t *plz)
+{
+	py_zfs_prop_cache_t *cache = &plz->prop_cache;
+
+	if (cache->entries == NULL)
+		return;
+
+	cache->invalidations += fnvlist_num_pairs(cache->entries);
+	fnvlist_free(cache->entries);
+	cache->entries = NULL;
+}
@@ -0,0 +1,172 @@
+#include "../truenas_pylibzfs.h"
+
+/*
+ * ZFSPropertySelector
+ *
+ * Precompiled set of ZFS properties that may be passed in place of a set
+ * of ZFSProperty to ZFSResource.get_properties(), ZFSResource.asdict() and
+ * ZFS.query(). The set is resolved against zfs_prop_table once when the
+ * selector is created so that callers that request the same properties for
+ * many datasets do not pay for a PySet_Contains() lookup per table entry
+ * per dataset.
+ */
+
+static void
+py_zfs_prop_selector_dealloc(py_zfs_prop_selector_t *self)
+{
+	Py_CLEAR(self->props);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+py_zfs_prop_selector_repr(PyObject *self)
+{
+	py_zfs_prop_selector_t *sel = (py_zfs_prop_selector_t *)self;
+
+	return PyUnicode_FromFormat("<" PYLIBZFS_TYPES_MODULE_NAME
+				    ".ZFSPropertySelector(%R)>", sel->props);
+}
+
+static Py_ssize_t
+py_zfs_prop_selector_len(PyObject *self)
+{
+	return (Py_ssize_t)((py_zfs_prop_selector_t *)self)->nidx;
+}
+
+static int
+py_zfs_prop_selector_contains(PyObject *self, PyObject *value)
+{
+	return PySet_Contains(((py_zfs_prop_selector_t *)self)->props, value);
+}
+
+static PyObject *
+py_zfs_prop_selector_iter(PyObject *self)
+{
+	return PyObject_GetIter(((py_zfs_prop_selector_t *)self)->props);
+}
+
+static PySequenceMethods py_zfs_prop_selector_as_sequence = {
+	.sq_length = py_zfs_prop_selector_len,
+	.sq_contains = py_zfs_prop_selector_contains,
+};
+
+static PyObject *
+py_zfs_prop_selector_get_properties(PyObject *self, void *extra)
+{
+	return Py_NewRef(((py_zfs_prop_selector_t *)self)->props);
+}
+
+static PyGetSetDef py_zfs_prop_selector_getsetters[] = {
+	{
+		.name	= "properties",
+		.get	= (getter)py_zfs_prop_selector_get_properties,
+		.doc	= "frozenset of ZFSProperty selected."
+	},
+	{ .name = NULL }
+};
+
+PyDoc_STRVAR(py_zfs_prop_selector__doc__,
+"ZFSPropertySelector\n"
+"-------------------\n\n"
+"Precompiled set of ZFS properties created by\n"
+"truenas_pylibzfs.create_property_selector().\n\n"
+"May be passed as the `properties` argument of ZFSResource.get_properties(),\n"
+"ZFSResource.asdict() and ZFS.query() in place of a set. Membership is\n"
+"resolved once when the selector is created rather than on every call.\n"
+);
+
+PyTypeObject ZFSPropertySelector = {
+	.tp_name      = PYLIBZFS_TYPES_MODULE_NAME ".ZFSPropertySelector",
+	.tp_basicsize = sizeof (py_zfs_prop_selector_t),
+	.tp_itemsize  = 0,
+	.tp_dealloc   = (destructor)py_zfs_prop_selector_dealloc,
+	.tp_new       = py_no_new_impl,
+	.tp_repr      = py_zfs_prop_selector_repr,
+	.tp_as_sequence = &py_zfs_prop_selector_as_sequence,
+	.tp_iter      = py_zfs_prop_selector_iter,
+	.tp_getset    = py_zfs_prop_selector_getsetters,
+	.tp_flags     = Py_TPFLAGS_DEFAULT,
+	.tp_doc       = py_zfs_prop_selector__doc__,
+};
+
+PyObject *
+py_zfs_prop_selector_create(pylibzfs_state_t *state, PyObject *py_props)
+{
+	py_zfs_prop_selector_t *sel = NULL;
+	PyObject *props = NULL;
+	PyObject *iterator = NULL;
+	PyObject *item = NULL;
+	size_t idx;
+
+	if (py_props == NULL) {
+		PyErr_SetString(PyExc_ValueError,
+				"properties keyword is required.");
+		return NULL;
+	}
+
+	// Consume the argument exactly once so that iterators and generators
+	// are handled, then validate the members so that typos are not
+	// silently ignored.
+	props = PyFrozenSet_New(py_props);
+	if (props == NULL)
+		return NULL;
+
+	iterator = PyObject_GetIter(props);
+	if (iterator == NULL) {
+		Py_DECREF(props);
+		return NULL;
+	}
+
+	while ((item = PyIter_Next(iterator)) != NULL) {
+		int rv = PyObject_IsInstance(item, state->zfs_property_enum);
+		Py_DECREF(item);
+		if (rv != 1) {
+			if (rv == 0) {
+				PyErr_SetString(PyExc_TypeError,
+						"properties must contain only "
+						"ZFSProperty members.");
+			}
+			Py_DECREF(iterator);
+			Py_DECREF(props);
+			return NULL;
+		}
+	}
+
+	Py_DECREF(iterator);
+	if (PyErr_Occurred()) {
+		Py_DECREF(props);
+		return NULL;
+	}
+
+	sel = (py_zfs_prop_selector_t *)ZFSPropertySelector.tp_alloc(
+	    &ZFSPropertySelector, 0);
+	if (sel == NULL) {
+		Py_DECREF(props);
+		return NULL;
+	}
+
+	sel->props = props;
+
+	for (idx = 0; idx < ARRAY_SIZE(zfs_prop_table); idx++) {
+		PyObject *enum_obj = state->zfs_prop_enum_tbl[idx].obj;
+		int rv;
+
+		if (enum_obj == NULL)
+			continue;
+
+		rv = PySet_Contains(sel->props, enum_obj);
+		if (rv == -1)
+			goto fail;
+		else if (rv == 0)
+			continue;
+
+		sel->mask[idx / 64] |= (1ULL << (idx % 64));
+		sel->idx[sel->nidx++] = idx;
+	}
+
+	return (PyObject *)sel;
+
+fail:
+	Py_DECREF(sel);
+	return NULL;
+}
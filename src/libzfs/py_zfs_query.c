@@ -0,0 +1,659 @@
+#include "../truenas_pylibzfs.h"
+#include "py_zfs_iter.h"
+
+/*
+ * Implementation of ZFS.query()
+ *
+ * ZFS.query() walks the dataset tree and builds the list of result
+ * dictionaries in a single call, without creating ZFSDataset / ZFSVolume /
+ * ZFSSnapshot objects and without the intermediate struct_zfs_property
+ * objects created by ZFSResource.asdict().
+ *
+ * The libzfs handle lock is held for the duration of the walk. The GIL is
+ * released while libzfs is iterating and re-acquired in the zfs_iter_f
+ * callback only for resources that will be part of the result, in the same
+ * manner as the iterators in py_zfs_iter.c. Requested properties are first
+ * read into a prop_arena_t (see py_zfs_get_properties()) without the GIL,
+ * which is then only held to build the dictionaries.
+ *
+ * Each result dictionary has the same keys and values as
+ * ZFSResource.asdict() (minus "crypto"), optionally limited by `select`.
+ *
+ * ZFS.query_json() performs the same walk but writes each entry as JSON
+ * into a py_json_buf_t from within the callback, so that the GIL is not
+ * re-acquired per resource at all.
+ */
+
+typedef enum {
+	QUERY_FIELD_NAME,
+	QUERY_FIELD_POOL,
+	QUERY_FIELD_TYPE,
+	QUERY_FIELD_TYPE_ENUM,
+	QUERY_FIELD_CREATETXG,
+	QUERY_FIELD_GUID,
+	QUERY_FIELD_PROPERTIES,
+	QUERY_FIELD_USER_PROPERTIES,
+	QUERY_FIELD_COUNT,
+} query_field_t;
+
+static const char *query_field_names[QUERY_FIELD_COUNT] = {
+	"name",
+	"pool",
+	"type",
+	"type_enum",
+	"createtxg",
+	"guid",
+	"properties",
+	"user_properties",
+};
+
+#define QUERY_FIELDS_ALL ((1U << QUERY_FIELD_COUNT) - 1)
+#define QUERY_FIELD_SELECTED(q, f) ((q)->fields & (1U << (f)))
+
+typedef struct {
+	zfs_prop_t prop;
+	size_t idx;
+	const char *name;
+	PyObject *key;
+} query_prop_t;
+
+/*
+ * plz: libzfs handle on which query is performed.
+ * types: zfs_type_t mask of resources to include in output.
+ * recursive: descend into child datasets.
+ * get_source: include property source information.
+ * get_user_props: include user properties.
+ * flags: zfs_iter_f flags (ZFS_ITER_SIMPLE if no properties needed).
+ * filter: optional compiled filter (see py_zfs_filter.c).
+ * fields: bitmask of query_field_t to include in output.
+ * keys: interned key strings for output dictionaries.
+ * props: requested ZFS properties and their keys in "properties" dict.
+ * arena: values of props for the current resource, read without the GIL.
+ * out: result list.
+ * json: write results into jb rather than out.
+ * jb: JSON output buffer.
+ * nout: number of entries written to jb.
+ * _save: saved thread state while GIL is released.
+ */
+typedef struct {
+	py_zfs_t *plz;
+	pylibzfs_state_t *state;
+	zfs_type_t types;
+	boolean_t recursive;
+	boolean_t get_source;
+	boolean_t get_user_props;
+	int flags;
+	const py_zfs_filter_t *filter;
+	uint_t fields;
+	PyObject *keys[QUERY_FIELD_COUNT];
+	query_prop_t *props;
+	size_t nprops;
+	boolean_t props_requested;
+	prop_arena_t arena;
+	PyObject *out;
+	boolean_t json;
+	py_json_buf_t jb;
+	size_t nout;
+	PyThreadState *_save;
+} query_state_t;
+
+/*
+ * Read the requested properties that apply to the type of zhp into
+ * q->arena. Called without the GIL and with the libzfs lock held. Returns
+ * the same values as prop_arena_fill().
+ */
+static int
+query_read_props(query_state_t *q, zfs_handle_t *zhp, size_t *failed,
+		 int *err_errno)
+{
+	zfs_type_t type = zfs_get_type(zhp);
+	size_t i;
+
+	q->arena.nentries = 0;
+	q->arena.used = 0;
+
+	for (i = 0; i < q->nprops; i++) {
+		// Mixed resource types are expected in query results, and so
+		// properties that do not apply to this type are omitted rather
+		// than raising ValueError as asdict() does.
+		if (!zfs_prop_valid_for_type(q->props[i].prop, type, B_FALSE))
+			continue;
+
+		q->arena.entries[q->arena.nentries++].idx = q->props[i].idx;
+	}
+
+	// Values are read as strings so that "raw" is available
+	return prop_arena_fill(&q->arena, q->state, zhp, B_TRUE, failed,
+			       err_errno);
+}
+
+/*
+ * Build "properties" dictionary from q->arena. Arena entries are in the
+ * same order as q->props, less those not valid for the type.
+ */
+static PyObject *
+query_build_props(query_state_t *q, zfs_type_t type)
+{
+	PyObject *out = NULL;
+	size_t i, entry = 0;
+
+	out = PyDict_New();
+	if (out == NULL)
+		return NULL;
+
+	for (i = 0; i < q->nprops; i++) {
+		PyObject *pyprop;
+		int err;
+
+		if (!zfs_prop_valid_for_type(q->props[i].prop, type, B_FALSE))
+			continue;
+
+		pyprop = py_zfs_prop_arena_dict(q->plz, q->state, &q->arena,
+						entry++, q->get_source);
+		if (pyprop == NULL) {
+			Py_DECREF(out);
+			return NULL;
+		}
+
+		err = PyDict_SetItem(out, q->props[i].key, pyprop);
+		Py_DECREF(pyprop);
+		if (err) {
+			Py_DECREF(out);
+			return NULL;
+		}
+	}
+
+	return out;
+}
+
+/*
+ * Build output dictionary for the ZFS handle. GIL and libzfs lock held.
+ * Properties must already have been read by query_read_props().
+ */
+static PyObject *
+query_build_entry(query_state_t *q, zfs_handle_t *zhp)
+{
+	PyObject *out = NULL;
+	zfs_type_t type = zfs_get_type(zhp);
+	PyObject *type_name = NULL;
+	PyObject *type_enum = NULL;
+	int i;
+
+	out = PyDict_New();
+	if (out == NULL)
+		return NULL;
+
+	if (QUERY_FIELD_SELECTED(q, QUERY_FIELD_TYPE) ||
+	    QUERY_FIELD_SELECTED(q, QUERY_FIELD_TYPE_ENUM))
+		type_enum = py_get_zfs_type(q->plz, type, &type_name);
+
+	for (i = 0; i < QUERY_FIELD_COUNT; i++) {
+		PyObject *val = NULL;
+		int err;
+
+		if (!QUERY_FIELD_SELECTED(q, i))
+			continue;
+
+		switch (i) {
+		case QUERY_FIELD_NAME:
+			val = PyUnicode_FromString(zfs_get_name(zhp));
+			break;
+		case QUERY_FIELD_POOL:
+			val = py_zfs_pool_name_str(q->plz,
+						   zfs_get_pool_name(zhp));
+			break;
+		case QUERY_FIELD_TYPE:
+			val = Py_NewRef(type_name);
+			break;
+		case QUERY_FIELD_TYPE_ENUM:
+			val = Py_NewRef(type_enum);
+			break;
+		case QUERY_FIELD_CREATETXG:
+			val = PyLong_FromUnsignedLongLong(
+			    zfs_prop_get_int(zhp, ZFS_PROP_CREATETXG));
+			break;
+		case QUERY_FIELD_GUID:
+			val = PyLong_FromUnsignedLongLong(
+			    zfs_prop_get_int(zhp, ZFS_PROP_GUID));
+			break;
+		case QUERY_FIELD_PROPERTIES:
+			if (q->props_requested)
+				val = query_build_props(q, type);
+			else
+				val = Py_NewRef(Py_None);
+			break;
+		case QUERY_FIELD_USER_PROPERTIES:
+			if (q->get_user_props)
+				val = user_props_nvlist_to_py_dict(
+				    zfs_get_user_props(zhp));
+			else
+				val = Py_NewRef(Py_None);
+			break;
+		}
+
+		if (val == NULL)
+			goto fail;
+
+		err = PyDict_SetItem(out, q->keys[i], val);
+		Py_DECREF(val);
+		if (err)
+			goto fail;
+	}
+
+	Py_XDECREF(type_name);
+	Py_XDECREF(type_enum);
+	return out;
+
+fail:
+	Py_XDECREF(type_name);
+	Py_XDECREF(type_enum);
+	Py_DECREF(out);
+	return NULL;
+}
+
+/*
+ * Write JSON for the ZFS handle into q->jb. Called without the GIL and with
+ * the libzfs lock held. The GIL is only re-acquired to set the exception if
+ * a property can not be read.
+ */
+static int
+query_json_entry(query_state_t *q, zfs_handle_t *zhp)
+{
+	py_json_buf_t *jb = &q->jb;
+	zfs_type_t type = zfs_get_type(zhp);
+	boolean_t first = B_TRUE;
+	boolean_t pfirst;
+	int i, err, err_errno;
+	size_t j;
+
+	if (q->nout++)
+		json_buf_lit(jb, ",");
+	json_buf_lit(jb, "{");
+
+	for (i = 0; i < QUERY_FIELD_COUNT; i++) {
+		if (!QUERY_FIELD_SELECTED(q, i))
+			continue;
+
+		if (!first)
+			json_buf_lit(jb, ",");
+		first = B_FALSE;
+		json_buf_key(jb, query_field_names[i]);
+
+		switch (i) {
+		case QUERY_FIELD_NAME:
+			json_buf_str(jb, zfs_get_name(zhp));
+			break;
+		case QUERY_FIELD_POOL:
+			json_buf_str(jb, zfs_get_pool_name(zhp));
+			break;
+		case QUERY_FIELD_TYPE:
+			json_buf_str(jb, get_dataset_type(type));
+			break;
+		case QUERY_FIELD_TYPE_ENUM:
+			json_buf_u64(jb, type);
+			break;
+		case QUERY_FIELD_CREATETXG:
+			json_buf_u64(jb,
+			    zfs_prop_get_int(zhp, ZFS_PROP_CREATETXG));
+			break;
+		case QUERY_FIELD_GUID:
+			json_buf_u64(jb, zfs_prop_get_int(zhp, ZFS_PROP_GUID));
+			break;
+		case QUERY_FIELD_PROPERTIES:
+			if (!q->props_requested) {
+				json_buf_lit(jb, "null");
+				break;
+			}
+
+			json_buf_lit(jb, "{");
+			pfirst = B_TRUE;
+			for (j = 0; j < q->nprops; j++) {
+				// See query_build_props()
+				if (!zfs_prop_valid_for_type(q->props[j].prop,
+				    type, B_FALSE))
+					continue;
+
+				if (!pfirst)
+					json_buf_lit(jb, ",");
+				pfirst = B_FALSE;
+				json_buf_key(jb, q->props[j].name);
+				err = py_zfs_prop_json_locked(jb, zhp,
+				    q->props[j].prop, q->get_source, B_TRUE,
+				    &err_errno);
+				if (err) {
+					PyEval_RestoreThread(q->_save);
+					py_zfs_prop_json_exc(q->props[j].prop,
+					    type, zfs_get_name(zhp), err,
+					    err_errno);
+					q->_save = PyEval_SaveThread();
+					return ITER_RESULT_ERROR;
+				}
+			}
+			json_buf_lit(jb, "}");
+			break;
+		case QUERY_FIELD_USER_PROPERTIES:
+			if (q->get_user_props)
+				user_props_nvlist_to_json(jb,
+				    zfs_get_user_props(zhp));
+			else
+				json_buf_lit(jb, "null");
+			break;
+		}
+	}
+
+	json_buf_lit(jb, "}");
+	return ITER_RESULT_SUCCESS;
+}
+
+/*
+ * zfs_iter_f callback for the walk. Called without the GIL and with the
+ * libzfs lock held. Takes ownership of (and always closes) zhp.
+ */
+static int
+query_callback(zfs_handle_t *zhp, void *private)
+{
+	query_state_t *q = (query_state_t *)private;
+	zfs_type_t type = zfs_get_type(zhp);
+	int ret = ITER_RESULT_SUCCESS;
+
+	if ((type & q->types) &&
+	    ((q->filter == NULL) || py_zfs_filter_match(q->filter, zhp))) {
+		PyObject *entry = NULL;
+		size_t failed;
+		int err = 0, err_errno;
+
+		if (q->json) {
+			ret = query_json_entry(q, zhp);
+		} else {
+			if (q->props_requested)
+				err = query_read_props(q, zhp, &failed,
+						       &err_errno);
+
+			PyEval_RestoreThread(q->_save);
+			if (err) {
+				prop_arena_exc(&q->arena, q->state, failed,
+					       type, zfs_get_name(zhp),
+					       err_errno);
+			} else {
+				entry = query_build_entry(q, zhp);
+			}
+			if ((entry == NULL) ||
+			    (PyList_Append(q->out, entry) < 0))
+				ret = ITER_RESULT_ERROR;
+			Py_XDECREF(entry);
+			q->_save = PyEval_SaveThread();
+		}
+	}
+
+	if ((ret == ITER_RESULT_SUCCESS) && (type != ZFS_TYPE_SNAPSHOT) &&
+	    (q->types & ZFS_TYPE_SNAPSHOT)) {
+		ret = zfs_iter_snapshots_sorted_v2(zhp, q->flags,
+						   query_callback, q, 0, 0);
+	}
+
+	if ((ret == ITER_RESULT_SUCCESS) && q->recursive &&
+	    (type == ZFS_TYPE_FILESYSTEM)) {
+		ret = zfs_iter_filesystems_v2(zhp, q->flags, query_callback, q);
+	}
+
+	zfs_close(zhp);
+	return ret;
+}
+
+static boolean_t
+query_parse_select(query_state_t *q, PyObject *select)
+{
+	PyObject *iterator = NULL;
+	PyObject *item = NULL;
+
+	if (NULL_OR_NONE(select)) {
+		q->fields = QUERY_FIELDS_ALL;
+		return B_TRUE;
+	}
+
+	if (PyUnicode_Check(select)) {
+		PyErr_SetString(PyExc_TypeError,
+				"select must be an iterable of field names.");
+		return B_FALSE;
+	}
+
+	iterator = PyObject_GetIter(select);
+	if (iterator == NULL)
+		return B_FALSE;
+
+	q->fields = 0;
+	while ((item = PyIter_Next(iterator))) {
+		const char *field;
+		int i;
+
+		field = PyUnicode_Check(item) ? PyUnicode_AsUTF8(item) : NULL;
+		if (field == NULL) {
+			if (!PyErr_Occurred()) {
+				PyErr_Format(PyExc_TypeError,
+					     "%R: field name must be a string.",
+					     item);
+			}
+			Py_DECREF(item);
+			Py_DECREF(iterator);
+			return B_FALSE;
+		}
+
+		for (i = 0; i < QUERY_FIELD_COUNT; i++) {
+			if (strcmp(field, query_field_names[i]) == 0)
+				break;
+		}
+
+		if (i == QUERY_FIELD_COUNT) {
+			PyErr_Format(PyExc_ValueError,
+				     "%s: invalid field name. Expected one of: "
+				     "name, pool, type, type_enum, createtxg, "
+				     "guid, properties, user_properties.", field);
+			Py_DECREF(item);
+			Py_DECREF(iterator);
+			return B_FALSE;
+		}
+
+		q->fields |= (1U << i);
+		Py_DECREF(item);
+	}
+
+	Py_DECREF(iterator);
+	return PyErr_Occurred() ? B_FALSE : B_TRUE;
+}
+
+static boolean_t
+query_parse_props(query_state_t *q, pylibzfs_state_t *state, PyObject *prop_set)
+{
+	py_zfs_prop_selector_t *sel = NULL;
+	size_t i, idx, count;
+
+	if (NULL_OR_NONE(prop_set))
+		return B_TRUE;
+
+	if (!PY_ZFS_PROPS_CHECK(prop_set)) {
+		PyErr_SetString(PyExc_TypeError,
+				"properties must be a set or ZFSPropertySelector.");
+		return B_FALSE;
+	}
+
+	if (PyObject_TypeCheck(prop_set, &ZFSPropertySelector))
+		sel = (py_zfs_prop_selector_t *)prop_set;
+
+	q->props_requested = B_TRUE;
+	q->props = PyMem_Calloc(ARRAY_SIZE(zfs_prop_table), sizeof (query_prop_t));
+	q->arena.entries = PyMem_Calloc(ARRAY_SIZE(zfs_prop_table),
+					sizeof (prop_arena_entry_t));
+	if ((q->props == NULL) || (q->arena.entries == NULL)) {
+		PyErr_NoMemory();
+		return B_FALSE;
+	}
+
+	// Same lookup as py_zfs_get_properties(), but done once per query
+	// rather than once per dataset. A selector already holds the
+	// resolved table indexes.
+	count = sel ? sel->nidx : ARRAY_SIZE(zfs_prop_table);
+	for (i = 0; i < count; i++) {
+		query_prop_t *qp;
+
+		idx = sel ? sel->idx[i] : i;
+		if (sel == NULL) {
+			PyObject *enum_obj = state->zfs_prop_enum_tbl[idx].obj;
+			int rv;
+
+			if (enum_obj == NULL)
+				continue;
+
+			rv = PySet_Contains(prop_set, enum_obj);
+			if (rv == -1)
+				return B_FALSE;
+			else if (rv == 0)
+				continue;
+		}
+
+		qp = &q->props[q->nprops];
+		qp->key = PyUnicode_InternFromString(
+		    state->struct_prop_fields[idx].name);
+		if (qp->key == NULL)
+			return B_FALSE;
+
+		qp->name = state->struct_prop_fields[idx].name;
+		qp->prop = state->zfs_prop_enum_tbl[idx].type;
+		qp->idx = idx;
+		q->nprops++;
+	}
+
+	return B_TRUE;
+}
+
+static void
+query_state_free(query_state_t *q)
+{
+	size_t i;
+
+	for (i = 0; i < QUERY_FIELD_COUNT; i++)
+		Py_CLEAR(q->keys[i]);
+
+	for (i = 0; i < q->nprops; i++)
+		Py_CLEAR(q->props[i].key);
+
+	PyMem_Free(q->props);
+	q->props = NULL;
+	PyMem_Free(q->arena.entries);
+	q->arena.entries = NULL;
+	PyMem_RawFree(q->arena.buf);
+	q->arena.buf = NULL;
+	json_buf_free(&q->jb);
+}
+
+PyObject *py_zfs_do_query(py_zfs_t *plz, py_zfs_query_args_t *args)
+{
+	pylibzfs_state_t *state = py_get_module_state(plz);
+	query_state_t q = (query_state_t) {
+		.plz = plz,
+		.state = state,
+		.types = ZFS_TYPE_FILESYSTEM | ZFS_TYPE_VOLUME,
+		.recursive = args->recursive,
+		.get_source = args->get_source,
+		.get_user_props = args->get_user_properties,
+		.json = args->json,
+	};
+	zfs_handle_t *zhp = NULL;
+	py_zfs_error_t zfs_err;
+	uint64_t op_start;
+	int i, ret;
+
+	if (!NULL_OR_NONE(args->types)) {
+		if (!py_zfs_types_to_mask(state, args->types, &q.types))
+			goto fail;
+
+		if ((q.types & SUPPORTED_RESOURCES) != q.types) {
+			PyErr_SetString(PyExc_ValueError,
+					"types may only contain ZFS_TYPE_FILESYSTEM, "
+					"ZFS_TYPE_VOLUME, and ZFS_TYPE_SNAPSHOT.");
+			goto fail;
+		}
+	}
+
+	if (!NULL_OR_NONE(args->filter)) {
+		if (!PyObject_TypeCheck(args->filter, &ZFSFilter)) {
+			PyErr_SetString(PyExc_TypeError,
+					"filter must be a ZFSFilter object created "
+					"by truenas_pylibzfs.create_filter().");
+			goto fail;
+		}
+		q.filter = (py_zfs_filter_t *)args->filter;
+	}
+
+	if (!query_parse_select(&q, args->select))
+		goto fail;
+
+	if (QUERY_FIELD_SELECTED(&q, QUERY_FIELD_PROPERTIES) &&
+	    !query_parse_props(&q, state, args->properties))
+		goto fail;
+
+	if (!QUERY_FIELD_SELECTED(&q, QUERY_FIELD_USER_PROPERTIES))
+		q.get_user_props = B_FALSE;
+
+	// Property information is not needed for output or filtering and
+	// so we can use the cheaper simple handles.
+	if (!q.props_requested && !q.get_user_props &&
+	    ((q.filter == NULL) || !PY_ZFS_FILTER_NEEDS_PROPS(q.filter)))
+		q.flags |= ZFS_ITER_SIMPLE;
+
+	for (i = 0; i < QUERY_FIELD_COUNT; i++) {
+		q.keys[i] = PyUnicode_InternFromString(query_field_names[i]);
+		if (q.keys[i] == NULL)
+			goto fail;
+	}
+
+	if (q.json) {
+		json_buf_lit(&q.jb, "[");
+	} else {
+		q.out = PyList_New(0);
+		if (q.out == NULL)
+			goto fail;
+	}
+
+	q._save = PyEval_SaveThread();
+	PY_ZFS_LOCK(plz);
+	op_start = py_zfs_stats_now();
+	if (args->root) {
+		zhp = zfs_open(plz->lzh, args->root,
+			       ZFS_TYPE_FILESYSTEM | ZFS_TYPE_VOLUME);
+		if (zhp == NULL) {
+			ret = ITER_RESULT_IOCTL_ERROR;
+		} else {
+			ret = query_callback(zhp, &q);
+		}
+	} else {
+		ret = zfs_iter_root(plz->lzh, query_callback, &q);
+	}
+
+	if (ret == ITER_RESULT_IOCTL_ERROR)
+		py_get_zfs_error(plz->lzh, &zfs_err);
+
+	py_zfs_stats_op(plz, PY_ZFS_OP_ITER, op_start);
+	PY_ZFS_UNLOCK(plz);
+	PyEval_RestoreThread(q._save);
+
+	if (ret == ITER_RESULT_IOCTL_ERROR) {
+		set_exc_from_libzfs(&zfs_err, "ZFS query failed");
+		goto fail;
+	} else if (ret != ITER_RESULT_SUCCESS) {
+		// Python exception set while building result
+		goto fail;
+	}
+
+	if (q.json) {
+		json_buf_lit(&q.jb, "]");
+		q.out = json_buf_to_bytes(&q.jb);
+	}
+
+	query_state_free(&q);
+	return q.out;
+
+fail:
+	query_state_free(&q);
+	Py_XDECREF(q.out);
+	return NULL;
+}
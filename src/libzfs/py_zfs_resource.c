@@ -22,28 +22,74 @@ PyObject *py_repr_zfs_resource(PyObject *self)
 }
 
 PyDoc_STRVAR(py_zfs_resource_refresh_props__doc__,
-"refresh_properties() -> None\n"
+"refresh_properties(*, if_changed=False, max_age=0) -> bool\n"
 "--------------------------------------------------------\n"
 "Refresh the properties for a ZFSResource. ZFS properties may be internally\n"
 "cached in the zfs_handle_t object underlying the python object.\n"
 "Parameters\n"
 "----------\n"
-"None\n\n"
+"if_changed: bool, optional, default=False\n"
+"    Skip the refresh if nothing appears to have changed since the last\n"
+"    refresh done with if_changed=True. Changes are detected through the\n"
+"    write and unlink counters of the objset kstat, the last txg of the\n"
+"    pool that wrote anything and property changes made with this module\n"
+"    (or reported by ZFSEventIterator). Space accounting such as used,\n"
+"    available and usedbychildren, snapshots, and properties set by other\n"
+"    processes are picked up once the pool syncs them. Empty txgs synced\n"
+"    by an idle pool do not count as a change. A dataset is only skipped\n"
+"    after two consecutive refreshes saw no change. State that changes\n"
+"    without writing to the pool, such as the mounted property after\n"
+"    another process mounts or unmounts the filesystem, may be stale.\n"
+"    Filesystems that are not mounted and snapshots are always refreshed.\n\n"
+""
+"max_age: float, optional, default=0\n"
+"    With if_changed=True, refresh anyway if the last refresh is older\n"
+"    than this many seconds. Zero means no limit, which is only suitable\n"
+"    if the properties listed above as possibly stale are not used.\n\n"
 ""
 "Returns\n"
 "-------\n"
-"None\n\n"
+"bool: True if properties were refreshed.\n\n"
 ""
 "Raises\n"
 "------\n"
-"Does not raise an exception.\n"
+"ValueError:\n"
+"    max_age is negative.\n"
 );
 static
-PyObject *py_zfs_resource_refresh_props(PyObject *self, PyObject *args_unused)
+PyObject *py_zfs_resource_refresh_props(PyObject *self,
+					PyObject *args_unused,
+					PyObject *kwargs)
 {
 	py_zfs_resource_t *res = (py_zfs_resource_t *)self;
-	py_zfs_props_refresh(res);
-	Py_RETURN_NONE;
+	int if_changed = B_FALSE;
+	double max_age = 0;
+	boolean_t refreshed;
+
+	char *kwnames [] = { "if_changed", "max_age", NULL };
+
+	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
+					 "|$pd",
+					 kwnames,
+					 &if_changed,
+					 &max_age)) {
+		return NULL;
+	}
+
+	if (!(max_age >= 0)) {
+		PyErr_SetString(PyExc_ValueError,
+				"max_age must not be negative.");
+		return NULL;
+	}
+
+	if (!if_changed) {
+		py_zfs_props_refresh(res);
+		Py_RETURN_TRUE;
+	}
+
+	refreshed = py_zfs_props_refresh_if_changed(res,
+	    (uint64_t)(max_age * 1000000000.0));
+	return PyBool_FromLong(refreshed);
 }
 
 PyDoc_STRVAR(py_zfs_resource_get_mount__doc__,
@@ -92,12 +138,14 @@ PyObject *py_zfs_resource_get_mount(PyObject *self, PyObject *args_unused)
 }
 
 PyDoc_STRVAR(py_zfs_resource_iter_filesystems__doc__,
-"iter_filesystems(*, callback, state, fast=False) -> bool\n\n"
+"iter_filesystems(*, callback, state, fast=False, batch_size=0,\n"
+"                 recursive=False, max_depth=0, order=\"pre\",\n"
+"                 include_snapshots=False, filter=None) -> bool\n"
 "--------------------------------------------------------\n\n"
 "List all child filesystems of this ZFSResource. Arguments are keyword-only\n\n"
 "Parameters\n"
 "----------\n"
-"callback: callable\n"
+"callback: callable, optional\n"
 "    Callback function that will be called for every child dataset.\n\n"
 "state: object, optional\n"
 "    Optional python object (for example dictionary) passed as an argument\n"
@@ -106,11 +154,39 @@ PyDoc_STRVAR(py_zfs_resource_iter_filesystems__doc__,
 "    Optional boolean flag to perform faster filesystem iteration.\n"
 "    The speedup is accomplished by generating simple ZFS dataset handles\n"
 "    that do not contain full property information\n\n"
+"batch_size: int, optional, default=0\n"
+"    If non-zero then the callback function is called with a list of up to\n"
+"    batch_size datasets rather than once per dataset. The GIL and the\n"
+"    libzfs handle lock are toggled once per batch, which significantly\n"
+"    reduces overhead when iterating large numbers of datasets.\n\n"
+"recursive: bool, optional, default=False\n"
+"    Walk the entire dataset tree below this ZFSResource rather than only\n"
+"    the immediate children. The walk is performed in C under a single\n"
+"    acquisition of the libzfs handle lock. May not be combined with\n"
+"    batch_size and requires callback.\n\n"
+"max_depth: int, optional, default=0\n"
+"    Maximum depth of the recursive walk relative to this resource.\n"
+"    Zero means unlimited; one is equivalent to recursive=False.\n\n"
+"order: str, optional, default=\"pre\"\n"
+"    Traversal order of the recursive walk. One of \"pre\" (parents before\n"
+"    children), \"post\" (children before parents), or \"bfs\"\n"
+"    (breadth-first).\n\n"
+"include_snapshots: bool, optional, default=False\n"
+"    Also pass the snapshots of every dataset visited by the recursive walk\n"
+"    to the callback, ordered by transaction group. In \"pre\" and \"bfs\"\n"
+"    order snapshots follow their dataset; in \"post\" order they precede\n"
+"    it.\n\n"
+"filter: truenas_pylibzfs.libzfs_types.ZFSFilter, optional\n"
+"    Filter created by truenas_pylibzfs.create_filter(). Datasets that do\n"
+"    not match are skipped before python objects are created for them.\n"
+"    During a recursive walk the children of non-matching datasets are\n"
+"    still visited.\n\n"
 "Returns\n"
 "-------\n"
-"bool\n"
+"bool or truenas_pylibzfs.ZFSResourceIterator\n"
 "    Value indicates that iteration completed without being stopp by the\n"
-"    callback fuction returning False.\n\n"
+"    callback fuction returning False. If \"callback\" is omitted then an\n"
+"    iterator yielding datasets is returned instead.\n\n"
 "Raises:\n"
 "-------\n"
 "truenas_pylibzfs.ZFSError:\n"
@@ -121,7 +197,10 @@ PyDoc_STRVAR(py_zfs_resource_iter_filesystems__doc__,
 "Minimally the function signature must take a single argument for each ZFS\n"
 "object. If the \"state\" keyword is specified then the callback function\n"
 "should take two arguments. The callback function must return bool value\n"
-"indicating whether iteration should continue.\n\n"
+"indicating whether iteration should continue. If \"batch_size\" is\n"
+"specified then the first argument is a list of datasets. If\n"
+"\"include_snapshots\" is specified then the callback is also called with\n"
+"snapshots.\n\n"
 "Example \"callback\":\n"
 "-------------------\n"
 "def my_callback(ds, state):\n"
@@ -134,45 +213,115 @@ PyObject *py_zfs_resource_iter_filesystems(PyObject *self,
 					   PyObject *kwargs)
 {
 	int err;
+	Py_ssize_t batch_size = 0;
 	py_zfs_resource_t *rsrc = (py_zfs_resource_t *)self;
 	py_zfs_obj_t *obj = &rsrc->obj;
+	PyObject *py_name = NULL;
 
 	py_iter_state_t iter_state = (py_iter_state_t){
 		.pylibzfsp = obj->pylibzfsp,
 		.target = obj->zhp
 	};
 	int simple_handle = 0;
+	int recursive = 0;
+	int max_depth = 0;
+	int include_snapshots = 0;
+	const char *order = NULL;
+	PyObject *py_filter = NULL;
 
 	char *kwnames [] = {
 		"callback",
 		"state",
 		"fast",
+		"batch_size",
+		"recursive",
+		"max_depth",
+		"order",
+		"include_snapshots",
+		"filter",
 		NULL
 	};
 
 	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
-					 "|$OOp",
+					 "|$OOpnpispO",
 					 kwnames,
 					 &iter_state.callback_fn,
 					 &iter_state.private_data,
-					 &simple_handle)) {
+					 &simple_handle,
+					 &batch_size,
+					 &recursive,
+					 &max_depth,
+					 &order,
+					 &include_snapshots,
+					 &py_filter)) {
 		return NULL;
 	}
 
-	if (!iter_state.callback_fn) {
-		PyErr_SetString(PyExc_ValueError,
-				"`callback` keyword argument is required.");
+	if (iter_state.callback_fn == NULL) {
+		// No callback means caller wants a ZFSResourceIterator
+		if ((iter_state.private_data != NULL) || batch_size) {
+			PyErr_SetString(PyExc_ValueError,
+					"`state` and `batch_size` require a "
+					"`callback` keyword argument.");
+			return NULL;
+		}
+	} else if (!PyCallable_Check(iter_state.callback_fn)) {
+		PyErr_SetString(PyExc_TypeError,
+				"callback function must be callable.");
 		return NULL;
 	}
 
-	if (!PyCallable_Check(iter_state.callback_fn)) {
-		PyErr_SetString(PyExc_TypeError,
-				"callback function must be callable.");
+	if (py_iter_set_batch_size(&iter_state, batch_size) < 0)
+		return NULL;
+
+	if (py_iter_set_filter(&iter_state, py_filter, simple_handle) < 0)
 		return NULL;
+
+	if (!recursive && (max_depth || order || include_snapshots)) {
+		PyErr_SetString(PyExc_ValueError,
+				"`max_depth`, `order`, and `include_snapshots` "
+				"require recursive=True.");
+		return NULL;
+	}
+
+	if (recursive) {
+		iter_conf_filesystem_t *conf = &iter_state.iter_config.filesystem;
+
+		if ((iter_state.callback_fn == NULL) || batch_size) {
+			PyErr_SetString(PyExc_ValueError,
+					"recursive iteration requires `callback` "
+					"and may not be combined with `batch_size`.");
+			return NULL;
+		}
+
+		if (max_depth < 0) {
+			PyErr_SetString(PyExc_ValueError,
+					"max_depth must be a non-negative integer.");
+			return NULL;
+		}
+
+		if ((order == NULL) || (strcmp(order, "pre") == 0)) {
+			conf->order = ITER_ORDER_PRE;
+		} else if (strcmp(order, "post") == 0) {
+			conf->order = ITER_ORDER_POST;
+		} else if (strcmp(order, "bfs") == 0) {
+			conf->order = ITER_ORDER_BFS;
+		} else {
+			PyErr_Format(PyExc_ValueError,
+				     "%s: invalid order. Expected one of "
+				     "\"pre\", \"post\", or \"bfs\".", order);
+			return NULL;
+		}
+
+		conf->max_depth = (uint_t)max_depth;
+		conf->snapshots = include_snapshots ? B_TRUE : B_FALSE;
 	}
 
-	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSResource.iter_filesystems",
-			"OO", obj->name, kwargs) < 0) {
+	py_name = py_zfs_obj_name_ref(obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSResource.iter_filesystems",
+			  "OO", py_name, kwargs);
+	Py_DECREF(py_name);
+	if (err < 0) {
 		return NULL;
 	}
 
@@ -180,7 +329,15 @@ PyObject *py_zfs_resource_iter_filesystems(PyObject *self,
 		iter_state.iter_config.filesystem.flags |= ZFS_ITER_SIMPLE;
 	}
 
-	err = py_iter_filesystems(&iter_state);
+	if (iter_state.callback_fn == NULL) {
+		return py_zfs_resource_iter_create(&iter_state, self,
+						   PY_ITER_FILESYSTEMS);
+	}
+
+	if (recursive)
+		err = py_iter_filesystems_recursive(&iter_state);
+	else
+		err = py_iter_filesystems(&iter_state);
 	if ((err == ITER_RESULT_ERROR) || (err == ITER_RESULT_IOCTL_ERROR)) {
 		// Exception is set by callback function
 		return NULL;
@@ -197,12 +354,13 @@ PyDoc_STRVAR(py_zfs_resource_iter_snapshots__doc__,
 "iter_snapshots(*, callback, state, fast=False,\n"
 "               min_transaction_group=0,\n"
 "               max_transaction_group=0,\n"
-"               order_by_transaction_group=False) -> bool\n"
+"               order_by_transaction_group=False,\n"
+"               batch_size=0, filter=None) -> bool\n"
 "--------------------------------------------------------\n\n"
 "List all snapshots of this ZFSResource. Arguments are keyword-only\n\n"
 "Parameters\n"
 "----------\n"
-"callback: callable\n"
+"callback: callable, optional\n"
 "    Callback function that will be called for every child dataset.\n\n"
 "state: object, optional\n"
 "    Optional python object (for example dictionary) passed as an argument\n"
@@ -218,11 +376,18 @@ PyDoc_STRVAR(py_zfs_resource_iter_snapshots__doc__,
 "order_by_transaction_group: bool, optional, default=False\n"
 "    Pre-sort the snapshots by transaction group prior to calling\n"
 "    the specified callback function\n\n"
+"batch_size: int, optional, default=0\n"
+"    If non-zero then the callback function is called with a list of up to\n"
+"    batch_size snapshots rather than once per snapshot.\n\n"
+"filter: truenas_pylibzfs.libzfs_types.ZFSFilter, optional\n"
+"    Filter created by truenas_pylibzfs.create_filter(). Snapshots that do\n"
+"    not match are skipped before python objects are created for them.\n\n"
 "Returns\n"
 "-------\n"
-"bool\n"
+"bool or truenas_pylibzfs.ZFSResourceIterator\n"
 "    Value indicates that iteration completed without being stopped by the\n"
-"    callback fuction returning False.\n\n"
+"    callback fuction returning False. If \"callback\" is omitted then an\n"
+"    iterator yielding snapshots is returned instead.\n\n"
 "Raises:\n"
 "-------\n"
 "truenas_pylibzfs.ZFSError:\n"
@@ -233,7 +398,8 @@ PyDoc_STRVAR(py_zfs_resource_iter_snapshots__doc__,
 "Minimally the function signature must take a single argument for each ZFS\n"
 "object. If the \"state\" keyword is specified then the callback function\n"
 "should take two arguments. The callback function must return bool value\n"
-"indicating whether iteration should continue.\n\n"
+"indicating whether iteration should continue. If \"batch_size\" is\n"
+"specified then the first argument is a list of snapshots.\n\n"
 "Example \"callback\":\n"
 "-------------------\n"
 "def my_callback(ds, state):\n"
@@ -246,9 +412,12 @@ PyObject *py_zfs_resource_iter_snapshots(PyObject *self,
 					 PyObject *kwargs)
 {
 	int err;
+	Py_ssize_t batch_size = 0;
 	py_zfs_resource_t *rsrc = (py_zfs_resource_t *)self;
 	py_zfs_obj_t *obj = &rsrc->obj;
 	boolean_t simple_handle = B_FALSE;
+	PyObject *py_filter = NULL;
+	PyObject *py_name = NULL;
 
 	py_iter_state_t iter_state = (py_iter_state_t){
 		.pylibzfsp = obj->pylibzfsp,
@@ -262,35 +431,50 @@ PyObject *py_zfs_resource_iter_snapshots(PyObject *self,
 		"min_transaction_group",
 		"max_transaction_group",
 		"order_by_transaction_group",
+		"batch_size",
+		"filter",
 		NULL
 	};
 
 	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
-					 "|$OOpkkp",
+					 "|$OOpkkpnO",
 					 kwnames,
 					 &iter_state.callback_fn,
 					 &iter_state.private_data,
 					 &simple_handle,
 					 &iter_state.iter_config.snapshot.min_txg,
 					 &iter_state.iter_config.snapshot.max_txg,
-					 &iter_state.iter_config.snapshot.sorted)) {
+					 &iter_state.iter_config.snapshot.sorted,
+					 &batch_size,
+					 &py_filter)) {
 		return NULL;
 	}
 
-	if (!iter_state.callback_fn) {
-		PyErr_SetString(PyExc_ValueError,
-				"`callback` keyword argument is required.");
-		return NULL;
-	}
-
-	if (!PyCallable_Check(iter_state.callback_fn)) {
+	if (iter_state.callback_fn == NULL) {
+		// No callback means caller wants a ZFSResourceIterator
+		if ((iter_state.private_data != NULL) || batch_size) {
+			PyErr_SetString(PyExc_ValueError,
+					"`state` and `batch_size` require a "
+					"`callback` keyword argument.");
+			return NULL;
+		}
+	} else if (!PyCallable_Check(iter_state.callback_fn)) {
 		PyErr_SetString(PyExc_TypeError,
 				"callback function must be callable.");
 		return NULL;
 	}
 
-	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSResource.iter_snapshots",
-			"OO", obj->name, kwargs) < 0) {
+	if (py_iter_set_batch_size(&iter_state, batch_size) < 0)
+		return NULL;
+
+	if (py_iter_set_filter(&iter_state, py_filter, simple_handle) < 0)
+		return NULL;
+
+	py_name = py_zfs_obj_name_ref(obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSResource.iter_snapshots",
+			  "OO", py_name, kwargs);
+	Py_DECREF(py_name);
+	if (err < 0) {
 		return NULL;
 	}
 
@@ -298,6 +482,11 @@ PyObject *py_zfs_resource_iter_snapshots(PyObject *self,
 		iter_state.iter_config.filesystem.flags |= ZFS_ITER_SIMPLE;
 	}
 
+	if (iter_state.callback_fn == NULL) {
+		return py_zfs_resource_iter_create(&iter_state, self,
+						   PY_ITER_SNAPSHOTS);
+	}
+
 	err = py_iter_snapshots(&iter_state);
 	if ((err == ITER_RESULT_ERROR) || (err == ITER_RESULT_IOCTL_ERROR)) {
 		// Exception is set by callback function
@@ -311,19 +500,240 @@ PyObject *py_zfs_resource_iter_snapshots(PyObject *self,
 	Py_RETURN_FALSE;
 }
 
+PyDoc_STRVAR(py_zfs_resource_list_filesystem_names__doc__,
+"list_filesystem_names(*, recursive=False) -> tuple[str, ...]\n"
+"------------------------------------------------------------\n\n"
+"Return the names of the child filesystems and volumes of this\n"
+"ZFSResource. This is considerably cheaper than iter_filesystems() when\n"
+"only names are required since no ZFS objects are created.\n\n"
+"Parameters\n"
+"----------\n"
+"recursive: bool, optional, default=False\n"
+"    Include all descendants rather than only the immediate children.\n"
+"    Parents are listed before their children.\n\n"
+"Returns\n"
+"-------\n"
+"tuple of str\n\n"
+"Raises:\n"
+"-------\n"
+"truenas_pylibzfs.ZFSError:\n"
+"    An error occurred during iteration of the dataset.\n"
+);
+static
+PyObject *py_zfs_resource_list_filesystem_names(PyObject *self,
+						PyObject *args_unused,
+						PyObject *kwargs)
+{
+	py_zfs_resource_t *rsrc = (py_zfs_resource_t *)self;
+	py_zfs_obj_t *obj = &rsrc->obj;
+	int recursive = 0;
+	PyObject *py_name = NULL;
+	int err;
+
+	py_iter_state_t iter_state = (py_iter_state_t){
+		.pylibzfsp = obj->pylibzfsp,
+		.target = obj->zhp
+	};
+
+	char *kwnames [] = { "recursive", NULL };
+
+	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
+					 "|$p",
+					 kwnames,
+					 &recursive)) {
+		return NULL;
+	}
+
+	py_name = py_zfs_obj_name_ref(obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSResource.list_filesystem_names",
+			  "OO", py_name, kwargs ? kwargs : Py_None);
+	Py_DECREF(py_name);
+	if (err < 0) {
+		return NULL;
+	}
+
+	return py_iter_names(&iter_state, B_FALSE, recursive, B_FALSE);
+}
+
+PyDoc_STRVAR(py_zfs_resource_list_snapshot_names__doc__,
+"list_snapshot_names(*, recursive=False, min_transaction_group=0,\n"
+"                    max_transaction_group=0,\n"
+"                    order_by_transaction_group=False,\n"
+"                    get_createtxg=False) -> tuple\n"
+"--------------------------------------------------------------\n\n"
+"Return the names of the snapshots of this ZFSResource. This is\n"
+"considerably cheaper than iter_snapshots() when only names are required\n"
+"since no ZFSSnapshot objects are created.\n\n"
+"Parameters\n"
+"----------\n"
+"recursive: bool, optional, default=False\n"
+"    Also include the snapshots of all descendant filesystems and volumes.\n\n"
+"min_transaction_group: int, optional\n"
+"    Only include snapshots newer than the specified transaction group\n\n"
+"max_transaction_group: int, optional\n"
+"    Only include snapshots older than the specified transaction group\n\n"
+"order_by_transaction_group: bool, optional, default=False\n"
+"    Sort the snapshots of each dataset by transaction group.\n\n"
+"get_createtxg: bool, optional, default=False\n"
+"    Also return the createtxg of each snapshot.\n\n"
+"Returns\n"
+"-------\n"
+"tuple of str, or if get_createtxg is set a tuple of two equal-length\n"
+"tuples: (names, createtxgs).\n\n"
+"Raises:\n"
+"-------\n"
+"truenas_pylibzfs.ZFSError:\n"
+"    An error occurred during iteration of the dataset.\n"
+);
+static
+PyObject *py_zfs_resource_list_snapshot_names(PyObject *self,
+					      PyObject *args_unused,
+					      PyObject *kwargs)
+{
+	py_zfs_resource_t *rsrc = (py_zfs_resource_t *)self;
+	py_zfs_obj_t *obj = &rsrc->obj;
+	int recursive = 0;
+	int get_createtxg = 0;
+	PyObject *py_name = NULL;
+	int err;
+
+	py_iter_state_t iter_state = (py_iter_state_t){
+		.pylibzfsp = obj->pylibzfsp,
+		.target = obj->zhp
+	};
+
+	char *kwnames [] = {
+		"recursive",
+		"min_transaction_group",
+		"max_transaction_group",
+		"order_by_transaction_group",
+		"get_createtxg",
+		NULL
+	};
+
+	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
+					 "|$pkkpp",
+					 kwnames,
+					 &recursive,
+					 &iter_state.iter_config.snapshot.min_txg,
+					 &iter_state.iter_config.snapshot.max_txg,
+					 &iter_state.iter_config.snapshot.sorted,
+					 &get_createtxg)) {
+		return NULL;
+	}
+
+	py_name = py_zfs_obj_name_ref(obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSResource.list_snapshot_names",
+			  "OO", py_name, kwargs ? kwargs : Py_None);
+	Py_DECREF(py_name);
+	if (err < 0) {
+		return NULL;
+	}
+
+	return py_iter_names(&iter_state, B_TRUE, recursive, get_createtxg);
+}
+
+PyDoc_STRVAR(py_zfs_resource_space_summary__doc__,
+"space_summary(*, recursive=True, include_snapshots=True) -> dict\n"
+"----------------------------------------------------------------\n\n"
+"Return aggregated space accounting for this filesystem or volume and its\n"
+"descendants. Properties are read and summed in C while walking the tree\n"
+"and no ZFS objects are created for the descendants. The properties of\n"
+"this ZFSResource are refreshed as a side effect.\n\n"
+"Parameters\n"
+"----------\n"
+"recursive: bool, optional, default=True\n"
+"    Include all descendants. If False then only this dataset is\n"
+"    summarized.\n\n"
+"include_snapshots: bool, optional, default=True\n"
+"    Count the snapshots of each dataset. If False the snapshots field is\n"
+"    zero, and no snapshot iteration is performed.\n\n"
+"Returns\n"
+"-------\n"
+"dict mapping dataset name to truenas_pylibzfs.struct_zfs_space_summary\n"
+"for the subtree rooted at that dataset. Parents are listed before their\n"
+"children. The entry for this ZFSResource covers the entire walk.\n\n"
+"Raises:\n"
+"-------\n"
+"ValueError:\n"
+"    This ZFSResource is a snapshot.\n\n"
+"truenas_pylibzfs.ZFSError:\n"
+"    An error occurred during iteration of the dataset.\n"
+);
+static
+PyObject *py_zfs_resource_space_summary(PyObject *self,
+					PyObject *args_unused,
+					PyObject *kwargs)
+{
+	py_zfs_resource_t *rsrc = (py_zfs_resource_t *)self;
+	py_zfs_obj_t *obj = &rsrc->obj;
+	int recursive = 1;
+	int include_snapshots = 1;
+	PyObject *py_name = NULL;
+	int err;
+
+	py_iter_state_t iter_state = (py_iter_state_t){
+		.pylibzfsp = obj->pylibzfsp,
+		.target = obj->zhp
+	};
+
+	char *kwnames [] = { "recursive", "include_snapshots", NULL };
+
+	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
+					 "|$pp",
+					 kwnames,
+					 &recursive,
+					 &include_snapshots)) {
+		return NULL;
+	}
+
+	if (obj->ctype == ZFS_TYPE_SNAPSHOT) {
+		PyErr_SetString(PyExc_ValueError,
+				"space_summary() is not supported for "
+				"snapshots.");
+		return NULL;
+	}
+
+	py_name = py_zfs_obj_name_ref(obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSResource.space_summary",
+			  "OO", py_name, kwargs ? kwargs : Py_None);
+	Py_DECREF(py_name);
+	if (err < 0) {
+		return NULL;
+	}
+
+	// Handle may be simple or have been opened long ago. Refresh so that
+	// values for this dataset are consistent with its descendants.
+	py_zfs_props_refresh(rsrc);
+
+	return py_iter_space_summary(&iter_state, recursive, include_snapshots);
+}
+
 PyDoc_STRVAR(py_zfs_resource_get_properties__doc__,
-"get_properties(*, properties, get_source=False) -> "
+"get_properties(*, properties, get_source=False, raw=True, lazy=False) -> "
 "truenas_pylibzfs.struct_zfs_property\n\n"
 "-----------------------------------------------------\n\n"
 "Get the specified properties of a given ZFS resource.\n\n"
 ""
 "Parameters\n"
 "----------\n"
-"properties: set, required\n"
-"    Set of truenas_pylibzfs.ZFSProperty properties to retrieve.\n\n"
+"properties: set | truenas_pylibzfs.ZFSPropertySelector, required\n"
+"    Set of truenas_pylibzfs.ZFSProperty properties to retrieve, or a\n"
+"    selector created by truenas_pylibzfs.create_property_selector().\n\n"
 "get_source: bool, optional, default=False\n"
 "    Non-default option to retrieve the source information for the returned\n"
 "    propeties.\n\n"
+"raw: bool, optional, default=True\n"
+"    If False then numeric properties (for example used, available,\n"
+"    referenced, quota) are read as integers directly rather than being\n"
+"    formatted to a string and parsed back. The `raw` member of those\n"
+"    properties is None in this case.\n\n"
+"lazy: bool, optional, default=False\n"
+"    Return a truenas_pylibzfs.ZFSPropertyView instead. Its attributes are\n"
+"    the same as those of struct_zfs_property, but each requested property\n"
+"    is only read when its attribute is first accessed. Errors (including\n"
+"    ValueError for properties invalid for the resource type) are raised on\n"
+"    attribute access rather than by this method.\n\n"
 ""
 "Returns\n"
 "-------\n"
@@ -332,6 +742,8 @@ PyDoc_STRVAR(py_zfs_resource_get_properties__doc__,
 "    The requested properties will be represented by truenas_pylibzfs.struct_zfs_property_data\n"
 "    objects under the respective attributes. Properties that were not\n"
 "    requested will be set to None type.\n\n"
+"truenas_pylibzfs.ZFSPropertyView\n"
+"    If lazy=True.\n\n"
 ""
 "Raises:\n"
 "-------\n"
@@ -354,17 +766,23 @@ PyObject *py_zfs_resource_get_properties(PyObject *self,
 	py_zfs_resource_t *res = (py_zfs_resource_t *)self;
 	PyObject *prop_set = NULL;
 	boolean_t get_source = B_FALSE;
+	boolean_t get_raw = B_TRUE;
+	boolean_t lazy = B_FALSE;
 	char *kwnames [] = {
 		"properties",
 		"get_source",
+		"raw",
+		"lazy",
 		NULL
 	};
 
 	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
-					 "|$Op",
+					 "|$Oppp",
 					 kwnames,
 					 &prop_set,
-					 &get_source)) {
+					 &get_source,
+					 &get_raw,
+					 &lazy)) {
 					 return NULL;
 	}
 	if (prop_set == NULL) {
@@ -372,22 +790,21 @@ PyObject *py_zfs_resource_get_properties(PyObject *self,
 				"properties keyword is required.");
 		return NULL;
 	}
-	if (!PyAnySet_Check(prop_set)) {
+	if (!PY_ZFS_PROPS_CHECK(prop_set)) {
 		PyErr_SetString(PyExc_TypeError,
-				"properties must be a python set.");
+				"properties must be a python set or "
+				"ZFSPropertySelector.");
 		return NULL;
 	}
 
-	if (res->is_simple) {
-		/*
-		 * We have simple handle that lacks property information.
-		 * This means we _must_ refresh properties before
-		 * generating python object
-		 */
-		py_zfs_props_refresh(res);
+	if (lazy) {
+		// handle is refreshed on first attribute access if needed
+		return py_zfs_get_properties_lazy(res, prop_set, get_source,
+						  get_raw);
 	}
 
-	return py_zfs_get_properties(&res->obj, prop_set, get_source);
+	// simple handles are refreshed by py_zfs_get_properties() if needed
+	return py_zfs_get_properties(res, prop_set, get_source, get_raw);
 }
 
 PyDoc_STRVAR(py_zfs_resource_set_properties__doc__,
@@ -432,16 +849,16 @@ PyObject *py_zfs_resource_set_properties(PyObject *self,
 					 PyObject *args_unused,
 					 PyObject *kwargs)
 {
-	static const char *volsz = NULL;
 	py_zfs_resource_t *res = (py_zfs_resource_t *)self;
 	nvlist_t *nvl = NULL;
-	const char *cval = NULL;
 	PyObject *propsdict = NULL;
 	char *json_str = NULL;
 	pylibzfs_state_t *state = NULL;
 	boolean_t remount = B_TRUE;
 	py_zfs_error_t zfs_err;
+	uint64_t op_start;
 	int err;
+	PyObject *py_name = NULL;
 
 	char *kwnames [] = {
 		"properties",
@@ -449,9 +866,6 @@ PyObject *py_zfs_resource_set_properties(PyObject *self,
 		NULL
 	};
 
-	if (volsz == NULL)
-		volsz = zfs_prop_to_name(ZFS_PROP_VOLSIZE);
-
 	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
 					 "|$Op",
 					 kwnames,
@@ -476,43 +890,30 @@ PyObject *py_zfs_resource_set_properties(PyObject *self,
 	if (nvl == NULL)
 		return NULL;
 
-	if (PySys_Audit(PYLIBZFS_MODULE_NAME
-			".ZFSResource.set_properties", "OO",
-			res->obj.name, kwargs) < 0) {
+	py_name = py_zfs_obj_name_ref(&res->obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME
+			  ".ZFSResource.set_properties", "OO",
+			  py_name, kwargs);
+	Py_DECREF(py_name);
+	if (err < 0) {
 		fnvlist_free(nvl);
 		return NULL;
 	}
 
 	Py_BEGIN_ALLOW_THREADS
 	PY_ZFS_LOCK(res->obj.pylibzfsp);
+	py_zfs_prop_drop_unchanged_volsize(res->obj.zhp, nvl);
 
-	/*
-	 * Sometimes API users will set all ZFS properties in a request.
-	 * If we include the volsize property on a readonly dataset, this
-	 * will cause spurious failures with EZFS_DSREADONLY. So we have
-	 * some logic here to pop that key out of payload if it matches
-	 * what's already on disk.
-	 */
-	if ((res->obj.ctype == ZFS_TYPE_VOLUME) &&
-	    nvlist_lookup_string(nvl, volsz, &cval) == 0) {
-		// propsize present in nvl payload. This property is problematic
-		// because it can't be set when zvol is readonly
-		char vsz[ZFS_MAXPROPLEN];
-
-		if (zfs_prop_get(res->obj.zhp, ZFS_PROP_VOLSIZE,
-		    vsz, sizeof(vsz), NULL, NULL, 0, B_TRUE) == 0) {
-			if (strcmp(vsz, cval) == 0) {
-				//propsize hasn't changed so let's just remove it
-				fnvlist_remove(nvl, volsz);
-			}
-		}
-	}
-
+	op_start = py_zfs_stats_now();
 	err = zfs_prop_set_list_flags(res->obj.zhp,
 				      nvl,
 				      remount ? 0 : ZFS_SET_NOMOUNT);
+	py_zfs_stats_op(res->obj.pylibzfsp, PY_ZFS_OP_PROP_SET, op_start);
 	if (err) {
 		py_get_zfs_error(res->obj.pylibzfsp->lzh, &zfs_err);
+	} else {
+		py_zfs_prop_cache_invalidate(res->obj.pylibzfsp,
+					     zfs_get_name(res->obj.zhp));
 	}
 
 	PY_ZFS_UNLOCK(res->obj.pylibzfsp);
@@ -595,6 +996,7 @@ PyObject *py_zfs_resource_inherit_property(PyObject *self,
 	py_zfs_error_t zfs_err;
 	pylibzfs_state_t *state = NULL;
 	int err;
+	PyObject *py_name = NULL;
 
 	char *kwnames [] = {
 		"property",
@@ -633,9 +1035,12 @@ PyObject *py_zfs_resource_inherit_property(PyObject *self,
 		cprop = zfs_prop_to_name(zprop);
 	}
 
-	if (PySys_Audit(PYLIBZFS_MODULE_NAME
-			".ZFSResource.inherit_property", "OO",
-			res->obj.name, kwargs) < 0) {
+	py_name = py_zfs_obj_name_ref(&res->obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME
+			  ".ZFSResource.inherit_property", "OO",
+			  py_name, kwargs);
+	Py_DECREF(py_name);
+	if (err < 0) {
 		return NULL;
 	}
 
@@ -644,6 +1049,9 @@ PyObject *py_zfs_resource_inherit_property(PyObject *self,
 	err = zfs_prop_inherit(res->obj.zhp, cprop, received);
 	if (err) {
 		py_get_zfs_error(res->obj.pylibzfsp->lzh, &zfs_err);
+	} else {
+		py_zfs_prop_cache_invalidate(res->obj.pylibzfsp,
+					     zfs_get_name(res->obj.zhp));
 	}
 	PY_ZFS_UNLOCK(res->obj.pylibzfsp);
 	Py_END_ALLOW_THREADS
@@ -739,7 +1147,9 @@ PyObject *py_zfs_resource_set_user_properties(PyObject *self,
 	PyObject *props_dict = NULL;
 	char *json_str = NULL;
 	nvlist_t *nvl;
+	uint64_t op_start;
 	int err;
+	PyObject *py_name = NULL;
 
 	char *kwnames [] = {
 		"user_properties",
@@ -770,14 +1180,19 @@ PyObject *py_zfs_resource_set_user_properties(PyObject *self,
 	if (nvl == NULL)
 		return NULL;
 
-	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSObject.set_user_propeties",
-			"OO", res->obj.name, kwargs) < 0) {
+	py_name = py_zfs_obj_name_ref(&res->obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME ".ZFSObject.set_user_propeties",
+			  "OO", py_name, kwargs);
+	Py_DECREF(py_name);
+	if (err < 0) {
 		return NULL;
 	}
 
 	Py_BEGIN_ALLOW_THREADS
 	PY_ZFS_LOCK(res->obj.pylibzfsp);
+	op_start = py_zfs_stats_now();
 	err = zfs_prop_set_list(res->obj.zhp, nvl);
+	py_zfs_stats_op(res->obj.pylibzfsp, PY_ZFS_OP_PROP_SET, op_start);
 	if (err)
 		py_get_zfs_error(res->obj.pylibzfsp->lzh, &zfs_err);
 
@@ -818,14 +1233,15 @@ PyObject *py_zfs_resource_set_user_properties(PyObject *self,
 
 PyDoc_STRVAR(py_zfs_resource_asdict__doc__,
 "asdict(*, properties, get_source=False, get_user_properties=False,\n"
-"       get_crypto=False) -> dict\n\n"
+"       get_crypto=False, raw=True) -> dict\n\n"
 "------------------------------------------------------------------\n\n"
 "Get the specified properties of a given ZFS resource.\n\n"
 ""
 "Parameters\n"
 "----------\n"
-"properties: set, optional\n"
-"    Set of truenas_pylibzfs.ZFSProperty properties to retrieve.\n\n"
+"properties: set | truenas_pylibzfs.ZFSPropertySelector, optional\n"
+"    Set of truenas_pylibzfs.ZFSProperty properties to retrieve, or a\n"
+"    selector created by truenas_pylibzfs.create_property_selector().\n\n"
 "get_source: bool, optional, default=False\n"
 "    Non-default option to retrieve the source information for the returned\n"
 "    propeties.\n\n"
@@ -833,6 +1249,11 @@ PyDoc_STRVAR(py_zfs_resource_asdict__doc__,
 "    Non-default option to retrieve user properties.\n\n"
 "get_crypto: bool, optional, default=False\n"
 "    Non-default option to include encryption-related information.\n\n"
+"raw: bool, optional, default=True\n"
+"    If False then numeric properties (for example used, available,\n"
+"    referenced, quota) are read as integers directly rather than being\n"
+"    formatted to a string and parsed back. The `raw` member of those\n"
+"    properties is None in this case.\n\n"
 ""
 "Returns\n"
 "-------\n"
@@ -870,52 +1291,45 @@ PyObject *py_zfs_resource_asdict(PyObject *self,
 	PyObject *props_dict = NULL;
 	PyObject *userprops = NULL;
 	PyObject *crypto = NULL;
+	PyObject *py_name = NULL;
 	PyObject *out = NULL;
 	boolean_t get_source = B_FALSE;
 	boolean_t get_userprops = B_FALSE;
 	boolean_t get_crypto = B_FALSE;
+	boolean_t get_raw = B_TRUE;
 	char *kwnames [] = {
 		"properties",
 		"get_source",
 		"get_user_properties",
 		"get_crypto",
+		"raw",
 		NULL
 	};
 
 	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
-					 "|$Oppp",
+					 "|$Opppp",
 					 kwnames,
 					 &prop_set,
 					 &get_source,
 					 &get_userprops,
-					 &get_crypto)) {
+					 &get_crypto,
+					 &get_raw)) {
 		return NULL;
 	}
 
 	if ((prop_set != NULL) && (prop_set != Py_None)) {
 		PyObject *zfsprops = NULL;
 
-		if (!PyAnySet_Check(prop_set)) {
+		if (!PY_ZFS_PROPS_CHECK(prop_set)) {
 			PyErr_SetString(PyExc_TypeError,
-					"properties must be a set.");
+					"properties must be a set or "
+					"ZFSPropertySelector.");
 			return NULL;
 		}
 
-		if (res->is_simple) {
-			/*
-			 * We have simple handle that lacks property information.
-			 * This means we _must_ refresh properties before
-			 * generating python object
-			 */
-			Py_BEGIN_ALLOW_THREADS
-			PY_ZFS_LOCK(res->obj.pylibzfsp);
-			zfs_refresh_properties(res->obj.zhp);
-			PY_ZFS_UNLOCK(res->obj.pylibzfsp);
-			res->is_simple = B_FALSE;
-			Py_END_ALLOW_THREADS
-		}
-
-		zfsprops = py_zfs_get_properties(&res->obj, prop_set, get_source);
+		// simple handles are refreshed by py_zfs_get_properties() if needed
+		zfsprops = py_zfs_get_properties(res, prop_set, get_source,
+						 get_raw);
 		if (zfsprops == NULL)
 			return NULL;
 
@@ -942,9 +1356,10 @@ PyObject *py_zfs_resource_asdict(PyObject *self,
 		}
 	}
 
+	py_name = py_zfs_obj_name_ref(&res->obj);
 	out = Py_BuildValue(
 		"{s:O,s:O,s:O,s:O,s:O,s:O,s:O,s:O,s:O}",
-		"name", res->obj.name,
+		"name", py_name,
 		"pool", res->obj.pool_name,
 		"type", res->obj.type,
 		"type_enum", res->obj.type_enum,
@@ -955,12 +1370,215 @@ PyObject *py_zfs_resource_asdict(PyObject *self,
 		"crypto", crypto ? crypto : Py_None
 	);
 
+	Py_DECREF(py_name);
 	Py_XDECREF(props_dict);
 	Py_XDECREF(userprops);
 	Py_XDECREF(crypto);
 	return out;
 }
 
+PyDoc_STRVAR(py_zfs_resource_asdict_json__doc__,
+"asdict_json(*, properties, get_source=False, get_user_properties=False,\n"
+"            get_crypto=False, raw=True) -> bytes\n\n"
+"-----------------------------------------------------------------------\n\n"
+"Same as asdict() except that the result is returned as UTF-8 encoded\n"
+"JSON. The JSON is written directly from libzfs data while the libzfs\n"
+"handle lock is held, without creating the intermediate python objects.\n\n"
+""
+"Parameters\n"
+"----------\n"
+"Same as asdict().\n\n"
+""
+"Returns\n"
+"-------\n"
+"bytes containing a compact JSON object equal to json.dumps() of the\n"
+"dictionary returned by asdict(). Enums (type_enum, property source type)\n"
+"are written as their integer values.\n\n"
+""
+"Raises:\n"
+"-------\n"
+"Same as asdict().\n"
+);
+static
+PyObject *py_zfs_resource_asdict_json(PyObject *self,
+				      PyObject *args_unused,
+				      PyObject *kwargs)
+{
+	py_zfs_resource_t *res = (py_zfs_resource_t *)self;
+	py_zfs_t *plz = res->obj.pylibzfsp;
+	pylibzfs_state_t *state = py_get_module_state(plz);
+	py_json_buf_t jb = {0};
+	py_json_buf_t crypto = {0};
+	PyObject *prop_set = NULL;
+	py_zfs_prop_selector_t *sel = NULL;
+	boolean_t get_source = B_FALSE;
+	boolean_t get_userprops = B_FALSE;
+	boolean_t get_crypto = B_FALSE;
+	boolean_t get_raw = B_TRUE;
+	boolean_t props_requested = B_FALSE;
+	size_t props[ARRAY_SIZE(zfs_prop_table)];
+	size_t nprops = 0, idx, i;
+	PyObject *result = NULL;
+	PyObject *py_name = NULL, *py_pool = NULL, *py_type = NULL;
+	const char *name, *pool, *type;
+	uint64_t guid, createtxg;
+	int err = 0, err_errno = 0;
+	char *kwnames [] = {
+		"properties",
+		"get_source",
+		"get_user_properties",
+		"get_crypto",
+		"raw",
+		NULL
+	};
+
+	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
+					 "|$Opppp",
+					 kwnames,
+					 &prop_set,
+					 &get_source,
+					 &get_userprops,
+					 &get_crypto,
+					 &get_raw)) {
+		return NULL;
+	}
+
+	if ((prop_set != NULL) && (prop_set != Py_None)) {
+		if (!PY_ZFS_PROPS_CHECK(prop_set)) {
+			PyErr_SetString(PyExc_TypeError,
+					"properties must be a set or "
+					"ZFSPropertySelector.");
+			return NULL;
+		}
+
+		if (PyObject_TypeCheck(prop_set, &ZFSPropertySelector))
+			sel = (py_zfs_prop_selector_t *)prop_set;
+
+		// Same lookup as py_zfs_get_properties(). A selector already
+		// holds the resolved table indexes.
+		if (sel != NULL) {
+			memcpy(props, sel->idx, sel->nidx * sizeof (props[0]));
+			nprops = sel->nidx;
+		}
+
+		for (idx = 0; sel == NULL && idx < ARRAY_SIZE(zfs_prop_table);
+		    idx++) {
+			PyObject *enum_obj = state->zfs_prop_enum_tbl[idx].obj;
+			int rv;
+
+			if (enum_obj == NULL)
+				continue;
+
+			rv = PySet_Contains(prop_set, enum_obj);
+			if (rv == -1)
+				return NULL;
+			else if (rv == 1)
+				props[nprops++] = idx;
+		}
+		props_requested = B_TRUE;
+	}
+
+	guid = PyLong_AsUnsignedLongLong(res->obj.guid);
+	if (PyErr_Occurred())
+		return NULL;
+
+	createtxg = PyLong_AsUnsignedLongLong(res->obj.createtxg);
+	if (PyErr_Occurred())
+		return NULL;
+
+	// Crypto info takes the lock itself and needs the GIL on error
+	if (get_crypto && !py_zfs_crypto_info_json(&res->obj, &crypto)) {
+		json_buf_free(&crypto);
+		return NULL;
+	} else if (crypto.nomem) {
+		json_buf_free(&crypto);
+		return PyErr_NoMemory();
+	}
+
+	// The UTF-8 buffers are used with the GIL released. Hold strong
+	// references so that a concurrent rename cannot free them.
+	py_name = py_zfs_obj_name_ref(&res->obj);
+	py_pool = Py_XNewRef(res->obj.pool_name);
+	py_type = Py_XNewRef(res->obj.type);
+
+	name = PyUnicode_AsUTF8(py_name);
+	pool = PyUnicode_AsUTF8(py_pool);
+	type = PyUnicode_AsUTF8(py_type);
+	if ((name == NULL) || (pool == NULL) || (type == NULL)) {
+		json_buf_free(&crypto);
+		goto out;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	PY_ZFS_LOCK(plz);
+	if (res->is_simple && (nprops || get_userprops)) {
+		zfs_refresh_properties(res->obj.zhp);
+		res->is_simple = B_FALSE;
+	}
+
+	json_buf_lit(&jb, "{\"name\":");
+	json_buf_str(&jb, name);
+	json_buf_lit(&jb, ",\"pool\":");
+	json_buf_str(&jb, pool);
+	json_buf_lit(&jb, ",\"type\":");
+	json_buf_str(&jb, type);
+	json_buf_lit(&jb, ",\"type_enum\":");
+	json_buf_u64(&jb, res->obj.ctype);
+	json_buf_lit(&jb, ",\"createtxg\":");
+	json_buf_u64(&jb, createtxg);
+	json_buf_lit(&jb, ",\"guid\":");
+	json_buf_u64(&jb, guid);
+
+	json_buf_lit(&jb, ",\"properties\":");
+	if (props_requested) {
+		json_buf_lit(&jb, "{");
+		for (i = 0; i < nprops; i++) {
+			if (i)
+				json_buf_lit(&jb, ",");
+			json_buf_key(&jb, state->struct_prop_fields[props[i]].name);
+			err = py_zfs_prop_json_locked(&jb, res->obj.zhp,
+			    state->zfs_prop_enum_tbl[props[i]].type,
+			    get_source, get_raw, &err_errno);
+			if (err)
+				break;
+		}
+		json_buf_lit(&jb, "}");
+	} else {
+		json_buf_lit(&jb, "null");
+	}
+
+	json_buf_lit(&jb, ",\"user_properties\":");
+	if (get_userprops)
+		user_props_nvlist_to_json(&jb, zfs_get_user_props(res->obj.zhp));
+	else
+		json_buf_lit(&jb, "null");
+
+	json_buf_lit(&jb, ",\"crypto\":");
+	if (get_crypto)
+		json_buf_append(&jb, crypto.buf, crypto.used);
+	else
+		json_buf_lit(&jb, "null");
+	json_buf_lit(&jb, "}");
+
+	PY_ZFS_UNLOCK(plz);
+	Py_END_ALLOW_THREADS
+
+	json_buf_free(&crypto);
+	if (err) {
+		py_zfs_prop_json_exc(state->zfs_prop_enum_tbl[props[i]].type,
+				     res->obj.ctype, name, err, err_errno);
+		json_buf_free(&jb);
+		goto out;
+	}
+
+	result = json_buf_to_bytes(&jb);
+out:
+	Py_XDECREF(py_name);
+	Py_XDECREF(py_pool);
+	Py_XDECREF(py_type);
+	return result;
+}
+
 PyDoc_STRVAR(py_zfs_resource_mount__doc__,
 "mount(*, mountpoint, mount_options=None, force=False, \n"
 "      load_encryption_key=False) -> None\n"
@@ -1164,6 +1782,7 @@ PyObject *py_zfs_resource_unmount(PyObject *self,
 		NULL
 	};
 	const char *mp = NULL;
+	uint64_t op_start;
 	int err;
 	int flags = 0;
 	py_zfs_error_t zfs_err;
@@ -1199,11 +1818,13 @@ PyObject *py_zfs_resource_unmount(PyObject *self,
 
 	Py_BEGIN_ALLOW_THREADS
 	PY_ZFS_LOCK(res->obj.pylibzfsp);
+	op_start = py_zfs_stats_now();
 	if (recurse) {
 		err = zfs_unmountall(res->obj.zhp, flags);
 	} else {
 		err = zfs_unmount(res->obj.zhp, mp, flags);
 	}
+	py_zfs_stats_op(res->obj.pylibzfsp, PY_ZFS_OP_MOUNT, op_start);
 	if (err) {
 		py_get_zfs_error(res->obj.pylibzfsp->lzh, &zfs_err);
 	} else {
@@ -1236,6 +1857,24 @@ PyMethodDef zfs_resource_methods[] = {
 		.ml_flags = METH_VARARGS | METH_KEYWORDS,
 		.ml_doc = py_zfs_resource_iter_snapshots__doc__
 	},
+	{
+		.ml_name = "list_filesystem_names",
+		.ml_meth = (PyCFunction)py_zfs_resource_list_filesystem_names,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_resource_list_filesystem_names__doc__
+	},
+	{
+		.ml_name = "list_snapshot_names",
+		.ml_meth = (PyCFunction)py_zfs_resource_list_snapshot_names,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_resource_list_snapshot_names__doc__
+	},
+	{
+		.ml_name = "space_summary",
+		.ml_meth = (PyCFunction)py_zfs_resource_space_summary,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_resource_space_summary__doc__
+	},
 	{
 		.ml_name = "get_properties",
 		.ml_meth = (PyCFunction)py_zfs_resource_get_properties,
@@ -1263,7 +1902,7 @@ PyMethodDef zfs_resource_methods[] = {
 	{
 		.ml_name = "refresh_properties",
 		.ml_meth = (PyCFunction)py_zfs_resource_refresh_props,
-		.ml_flags = METH_NOARGS,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
 		.ml_doc = py_zfs_resource_refresh_props__doc__
 	},
 	{
@@ -1278,6 +1917,12 @@ PyMethodDef zfs_resource_methods[] = {
 		.ml_flags = METH_VARARGS | METH_KEYWORDS,
 		.ml_doc = py_zfs_resource_asdict__doc__
 	},
+	{
+		.ml_name = "asdict_json",
+		.ml_meth = (PyCFunction)py_zfs_resource_asdict_json,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_resource_asdict_json__doc__
+	},
 	{
 		.ml_name = "mount",
 		.ml_meth = (PyCFunction)py_zfs_resource_mount,
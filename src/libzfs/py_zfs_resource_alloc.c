@@ -0,0 +1,101 @@
+#include "../truenas_pylibzfs.h"
+
+/*
+ * Allocation helpers for ZFSDataset, ZFSVolume and ZFSSnapshot objects
+ *
+ * Iterating a large number of datasets or snapshots with a callback creates
+ * and destroys one resource object per item. Deallocated objects are kept
+ * on a small per-type free-list and reused by the next allocation, so
+ * steady-state iteration does not go through the object allocator.
+ *
+ * The free-lists rely on the GIL for protection and are disabled on
+ * free-threaded builds, where the allocator already uses per-thread heaps.
+ *
+ * Pool names are identical for every object in a pool, so the most
+ * recently created pool name string is kept on the py_zfs_t and shared by
+ * new objects for that pool. Type strings and ZFSType enums are already
+ * shared through the module state (see py_get_zfs_type()).
+ */
+
+#define	RSRC_FREELIST_MAX	256
+
+#ifndef Py_GIL_DISABLED
+typedef struct {
+	PyObject *items[RSRC_FREELIST_MAX];
+	int count;
+} rsrc_freelist_t;
+
+static rsrc_freelist_t freelist_dataset;
+static rsrc_freelist_t freelist_volume;
+static rsrc_freelist_t freelist_snapshot;
+
+static rsrc_freelist_t *
+rsrc_freelist(PyTypeObject *type)
+{
+	if (type == &ZFSDataset)
+		return &freelist_dataset;
+	if (type == &ZFSVolume)
+		return &freelist_volume;
+	if (type == &ZFSSnapshot)
+		return &freelist_snapshot;
+
+	return NULL;
+}
+#endif /* Py_GIL_DISABLED */
+
+PyObject *
+py_zfs_resource_alloc(PyTypeObject *type)
+{
+#ifndef Py_GIL_DISABLED
+	rsrc_freelist_t *fl = rsrc_freelist(type);
+
+	if ((fl != NULL) && (fl->count > 0)) {
+		PyObject *out = fl->items[--fl->count];
+
+		// Match the zero-initialized state from tp_alloc()
+		memset((char *)out + sizeof (PyObject), 0,
+		       type->tp_basicsize - sizeof (PyObject));
+		return PyObject_Init(out, type);
+	}
+#endif
+	return type->tp_alloc(type, 0);
+}
+
+void
+py_zfs_resource_free(PyObject *self)
+{
+#ifndef Py_GIL_DISABLED
+	rsrc_freelist_t *fl = rsrc_freelist(Py_TYPE(self));
+
+	if ((fl != NULL) && (fl->count < RSRC_FREELIST_MAX)) {
+		fl->items[fl->count++] = self;
+		return;
+	}
+#endif
+	Py_TYPE(self)->tp_free(self);
+}
+
+PyObject *
+py_zfs_pool_name_str(py_zfs_t *plz, const char *pool_name)
+{
+	PyObject *out = NULL;
+
+	Py_BEGIN_CRITICAL_SECTION(plz);
+	if (plz->pool_name_cache != NULL) {
+		const char *cached = PyUnicode_AsUTF8(plz->pool_name_cache);
+
+		// Cached string was created from UTF-8 and so can not fail
+		// to convert.
+		if (strcmp(cached, pool_name) == 0)
+			out = Py_NewRef(plz->pool_name_cache);
+	}
+
+	if (out == NULL) {
+		out = PyUnicode_FromString(pool_name);
+		if (out != NULL)
+			Py_XSETREF(plz->pool_name_cache, Py_NewRef(out));
+	}
+	Py_END_CRITICAL_SECTION();
+
+	return out;
+}
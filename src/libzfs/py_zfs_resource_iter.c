@@ -0,0 +1,375 @@
+#include "../truenas_pylibzfs.h"
+#include "py_zfs_iter.h"
+#include <pthread.h>
+
+/*
+ * ZFSResourceIterator
+ *
+ * Python iterator that yields ZFSDataset / ZFSVolume / ZFSSnapshot /
+ * ZFSPool objects. It is returned by the iter_filesystems(),
+ * iter_snapshots(), iter_root_filesystems() and iter_pools() methods
+ * when they are called without a `callback`.
+ *
+ * A producer pthread runs the libzfs iterator (zfs_iter_filesystems_v2(),
+ * zfs_iter_snapshots_v2(), etc.) without the GIL and pushes the resulting
+ * libzfs handles into a bounded queue. __next__ pops one handle from the
+ * queue (releasing the GIL while it waits) and wraps it in a python object.
+ * This allows ioctl latency to overlap with python-side processing of
+ * previously returned objects.
+ *
+ * Locking:
+ * The producer holds the libzfs handle lock (PY_ZFS_LOCK) while running the
+ * libzfs iterator, but drops it for each handle it pushes (and while it
+ * waits on a full queue), so that python code processing the yielded
+ * objects can perform libzfs operations between ioctls. This is the same
+ * approach taken by common_callback() in py_zfs_iter.c. The queue mutex is
+ * never held while acquiring the libzfs handle lock.
+ *
+ * If the iterator is deallocated before being exhausted, the producer is
+ * told to stop, joined, and any handles left in the queue are closed.
+ *
+ * __next__ may be called from several python threads on free-threaded
+ * builds. Calls are serialized by next_lock (a PyMutex rather than a
+ * critical section since the GIL is released while waiting on the queue)
+ * so that the producer is only stopped and joined once.
+ */
+
+#define RESOURCE_ITER_QUEUE_DEPTH 128
+
+typedef struct {
+	PyObject_HEAD
+	py_iter_state_t state;	  /* pylibzfsp, target, iter_config, kind, filter */
+	PyObject	*source;  /* python object owning state.target, may be NULL */
+	py_iter_type_t	 type;
+	pthread_t	 producer;
+	boolean_t	 started; /* producer thread created, not yet joined */
+	PyMutex		 next_lock; /* serializes __next__ between python threads */
+	pthread_mutex_t	 lock;	  /* protects fields below */
+	pthread_cond_t	 cv;
+	void		**queue;  /* ring buffer of libzfs handles */
+	size_t		 qhead;
+	size_t		 qcount;
+	boolean_t	 done;	  /* producer finished iterating */
+	boolean_t	 cancel;  /* consumer requested producer stop */
+	int		 iter_ret;
+	py_zfs_error_t	 zfs_err;
+} py_zfs_resource_iter_t;
+
+/*
+ * Push handle generated by libzfs iterator onto queue. Called in producer
+ * thread with libzfs handle lock held. The lock is dropped while pushing
+ * so that the consumer, or any other thread, may use the libzfs handle
+ * before the next ioctl is issued.
+ */
+static int
+resource_iter_push(py_zfs_resource_iter_t *self, void *hdl)
+{
+	int ret = ITER_RESULT_SUCCESS;
+
+	PY_ZFS_UNLOCK(self->state.pylibzfsp);
+
+	pthread_mutex_lock(&self->lock);
+	while ((self->qcount == RESOURCE_ITER_QUEUE_DEPTH) && !self->cancel)
+		pthread_cond_wait(&self->cv, &self->lock);
+
+	if (self->cancel) {
+		ret = ITER_RESULT_STOP;
+	} else {
+		self->queue[(self->qhead + self->qcount) %
+		    RESOURCE_ITER_QUEUE_DEPTH] = hdl;
+		self->qcount++;
+		pthread_cond_broadcast(&self->cv);
+	}
+	pthread_mutex_unlock(&self->lock);
+
+	PY_ZFS_LOCK(self->state.pylibzfsp);
+
+	if (ret == ITER_RESULT_STOP)
+		py_iter_close_hdl(self->state.batch.kind, hdl);
+
+	return ret;
+}
+
+static int
+resource_iter_zfs_cb(zfs_handle_t *zhp, void *private)
+{
+	py_zfs_resource_iter_t *self = (py_zfs_resource_iter_t *)private;
+
+	if (self->state.filter &&
+	    !py_zfs_filter_match(self->state.filter, zhp)) {
+		zfs_close(zhp);
+		return ITER_RESULT_SUCCESS;
+	}
+
+	return resource_iter_push(self, zhp);
+}
+
+static int
+resource_iter_pool_cb(zpool_handle_t *zhp, void *private)
+{
+	return resource_iter_push((py_zfs_resource_iter_t *)private, zhp);
+}
+
+static void *
+resource_iter_producer(void *arg)
+{
+	py_zfs_resource_iter_t *self = (py_zfs_resource_iter_t *)arg;
+	py_zfs_t *plz = self->state.pylibzfsp;
+	iter_conf_snapshot_t snap = self->state.iter_config.snapshot;
+	py_zfs_error_t zfs_err;
+	int iter_ret = ITER_RESULT_SUCCESS;
+
+	PY_ZFS_LOCK(plz);
+	switch (self->type) {
+	case PY_ITER_FILESYSTEMS:
+		iter_ret = zfs_iter_filesystems_v2(self->state.target,
+		    self->state.iter_config.filesystem.flags,
+		    resource_iter_zfs_cb, self);
+		break;
+	case PY_ITER_SNAPSHOTS:
+		if (snap.sorted) {
+			iter_ret = zfs_iter_snapshots_sorted_v2(
+			    self->state.target, snap.flags,
+			    resource_iter_zfs_cb, self,
+			    snap.min_txg, snap.max_txg);
+		} else {
+			iter_ret = zfs_iter_snapshots_v2(
+			    self->state.target, snap.flags,
+			    resource_iter_zfs_cb, self,
+			    snap.min_txg, snap.max_txg);
+		}
+		break;
+	case PY_ITER_ROOT_FILESYSTEMS:
+		iter_ret = zfs_iter_root(plz->lzh, resource_iter_zfs_cb, self);
+		break;
+	case PY_ITER_POOLS:
+		iter_ret = zpool_iter(plz->lzh, resource_iter_pool_cb, self);
+		break;
+	}
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR)
+		py_get_zfs_error(plz->lzh, &zfs_err);
+	PY_ZFS_UNLOCK(plz);
+
+	pthread_mutex_lock(&self->lock);
+	self->iter_ret = iter_ret;
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR)
+		self->zfs_err = zfs_err;
+	self->done = B_TRUE;
+	pthread_cond_broadcast(&self->cv);
+	pthread_mutex_unlock(&self->lock);
+
+	return NULL;
+}
+
+/*
+ * Stop and join producer thread. GIL must be held; it is released
+ * while waiting for the producer.
+ */
+static void
+resource_iter_stop(py_zfs_resource_iter_t *self)
+{
+	if (!self->started)
+		return;
+
+	Py_BEGIN_ALLOW_THREADS
+	pthread_mutex_lock(&self->lock);
+	self->cancel = B_TRUE;
+	pthread_cond_broadcast(&self->cv);
+	pthread_mutex_unlock(&self->lock);
+	pthread_join(self->producer, NULL);
+	Py_END_ALLOW_THREADS
+
+	self->started = B_FALSE;
+}
+
+static void
+py_zfs_resource_iter_dealloc(py_zfs_resource_iter_t *self)
+{
+	resource_iter_stop(self);
+
+	if (self->queue != NULL) {
+		Py_BEGIN_ALLOW_THREADS
+		while (self->qcount > 0) {
+			py_iter_close_hdl(self->state.batch.kind,
+			    self->queue[self->qhead]);
+			self->qhead = (self->qhead + 1) % RESOURCE_ITER_QUEUE_DEPTH;
+			self->qcount--;
+		}
+		Py_END_ALLOW_THREADS
+
+		PyMem_RawFree(self->queue);
+		self->queue = NULL;
+		pthread_mutex_destroy(&self->lock);
+		pthread_cond_destroy(&self->cv);
+	}
+
+	Py_CLEAR(self->source);
+	Py_CLEAR(self->state.filter);
+	Py_CLEAR(self->state.pylibzfsp);
+	Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+py_zfs_resource_iter_iter(PyObject *self)
+{
+	Py_INCREF(self);
+	return (self);
+}
+
+static PyObject *
+py_zfs_resource_iter_next_impl(py_zfs_resource_iter_t *self)
+{
+	void *hdl = NULL;
+	int iter_ret = ITER_RESULT_SUCCESS;
+	py_zfs_error_t zfs_err;
+	PyObject *out = NULL;
+
+	if (!self->started && self->qcount == 0) {
+		// exhausted
+		return NULL;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	pthread_mutex_lock(&self->lock);
+	while ((self->qcount == 0) && !self->done)
+		pthread_cond_wait(&self->cv, &self->lock);
+
+	if (self->qcount > 0) {
+		hdl = self->queue[self->qhead];
+		self->qhead = (self->qhead + 1) % RESOURCE_ITER_QUEUE_DEPTH;
+		self->qcount--;
+		pthread_cond_broadcast(&self->cv);
+	} else {
+		iter_ret = self->iter_ret;
+		zfs_err = self->zfs_err;
+	}
+	pthread_mutex_unlock(&self->lock);
+	Py_END_ALLOW_THREADS
+
+	if (hdl != NULL) {
+		out = py_iter_hdl_to_py(&self->state, hdl);
+		if (out == NULL) {
+			Py_BEGIN_ALLOW_THREADS
+			py_iter_close_hdl(self->state.batch.kind, hdl);
+			Py_END_ALLOW_THREADS
+		}
+		return out;
+	}
+
+	// Producer is done and queue is drained.
+	resource_iter_stop(self);
+
+	if (iter_ret == ITER_RESULT_IOCTL_ERROR) {
+		set_exc_from_libzfs(&zfs_err, "ZFS resource iteration failed");
+	}
+
+	// Returning NULL without exception set signals StopIteration
+	return NULL;
+}
+
+static PyObject *
+py_zfs_resource_iter_next(PyObject *self_obj)
+{
+	py_zfs_resource_iter_t *self = (py_zfs_resource_iter_t *)self_obj;
+	PyObject *out;
+
+	PyMutex_Lock(&self->next_lock);
+	out = py_zfs_resource_iter_next_impl(self);
+	PyMutex_Unlock(&self->next_lock);
+
+	return out;
+}
+
+PyDoc_STRVAR(py_zfs_resource_iter__doc__,
+"ZFSResourceIterator\n"
+"-------------------\n\n"
+"Iterator yielding ZFS resource or pool objects.\n\n"
+"Returned by iter_filesystems(), iter_snapshots(), iter_root_filesystems()\n"
+"and iter_pools() when they are called without a \"callback\" argument.\n\n"
+"A native thread runs the underlying libzfs iterator without the GIL and\n"
+"prefetches up to 128 objects into a bounded queue, so that ZFS ioctls\n"
+"overlap with python-side processing. Breaking out of the loop early is\n"
+"supported; the producer thread is stopped when the iterator is released.\n\n"
+"The producer releases the libzfs handle lock after each object it\n"
+"prefetches, so libzfs operations performed inside the loop body wait for\n"
+"at most one ioctl of the producer rather than for the whole iteration.\n\n"
+"Raises\n"
+"------\n"
+"ZFSException\n"
+"    A libzfs error occurred during iteration.\n"
+);
+
+PyTypeObject ZFSResourceIterator = {
+	.tp_name      = PYLIBZFS_TYPES_MODULE_NAME ".ZFSResourceIterator",
+	.tp_basicsize = sizeof (py_zfs_resource_iter_t),
+	.tp_itemsize  = 0,
+	.tp_dealloc   = (destructor)py_zfs_resource_iter_dealloc,
+	.tp_new       = py_no_new_impl,
+	.tp_flags     = Py_TPFLAGS_DEFAULT,
+	.tp_doc       = py_zfs_resource_iter__doc__,
+	.tp_iter      = py_zfs_resource_iter_iter,
+	.tp_iternext  = py_zfs_resource_iter_next,
+};
+
+/*
+ * Factory: create a ZFSResourceIterator and start its producer thread.
+ *
+ * state: pylibzfsp, target (where applicable) and iter_config are copied
+ *     from the state prepared by the calling python method.
+ * source: python object that owns state->target (kept alive for the
+ *     lifetime of the iterator). May be NULL for root / pool iteration.
+ * type: which libzfs iterator to run.
+ */
+PyObject *
+py_zfs_resource_iter_create(py_iter_state_t *state,
+			    PyObject *source,
+			    py_iter_type_t type)
+{
+	py_zfs_resource_iter_t *it;
+	int err;
+
+	it = (py_zfs_resource_iter_t *)ZFSResourceIterator.tp_alloc(
+	    &ZFSResourceIterator, 0);
+	if (it == NULL)
+		return (NULL);
+
+	it->state = (py_iter_state_t){
+		.pylibzfsp = (py_zfs_t *)Py_NewRef(state->pylibzfsp),
+		.target = state->target,
+		.iter_config = state->iter_config,
+		.filter = (py_zfs_filter_t *)Py_XNewRef(state->filter),
+	};
+	it->source = Py_XNewRef(source);
+	it->type = type;
+
+	switch (type) {
+	case PY_ITER_SNAPSHOTS:
+		it->state.batch.kind = ITER_BATCH_SNAPSHOT;
+		break;
+	case PY_ITER_POOLS:
+		it->state.batch.kind = ITER_BATCH_POOL;
+		break;
+	default:
+		it->state.batch.kind = ITER_BATCH_DATASET;
+		break;
+	}
+
+	it->queue = PyMem_RawCalloc(RESOURCE_ITER_QUEUE_DEPTH, sizeof (void *));
+	if (it->queue == NULL) {
+		Py_DECREF(it);
+		return (PyErr_NoMemory());
+	}
+	pthread_mutex_init(&it->lock, NULL);
+	pthread_cond_init(&it->cv, NULL);
+
+	err = pthread_create(&it->producer, NULL, resource_iter_producer, it);
+	if (err) {
+		errno = err;
+		PyErr_SetFromErrno(PyExc_OSError);
+		Py_DECREF(it);
+		return (NULL);
+	}
+	it->started = B_TRUE;
+
+	return ((PyObject *)it);
+}
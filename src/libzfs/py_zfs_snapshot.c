@@ -7,7 +7,7 @@
 static
 void py_zfs_snapshot_dealloc(py_zfs_snapshot_t *self) {
 	free_py_zfs_obj(RSRC_TO_ZFS(self));
-	Py_TYPE(self)->tp_free((PyObject *)self);
+	py_zfs_resource_free((PyObject *)self);
 }
 
 static
@@ -167,6 +167,7 @@ PyObject *py_zfs_snapshot_clone(PyObject *self,	PyObject *args, PyObject *kwargs
 	const char *cname = NULL;
 	pylibzfs_state_t *state = NULL;
 	zfs_type_t clone_type;
+	PyObject *py_name = NULL;
 
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs,
 					 "|$sOO",
@@ -216,9 +217,12 @@ PyObject *py_zfs_snapshot_clone(PyObject *self,	PyObject *args, PyObject *kwargs
 		}
 	}
 
-	if (PySys_Audit(PYLIBZFS_MODULE_NAME
-			".ZFSSnapshot.clone", "OO",
-			ds->rsrc.obj.name, kwargs) < 0) {
+	py_name = py_zfs_obj_name_ref(&ds->rsrc.obj);
+	err = PySys_Audit(PYLIBZFS_MODULE_NAME
+			  ".ZFSSnapshot.clone", "OO",
+			  py_name, kwargs);
+	Py_DECREF(py_name);
+	if (err < 0) {
 		fnvlist_free(nvl);
 		return NULL;
 	}
@@ -317,7 +321,7 @@ py_zfs_snapshot_t *init_zfs_snapshot(py_zfs_t *lzp, zfs_handle_t *zfsp, boolean_
 	uint64_t guid, createtxg;
 	boolean_t is_encrypted = B_FALSE;
 
-	out = (py_zfs_snapshot_t *)ZFSSnapshot.tp_alloc(&ZFSSnapshot, 0);
+	out = (py_zfs_snapshot_t *)py_zfs_resource_alloc(&ZFSSnapshot);
 	if (out == NULL)
 		return NULL;
 	out->rsrc.is_simple = simple;
@@ -340,7 +344,7 @@ py_zfs_snapshot_t *init_zfs_snapshot(py_zfs_t *lzp, zfs_handle_t *zfsp, boolean_
 	if (obj->name == NULL)
 		goto error;
 
-	obj->pool_name = PyUnicode_FromString(pool_name);
+	obj->pool_name = py_zfs_pool_name_str(lzp, pool_name);
 	if (obj->pool_name == NULL)
 		goto error;
 
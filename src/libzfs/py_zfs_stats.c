@@ -0,0 +1,176 @@
+#include "../truenas_pylibzfs.h"
+
+/*
+ * Implementation of ZFS.stats() and ZFS.reset_stats()
+ *
+ * Counters are collected per py_zfs_t (see py_zfs_stats_t). If the handle
+ * has a handle pool then the counters of every handle in the pool are
+ * combined: totals and histograms are summed and maximums are the maximum
+ * over all handles.
+ */
+
+static const char *op_names[PY_ZFS_OP_COUNT] = {
+	[PY_ZFS_OP_OPEN] = "open",
+	[PY_ZFS_OP_PROP_GET] = "prop_get",
+	[PY_ZFS_OP_PROP_SET] = "prop_set",
+	[PY_ZFS_OP_ITER] = "iter",
+	[PY_ZFS_OP_MOUNT] = "mount",
+	[PY_ZFS_OP_SEND] = "send",
+};
+
+#define	STAT_LOAD(x)	__atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define	STAT_CLEAR(x)	__atomic_store_n(&(x), 0, __ATOMIC_RELAXED)
+
+static void
+stats_accumulate(py_zfs_stats_t *out, py_zfs_t *plz)
+{
+	py_zfs_stats_t *in = &plz->stats;
+	uint64_t val;
+	int i;
+
+	out->acquisitions += STAT_LOAD(in->acquisitions);
+	out->wait_total_ns += STAT_LOAD(in->wait_total_ns);
+	out->hold_total_ns += STAT_LOAD(in->hold_total_ns);
+
+	val = STAT_LOAD(in->wait_max_ns);
+	out->wait_max_ns = Py_MAX(out->wait_max_ns, val);
+	val = STAT_LOAD(in->hold_max_ns);
+	out->hold_max_ns = Py_MAX(out->hold_max_ns, val);
+
+	for (i = 0; i < PY_ZFS_STATS_HIST_BUCKETS; i++) {
+		out->wait_hist[i] += STAT_LOAD(in->wait_hist[i]);
+		out->hold_hist[i] += STAT_LOAD(in->hold_hist[i]);
+	}
+
+	for (i = 0; i < PY_ZFS_OP_COUNT; i++) {
+		out->ops[i].count += STAT_LOAD(in->ops[i].count);
+		out->ops[i].total_ns += STAT_LOAD(in->ops[i].total_ns);
+		val = STAT_LOAD(in->ops[i].max_ns);
+		out->ops[i].max_ns = Py_MAX(out->ops[i].max_ns, val);
+	}
+}
+
+static void
+stats_clear(py_zfs_t *plz)
+{
+	py_zfs_stats_t *st = &plz->stats;
+	int i;
+
+	STAT_CLEAR(st->acquisitions);
+	STAT_CLEAR(st->wait_total_ns);
+	STAT_CLEAR(st->wait_max_ns);
+	STAT_CLEAR(st->hold_total_ns);
+	STAT_CLEAR(st->hold_max_ns);
+
+	for (i = 0; i < PY_ZFS_STATS_HIST_BUCKETS; i++) {
+		STAT_CLEAR(st->wait_hist[i]);
+		STAT_CLEAR(st->hold_hist[i]);
+	}
+
+	for (i = 0; i < PY_ZFS_OP_COUNT; i++) {
+		STAT_CLEAR(st->ops[i].count);
+		STAT_CLEAR(st->ops[i].total_ns);
+		STAT_CLEAR(st->ops[i].max_ns);
+	}
+}
+
+static PyObject *
+hist_to_tuple(const uint64_t *hist)
+{
+	PyObject *out = NULL;
+	int i;
+
+	out = PyTuple_New(PY_ZFS_STATS_HIST_BUCKETS);
+	if (out == NULL)
+		return NULL;
+
+	for (i = 0; i < PY_ZFS_STATS_HIST_BUCKETS; i++) {
+		PyObject *val = PyLong_FromUnsignedLongLong(hist[i]);
+		if (val == NULL) {
+			Py_DECREF(out);
+			return NULL;
+		}
+		PyTuple_SET_ITEM(out, i, val);
+	}
+
+	return out;
+}
+
+PyObject *py_zfs_stats_dict(py_zfs_t *plz)
+{
+	py_zfs_stats_t st = { 0 };
+	PyObject *lock = NULL;
+	PyObject *ops = NULL;
+	Py_ssize_t nhandles = 1;
+	Py_ssize_t i;
+
+	stats_accumulate(&st, plz);
+	if (plz->handle_pool != NULL) {
+		nhandles += PyTuple_GET_SIZE(plz->handle_pool);
+		for (i = 0; i < PyTuple_GET_SIZE(plz->handle_pool); i++) {
+			stats_accumulate(&st,
+			    (py_zfs_t *)PyTuple_GET_ITEM(plz->handle_pool, i));
+		}
+	}
+
+	lock = Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:N,s:N}",
+			     "acquisitions",
+			     (unsigned long long)st.acquisitions,
+			     "wait_total_ns",
+			     (unsigned long long)st.wait_total_ns,
+			     "wait_max_ns",
+			     (unsigned long long)st.wait_max_ns,
+			     "hold_total_ns",
+			     (unsigned long long)st.hold_total_ns,
+			     "hold_max_ns",
+			     (unsigned long long)st.hold_max_ns,
+			     "wait_histogram", hist_to_tuple(st.wait_hist),
+			     "hold_histogram", hist_to_tuple(st.hold_hist));
+	if (lock == NULL)
+		return NULL;
+
+	ops = PyDict_New();
+	if (ops == NULL)
+		goto fail;
+
+	for (i = 0; i < PY_ZFS_OP_COUNT; i++) {
+		PyObject *op;
+		int err;
+
+		op = Py_BuildValue("{s:K,s:K,s:K}",
+				   "count",
+				   (unsigned long long)st.ops[i].count,
+				   "total_ns",
+				   (unsigned long long)st.ops[i].total_ns,
+				   "max_ns",
+				   (unsigned long long)st.ops[i].max_ns);
+		if (op == NULL)
+			goto fail;
+
+		err = PyDict_SetItemString(ops, op_names[i], op);
+		Py_DECREF(op);
+		if (err)
+			goto fail;
+	}
+
+	return Py_BuildValue("{s:n,s:N,s:N}",
+			     "handles", nhandles,
+			     "lock", lock,
+			     "operations", ops);
+fail:
+	Py_XDECREF(lock);
+	Py_XDECREF(ops);
+	return NULL;
+}
+
+void py_zfs_stats_reset(py_zfs_t *plz)
+{
+	Py_ssize_t i;
+
+	stats_clear(plz);
+	if (plz->handle_pool == NULL)
+		return;
+
+	for (i = 0; i < PyTuple_GET_SIZE(plz->handle_pool); i++)
+		stats_clear((py_zfs_t *)PyTuple_GET_ITEM(plz->handle_pool, i));
+}
@@ -7,7 +7,7 @@
 static
 void py_zfs_volume_dealloc(py_zfs_volume_t *self) {
 	free_py_zfs_obj(RSRC_TO_ZFS(self));
-	Py_TYPE(self)->tp_free((PyObject *)self);
+	py_zfs_resource_free((PyObject *)self);
 }
 
 static
@@ -131,7 +131,7 @@ py_zfs_volume_t *init_zfs_volume(py_zfs_t *lzp, zfs_handle_t *zfsp, boolean_t si
 	uint64_t guid, createtxg;
 	boolean_t is_encrypted = B_FALSE;
 
-	out = (py_zfs_volume_t *)ZFSVolume.tp_alloc(&ZFSVolume, 0);
+	out = (py_zfs_volume_t *)py_zfs_resource_alloc(&ZFSVolume);
 	if (out == NULL)
 		return NULL;
 	out->rsrc.is_simple = simple;
@@ -154,7 +154,7 @@ py_zfs_volume_t *init_zfs_volume(py_zfs_t *lzp, zfs_handle_t *zfsp, boolean_t si
 	if (obj->name == NULL)
 		goto error;
 
-	obj->pool_name = PyUnicode_FromString(pool_name);
+	obj->pool_name = py_zfs_pool_name_str(lzp, pool_name);
 	if (obj->pool_name == NULL)
 		goto error;
 
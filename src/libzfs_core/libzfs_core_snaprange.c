@@ -0,0 +1,722 @@
+#include "libzfs_core_snaprange.h"
+
+#include <pthread.h>
+
+/*
+ * Implementation of lzc.snaprange_space_matrix()
+ *
+ * lzc_snaprange_space(first, last) returns the space that would be freed
+ * by destroying every snapshot of a dataset from first through last. Each
+ * call is a separate ioctl, so retention planning over thousands of
+ * snapshots is dominated by the number of calls rather than by the work
+ * done per call.
+ *
+ * All arguments are converted to C arrays up front with the GIL held. The
+ * requested ranges are then flattened into a job list that is consumed by
+ * a small set of native threads (the calling thread included) with the GIL
+ * released. Each job writes its result directly into the buffer of the
+ * bytes object that is returned to the caller as a memoryview, and so no
+ * python object is created per range.
+ *
+ * The first failing ioctl stops the remaining jobs and is raised as a
+ * ZFSCoreException.
+ *
+ * lzc_snaprange_space() counts every snapshot between first and last,
+ * whether or not the caller listed it, and so the snapshots are first
+ * checked to be consecutive snapshots of the dataset in creation order.
+ * Otherwise a range (and a run of candidate indexes) would silently
+ * include unlisted snapshots.
+ *
+ * The matrix costs about len(snapshots) * max_span ioctls, and so the span
+ * defaults to SNAPRANGE_DEFAULT_SPAN rather than to all snapshots.
+ */
+
+#define	SNAPRANGE_DEFAULT_WORKERS	4
+#define	SNAPRANGE_MAX_WORKERS		64
+#define	SNAPRANGE_DEFAULT_SPAN		64
+
+typedef struct {
+	size_t first;
+	size_t last;
+	uint64_t *out;
+} snaprange_job_t;
+
+typedef struct {
+	const char **names;
+	snaprange_job_t *jobs;
+	size_t njobs;
+	size_t next;
+	int error;
+	size_t err_job;
+} snaprange_ctx_t;
+
+typedef struct {
+	size_t first;
+	size_t last;
+} snaprange_run_t;
+
+/* Snapshot names of the dataset in creation order */
+typedef struct {
+	char **names;
+	size_t count;
+	size_t size;
+	int error;
+} snaprange_list_t;
+
+static int
+snaprange_list_cb(zfs_handle_t *zhp, void *arg)
+{
+	snaprange_list_t *list = (snaprange_list_t *)arg;
+	char *name;
+
+	if (list->count == list->size) {
+		size_t new_size = list->size ? list->size * 2 : 64;
+		char **new_names;
+
+		new_names = PyMem_RawRealloc(list->names,
+		    new_size * sizeof(char *));
+		if (new_names == NULL) {
+			list->error = ENOMEM;
+			zfs_close(zhp);
+			return -1;
+		}
+		list->names = new_names;
+		list->size = new_size;
+	}
+
+	name = strdup(zfs_get_name(zhp));
+	zfs_close(zhp);
+	if (name == NULL) {
+		list->error = ENOMEM;
+		return -1;
+	}
+
+	list->names[list->count++] = name;
+	return 0;
+}
+
+static boolean_t
+snaprange_list_has(snaprange_list_t *list, const char *name)
+{
+	size_t i;
+
+	for (i = 0; i < list->count; i++) {
+		if (strcmp(list->names[i], name) == 0)
+			return B_TRUE;
+	}
+
+	return B_FALSE;
+}
+
+/*
+ * Verify that names are consecutive snapshots of dataset, oldest first.
+ * GIL not required. Returns 0 on success, otherwise an errno. *bad is set
+ * to the index of the offending name for ENOENT (snapshot does not exist)
+ * and EINVAL (snapshot does not directly follow the previous name), and
+ * to nsnaps if the snapshots of the dataset could not be listed.
+ */
+static int
+snaprange_check_order(const char *dataset,
+		      const char **names,
+		      size_t nsnaps,
+		      size_t *bad)
+{
+	snaprange_list_t list = { 0 };
+	libzfs_handle_t *hdl;
+	zfs_handle_t *zhp;
+	size_t i, start;
+	int err = 0;
+
+	*bad = nsnaps;
+
+	hdl = libzfs_init();
+	if (hdl == NULL)
+		return errno ? errno : ENOMEM;
+
+	zhp = zfs_open(hdl, dataset, ZFS_TYPE_FILESYSTEM | ZFS_TYPE_VOLUME);
+	if (zhp == NULL) {
+		err = errno ? errno : ENOENT;
+		goto out;
+	}
+
+	// Same ordering as ZFSResource.list_snapshot_names()
+	if (zfs_iter_snapshots_sorted_v2(zhp, ZFS_ITER_SIMPLE,
+	    snaprange_list_cb, &list, 0, 0) != 0)
+		err = list.error ? list.error : (errno ? errno : EIO);
+	zfs_close(zhp);
+	if (err)
+		goto out;
+
+	for (start = 0; start < list.count; start++) {
+		if (strcmp(list.names[start], names[0]) == 0)
+			break;
+	}
+
+	for (i = 0; i < nsnaps; i++) {
+		if ((start + i < list.count) &&
+		    (strcmp(list.names[start + i], names[i]) == 0))
+			continue;
+
+		*bad = i;
+		err = snaprange_list_has(&list, names[i]) ? EINVAL : ENOENT;
+		break;
+	}
+
+out:
+	for (i = 0; i < list.count; i++)
+		free(list.names[i]);
+	PyMem_RawFree(list.names);
+	libzfs_fini(hdl);
+	return err;
+}
+
+/*
+ * Set ZFSCoreException for failure of snaprange_check_order(). The errors
+ * attribute names the missing snapshot, or the pair of snapshots that are
+ * not consecutive in `<dataset>@<first>%<last>` notation.
+ */
+static void
+snaprange_order_exc(PyObject *self,
+		    const char *dataset,
+		    const char **names,
+		    size_t bad,
+		    size_t nsnaps,
+		    int err)
+{
+	PyObject *errtup = NULL;
+
+	if (bad == nsnaps) {
+		errtup = Py_BuildValue("((si))", dataset, err);
+	} else if (err == EINVAL) {
+		errtup = Py_BuildValue("((Ni))",
+				       PyUnicode_FromFormat("%s%%%s",
+				       names[bad - 1],
+				       strchr(names[bad], '@') + 1),
+				       err);
+	} else {
+		errtup = Py_BuildValue("((si))", names[bad], err);
+	}
+	if (errtup == NULL)
+		return;
+
+	set_zfscore_exc(self, (err == EINVAL) ?
+			"snapshots are not consecutive snapshots of the "
+			"dataset ordered oldest to newest" :
+			"failed to list snapshots of dataset",
+			err, errtup);
+	Py_DECREF(errtup);
+}
+
+static void
+snaprange_run(snaprange_ctx_t *ctx)
+{
+	for (;;) {
+		size_t idx = __atomic_fetch_add(&ctx->next, 1, __ATOMIC_RELAXED);
+		snaprange_job_t *job;
+		int expected = 0;
+		int err;
+
+		if ((idx >= ctx->njobs) ||
+		    __atomic_load_n(&ctx->error, __ATOMIC_RELAXED))
+			break;
+
+		job = &ctx->jobs[idx];
+		err = lzc_snaprange_space(ctx->names[job->first],
+					  ctx->names[job->last],
+					  job->out);
+		if (err == 0)
+			continue;
+
+		// Only the first error is reported. err_job is read after
+		// the worker threads are joined.
+		if (__atomic_compare_exchange_n(&ctx->error, &expected, err,
+		    B_FALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			ctx->err_job = idx;
+		break;
+	}
+}
+
+static void *
+snaprange_worker(void *arg)
+{
+	snaprange_run((snaprange_ctx_t *)arg);
+	return NULL;
+}
+
+static void
+snaprange_execute(snaprange_ctx_t *ctx, int workers)
+{
+	pthread_t tids[SNAPRANGE_MAX_WORKERS];
+	int nthreads = 0;
+	int i;
+
+	if ((size_t)workers > ctx->njobs)
+		workers = (int)ctx->njobs;
+
+	// The calling thread is one of the workers. Failure to start
+	// additional threads only reduces concurrency.
+	for (i = 1; i < workers; i++) {
+		if (pthread_create(&tids[nthreads], NULL,
+				   snaprange_worker, ctx) != 0)
+			break;
+		nthreads++;
+	}
+
+	snaprange_run(ctx);
+
+	for (i = 0; i < nthreads; i++)
+		pthread_join(tids[i], NULL);
+}
+
+/*
+ * Convert snapshot names to full names. Entries may be either the short
+ * snapshot name or "<dataset>@<name>". Returns a new list of str.
+ */
+static PyObject *
+snaprange_full_names(const char *dataset, PyObject *snapshots)
+{
+	PyObject *seq = NULL;
+	PyObject *out = NULL;
+	size_t dslen = strlen(dataset);
+	Py_ssize_t i, n;
+
+	seq = PySequence_Fast(snapshots, "snapshots must be a sequence");
+	if (seq == NULL)
+		return NULL;
+
+	n = PySequence_Fast_GET_SIZE(seq);
+	if (n == 0) {
+		PyErr_SetString(PyExc_ValueError,
+				"At least one snapshot name must "
+				"be specified");
+		goto fail;
+	}
+
+	out = PyList_New(n);
+	if (out == NULL)
+		goto fail;
+
+	for (i = 0; i < n; i++) {
+		PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+		PyObject *full = NULL;
+		const char *cname;
+
+		if (!PyUnicode_Check(item)) {
+			PyErr_Format(PyExc_TypeError,
+				     "%R: item is not a string", item);
+			goto fail;
+		}
+
+		cname = PyUnicode_AsUTF8(item);
+		if (cname == NULL)
+			goto fail;
+
+		if (strchr(cname, '@') == NULL) {
+			full = PyUnicode_FromFormat("%s@%s", dataset, cname);
+			if (full == NULL)
+				goto fail;
+		} else if ((strncmp(cname, dataset, dslen) == 0) &&
+			   (cname[dslen] == '@')) {
+			full = Py_NewRef(item);
+		} else {
+			PyErr_Format(PyExc_ValueError,
+				     "%s: snapshot is not of dataset [%s].",
+				     cname, dataset);
+			goto fail;
+		}
+
+		PyList_SET_ITEM(out, i, full);
+
+		if (!zfs_name_valid(PyUnicode_AsUTF8(full), ZFS_TYPE_SNAPSHOT)) {
+			PyErr_Format(PyExc_TypeError,
+				     "%U: not a valid snapshot name", full);
+			goto fail;
+		}
+	}
+
+	Py_DECREF(seq);
+	return out;
+
+fail:
+	Py_XDECREF(out);
+	Py_DECREF(seq);
+	return NULL;
+}
+
+static int
+snaprange_cmp_index(const void *a, const void *b)
+{
+	size_t x = *(const size_t *)a;
+	size_t y = *(const size_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ * Split each candidate set into maximal runs of consecutive snapshot
+ * indexes. Destroying a set frees the sum of the space freed by each of
+ * its runs since any block unique to one run is still referenced by the
+ * retained snapshot that separates it from the next run.
+ *
+ * On success *runs_out holds all runs and ends_out[c] is the index one
+ * past the last run of candidate c.
+ */
+static int
+snaprange_candidate_runs(PyObject *candidates,
+			 size_t nsnaps,
+			 snaprange_run_t **runs_out,
+			 size_t *nruns_out,
+			 size_t **ends_out,
+			 size_t *ncand_out)
+{
+	PyObject *seq = NULL;
+	snaprange_run_t *runs = NULL;
+	size_t *ends = NULL;
+	size_t *idx = NULL;
+	size_t nruns = 0, size = 0;
+	Py_ssize_t c, ncand;
+
+	seq = PySequence_Fast(candidates, "candidates must be a sequence");
+	if (seq == NULL)
+		return -1;
+
+	ncand = PySequence_Fast_GET_SIZE(seq);
+	ends = PyMem_Calloc(ncand ? ncand : 1, sizeof(size_t));
+	if (ends == NULL) {
+		PyErr_NoMemory();
+		goto fail;
+	}
+
+	for (c = 0; c < ncand; c++) {
+		PyObject *cand;
+		Py_ssize_t i, cnt;
+		size_t j, nidx = 0;
+
+		cand = PySequence_Fast(PySequence_Fast_GET_ITEM(seq, c),
+				       "candidate must be a sequence of "
+				       "snapshot indexes");
+		if (cand == NULL)
+			goto fail;
+
+		cnt = PySequence_Fast_GET_SIZE(cand);
+		PyMem_Free(idx);
+		idx = PyMem_Calloc(cnt ? cnt : 1, sizeof(size_t));
+		if (idx == NULL) {
+			Py_DECREF(cand);
+			PyErr_NoMemory();
+			goto fail;
+		}
+
+		for (i = 0; i < cnt; i++) {
+			Py_ssize_t val;
+
+			val = PyLong_AsSsize_t(PySequence_Fast_GET_ITEM(cand, i));
+			if ((val == -1) && PyErr_Occurred()) {
+				Py_DECREF(cand);
+				goto fail;
+			}
+
+			if ((val < 0) || ((size_t)val >= nsnaps)) {
+				PyErr_Format(PyExc_ValueError,
+					     "%zd: snapshot index in candidate "
+					     "%zd is out of range.", val, c);
+				Py_DECREF(cand);
+				goto fail;
+			}
+			idx[i] = (size_t)val;
+		}
+		Py_DECREF(cand);
+
+		qsort(idx, cnt, sizeof(size_t), snaprange_cmp_index);
+
+		for (j = 0; j < (size_t)cnt; j++) {
+			if ((nidx > 0) && (idx[j] == idx[nidx - 1]))
+				continue;
+			idx[nidx++] = idx[j];
+		}
+
+		for (j = 0; j < nidx; j++) {
+			if ((j > 0) && (idx[j] == idx[j - 1] + 1)) {
+				runs[nruns - 1].last = idx[j];
+				continue;
+			}
+
+			if (nruns == size) {
+				size_t new_size = size ? size * 2 : 64;
+				snaprange_run_t *new_runs;
+
+				new_runs = PyMem_Realloc(runs,
+				    new_size * sizeof(snaprange_run_t));
+				if (new_runs == NULL) {
+					PyErr_NoMemory();
+					goto fail;
+				}
+				runs = new_runs;
+				size = new_size;
+			}
+
+			runs[nruns].first = idx[j];
+			runs[nruns].last = idx[j];
+			nruns++;
+		}
+
+		ends[c] = nruns;
+	}
+
+	PyMem_Free(idx);
+	Py_DECREF(seq);
+	*runs_out = runs;
+	*nruns_out = nruns;
+	*ends_out = ends;
+	*ncand_out = (size_t)ncand;
+	return 0;
+
+fail:
+	PyMem_Free(idx);
+	PyMem_Free(runs);
+	PyMem_Free(ends);
+	Py_DECREF(seq);
+	return -1;
+}
+
+static PyObject *
+snaprange_bytes_to_view(PyObject *bytes, size_t rows, size_t cols)
+{
+	PyObject *mv = NULL;
+	PyObject *out = NULL;
+
+	mv = PyMemoryView_FromObject(bytes);
+	if (mv == NULL)
+		return NULL;
+
+	if (cols == 0) {
+		out = PyObject_CallMethod(mv, "cast", "s", "Q");
+	} else {
+		out = PyObject_CallMethod(mv, "cast", "s(nn)", "Q",
+					  (Py_ssize_t)rows, (Py_ssize_t)cols);
+	}
+	Py_DECREF(mv);
+	return out;
+}
+
+static PyObject *
+snaprange_error_tuple(snaprange_ctx_t *ctx)
+{
+	snaprange_job_t *job = &ctx->jobs[ctx->err_job];
+	const char *last = strchr(ctx->names[job->last], '@');
+
+	// Same notation as `zfs destroy <dataset>@<first>%<last>`
+	return Py_BuildValue("((Ni))",
+			     PyUnicode_FromFormat("%s%%%s",
+						  ctx->names[job->first],
+						  last + 1),
+			     ctx->error);
+}
+
+PyObject *
+py_lzc_snaprange_space_matrix(PyObject *self,
+			      PyObject *args_unused,
+			      PyObject *kwargs)
+{
+	const char *dataset = NULL;
+	PyObject *py_snaps = NULL;
+	PyObject *py_candidates = NULL;
+	Py_ssize_t max_span = SNAPRANGE_DEFAULT_SPAN;
+	int workers = SNAPRANGE_DEFAULT_WORKERS;
+	PyObject *fullnames = NULL;
+	PyObject *matrix = NULL;
+	PyObject *cand_space = NULL;
+	PyObject *out = NULL;
+	snaprange_run_t *runs = NULL;
+	uint64_t *run_space = NULL;
+	size_t *cand_ends = NULL;
+	size_t nsnaps, span, nruns = 0, ncand = 0, i, k, j, bad;
+	snaprange_ctx_t ctx = { 0 };
+	int err;
+
+	char *kwnames[] = {
+		"dataset",
+		"snapshots",
+		"max_span",
+		"candidates",
+		"workers",
+		NULL
+	};
+
+	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs, "|$zOnOi",
+					 kwnames,
+					 &dataset,
+					 &py_snaps,
+					 &max_span,
+					 &py_candidates,
+					 &workers))
+		return NULL;
+
+	if (dataset == NULL) {
+		PyErr_SetString(PyExc_ValueError, "dataset is required");
+		return NULL;
+	}
+
+	if (py_snaps == NULL) {
+		PyErr_SetString(PyExc_ValueError, "snapshots is required");
+		return NULL;
+	}
+
+	if (!zfs_name_valid(dataset, ZFS_TYPE_FILESYSTEM | ZFS_TYPE_VOLUME)) {
+		PyErr_Format(PyExc_TypeError,
+			     "%s: not a valid dataset name", dataset);
+		return NULL;
+	}
+
+	if (max_span < 1) {
+		PyErr_SetString(PyExc_ValueError,
+				"max_span must be a positive integer.");
+		return NULL;
+	}
+
+	if ((workers < 1) || (workers > SNAPRANGE_MAX_WORKERS)) {
+		PyErr_Format(PyExc_ValueError,
+			     "workers must be between 1 and %d.",
+			     SNAPRANGE_MAX_WORKERS);
+		return NULL;
+	}
+
+	fullnames = snaprange_full_names(dataset, py_snaps);
+	if (fullnames == NULL)
+		return NULL;
+
+	nsnaps = (size_t)PyList_GET_SIZE(fullnames);
+	span = ((size_t)max_span > nsnaps) ? nsnaps : (size_t)max_span;
+
+	if (span > PY_SSIZE_T_MAX / sizeof(uint64_t) / nsnaps) {
+		PyErr_SetString(PyExc_OverflowError,
+				"matrix size is too large. Reduce max_span.");
+		goto out;
+	}
+
+	if (!NULL_OR_NONE(py_candidates) &&
+	    (snaprange_candidate_runs(py_candidates, nsnaps, &runs, &nruns,
+				      &cand_ends, &ncand) != 0))
+		goto out;
+
+	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".lzc.snaprange_space_matrix",
+			"sO", dataset, kwargs) < 0)
+		goto out;
+
+	ctx.names = PyMem_Calloc(nsnaps, sizeof(char *));
+	if (ctx.names == NULL) {
+		PyErr_NoMemory();
+		goto out;
+	}
+
+	for (i = 0; i < nsnaps; i++) {
+		ctx.names[i] = PyUnicode_AsUTF8(PyList_GET_ITEM(fullnames, i));
+		if (ctx.names[i] == NULL)
+			goto out;
+	}
+
+	// Results are written directly into the returned buffers.
+	matrix = PyBytes_FromStringAndSize(NULL,
+	    nsnaps * span * sizeof(uint64_t));
+	if (matrix == NULL)
+		goto out;
+	memset(PyBytes_AS_STRING(matrix), 0, PyBytes_GET_SIZE(matrix));
+
+	if (cand_ends != NULL) {
+		cand_space = PyBytes_FromStringAndSize(NULL,
+		    ncand * sizeof(uint64_t));
+		if (cand_space == NULL)
+			goto out;
+		memset(PyBytes_AS_STRING(cand_space), 0,
+		       PyBytes_GET_SIZE(cand_space));
+
+		run_space = PyMem_Calloc(nruns ? nruns : 1, sizeof(uint64_t));
+		if (run_space == NULL) {
+			PyErr_NoMemory();
+			goto out;
+		}
+	}
+
+	for (i = 0; i < nsnaps; i++)
+		ctx.njobs += (nsnaps - i < span) ? nsnaps - i : span;
+	ctx.njobs += nruns;
+
+	ctx.jobs = PyMem_Calloc(ctx.njobs, sizeof(snaprange_job_t));
+	if (ctx.jobs == NULL) {
+		PyErr_NoMemory();
+		goto out;
+	}
+
+	j = 0;
+	for (i = 0; i < nsnaps; i++) {
+		uint64_t *row = (uint64_t *)PyBytes_AS_STRING(matrix) + (i * span);
+
+		for (k = 0; (k < span) && (i + k < nsnaps); k++) {
+			ctx.jobs[j++] = (snaprange_job_t) {
+				.first = i,
+				.last = i + k,
+				.out = &row[k],
+			};
+		}
+	}
+
+	for (i = 0; i < nruns; i++) {
+		ctx.jobs[j++] = (snaprange_job_t) {
+			.first = runs[i].first,
+			.last = runs[i].last,
+			.out = &run_space[i],
+		};
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	err = snaprange_check_order(dataset, ctx.names, nsnaps, &bad);
+	if (err == 0)
+		snaprange_execute(&ctx, workers);
+	Py_END_ALLOW_THREADS
+
+	if (err) {
+		snaprange_order_exc(self, dataset, ctx.names, bad, nsnaps, err);
+		goto out;
+	}
+
+	if (ctx.error) {
+		PyObject *errtup = snaprange_error_tuple(&ctx);
+		if (errtup == NULL)
+			goto out;
+
+		set_zfscore_exc(self, "lzc_snaprange_space() failed",
+				ctx.error, errtup);
+		Py_DECREF(errtup);
+		goto out;
+	}
+
+	if (cand_ends != NULL) {
+		uint64_t *sums = (uint64_t *)PyBytes_AS_STRING(cand_space);
+		size_t r = 0;
+
+		for (i = 0; i < ncand; i++) {
+			for (; r < cand_ends[i]; r++)
+				sums[i] += run_space[r];
+		}
+	}
+
+	out = snaprange_bytes_to_view(matrix, nsnaps, span);
+	if ((out != NULL) && (cand_space != NULL)) {
+		PyObject *view = snaprange_bytes_to_view(cand_space, ncand, 0);
+		if (view == NULL)
+			Py_CLEAR(out);
+		else
+			out = Py_BuildValue("(NN)", out, view);
+	}
+
+out:
+	Py_XDECREF(fullnames);
+	Py_XDECREF(matrix);
+	Py_XDECREF(cand_space);
+	PyMem_Free(ctx.names);
+	PyMem_Free(ctx.jobs);
+	PyMem_Free(runs);
+	PyMem_Free(run_space);
+	PyMem_Free(cand_ends);
+	return out;
+}
@@ -0,0 +1,13 @@
+#ifndef _LIBZFS_CORE_SNAPRANGE_H
+#define _LIBZFS_CORE_SNAPRANGE_H
+#include "../truenas_pylibzfs.h"
+
+/* Exposed from py_zfs_core_module.c */
+extern void set_zfscore_exc(PyObject *module, const char *msg, int code,
+			    PyObject *errors_tuple);
+
+/* Functions implemented in libzfs_core_snaprange.c */
+extern PyObject *py_lzc_snaprange_space_matrix(PyObject *self, PyObject *args,
+					       PyObject *kwds);
+
+#endif /* _LIBZFS_CORE_SNAPRANGE_H */
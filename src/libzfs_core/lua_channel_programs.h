@@ -216,6 +216,102 @@ static const char SNAPSHOT_ROLLBACK_LUA[] =
 "\n"
 "return out\n";
 
+/*
+ * Read-only listing of a dataset tree and requested properties for
+ * lzc.list_tree(). Snapshots and children are visited in name order. At
+ * most `limit` entries are returned per run. If more remain, "next" holds
+ * the name of the last entry returned, and is passed back as `after` to
+ * continue. Resuming only descends the path to `after`, so subtrees that
+ * were already returned are not walked again.
+ */
+static const char LIST_TREE_LUA[] =
+"entries = {}\n"
+"count = 0\n"
+"last = nil\n"
+"complete = true\n"
+"\n"
+"function add_entry(ds)\n"
+"    if count >= limit then\n"
+"        complete = false\n"
+"        return false\n"
+"    end\n"
+"    local entry = {}\n"
+"    if props then\n"
+"        for i, prop in ipairs(props) do\n"
+"            -- properties that do not apply to this type are omitted\n"
+"            local ok, val, src = pcall(zfs.get_prop, ds, prop)\n"
+"            if ok and val ~= nil then\n"
+"                entry[prop] = {value = val, source = src}\n"
+"            end\n"
+"        end\n"
+"    end\n"
+"    entries[ds] = entry\n"
+"    count = count + 1\n"
+"    last = ds\n"
+"    return true\n"
+"end\n"
+"\n"
+"function sorted(iter)\n"
+"    local names = {}\n"
+"    for name in iter do\n"
+"        table.insert(names, name)\n"
+"    end\n"
+"    table.sort(names)\n"
+"    return names\n"
+"end\n"
+"\n"
+"-- If resume is set then `after` is ds, one of its snapshots or one of\n"
+"-- its descendants, and everything up to and including it is skipped.\n"
+"function walk(ds, depth, resume)\n"
+"    local path = nil\n"
+"    if resume then\n"
+"        if string.sub(after, #ds + 1, #ds + 1) == \"/\" then\n"
+"            local rest = string.sub(after, #ds + 2)\n"
+"            path = ds .. \"/\" .. string.match(rest, \"^[^/@]+\")\n"
+"        end\n"
+"    elseif not add_entry(ds) then\n"
+"        return false\n"
+"    end\n"
+"    if snapshots and not path then\n"
+"        for i, snap in ipairs(sorted(zfs.list.snapshots(ds))) do\n"
+"            if not (resume and snap <= after) then\n"
+"                if not add_entry(snap) then\n"
+"                    return false\n"
+"                end\n"
+"            end\n"
+"        end\n"
+"    end\n"
+"    if max_depth < 0 or depth < max_depth then\n"
+"        for i, child in ipairs(sorted(zfs.list.children(ds))) do\n"
+"            if child == path then\n"
+"                if not walk(child, depth + 1, true) then\n"
+"                    return false\n"
+"                end\n"
+"            elseif not (path and child < path) then\n"
+"                if not walk(child, depth + 1, false) then\n"
+"                    return false\n"
+"                end\n"
+"            end\n"
+"        end\n"
+"    end\n"
+"    return true\n"
+"end\n"
+"\n"
+"args = ...\n"
+"props = args[\"properties\"]\n"
+"snapshots = args[\"snapshots\"]\n"
+"max_depth = args[\"max_depth\"]\n"
+"after = args[\"after\"]\n"
+"limit = args[\"limit\"]\n"
+"walk(args[\"root\"], 0, after ~= nil)\n"
+"\n"
+"out = {}\n"
+"out[\"entries\"] = entries\n"
+"if not complete then\n"
+"    out[\"next\"] = last\n"
+"end\n"
+"\n"
+"return out\n";
 
 static const struct {
 	const char *name;
@@ -225,6 +321,7 @@ static const struct {
 	{ "DESTROY_SNAPSHOTS", SNAPSHOT_DESTROY_LUA },
 	{ "TAKE_SNAPSHOTS", SNAPSHOT_TAKE_LUA },
 	{ "ROLLBACK_TO_TXG", SNAPSHOT_ROLLBACK_LUA },
+	{ "LIST_TREE", LIST_TREE_LUA },
 };
 
 #endif /* PY_ZFS_CORE_LUA_SCRIPT_H */
@@ -1,6 +1,9 @@
 #include "../truenas_pylibzfs.h"
 #include "lua_channel_programs.h"
 #include "libzfs_core_replication.h"
+#include "libzfs_core_snaprange.h"
+
+#include <pthread.h>
 
 typedef struct {
 	PyObject *zc_exc;
@@ -1096,6 +1099,374 @@ static PyObject *py_lzc_create_snaps(PyObject *self,
 	Py_RETURN_NONE;
 }
 
+/*
+ * Implementation of lzc.create_snapshots_multi()
+ *
+ * lzc_snapshot() requires all snapshots to be within one pool. Snapshot
+ * names are partitioned by pool and one lzc_snapshot() is issued per pool,
+ * each on its own native thread, so that the total latency is that of the
+ * slowest pool rather than the sum over all pools.
+ *
+ * The kernel only permits the history entry for a snapshot ioctl from the
+ * thread that issued it, so history is written by the same thread through
+ * a temporary libzfs handle, without the GIL.
+ */
+
+typedef struct {
+	char pool[ZFS_MAX_DATASET_NAME_LEN];
+	nvlist_t *snaps;
+	nvlist_t *props;
+	const char *props_json;
+	nvlist_t *errors;
+	size_t nsnaps;
+	int err;
+	int history_err;
+	pthread_t tid;
+	boolean_t started;
+} snap_group_t;
+
+static int
+snap_group_log_history(snap_group_t *g)
+{
+	char histbuf[PYMAXHISTORYLEN];
+	libzfs_handle_t *hdl;
+	int err = 0;
+
+	if (g->props_json) {
+		snprintf(histbuf, sizeof(histbuf),
+			 "truenas_pylibzfs: lzc_snapshot() %zu snapshots of "
+			 "datasets within pool \"%s\" with user properties: %s",
+			 g->nsnaps, g->pool, g->props_json);
+	} else {
+		snprintf(histbuf, sizeof(histbuf),
+			 "truenas_pylibzfs: lzc_snapshot() %zu snapshots of "
+			 "datasets within pool \"%s\"",
+			 g->nsnaps, g->pool);
+	}
+
+	hdl = libzfs_init();
+	if (hdl == NULL)
+		return errno ? errno : ENOMEM;
+
+	do {
+		if (zpool_log_history(hdl, histbuf) != 0)
+			err = errno;
+		else
+			err = 0;
+	} while (err == EINTR);
+
+	libzfs_fini(hdl);
+	return err;
+}
+
+static void *
+snap_group_worker(void *arg)
+{
+	snap_group_t *g = (snap_group_t *)arg;
+
+	g->err = lzc_snapshot(g->snaps, g->props, &g->errors);
+	if (g->err == 0)
+		g->history_err = snap_group_log_history(g);
+
+	return NULL;
+}
+
+static snap_group_t *
+snap_group_lookup(snap_group_t **groups, size_t *ngroups, const char *snap)
+{
+	char pool[ZFS_MAX_DATASET_NAME_LEN];
+	snap_group_t *new_groups;
+	size_t i;
+
+	strlcpy(pool, snap, sizeof(pool));
+	pool[strcspn(pool, "/@")] = '\0';
+
+	for (i = 0; i < *ngroups; i++) {
+		if (strcmp((*groups)[i].pool, pool) == 0)
+			return &(*groups)[i];
+	}
+
+	new_groups = PyMem_Realloc(*groups,
+	    (*ngroups + 1) * sizeof(snap_group_t));
+	if (new_groups == NULL) {
+		PyErr_NoMemory();
+		return NULL;
+	}
+
+	*groups = new_groups;
+	memset(&new_groups[*ngroups], 0, sizeof(snap_group_t));
+	strlcpy(new_groups[*ngroups].pool, pool, sizeof(pool));
+	new_groups[*ngroups].snaps = fnvlist_alloc();
+	return &new_groups[(*ngroups)++];
+}
+
+/*
+ * Partition snapshot names by pool. Validation is the same as for
+ * create_snapshots() except that entries may span pools.
+ */
+static boolean_t
+py_iter_to_snap_groups(PyObject *obj, snap_group_t **groups, size_t *ngroups)
+{
+	PyObject *item = NULL;
+	PyObject *iterator = NULL;
+	PyObject *dsname_set = NULL;
+	boolean_t ok = B_FALSE;
+
+	iterator = PyObject_GetIter(obj);
+	if (iterator == NULL)
+		return B_FALSE;
+
+	dsname_set = PySet_New(NULL);
+	if (dsname_set == NULL)
+		goto out;
+
+	while ((item = PyIter_Next(iterator))) {
+		snap_group_t *g;
+		const char *snap;
+
+		if (!PyUnicode_Check(item)) {
+			PyErr_Format(PyExc_TypeError,
+				     "%R: item  is not a string", item);
+			Py_DECREF(item);
+			goto out;
+		}
+
+		snap = PyUnicode_AsUTF8(item);
+		if (snap == NULL) {
+			Py_DECREF(item);
+			goto out;
+		}
+
+		g = snap_group_lookup(groups, ngroups, snap);
+		if ((g == NULL) ||
+		    !py_snapname_to_nvpair(ADD_SNAP, g->snaps, item, dsname_set,
+					   g->pool, sizeof(g->pool))) {
+			Py_DECREF(item);
+			goto out;
+		}
+
+		g->nsnaps++;
+		Py_DECREF(item);
+	}
+
+	if (PyErr_Occurred())
+		goto out;
+
+	if (*ngroups == 0) {
+		PyErr_SetString(PyExc_ValueError,
+				"At least one snapshot name must "
+				"be specified");
+		goto out;
+	}
+
+	ok = B_TRUE;
+out:
+	Py_XDECREF(dsname_set);
+	Py_DECREF(iterator);
+	return ok;
+}
+
+static PyObject *
+snap_groups_err_tuple(snap_group_t *groups, size_t ngroups)
+{
+	PyObject *out = NULL;
+	size_t i;
+
+	out = PyList_New(0);
+	if (out == NULL)
+		return NULL;
+
+	for (i = 0; i < ngroups; i++) {
+		PyObject *errs;
+		Py_ssize_t cnt;
+
+		if (groups[i].err == 0)
+			continue;
+
+		errs = nvlist_errors_to_err_tuple(groups[i].errors,
+						  groups[i].err);
+		if (errs == NULL)
+			goto fail;
+
+		cnt = PyList_GET_SIZE(out);
+		if (PyList_SetSlice(out, cnt, cnt, errs) < 0) {
+			Py_DECREF(errs);
+			goto fail;
+		}
+		Py_DECREF(errs);
+	}
+
+	Py_SETREF(out, PyList_AsTuple(out));
+	return out;
+fail:
+	Py_DECREF(out);
+	return NULL;
+}
+
+PyDoc_STRVAR(py_zfs_core_create_snaps_multi__doc__,
+"create_snapshots_multi(*, snapshot_names, user_properties=None) -> None\n"
+"-----------------------------------------------------------------------\n\n"
+"Bulk create ZFS snapshots that may span multiple pools. Arguments are\n"
+"keyword-only.\n\n"
+"Snapshot names are grouped by pool and one lzc_snapshot() call is made per\n"
+"pool. The calls for different pools run concurrently on native threads\n"
+"with the GIL released. Snapshots within a pool are created atomically,\n"
+"but there is no atomicity across pools: if the snapshots of one pool fail\n"
+"then those of other pools may still have been created.\n\n"
+""
+"Parameters\n"
+"----------\n"
+"snapshot_names: iterable\n"
+"    Iterable (set, list, tuple, etc) containing names of snapshots to create.\n\n"
+"user_properties: dict, optional\n"
+"    Optional user properties to set on the newly-created snapshots.\n"
+"    See create_snapshots() for details.\n\n"
+""
+"Returns\n"
+"-------\n"
+"None\n\n"
+""
+"Raises\n"
+"------\n"
+"TypeError:\n"
+"    \"snapshot_names\" is not iterable.\n"
+"    \"snapshot_names\" contains an entry that is not a valid snapshot name.\n"
+"\n"
+"ValueError:\n"
+"    Multiple entries for same dataset were specified\n"
+"    \"snapshot_names\" was omitted or is empty\n"
+"\n"
+"ZFSCoreException:\n"
+"    Failed to create the snapshots of one or more pools. The failed\n"
+"    snapshots and error numbers of all such pools are reported by the\n"
+"    exception's \"errors\" attribute. The \"code\" attribute is the error\n"
+"    of the first failed pool.\n"
+"\n"
+"RuntimeError:\n"
+"    All snapshots were created but writing the pool history failed.\n"
+);
+static PyObject *py_lzc_create_snaps_multi(PyObject *self,
+					   PyObject *args_unused,
+					   PyObject *kwargs)
+{
+	PyObject *py_snaps = NULL;
+	PyObject *py_props_dict = NULL;
+	PyObject *py_errors = NULL;
+	nvlist_t *user_props = NULL;
+	char *user_props_json = NULL;
+	snap_group_t *groups = NULL;
+	snap_group_t *failed = NULL;
+	snap_group_t *hist_failed = NULL;
+	size_t ngroups = 0, i;
+	PyObject *out = NULL;
+
+	char *kwnames [] = {
+		"snapshot_names",
+		"user_properties",
+		NULL
+	};
+
+	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
+					 "|$OO",
+					 kwnames,
+					 &py_snaps,
+					 &py_props_dict)) {
+		return NULL;
+	}
+
+	if (py_snaps == NULL) {
+		PyErr_SetString(PyExc_ValueError,
+				"snapshot_names parameter is required");
+		return NULL;
+	}
+
+	if (!py_iter_to_snap_groups(py_snaps, &groups, &ngroups))
+		goto out;
+
+	if (py_props_dict && py_props_dict != Py_None) {
+		user_props = py_userprops_dict_to_nvlist(py_props_dict);
+		if (user_props == NULL)
+			goto out;
+
+		user_props_json = nvlist_to_json_str(user_props);
+	}
+
+	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".lzc.create_snapshots_multi",
+			"O", kwargs) < 0) {
+		goto out;
+	}
+
+	for (i = 0; i < ngroups; i++) {
+		groups[i].props = user_props;
+		groups[i].props_json = user_props_json;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	// The first pool is handled by the calling thread. If a thread can
+	// not be created then that pool is also handled here.
+	for (i = 1; i < ngroups; i++) {
+		groups[i].started = pthread_create(&groups[i].tid, NULL,
+						   snap_group_worker,
+						   &groups[i]) == 0;
+	}
+
+	for (i = 0; i < ngroups; i++) {
+		if (groups[i].started)
+			continue;
+		snap_group_worker(&groups[i]);
+	}
+
+	for (i = 1; i < ngroups; i++) {
+		if (groups[i].started)
+			pthread_join(groups[i].tid, NULL);
+	}
+	Py_END_ALLOW_THREADS
+
+	for (i = 0; i < ngroups; i++) {
+		if ((failed == NULL) && groups[i].err)
+			failed = &groups[i];
+		if ((hist_failed == NULL) && groups[i].history_err)
+			hist_failed = &groups[i];
+	}
+
+	if (failed != NULL) {
+		py_errors = snap_groups_err_tuple(groups, ngroups);
+		if (py_errors == NULL)
+			goto out;
+
+		set_zfscore_exc(self, "lzc_snapshot() failed", failed->err,
+				py_errors);
+		Py_DECREF(py_errors);
+		goto out;
+	}
+
+	if (hist_failed != NULL) {
+		PyErr_Format(PyExc_RuntimeError,
+			     "[%s]: attempt to log snapshot creation to zpool "
+			     "history failed with error [%d]: %s. Since logging "
+			     "occurs after the action completes, this means "
+			     "that the snapshots were created successfully.",
+			     hist_failed->pool, hist_failed->history_err,
+			     strerror(hist_failed->history_err));
+		goto out;
+	}
+
+	out = Py_NewRef(Py_None);
+
+out:
+	Py_BEGIN_ALLOW_THREADS
+	for (i = 0; i < ngroups; i++) {
+		fnvlist_free(groups[i].snaps);
+		fnvlist_free(groups[i].errors);
+	}
+	fnvlist_free(user_props);
+	Py_END_ALLOW_THREADS
+
+	PyMem_RawFree(user_props_json);
+	PyMem_Free(groups);
+	return out;
+}
+
 PyDoc_STRVAR(py_zfs_core_destroy_snaps__doc__,
 "destroy_snapshots(*, snapshot_names, defer_destroy=False) -> None\n"
 "------------------------------------------------------------------\n\n"
@@ -1489,6 +1860,302 @@ static PyObject *py_lzc_program(PyObject *self,
 	return py_out;
 }
 
+#define	LIST_TREE_CHUNK		4096
+
+/*
+ * Convert iterable of property names (str or ZFSProperty) to nvlist string
+ * array under key "properties" in args.
+ */
+static boolean_t
+py_list_tree_props(PyObject *pyprops, nvlist_t *args)
+{
+	PyObject *seq = NULL;
+	const char **names = NULL;
+	Py_ssize_t cnt, i;
+
+	seq = PySequence_Fast(pyprops, "properties must be iterable");
+	if (seq == NULL)
+		return B_FALSE;
+
+	cnt = PySequence_Fast_GET_SIZE(seq);
+	if (cnt == 0) {
+		Py_DECREF(seq);
+		return B_TRUE;
+	}
+
+	names = PyMem_Calloc(cnt, sizeof (char *));
+	if (names == NULL) {
+		Py_DECREF(seq);
+		PyErr_NoMemory();
+		return B_FALSE;
+	}
+
+	for (i = 0; i < cnt; i++) {
+		/* borrowed reference, kept alive by seq */
+		PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+
+		if (PyUnicode_Check(item)) {
+			names[i] = PyUnicode_AsUTF8(item);
+			if (names[i] == NULL)
+				goto fail;
+		} else if (PyLong_Check(item)) {
+			// truenas_pylibzfs.ZFSProperty
+			long val = PyLong_AsLong(item);
+			if ((val < 0) || (val >= ZFS_NUM_PROPS)) {
+				if (!PyErr_Occurred()) {
+					PyErr_Format(PyExc_ValueError,
+						     "%R: not a valid ZFS "
+						     "property.", item);
+				}
+				goto fail;
+			}
+			names[i] = zfs_prop_to_name((zfs_prop_t)val);
+		} else {
+			PyErr_Format(PyExc_TypeError,
+				     "%R: property must be a string or "
+				     "ZFSProperty.", item);
+			goto fail;
+		}
+	}
+
+	fnvlist_add_string_array(args, "properties", names, (uint_t)cnt);
+	PyMem_Free(names);
+	Py_DECREF(seq);
+	return B_TRUE;
+
+fail:
+	PyMem_Free(names);
+	Py_DECREF(seq);
+	return B_FALSE;
+}
+
+PyDoc_STRVAR(py_lzc_list_tree__doc__,
+"list_tree(*, root, properties=None, snapshots=False, max_depth=None,\n"
+"          instruction_limit=10000000, memory_limit=10485760) -> dict\n"
+"------------------------------------------------------------------\n\n"
+"List a dataset and its descendants along with the requested properties\n"
+"using a read-only channel program (ChannelProgramEnum.LIST_TREE). Names\n"
+"and property values for many datasets are gathered by each\n"
+"lzc_channel_program_nosync() call rather than by per-dataset list and\n"
+"property ioctls.\n\n"
+"Results are gathered in chunks of datasets. If a chunk exceeds the\n"
+"instruction or memory limit then a single entry is listed from the same\n"
+"position and the chunk size is halved, and the chunk size grows again\n"
+"once a chunk succeeds. Snapshots and children are walked in name order\n"
+"and each chunk continues after the name of the last entry returned by\n"
+"the previous one. The listing is only consistent within a chunk:\n"
+"datasets created or destroyed during the call may or may not be\n"
+"included, but entries that exist throughout are listed once.\n\n"
+"Every run lists and sorts all snapshots and children of each dataset on\n"
+"the path to the position it continues from, whatever the chunk size.\n"
+"The number of snapshots (and children) of a single dataset is therefore\n"
+"limited by instruction_limit and memory_limit. If even a single entry\n"
+"does not fit then ZFSCoreException is raised and the limits need to be\n"
+"raised.\n\n"
+"Parameters\n"
+"----------\n"
+"root: str, required\n"
+"    Name of the filesystem or volume at which to start. The root is\n"
+"    included in the output.\n"
+"properties: iterable, optional\n"
+"    Property names (str, including user properties) or\n"
+"    truenas_pylibzfs.ZFSProperty members to retrieve for each entry.\n"
+"snapshots: bool, optional, default=False\n"
+"    Include the snapshots of each dataset visited.\n"
+"max_depth: int, optional\n"
+"    Maximum depth of children below root to descend. 0 lists only the\n"
+"    root (and its snapshots). Defaults to no limit.\n"
+"instruction_limit: int, optional, default=10000000\n"
+"    Instruction limit for each channel program run.\n"
+"memory_limit: int, optional, default=10485760\n"
+"    Memory limit for each channel program run.\n"
+"\n"
+"Returns\n"
+"-------\n"
+"dict mapping the name of each dataset (and snapshot) to a dictionary of\n"
+"{property: {\"value\": value, \"source\": source}} as returned by\n"
+"zfs.get_prop(). Properties that do not apply to an entry are omitted.\n\n"
+"Raises\n"
+"------\n"
+"TypeError:\n"
+"    \"properties\" is not an iterable of str / ZFSProperty.\n"
+"\n"
+"ValueError:\n"
+"    \"root\" was omitted or max_depth is negative.\n"
+"\n"
+"ZFSCoreException:\n"
+"    Failed to execute the channel program (for example root does not\n"
+"    exist), or a single entry exceeds the instruction or memory limit.\n\n"
+);
+static PyObject *py_lzc_list_tree(PyObject *self,
+				  PyObject *args_unused,
+				  PyObject *kwargs)
+{
+	const char *root = NULL;
+	char pool[ZFS_MAX_DATASET_NAME_LEN];
+	PyObject *pyprops = NULL;
+	PyObject *pydepth = NULL;
+	PyObject *out = NULL;
+	boolean_t snapshots = B_FALSE;
+	uint64_t ilimit = ZCP_DEFAULT_INSTRLIMIT;
+	uint64_t mlimit = ZCP_DEFAULT_MEMLIMIT;
+	int64_t max_depth = -1;
+	char after[ZFS_MAX_DATASET_NAME_LEN] = {0};
+	uint64_t chunk = LIST_TREE_CHUNK;
+	uint64_t next_chunk = 0;
+	nvlist_t *base = NULL;
+
+	char *kwnames [] = {
+		"root",
+		"properties",
+		"snapshots",
+		"max_depth",
+		"instruction_limit",
+		"memory_limit",
+		NULL
+	};
+
+	if (!PyArg_ParseTupleAndKeywords(args_unused, kwargs,
+					 "|$sOpOkk",
+					 kwnames,
+					 &root,
+					 &pyprops,
+					 &snapshots,
+					 &pydepth,
+					 &ilimit,
+					 &mlimit)) {
+		return NULL;
+	}
+
+	if (!root) {
+		PyErr_SetString(PyExc_ValueError, "root is required");
+		return NULL;
+	}
+
+	if (!NULL_OR_NONE(pydepth)) {
+		max_depth = PyLong_AsLongLong(pydepth);
+		if (max_depth == -1 && PyErr_Occurred())
+			return NULL;
+		if (max_depth < 0) {
+			PyErr_SetString(PyExc_ValueError,
+					"max_depth must not be negative");
+			return NULL;
+		}
+	}
+
+	strlcpy(pool, root, sizeof(pool));
+	pool[strcspn(pool, "/@")] = '\0';
+
+	base = fnvlist_alloc();
+	fnvlist_add_string(base, "root", root);
+	fnvlist_add_boolean_value(base, "snapshots", snapshots);
+	fnvlist_add_int64(base, "max_depth", max_depth);
+
+	if (!NULL_OR_NONE(pyprops) && !py_list_tree_props(pyprops, base)) {
+		fnvlist_free(base);
+		return NULL;
+	}
+
+	if (PySys_Audit(PYLIBZFS_MODULE_NAME ".lzc.list_tree", "s",
+			root) < 0) {
+		fnvlist_free(base);
+		return NULL;
+	}
+
+	out = PyDict_New();
+	if (out == NULL) {
+		fnvlist_free(base);
+		return NULL;
+	}
+
+	for (;;) {
+		nvlist_t *args = fnvlist_dup(base);
+		nvlist_t *outnvl = NULL;
+		nvlist_t *ret = NULL;
+		nvlist_t *entries = NULL;
+		PyObject *chunk_dict = NULL;
+		const char *next = NULL;
+		int err;
+
+		if (after[0] != '\0')
+			fnvlist_add_string(args, "after", after);
+		fnvlist_add_int64(args, "limit", (int64_t)chunk);
+
+		Py_BEGIN_ALLOW_THREADS
+		err = lzc_channel_program_nosync(pool, LIST_TREE_LUA, ilimit,
+						 mlimit, args, &outnvl);
+		fnvlist_free(args);
+		Py_END_ALLOW_THREADS
+
+		if ((err == ENOSPC || err == ENOMEM || err == ETIME) &&
+		    (chunk > 1)) {
+			/*
+			 * Limit hit. Listing and sorting the snapshots and
+			 * children on the resume path costs the same whatever
+			 * the chunk size, so first check that a single entry
+			 * fits before halving the chunk. If it does not then
+			 * no chunk size will and we fail below.
+			 */
+			fnvlist_free(outnvl);
+			next_chunk = chunk / 2;
+			chunk = 1;
+			continue;
+		}
+
+		if (err) {
+			PyObject *py_err = zcp_nvlist_errs_to_err_tuple(outnvl,
+									err);
+			const char *msg = "lzc_channel_program_nosync() failed";
+
+			if (err == ENOSPC || err == ENOMEM || err == ETIME) {
+				msg = "list_tree() exceeded the instruction or "
+				      "memory limit for a single entry";
+			}
+
+			fnvlist_free(outnvl);
+			if (py_err != NULL) {
+				set_zfscore_exc(self, msg, err, py_err);
+				Py_DECREF(py_err);
+			}
+			goto fail;
+		}
+
+		ret = fnvlist_lookup_nvlist(outnvl, ZCP_RET_RETURN);
+		entries = fnvlist_lookup_nvlist(ret, "entries");
+		if (nvlist_lookup_string(ret, "next", &next) == 0)
+			strlcpy(after, next, sizeof(after));
+
+		chunk_dict = py_nvlist_to_dict(entries);
+		fnvlist_free(outnvl);
+		if (chunk_dict == NULL)
+			goto fail;
+
+		err = PyDict_Update(out, chunk_dict);
+		Py_DECREF(chunk_dict);
+		if (err)
+			goto fail;
+
+		if (next == NULL)
+			break;
+
+		// Chunk fit within the limits, try a larger one next time
+		if (next_chunk != 0) {
+			chunk = next_chunk;
+			next_chunk = 0;
+		} else if (chunk < LIST_TREE_CHUNK) {
+			chunk *= 2;
+		}
+	}
+
+	fnvlist_free(base);
+	return out;
+
+fail:
+	fnvlist_free(base);
+	Py_DECREF(out);
+	return NULL;
+}
+
 PyDoc_STRVAR(py_zfs_core_rollback__doc__,
 "rollback(*, resource_name, snapshot_name=None) -> str\n"
 "------------------------------------------------------------------\n\n"
@@ -2053,6 +2720,62 @@ PyDoc_STRVAR(py_lzc_local_replicate__doc__,
 "function returns None.\n"
 );
 
+PyDoc_STRVAR(py_lzc_snaprange_space_matrix__doc__,
+"snaprange_space_matrix(*, dataset, snapshots, max_span=64, candidates=None,\n"
+"                       workers=4) -> memoryview | tuple[memoryview, memoryview]\n"
+"--------------------------------------------------------------------------\n\n"
+"Compute the space that would be freed by destroying ranges and sets of\n"
+"snapshots of a dataset. Each value is obtained with lzc_snaprange_space()\n"
+"and the calls are spread over native worker threads with the GIL released.\n\n"
+"Parameters\n"
+"----------\n"
+"dataset: str, required\n"
+"    Name of the filesystem or volume that owns the snapshots.\n\n"
+"snapshots: sequence of str, required\n"
+"    Consecutive snapshots of dataset ordered from oldest to newest, as\n"
+"    returned by list_snapshot_names(order_by_transaction_group=True).\n"
+"    This may be a slice of the dataset's snapshots but must not skip\n"
+"    any, since a range always includes every snapshot between its first\n"
+"    and last. Entries may be either the snapshot name (\"snap1\") or the\n"
+"    full name (\"pool/ds@snap1\").\n\n"
+"max_span: int, optional, default=64\n"
+"    Maximum number of consecutive snapshots per range. Must be at least\n"
+"    1. The number of ioctls performed for the matrix is roughly\n"
+"    len(snapshots) * max_span and the matrix takes\n"
+"    len(snapshots) * max_span * 8 bytes.\n\n"
+"candidates: sequence of sequences of int, optional\n"
+"    Sets of snapshot indexes (into snapshots) to evaluate for destruction\n"
+"    together. Indexes need not be contiguous or sorted.\n\n"
+"workers: int, optional, default=4\n"
+"    Number of threads issuing ioctls (including the calling thread).\n"
+"    Must be between 1 and 64.\n\n"
+"Returns\n"
+"-------\n"
+"memoryview\n"
+"    Read-only memoryview of format \"Q\" and shape\n"
+"    (len(snapshots), span). Element [i, k] is the number of bytes freed\n"
+"    by destroying snapshots[i] through snapshots[i + k]. Elements where\n"
+"    i + k is past the last snapshot are 0.\n\n"
+"    If candidates is specified then a tuple (matrix, candidate_space) is\n"
+"    returned where candidate_space is a memoryview of format \"Q\" with the\n"
+"    number of bytes freed by destroying each candidate set.\n\n"
+"Raises\n"
+"------\n"
+"TypeError:\n"
+"    dataset or an entry in snapshots is not a valid name.\n\n"
+"ValueError:\n"
+"    A required argument was omitted, snapshots is empty, a snapshot\n"
+"    belongs to another dataset, or an argument is out of range.\n\n"
+"OverflowError:\n"
+"    The matrix would be too large to allocate.\n\n"
+"ZFSCoreException:\n"
+"    A snapshot does not exist (ENOENT), snapshots are not consecutive\n"
+"    snapshots of the dataset ordered oldest to newest (EINVAL), or\n"
+"    lzc_snaprange_space() failed. The errors attribute contains the\n"
+"    missing snapshot or the offending range in\n"
+"    `<dataset>@<first>%<last>` notation and the error number.\n"
+);
+
 static int
 py_zfs_core_module_clear(PyObject *module)
 {
@@ -2079,6 +2802,12 @@ static PyMethodDef TruenasPylibzfsCoreMethods[] = {
 		.ml_flags = METH_VARARGS | METH_KEYWORDS,
 		.ml_doc = py_zfs_core_create_snaps__doc__
 	},
+	{
+		.ml_name = "create_snapshots_multi",
+		.ml_meth = (PyCFunction)py_lzc_create_snaps_multi,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_zfs_core_create_snaps_multi__doc__
+	},
 	{
 		.ml_name = "destroy_snapshots",
 		.ml_meth = (PyCFunction)py_lzc_destroy_snaps,
@@ -2103,6 +2832,12 @@ static PyMethodDef TruenasPylibzfsCoreMethods[] = {
 		.ml_flags = METH_VARARGS | METH_KEYWORDS,
 		.ml_doc = py_lzc_program__doc__
 	},
+	{
+		.ml_name = "list_tree",
+		.ml_meth = (PyCFunction)py_lzc_list_tree,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_lzc_list_tree__doc__
+	},
 	{
 		.ml_name = "rollback",
 		.ml_meth = (PyCFunction)py_lzc_rollback,
@@ -2133,6 +2868,12 @@ static PyMethodDef TruenasPylibzfsCoreMethods[] = {
 		.ml_flags = METH_VARARGS | METH_KEYWORDS,
 		.ml_doc = py_lzc_send_progress__doc__
 	},
+	{
+		.ml_name = "snaprange_space_matrix",
+		.ml_meth = (PyCFunction)py_lzc_snaprange_space_matrix,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_lzc_snaprange_space_matrix__doc__
+	},
 	{
 		.ml_name = "receive",
 		.ml_meth = (PyCFunction)py_lzc_receive,
@@ -4,13 +4,18 @@
 
 static PyTypeObject *alltypes[] = {
 	&ZFS,
+	&ZFSAio,
 	&ZFSCrypto,
 	&ZFSDataset,
 	&ZFSEventIterator,
+	&ZFSFilter,
 	&ZFSHistoryIterator,
 	&ZFSObject,
 	&ZFSPool,
+	&ZFSPropertySelector,
+	&ZFSPropertyView,
 	&ZFSResource,
+	&ZFSResourceIterator,
 	&ZFSSnapshot,
 	&ZFSVolume,
 	NULL
@@ -66,7 +71,8 @@ static int types_ready(PyObject *m) {
 
 PyDoc_STRVAR(py_get_libzfs_handle__doc__,
 "open_handle(*, history=True, history_prefix=\"truenas_pylibzfs:\", "
-"mnttab_cache=True) -> bool\n\n"
+"mnttab_cache=True, property_cache_ttl=0, pool_size=1, aio_workers=4, "
+"aio_queue_depth=256) -> bool\n\n"
 "--------------------------------------------------------\n\n"
 "Open a python libzfs handle. Arguments are keyword-only\n\n"
 "Parameters\n"
@@ -81,7 +87,34 @@ PyDoc_STRVAR(py_get_libzfs_handle__doc__,
 ""
 "mnttab_cache: bool, optional, default=True\n"
 "    Option boolean argument to determine whether to cache the mnttab\n"
-"    within the libzfs handle. Defaults to True.\n\n"
+"    within the libzfs handle. Defaults to True, or to False when\n"
+"    pool_size is greater than 1 since each libzfs handle would keep its\n"
+"    own cache. Passing mnttab_cache=True together with pool_size greater\n"
+"    than 1 raises ValueError.\n\n"
+""
+"property_cache_ttl: float, optional, default=0\n"
+"    Lifetime in seconds of entries in the per-handle property cache used\n"
+"    by ZFSResource.get_properties() and asdict(). Zero disables the cache.\n"
+"    Entries are also dropped when properties are changed through this\n"
+"    handle and when ZFSEventIterator from this handle reports a related\n"
+"    event. See ZFS.property_cache_stats().\n\n"
+""
+"pool_size: int, optional, default=1\n"
+"    Number of libzfs handles to open, each with its own lock. When greater\n"
+"    than 1, open_resource(), open_pool(), query(), iter_pools(), and\n"
+"    iter_root_filesystems() select a handle in round-robin order and the\n"
+"    returned objects use that handle for all subsequent operations. This\n"
+"    allows threads working on different resources to run libzfs\n"
+"    operations concurrently. May not be combined with property_cache_ttl\n"
+"    or mnttab_cache=True, and turns mnttab_cache off by default.\n\n"
+""
+"aio_workers: int, optional, default=4\n"
+"    Number of worker threads used by ZFS.aio. Threads are started on the\n"
+"    first ZFS.aio request.\n\n"
+""
+"aio_queue_depth: int, optional, default=256\n"
+"    Maximum number of ZFS.aio requests waiting for a worker thread.\n"
+"    Further requests raise BlockingIOError.\n\n"
 ""
 "Returns\n"
 "-------\n"
@@ -103,13 +136,15 @@ static PyObject *py_get_libzfs_handle(PyObject *self,
 	if (out == NULL)
 		return NULL;
 
+	// module must be set before py_zfs_init() so that it is
+	// inherited by the handle pool.
+	out->module = Py_NewRef(self);
+
 	if (py_zfs_init((PyObject *)out, args, kwargs) < 0) {
 		Py_DECREF(out);
 		return NULL;
 	}
 
-	out->module = self;
-	Py_INCREF(self);
 	return (PyObject *)out;
 }
 
@@ -256,6 +291,123 @@ py_create_vdev_spec(PyObject *self, PyObject *args, PyObject *kwargs)
 	    py_children);
 }
 
+PyDoc_STRVAR(py_create_filter__doc__,
+"create_filter(*, name_glob=None, name_prefix=None, types=None,\n"
+"              properties=None, user_properties=None)"
+" -> ZFSFilter\n"
+"---------------------------------------------------------\n\n"
+"Build a compiled filter for ZFSResource.iter_filesystems() and\n"
+"ZFSResource.iter_snapshots(). The filter is evaluated in C against\n"
+"each dataset or snapshot before a python object is created for it, so\n"
+"resources that do not match are skipped without python overhead.\n"
+"All criteria must match (logical AND). All arguments are keyword-only.\n\n"
+"Parameters\n"
+"----------\n"
+"name_glob: str | None, optional\n"
+"    fnmatch(3) pattern that the full resource name must match,\n"
+"    e.g. \"tank/*/data\".\n\n"
+"name_prefix: str | None, optional\n"
+"    String that the full resource name must begin with.\n\n"
+"types: iterable of " PYLIBZFS_MODULE_NAME ".ZFSType | None, optional\n"
+"    Only resources of one of the specified types match.\n\n"
+"properties: sequence of (property, operator, value) tuples | None, optional\n"
+"    property may be a str or " PYLIBZFS_MODULE_NAME ".ZFSProperty.\n"
+"    operator is one of \"==\", \"!=\", \"<\", \"<=\", \">\", \">=\".\n"
+"    An int or bool value is compared against the raw numeric value of\n"
+"    the property (index properties such as readonly compare by index).\n"
+"    A str value is compared against the unformatted property string.\n"
+"    Resources for which the property is not applicable do not match.\n\n"
+"user_properties: dict | None, optional\n"
+"    Mapping of user property name to value. The user property must be\n"
+"    set on (or inherited by) the resource with exactly this value.\n\n"
+"Returns\n"
+"-------\n"
+PYLIBZFS_TYPES_MODULE_NAME ".ZFSFilter\n\n"
+"Raises\n"
+"------\n"
+"ValueError:\n"
+"    Invalid property, operator, or user property name.\n"
+"TypeError:\n"
+"    Argument of unexpected type, or a numeric comparison was requested\n"
+"    for a string-only property.\n\n"
+"NOTE: filters containing properties or user_properties criteria may not\n"
+"be used with fast=True iteration since the property data is not\n"
+"available in that mode.\n"
+);
+static PyObject *
+py_create_filter(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	pylibzfs_state_t *state = NULL;
+	PyObject *py_glob = NULL;
+	PyObject *py_prefix = NULL;
+	PyObject *py_types = NULL;
+	PyObject *py_props = NULL;
+	PyObject *py_user_props = NULL;
+	char *kwnames[] = {
+		"name_glob",
+		"name_prefix",
+		"types",
+		"properties",
+		"user_properties",
+		NULL
+	};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$OOOOO",
+	    kwnames, &py_glob, &py_prefix, &py_types, &py_props,
+	    &py_user_props))
+		return NULL;
+
+	state = (pylibzfs_state_t *)PyModule_GetState(self);
+	PYZFS_ASSERT(state, "Failed to get module state");
+
+	return py_zfs_filter_create(state, py_glob, py_prefix, py_types,
+	    py_props, py_user_props);
+}
+
+PyDoc_STRVAR(py_create_property_selector__doc__,
+"create_property_selector(*, properties) -> ZFSPropertySelector\n"
+"--------------------------------------------------------------\n\n"
+"Build a precompiled property selection that may be passed as the\n"
+"`properties` argument of ZFSResource.get_properties(),\n"
+"ZFSResource.asdict() and ZFS.query() in place of a set. Membership is\n"
+"resolved once here rather than on every call, which matters when the\n"
+"same properties are requested for many datasets.\n\n"
+"Parameters\n"
+"----------\n"
+"properties: iterable of " PYLIBZFS_MODULE_NAME ".ZFSProperty, required\n"
+"    Properties to select, for example one of the frozensets in\n"
+"    " PYLIBZFS_MODULE_NAME ".property_sets.\n\n"
+"Returns\n"
+"-------\n"
+PYLIBZFS_TYPES_MODULE_NAME ".ZFSPropertySelector\n\n"
+"Raises\n"
+"------\n"
+"ValueError:\n"
+"    properties was not specified.\n"
+"TypeError:\n"
+"    properties is not iterable or contains an item that is not a\n"
+"    ZFSProperty.\n"
+);
+static PyObject *
+py_create_property_selector(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+	pylibzfs_state_t *state = NULL;
+	PyObject *py_props = NULL;
+	char *kwnames[] = {
+		"properties",
+		NULL
+	};
+
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$O",
+	    kwnames, &py_props))
+		return NULL;
+
+	state = (pylibzfs_state_t *)PyModule_GetState(self);
+	PYZFS_ASSERT(state, "Failed to get module state");
+
+	return py_zfs_prop_selector_create(state, py_props);
+}
+
 PyDoc_STRVAR(py_read_label__doc__,
 "read_label(*, fd: int) -> dict | None\n"
 "-------------------------------------\n\n"
@@ -444,6 +596,18 @@ static PyMethodDef TruenasPylibzfsMethods[] = {
 		.ml_flags = METH_VARARGS | METH_KEYWORDS,
 		.ml_doc = py_create_vdev_spec__doc__
 	},
+	{
+		.ml_name = "create_filter",
+		.ml_meth = (PyCFunction)py_create_filter,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_create_filter__doc__
+	},
+	{
+		.ml_name = "create_property_selector",
+		.ml_meth = (PyCFunction)py_create_property_selector,
+		.ml_flags = METH_VARARGS | METH_KEYWORDS,
+		.ml_doc = py_create_property_selector__doc__
+	},
 	{
 		.ml_name = "read_label",
 		.ml_meth = (PyCFunction)py_read_label,
@@ -618,6 +782,12 @@ PyInit_truenas_pylibzfs(void)
 	if (mpylibzfs == NULL)
 		return NULL;
 
+#ifdef Py_GIL_DISABLED
+	// Single-phase init equivalent of the Py_mod_gil slot. See
+	// "Thread safety" in truenas_pylibzfs.h.
+	PyUnstable_Module_SetGIL(mpylibzfs, Py_MOD_GIL_NOT_USED);
+#endif
+
 	if (types_ready(mpylibzfs) < 0) {
 		Py_DECREF(mpylibzfs);
 		return NULL;
@@ -19,6 +19,9 @@
 	ZFS_TYPE_SNAPSHOT
 #define MAX_HISTORY_PREFIX_LEN 25
 #define DEFAULT_HISTORY_PREFIX  "truenas-pylibzfs: "
+#define PYMAXHISTORYLEN 4096
+#define DEFAULT_AIO_WORKERS 4
+#define DEFAULT_AIO_QUEUE_DEPTH 256
 #define LIBZFS_NONE_VALUE "none"
 #define LIBZFS_INCONSISTENT_VALUE "<INCONSISTENT>"
 #define LIBZFS_IOERROR_VALUE "<IOERROR>"
@@ -47,6 +50,23 @@
 #error "truenas_pylibzfs requires Python 3.13 or later"
 #endif
 
+/*
+ * Thread safety
+ *
+ * The module declares that it does not need the GIL on free-threaded
+ * builds (Py_GIL_DISABLED). The following rules keep that safe:
+ *
+ * - Module state (enum tables, struct sequence types, property sets) is
+ *   fully populated during module init and is read-only afterwards.
+ * - All use of a libzfs_handle_t, and of libzfs handles opened through it,
+ *   happens with the py_zfs_t zfs_lock held. Per-resource state that
+ *   depends on the libzfs handle (e.g. is_simple) is also protected by it.
+ * - Python object members that change after creation (e.g. the name after
+ *   rename(), ZFSPropertyView cache) are accessed in a critical section.
+ * - State of iterators that is updated with the GIL released is protected
+ *   by a PyMutex on the iterator, since critical sections are suspended
+ *   while the thread state is detached.
+ */
 typedef PyMutex py_zfs_lock_t;
 #define PY_ZFS_LOCK_INIT(lockp)    (0)
 #define PY_ZFS_LOCK_DESTROY(lockp) /* no-op */
@@ -56,10 +76,84 @@ typedef PyMutex py_zfs_lock_t;
  * lzh: libzfs handle
  * zfs_lock: mutex for protecting libzfs handle
  *
+ * handle_pool: tuple of additional py_zfs_t objects created when
+ *     open_handle() is called with pool_size > 1. Each has its own
+ *     libzfs_handle_t and zfs_lock. NULL if pool_size is 1.
+ * handle_next: round-robin counter for py_zfs_get_handle()
+ * stats: lock and operation counters reported by ZFS.stats()
+ * aio_pool: worker threads and queue used by ZFS.aio (see py_zfs_aio.c).
+ *     Only set on the handle returned by open_handle().
+ * pool_name_cache: most recently used pool name string, shared by new
+ *     resource objects (see py_zfs_pool_name_str()). Accessed in a critical
+ *     section on the py_zfs_t.
+ *
  * NOTE: the libzfs_handle_t is potentially shared by multiple python objects.
  * The `zfs_lock` should be taken prior to any ZFS operation (e.g. zfs_rename)
  * and any error information should be retrieved while the lock is held.
  */
+/*
+ * Optional per-handle cache of ZFS property values (see py_zfs_prop_cache.c)
+ * ttl_ns: lifetime of an entry in nanoseconds. Zero disables the cache.
+ * entries: nvlist of cached property values keyed by dataset guid
+ * hits / misses / invalidations: counters reported by
+ *     ZFS.property_cache_stats()
+ *
+ * All members are protected by the zfs_lock of the owning py_zfs_t.
+ */
+typedef struct {
+	uint64_t ttl_ns;
+	nvlist_t *entries;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t invalidations;
+} py_zfs_prop_cache_t;
+
+/*
+ * Per-handle instrumentation (see py_zfs_stats.c)
+ *
+ * Lock counters are updated by PY_ZFS_LOCK / PY_ZFS_UNLOCK. Operation
+ * counters are updated by py_zfs_stats_op() around the libzfs calls of
+ * major entry points while the lock is held, so the difference between
+ * lock hold time and operation time is time spent outside of libzfs.
+ *
+ * All counters are in nanoseconds and are updated with relaxed atomics so
+ * that they may be read or reset without the zfs_lock. Histogram bucket 0
+ * counts waits of less than 1 microsecond and bucket N (N > 0) counts
+ * waits in [2^(N-1), 2^N) microseconds. The last bucket is open-ended.
+ * locked_at_ns is protected by the zfs_lock.
+ */
+#define	PY_ZFS_STATS_HIST_BUCKETS	32
+
+typedef enum {
+	PY_ZFS_OP_OPEN,
+	PY_ZFS_OP_PROP_GET,
+	PY_ZFS_OP_PROP_SET,
+	PY_ZFS_OP_ITER,
+	PY_ZFS_OP_MOUNT,
+	PY_ZFS_OP_SEND,
+	PY_ZFS_OP_COUNT
+} py_zfs_op_t;
+
+typedef struct {
+	uint64_t count;
+	uint64_t total_ns;
+	uint64_t max_ns;
+} py_zfs_op_stats_t;
+
+typedef struct {
+	uint64_t acquisitions;
+	uint64_t wait_total_ns;
+	uint64_t wait_max_ns;
+	uint64_t hold_total_ns;
+	uint64_t hold_max_ns;
+	uint64_t wait_hist[PY_ZFS_STATS_HIST_BUCKETS];
+	uint64_t hold_hist[PY_ZFS_STATS_HIST_BUCKETS];
+	uint64_t locked_at_ns;
+	py_zfs_op_stats_t ops[PY_ZFS_OP_COUNT];
+} py_zfs_stats_t;
+
+typedef struct py_zfs_aio_pool py_zfs_aio_pool_t;
+
 typedef struct {
 	PyObject_HEAD
 	PyObject *module;
@@ -69,20 +163,125 @@ typedef struct {
 	int history;
 	char history_prefix[MAX_HISTORY_PREFIX_LEN];
 	PyObject *proptypes;
+	py_zfs_prop_cache_t prop_cache;
+	PyObject *handle_pool;
+	uint64_t handle_next;
+	py_zfs_stats_t stats;
+	py_zfs_aio_pool_t *aio_pool;
+	PyObject *pool_name_cache;
 } py_zfs_t;
 
+#define PY_ZFS_PROP_CACHE_ENABLED(obj) ((obj)->prop_cache.ttl_ns != 0)
+
+/*
+ * Select the py_zfs_t to use for a new resource, pool, or read-mostly walk.
+ * Returns `plz` if it has no handle pool, otherwise the next handle in
+ * round-robin order (which may be `plz` itself). Returned reference is
+ * borrowed. GIL not required.
+ */
+extern py_zfs_t *py_zfs_get_handle(py_zfs_t *plz);
+
+static inline uint64_t
+py_zfs_stats_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+static inline void
+py_zfs_stats_max(uint64_t *target, uint64_t val)
+{
+	uint64_t cur = __atomic_load_n(target, __ATOMIC_RELAXED);
+
+	while ((val > cur) && !__atomic_compare_exchange_n(target, &cur, val,
+	    B_TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+
+static inline void
+py_zfs_stats_hist(uint64_t *hist, uint64_t ns)
+{
+	uint64_t us = ns / 1000;
+	int bucket = us ? 64 - __builtin_clzll(us) : 0;
+
+	if (bucket >= PY_ZFS_STATS_HIST_BUCKETS)
+		bucket = PY_ZFS_STATS_HIST_BUCKETS - 1;
+
+	__atomic_fetch_add(&hist[bucket], 1, __ATOMIC_RELAXED);
+}
+
+static inline void
+py_zfs_lock_impl(py_zfs_t *plz)
+{
+	uint64_t start = py_zfs_stats_now();
+	uint64_t wait;
+
+	PyMutex_Lock(&plz->zfs_lock);
+	plz->stats.locked_at_ns = py_zfs_stats_now();
+	wait = plz->stats.locked_at_ns - start;
+
+	__atomic_fetch_add(&plz->stats.acquisitions, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&plz->stats.wait_total_ns, wait, __ATOMIC_RELAXED);
+	py_zfs_stats_max(&plz->stats.wait_max_ns, wait);
+	py_zfs_stats_hist(plz->stats.wait_hist, wait);
+}
+
+static inline void
+py_zfs_unlock_impl(py_zfs_t *plz)
+{
+	uint64_t hold = py_zfs_stats_now() - plz->stats.locked_at_ns;
+
+	__atomic_fetch_add(&plz->stats.hold_total_ns, hold, __ATOMIC_RELAXED);
+	py_zfs_stats_max(&plz->stats.hold_max_ns, hold);
+	py_zfs_stats_hist(plz->stats.hold_hist, hold);
+	PyMutex_Unlock(&plz->zfs_lock);
+}
+
+/*
+ * Record an operation that started at `start` (from py_zfs_stats_now()).
+ * GIL and lock not required.
+ */
+static inline void
+py_zfs_stats_op(py_zfs_t *plz, py_zfs_op_t op, uint64_t start)
+{
+	py_zfs_op_stats_t *ops = &plz->stats.ops[op];
+	uint64_t elapsed = py_zfs_stats_now() - start;
+
+	__atomic_fetch_add(&ops->count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&ops->total_ns, elapsed, __ATOMIC_RELAXED);
+	py_zfs_stats_max(&ops->max_ns, elapsed);
+}
+
 /*
  * The following macros are to simplify code that locks and unlocks
- * py_zfs_t objects for operations using libzfs_handle_t.
+ * py_zfs_t objects for operations using libzfs_handle_t. Lock wait and
+ * hold times are recorded in the stats of the py_zfs_t.
  */
 #define PY_ZFS_LOCK(obj) do { \
-	PyMutex_Lock(&obj->zfs_lock); \
+	py_zfs_lock_impl(obj); \
 } while (0);
 
 #define PY_ZFS_UNLOCK(obj) do { \
-	PyMutex_Unlock(&obj->zfs_lock); \
+	py_zfs_unlock_impl(obj); \
 } while (0);
 
+/* Provided by py_zfs_stats.c */
+extern PyObject *py_zfs_stats_dict(py_zfs_t *plz);
+extern void py_zfs_stats_reset(py_zfs_t *plz);
+
+/*
+ * Provided by py_zfs_aio.c
+ * py_zfs_aio_pool_create() returns NULL on allocation failure without
+ * setting an exception. Worker threads are started on first use.
+ * py_zfs_aio_new() returns a new ZFSAio object for ZFS.aio.
+ */
+extern py_zfs_aio_pool_t *py_zfs_aio_pool_create(size_t nworkers,
+						 size_t depth);
+extern void py_zfs_aio_pool_destroy(py_zfs_aio_pool_t *pool);
+extern PyObject *py_zfs_aio_new(py_zfs_t *plz);
+
 /*
  * Common struct for resource objects and bookmarks.
  *
@@ -117,11 +316,27 @@ typedef struct {
  *
  * is_simple: c boolean indicating that the handle contains limited info.
  *    this can happen if we're using an optimized iterator. In this case
- *    get_properties-style methods will fail with ValueError
+ *    get_properties-style methods will fail with ValueError. Protected by
+ *    the zfs_lock of obj.pylibzfsp.
+ * refresh: change indicator recorded by the last full refresh done through
+ *    refresh_properties(if_changed=True). Protected by the zfs_lock of
+ *    obj.pylibzfsp.
  */
+#define	PY_ZFS_OBJSET_COUNTERS	4
+
+typedef struct {
+	boolean_t valid;
+	boolean_t stable;
+	uint64_t change_gen;
+	uint64_t pool_txg;
+	uint64_t refreshed_ns;
+	uint64_t counters[PY_ZFS_OBJSET_COUNTERS];
+} py_zfs_refresh_state_t;
+
 typedef struct {
 	py_zfs_obj_t obj;
 	boolean_t is_simple;
+	py_zfs_refresh_state_t refresh;
 } py_zfs_resource_t;
 
 typedef struct {
@@ -158,12 +373,17 @@ typedef struct {
 } py_zfs_enc_t;
 
 extern PyTypeObject ZFS;
+extern PyTypeObject ZFSAio;
 extern PyTypeObject ZFSDataset;
 extern PyTypeObject ZFSEventIterator;
+extern PyTypeObject ZFSFilter;
 extern PyTypeObject ZFSHistoryIterator;
 extern PyTypeObject ZFSObject;
 extern PyTypeObject ZFSPool;
+extern PyTypeObject ZFSPropertySelector;
+extern PyTypeObject ZFSPropertyView;
 extern PyTypeObject ZFSResource;
+extern PyTypeObject ZFSResourceIterator;
 extern PyTypeObject ZFSSnapshot;
 extern PyTypeObject ZFSVolume;
 
@@ -283,6 +503,17 @@ extern py_zfs_volume_t *init_zfs_volume(py_zfs_t *lzp, zfs_handle_t *zfsp,
 extern py_zfs_snapshot_t *init_zfs_snapshot(py_zfs_t *lzp, zfs_handle_t *zfsp,
 					    boolean_t simple);
 
+/*
+ * Provided by py_zfs_resource_alloc.c
+ * py_zfs_resource_alloc() / py_zfs_resource_free() replace tp_alloc and
+ * tp_free for ZFSDataset, ZFSVolume and ZFSSnapshot and reuse freed objects.
+ * py_zfs_pool_name_str() returns a new reference to a pool name string
+ * shared with other objects of the same pool. All require the GIL.
+ */
+extern PyObject *py_zfs_resource_alloc(PyTypeObject *type);
+extern void py_zfs_resource_free(PyObject *self);
+extern PyObject *py_zfs_pool_name_str(py_zfs_t *plz, const char *pool_name);
+
 /* Provided by py_zfs_pool.c */
 extern py_zfs_pool_t *init_zfs_pool(py_zfs_t *lzp, zpool_handle_t *zhp);
 
@@ -340,6 +571,101 @@ extern boolean_t py_zfs_validate_vdev_spec(pylibzfs_state_t *state,
 #define PYLIBZFS_MAX_MIRROR_WIDTH 4
 #define PYLIBZFS_MAX_RAIDZ_WIDTH  15
 
+/* Provided by py_zfs_filter.c */
+typedef enum {
+	FILTER_OP_EQ,
+	FILTER_OP_NE,
+	FILTER_OP_LT,
+	FILTER_OP_LE,
+	FILTER_OP_GT,
+	FILTER_OP_GE,
+} py_zfs_filter_op_t;
+
+/*
+ * Native property comparison. Numeric comparisons are performed against
+ * the raw value from zfs_prop_get_numeric() (index properties compare by
+ * index value), string comparisons against the unformatted property string.
+ */
+typedef struct {
+	zfs_prop_t prop;
+	py_zfs_filter_op_t op;
+	boolean_t numeric;
+	uint64_t ival;
+	char *sval;
+} py_zfs_filter_prop_t;
+
+typedef struct {
+	char *name;
+	char *value;
+} py_zfs_filter_user_prop_t;
+
+typedef struct {
+	PyObject_HEAD
+	char *name_glob;
+	char *name_prefix;
+	zfs_type_t types;
+	py_zfs_filter_prop_t *props;
+	size_t nprops;
+	py_zfs_filter_user_prop_t *user_props;
+	size_t nuser_props;
+	PyObject *repr;
+} py_zfs_filter_t;
+
+/* B_TRUE if filter has criteria that require the dataset property nvlist */
+#define PY_ZFS_FILTER_NEEDS_PROPS(f) \
+	(((f)->nprops != 0) || ((f)->nuser_props != 0))
+
+extern PyObject *py_zfs_filter_create(pylibzfs_state_t *state,
+    PyObject *py_glob, PyObject *py_prefix, PyObject *py_types,
+    PyObject *py_props, PyObject *py_user_props);
+extern boolean_t py_zfs_filter_match(const py_zfs_filter_t *filter,
+    zfs_handle_t *zhp);
+/* Convert iterable of ZFSType into mask of zfs_type_t. */
+extern boolean_t py_zfs_types_to_mask(pylibzfs_state_t *state,
+    PyObject *py_types, zfs_type_t *types_out);
+
+/* Provided by py_zfs_prop_selector.c */
+#define PROP_SELECTOR_MASK_WORDS ((ARRAY_SIZE(zfs_prop_table) + 63) / 64)
+
+typedef struct {
+	PyObject_HEAD
+	/* bitmap and list of selected indexes into zfs_prop_table */
+	uint64_t mask[PROP_SELECTOR_MASK_WORDS];
+	size_t idx[ARRAY_SIZE(zfs_prop_table)];
+	size_t nidx;
+	PyObject *props;  /* frozenset of ZFSProperty */
+} py_zfs_prop_selector_t;
+
+#define PY_ZFS_PROP_SELECTED(sel, i) \
+	(((sel)->mask[(i) / 64] & (1ULL << ((i) % 64))) != 0)
+
+/* B_TRUE if obj is acceptable as `properties` (set or ZFSPropertySelector) */
+#define PY_ZFS_PROPS_CHECK(obj) \
+	(PyAnySet_Check(obj) || PyObject_TypeCheck(obj, &ZFSPropertySelector))
+
+extern PyObject *py_zfs_prop_selector_create(pylibzfs_state_t *state,
+    PyObject *py_props);
+
+/* Provided by py_zfs_query.c */
+typedef struct {
+	const char	*root;
+	PyObject	*properties;
+	PyObject	*types;
+	PyObject	*select;
+	PyObject	*filter;
+	boolean_t	 get_source;
+	boolean_t	 get_user_properties;
+	boolean_t	 recursive;
+	boolean_t	 json;
+} py_zfs_query_args_t;
+
+extern PyObject *py_zfs_do_query(py_zfs_t *plz, py_zfs_query_args_t *args);
+
+/* Provided by py_zfs_prop_bulk.c */
+extern PyObject *py_zfs_do_set_properties_bulk(py_zfs_t *plz,
+					       PyObject *pyprops,
+					       boolean_t remount);
+
 /* Provided by utils.c */
 extern const char *get_dataset_type(zfs_type_t type);
 extern PyObject *py_repr_zfs_obj_impl(py_zfs_obj_t *obj, const char *fmt);
@@ -457,6 +783,20 @@ extern PyObject *py_get_zfs_type(py_zfs_t *zfs, zfs_type_t type, PyObject **name
  */
 extern void free_py_zfs_obj(py_zfs_obj_t *obj);
 
+/*
+ * @brief get a new reference to the name of a py_zfs_obj_t object
+ *
+ * The name of a ZFS object is replaced by rename() and so borrowed references
+ * to obj->name must not be used. This takes the reference under the object's
+ * critical section.
+ *
+ * @param[in]	obj - pointer to py_zfs_obj_t object
+ * @return	new reference to the name (None if it is not set)
+ *
+ * @note the GIL must be held when calling this function.
+ */
+extern PyObject *py_zfs_obj_name_ref(py_zfs_obj_t *obj);
+
 /*
  * @brief get a ref for truenas_pylibzfs.PropertySource object
  *
@@ -494,6 +834,19 @@ extern PyObject *py_zpool_get_user_properties(py_zfs_pool_t *p);
 extern PyObject *py_zpool_set_user_properties(py_zfs_pool_t *p,
 					      PyObject *propsdict);
 
+/*
+ * Growable buffer for JSON output (see json_buf.c)
+ * buf: PyMem_RawMalloc allocated output
+ * used / size: bytes written / allocated
+ * nomem: an allocation failed and output is incomplete
+ */
+typedef struct {
+	char *buf;
+	size_t used;
+	size_t size;
+	boolean_t nomem;
+} py_json_buf_t;
+
 /* Provided by py_zfs_props.c */
 /*
  * @brief get the properties specified in prop_set for the ZFS object
@@ -501,24 +854,108 @@ extern PyObject *py_zpool_set_user_properties(py_zfs_pool_t *p,
  * This function may be used to retrieve the set of truenas_pylibzfs.ZFSProperty
  * properties for a given ZFS filesystem, volume, etc.
  *
- * @param[in]	pyzfs - pointer to a py_zfs_obj_t object (filesystem, zvol, snap)
- * @param[in]	prop_set - PySet object containing properties to retrieve
+ * @param[in]	res - pointer to a py_zfs_resource_t object (filesystem, zvol, snap)
+ * @param[in]	prop_set - PySet or ZFSPropertySelector of properties to retrieve
  * @param[in]	get_source - boolean indicating whether to retrieve source of prop.
+ * @param[in]	get_raw - if B_FALSE, numeric properties are read with
+ *		zfs_prop_get_numeric() and their raw member is None.
  * @return	returns pointer to a Struct Sequence Object with specified properties
  *
  * @note Properties that were not requested will be set to Py_None.
  *
+ * @note If res is a simple handle its properties are refreshed before being
+ * read, unless all requested properties are served from the handle's
+ * property cache.
+ *
  * @note GIL must be held while calling this function.
  */
-extern PyObject *py_zfs_get_properties(py_zfs_obj_t *pyzfs,
+extern PyObject *py_zfs_get_properties(py_zfs_resource_t *res,
 				       PyObject *prop_set,
-				       boolean_t get_source);
+				       boolean_t get_source,
+				       boolean_t get_raw);
+
+/*
+ * @brief lazy variant of py_zfs_get_properties()
+ *
+ * Returns a ZFSPropertyView that reads each requested property from the
+ * resource's handle on first attribute access. Arguments are as for
+ * py_zfs_get_properties().
+ */
+extern PyObject *py_zfs_get_properties_lazy(py_zfs_resource_t *res,
+					    PyObject *prop_set,
+					    boolean_t get_source,
+					    boolean_t get_raw);
 
 extern PyObject *py_zfs_props_to_dict(py_zfs_obj_t *pyzfs, PyObject *pyprops);
 extern PyObject *py_zfs_prop_to_dict(PyObject *pyprop);
+/*
+ * Scratch arena for reading many properties. All requested properties are
+ * read into the arena under a single hold of the libzfs handle lock with the
+ * GIL released, and python objects are only created afterwards. Values and
+ * sources are packed as NUL-terminated strings and referenced by offset
+ * since the arena may be reallocated while filling it. The caller sets idx
+ * for each entry and frees buf with PyMem_RawFree(). See comments in
+ * py_zfs_prop.c.
+ */
+typedef struct {
+	size_t idx;		/* index into zfs_prop_table */
+	size_t value_off;
+	size_t source_off;
+	zprop_source_t sourcetype;
+	boolean_t numeric;	/* read via zfs_prop_get_numeric() */
+	uint64_t ival;
+} prop_arena_entry_t;
+
+typedef struct {
+	prop_arena_entry_t *entries;
+	size_t nentries;
+	char *buf;
+	size_t used;
+	size_t size;
+} prop_arena_t;
+
+extern int prop_arena_fill(prop_arena_t *arena, pylibzfs_state_t *state,
+    zfs_handle_t *zhp, boolean_t get_raw, size_t *failed, int *err_errno);
+extern void prop_arena_exc(prop_arena_t *arena, pylibzfs_state_t *state,
+    size_t failed, zfs_type_t ctype, const char *name, int err_errno);
+/*
+ * Same output as py_zfs_prop_to_dict() for a single property, but built
+ * from an arena filled with get_raw. GIL must be held.
+ */
+extern PyObject *py_zfs_prop_arena_dict(py_zfs_t *plz,
+    pylibzfs_state_t *state, prop_arena_t *arena, size_t i,
+    boolean_t get_source);
+/*
+ * JSON serialization of a single property for asdict_json() / query_json().
+ * See comments in py_zfs_prop.c.
+ */
+#define	PROP_JSON_READ_ERROR	-1
+#define	PROP_JSON_PARSE_ERROR	-2
+extern int py_zfs_prop_json_locked(py_json_buf_t *jb, zfs_handle_t *zhp,
+    zfs_prop_t prop, boolean_t get_source, boolean_t get_raw, int *err_errno);
+extern void py_zfs_prop_json_exc(zfs_prop_t prop, zfs_type_t ctype,
+    const char *name, int err, int err_errno);
 extern boolean_t py_zfs_prop_valid_for_type(zfs_prop_t prop, zfs_type_t zfs_type);
 extern char *pymem_strdup(const char *s);
 extern void py_zfs_props_refresh(py_zfs_resource_t *res);
+extern boolean_t py_zfs_props_refresh_if_changed(py_zfs_resource_t *res,
+						 uint64_t max_age_ns);
+extern void py_zfs_props_load(py_zfs_resource_t *res);
+extern void py_zfs_prop_drop_unchanged_volsize(zfs_handle_t *zhp,
+    nvlist_t *nvl);
+
+/* Provided by py_zfs_prop_cache.c. PY_ZFS_LOCK must be held. GIL not required */
+extern nvlist_t *py_zfs_prop_cache_lookup(py_zfs_t *plz, uint64_t guid);
+extern void py_zfs_prop_cache_insert(py_zfs_t *plz, uint64_t guid,
+    const char *name, nvlist_t *props);
+extern void py_zfs_prop_cache_invalidate(py_zfs_t *plz, const char *name);
+extern void py_zfs_prop_cache_event(py_zfs_t *plz, nvlist_t *event);
+extern void py_zfs_prop_cache_clear(py_zfs_t *plz);
+/* May be called without PY_ZFS_LOCK */
+extern uint64_t py_zfs_prop_change_gen(void);
+
+/* py_zfs_iter.c */
+extern void init_py_struct_space_summary_state(pylibzfs_state_t *state);
 
 /* py_zfs_userquota.c */
 extern void init_py_struct_userquota_state(pylibzfs_state_t *state);
@@ -697,8 +1134,24 @@ extern PyObject *py_nvlist_to_dict(nvlist_t *nvl);
 extern nvlist_t *py_dict_to_nvlist(PyObject *dict_in);
 extern char *nvlist_to_json_str(nvlist_t *nvl);
 
+/* Provided by json_buf.c. GIL not required except for json_buf_to_bytes() */
+extern void json_buf_append(py_json_buf_t *jb, const char *data, size_t len);
+extern void json_buf_str(py_json_buf_t *jb, const char *str);
+extern void json_buf_key(py_json_buf_t *jb, const char *key);
+extern void json_buf_u64(py_json_buf_t *jb, uint64_t val);
+extern void json_buf_free(py_json_buf_t *jb);
+extern PyObject *json_buf_to_bytes(py_json_buf_t *jb);
+#define json_buf_lit(jb, s) json_buf_append((jb), (s), sizeof (s) - 1)
+
+/*
+ * Append user properties nvlist as a JSON object of name -> value, the same
+ * as json.dumps(user_props_nvlist_to_py_dict(userprops)). GIL not required.
+ */
+extern void user_props_nvlist_to_json(py_json_buf_t *jb, nvlist_t *userprops);
+
 /* Provided by py_zfs_crypto.c */
 extern PyObject *py_zfs_crypto_info_dict(py_zfs_obj_t *obj);
+extern boolean_t py_zfs_crypto_info_json(py_zfs_obj_t *obj, py_json_buf_t *jb);
 
 /*
  * @brief create an encrypted ZFS resource
@@ -203,6 +203,7 @@ int init_py_zfs_state(PyObject *module)
 	init_py_struct_prop_state(state);
 	init_py_struct_zpool_prop_state(state);
 	init_py_struct_userquota_state(state);
+	init_py_struct_space_summary_state(state);
 	init_py_pool_status_state(state);
 	init_py_pool_feature_state(state);
 
@@ -249,6 +250,7 @@ py_register_struct_types(PyObject *module)
 	ADD_STRUCT("struct_zfs_property_source", state->struct_zfs_prop_src_type);
 	ADD_STRUCT("struct_zfs_property",        state->struct_zfs_props_type);
 	ADD_STRUCT("struct_zfs_userquota",       state->struct_zfs_userquota_type);
+	ADD_STRUCT("struct_zfs_space_summary",   state->struct_zfs_space_summary_type);
 	ADD_STRUCT("struct_zfs_crypto_info",     state->struct_zfs_crypto_info_type);
 	ADD_STRUCT("struct_zfs_crypto_config",   state->struct_zfs_crypto_change_type);
 	ADD_STRUCT("struct_zpool_status",        state->struct_zpool_status_type);
@@ -352,10 +354,12 @@ void free_py_zfs_state(PyObject *module)
 		state->struct_prop_fields[idx].doc = NULL;
 	}
 
+	Py_CLEAR(state->zfs_prop_field_idx);
 	Py_CLEAR(state->struct_zfs_props_type);
 	Py_CLEAR(state->struct_zfs_prop_type);
 	Py_CLEAR(state->struct_zfs_prop_src_type);
 	Py_CLEAR(state->struct_zfs_userquota_type);
+	Py_CLEAR(state->struct_zfs_space_summary_type);
 	Py_CLEAR(state->struct_zfs_crypto_info_type);
 	Py_CLEAR(state->struct_zfs_crypto_change_type);
 
@@ -394,4 +398,6 @@ void free_py_zfs_state(PyObject *module)
 	Py_CLEAR(state->struct_zpool_props_type);
 	Py_CLEAR(state->struct_zpool_prop_type);
 	Py_CLEAR(state->zpool_property_enum);
+	Py_CLEAR(state->aio_get_running_loop);
+	Py_CLEAR(state->aio_complete);
 }
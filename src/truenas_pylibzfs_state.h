@@ -29,6 +29,12 @@ typedef struct {
 	PyStructSequence_Field struct_prop_fields[ARRAY_SIZE(zfs_prop_table) + 1];
 	PyStructSequence_Desc struct_zfs_prop_desc;
 
+	/*
+	 * dict mapping struct_zfs_props_type field name to index into
+	 * zfs_prop_table. Used for attribute lookup by ZFSPropertyView.
+	 */
+	PyObject *zfs_prop_field_idx;
+
 	/*
 	 * Named tuple containing all ZFS properties as attributes.
 	 * this is used for generate get_properties() response.
@@ -53,6 +59,9 @@ typedef struct {
 	/* Reference to named tuple for ZFS user quota */
 	PyTypeObject *struct_zfs_userquota_type;
 
+	/* Reference to named tuple for dataset subtree space summary */
+	PyTypeObject *struct_zfs_space_summary_type;
+
 	/* Reference to named tuple for crypto info */
 	PyTypeObject *struct_zfs_crypto_info_type;
 
@@ -119,6 +128,14 @@ typedef struct {
 	 * Fields: (prop, value, raw, source)
 	 */
 	PyTypeObject *struct_zpool_prop_type;
+
+	/*
+	 * asyncio.get_running_loop and the callable used by ZFS.aio workers
+	 * to complete futures on the loop thread. Set on the first ZFS.aio
+	 * submission so that asyncio is only imported when it is used.
+	 */
+	PyObject *aio_get_running_loop;
+	PyObject *aio_complete;
 } pylibzfs_state_t;
 
 extern int init_py_zfs_state(PyObject *module);
@@ -1,5 +1,5 @@
-from collections.abc import Sequence
-from typing import Any, ClassVar
+from collections.abc import Iterable, Sequence
+from typing import Any, ClassVar, Literal
 
 from . import libzfs_types
 from . import lzc
@@ -41,7 +41,34 @@ def create_vdev_spec(
     """
     ...
 
-def open_handle(history: Any = ..., history_prefix: Any = ..., mnttab_cache: Any = ...) -> libzfs_types.ZFS: ...
+def create_filter(
+    *,
+    name_glob: str | None = None,
+    name_prefix: str | None = None,
+    types: "Iterable[ZFSType] | None" = None,
+    properties: "Sequence[tuple[ZFSProperty | str, Literal['==', '!=', '<', '<=', '>', '>='], int | bool | str]] | None" = None,
+    user_properties: dict[str, str] | None = None,
+) -> "libzfs_types.ZFSFilter":
+    """Create a filter for ZFSResource.iter_filesystems() / iter_snapshots().
+
+    The filter is evaluated in C before python objects are created, so
+    non-matching datasets and snapshots are skipped cheaply.  All criteria
+    must match.
+    """
+    ...
+
+def create_property_selector(
+    *,
+    properties: "Iterable[ZFSProperty]",
+) -> "libzfs_types.ZFSPropertySelector":
+    """Create a precompiled property selection.
+
+    May be passed as ``properties`` to ZFSResource.get_properties(),
+    ZFSResource.asdict() and ZFS.query() in place of a set.
+    """
+    ...
+
+def open_handle(history: Any = ..., history_prefix: Any = ..., mnttab_cache: Any = ..., property_cache_ttl: float = ..., pool_size: int = ..., aio_workers: int = ..., aio_queue_depth: int = ...) -> libzfs_types.ZFS: ...
 def read_label(*, fd: int) -> dict[str, Any] | None: ...
 def clear_label(*, fd: int) -> None: ...
 def name_is_valid(*, name: str, type: ZFSType) -> bool: ...
@@ -1,9 +1,12 @@
+import asyncio
 from collections.abc import Callable, Iterable, Iterator
 import enum
-from typing import Any, ClassVar, Literal, Self, final, overload
+from typing import Any, ClassVar, Literal, Self, TypeVar, final, overload
 
 from . import lzc
 
+_T_co = TypeVar('_T_co', covariant=True)
+
 
 # ---------------------------------------------------------------------------
 # Enums (dual-registered: also available at truenas_pylibzfs.<Name>)
@@ -634,7 +637,7 @@ class struct_zfs_property_source:
 class struct_zfs_property_data:
     """Individual property value and source information."""
     value: int | str | None
-    raw: str
+    raw: str | None
     source: struct_zfs_property_source | None
     __match_args__: ClassVar[tuple[str, ...]]
     n_fields: ClassVar[int]          # = 3
@@ -815,6 +818,27 @@ class struct_zfs_userquota:
     n_unnamed_fields: ClassVar[int]  # = 0
     def __replace__(self, **changes: Any) -> Self: ...
 
+@final
+class struct_zfs_space_summary:
+    """Subtree space totals returned by ZFSResource.space_summary().
+
+    ``used`` and ``usedbychildren`` are the values of the dataset itself;
+    the remaining space fields are summed over the subtree.
+    """
+    datasets: int
+    snapshots: int
+    used: int
+    usedbychildren: int
+    referenced: int
+    usedbydataset: int
+    usedbysnapshots: int
+    usedbyrefreservation: int
+    __match_args__: ClassVar[tuple[str, ...]]
+    n_fields: ClassVar[int]          # = 8
+    n_sequence_fields: ClassVar[int] # = 8
+    n_unnamed_fields: ClassVar[int]  # = 0
+    def __replace__(self, **changes: Any) -> Self: ...
+
 @final
 class struct_zfs_property:
     """ZFS dataset property bundle returned by ZFSResource.get_properties().
@@ -954,18 +978,78 @@ class ZFSObject:
 @final
 class ZFSResource(ZFSObject):
     """ZFS resource (filesystem or volume) with property and mount operations."""
-    def iter_filesystems(self, *, callback: Any, state: Any, fast: bool = ...) -> bool: ...
+    @overload
+    def iter_filesystems(
+        self,
+        *,
+        callback: Any,
+        state: Any = ...,
+        fast: bool = ...,
+        batch_size: int = ...,
+        recursive: bool = ...,
+        max_depth: int = ...,
+        order: Literal['pre', 'post', 'bfs'] = ...,
+        include_snapshots: bool = ...,
+        filter: ZFSFilter | None = ...,
+    ) -> bool: ...
+    @overload
+    def iter_filesystems(
+        self,
+        *,
+        fast: bool = ...,
+        filter: ZFSFilter | None = ...,
+    ) -> ZFSResourceIterator[ZFSDataset | ZFSVolume]: ...
+    @overload
     def iter_snapshots(
         self,
         *,
         callback: Any,
-        state: Any,
+        state: Any = ...,
         fast: bool = ...,
         min_transaction_group: int = ...,
         max_transaction_group: int = ...,
         order_by_transaction_group: bool = ...,
+        batch_size: int = ...,
+        filter: ZFSFilter | None = ...,
     ) -> bool: ...
-    def get_properties(self, *, properties: Any, get_source: bool = ...) -> struct_zfs_property: ...
+    @overload
+    def iter_snapshots(
+        self,
+        *,
+        fast: bool = ...,
+        min_transaction_group: int = ...,
+        max_transaction_group: int = ...,
+        order_by_transaction_group: bool = ...,
+        filter: ZFSFilter | None = ...,
+    ) -> ZFSResourceIterator[ZFSSnapshot]: ...
+    def list_filesystem_names(self, *, recursive: bool = ...) -> tuple[str, ...]: ...
+    @overload
+    def list_snapshot_names(
+        self,
+        *,
+        recursive: bool = ...,
+        min_transaction_group: int = ...,
+        max_transaction_group: int = ...,
+        order_by_transaction_group: bool = ...,
+        get_createtxg: Literal[False] = ...,
+    ) -> tuple[str, ...]: ...
+    @overload
+    def list_snapshot_names(
+        self,
+        *,
+        recursive: bool = ...,
+        min_transaction_group: int = ...,
+        max_transaction_group: int = ...,
+        order_by_transaction_group: bool = ...,
+        get_createtxg: Literal[True],
+    ) -> tuple[tuple[str, ...], tuple[int, ...]]: ...
+    def space_summary(
+        self, *, recursive: bool = ..., include_snapshots: bool = ...
+    ) -> dict[str, struct_zfs_space_summary]: ...
+    @overload
+    def get_properties(self, *, properties: set[ZFSProperty] | frozenset[ZFSProperty] | ZFSPropertySelector, get_source: bool = ..., raw: bool = ..., lazy: Literal[False] = ...) -> struct_zfs_property: ...
+    @overload
+    def get_properties(self, *, properties: set[ZFSProperty] | frozenset[ZFSProperty] | ZFSPropertySelector, get_source: bool = ..., raw: bool = ..., lazy: Literal[True]) -> ZFSPropertyView: ...
     def set_properties(self, *, properties: dict[str, Any], remount: bool = ...) -> None: ...
     def inherit_property(self, *, property: str, received: bool = ...) -> None: ...
     def asdict(
@@ -975,7 +1059,17 @@ class ZFSResource(ZFSObject):
         get_source: bool = ...,
         get_user_properties: bool = ...,
         get_crypto: bool = ...,
+        raw: bool = ...,
     ) -> dict[str, Any]: ...
+    def asdict_json(
+        self,
+        *,
+        properties: Any,
+        get_source: bool = ...,
+        get_user_properties: bool = ...,
+        get_crypto: bool = ...,
+        raw: bool = ...,
+    ) -> bytes: ...
     def mount(
         self,
         *,
@@ -995,7 +1089,7 @@ class ZFSResource(ZFSObject):
         recursive: bool = ...,
     ) -> None: ...
     def get_user_properties(self) -> dict[str, str]: ...
-    def refresh_properties(self) -> None: ...
+    def refresh_properties(self, *, if_changed: bool = False, max_age: float = 0) -> bool: ...
     def get_mountpoint(self) -> str | None: ...
     def set_user_properties(self, *, user_properties: dict[str, str]) -> None: ...
     def open_pool(self) -> ZFSPool: ...
@@ -1004,6 +1098,9 @@ class ZFSResource(ZFSObject):
 class ZFSDataset(ZFSResource):  # type: ignore[misc]
     """ZFS filesystem dataset."""
     def iter_userspace(self, *, callback: Any, state: Any, quota_type: Any) -> bool: ...
+    def get_userspace_columns(
+        self, *, quota_types: Iterable[ZFSUserQuota] | None = ...
+    ) -> dict[str, memoryview]: ...
     def set_userquotas(self, *, quotas: Any) -> None: ...
     def crypto(self) -> ZFSCrypto | None: ...
     def promote(self) -> None: ...
@@ -1082,12 +1179,42 @@ class ZFSEventIterator(Iterator[dict[str, Any]]):
     def __iter__(self) -> ZFSEventIterator: ...
     def __next__(self) -> dict[str, Any]: ...
 
+@final
+class ZFSFilter:
+    """Compiled dataset / snapshot filter created by create_filter()."""
+    ...
+
+@final
+class ZFSPropertySelector:
+    """Precompiled property selection created by create_property_selector()."""
+    @property
+    def properties(self) -> frozenset[ZFSProperty]: ...
+    def __len__(self) -> int: ...
+    def __contains__(self, item: object) -> bool: ...
+    def __iter__(self) -> Iterator[ZFSProperty]: ...
+
+@final
+class ZFSPropertyView:
+    """Lazy property view returned by get_properties(lazy=True).
+
+    Attribute names match struct_zfs_property; each requested property is
+    read on first access and cached.
+    """
+    def __getattr__(self, name: str) -> struct_zfs_property_data | None: ...
+    def materialize(self) -> struct_zfs_property: ...
+
 @final
 class ZFSHistoryIterator(Iterator[dict[str, Any]]):
     """Iterator over ZFS pool command history."""
     def __iter__(self) -> ZFSHistoryIterator: ...
     def __next__(self) -> dict[str, Any]: ...
 
+@final
+class ZFSResourceIterator(Iterator[_T_co]):
+    """Iterator over datasets, snapshots or pools prefetched by a native thread."""
+    def __iter__(self) -> ZFSResourceIterator[_T_co]: ...
+    def __next__(self) -> _T_co: ...
+
 
 class ZFSCrypto:
     """Encryption operations for a ZFS dataset or volume."""
@@ -1226,11 +1353,30 @@ class ZFSPool:
     def upgrade(self) -> None: ...
 
 
+@final
+class ZFSAio:
+    """Awaitable variants of ZFS methods. Obtain via ZFS.aio."""
+    def open_resource(self, *, name: str) -> asyncio.Future[Any]: ...
+    def open_pool(self, *, name: str) -> asyncio.Future[ZFSPool]: ...
+    def query(self, **kwargs: Any) -> asyncio.Future[list[dict[str, Any]]]: ...
+    def iter_root_filesystems(self) -> asyncio.Future[list[ZFSDataset]]: ...
+    def iter_pools(self) -> asyncio.Future[list[ZFSPool]]: ...
+    def get_properties(self, *, resource: ZFSResource, **kwargs: Any) -> asyncio.Future[Any]: ...
+    def asdict(self, *, resource: ZFSResource, **kwargs: Any) -> asyncio.Future[dict[str, Any]]: ...
+    def iter_filesystems(self, *, resource: ZFSResource, **kwargs: Any) -> asyncio.Future[list[Any]]: ...
+    def iter_snapshots(self, *, resource: ZFSResource, **kwargs: Any) -> asyncio.Future[list[ZFSSnapshot]]: ...
+    def pool_status(self, *, pool: ZFSPool, **kwargs: Any) -> asyncio.Future[Any]: ...
+    def local_replicate(self, *, resource: ZFSDataset | ZFSVolume, **kwargs: Any) -> asyncio.Future[Any]: ...
+
+
 class ZFS:
     """ZFS library handle. Obtain via truenas_pylibzfs.open_handle()."""
     def __init__(self, *args: Any, **kwargs: Any) -> None: ...
+    @property
+    def aio(self) -> ZFSAio: ...
     def open_pool(self, *, name: str) -> ZFSPool: ...
     def open_resource(self, **kwargs: Any) -> Any: ...
+    def open_resources(self, *, names: Iterable[str], missing_ok: bool = True) -> tuple[dict[str, ZFSDataset | ZFSVolume | ZFSSnapshot], list[str]]: ...
     def create_resource(self, *, name: str, type: ZFSType, properties: dict[str, Any] | None = None, user_properties: dict[str, str] | None = None, crypto: Any | None = None) -> None: ...
     def create_pool(
         self,
@@ -1250,8 +1396,48 @@ class ZFS:
     def destroy_pool(self, *, name: str, force: bool = False) -> None: ...
     def export_pool(self, *, name: str, force: bool = False) -> None: ...
     def destroy_resource(self, *, name: str) -> bool: ...
-    def iter_pools(self, *, callback: Any, state: Any) -> bool: ...
-    def iter_root_filesystems(self, *, callback: Any, state: Any) -> bool: ...
+    def property_cache_stats(self) -> dict[str, Any]: ...
+    def clear_property_cache(self) -> None: ...
+    def stats(self) -> dict[str, Any]: ...
+    def reset_stats(self) -> None: ...
+    @overload
+    def iter_pools(self, *, callback: Any, state: Any = ..., batch_size: int = ...) -> bool: ...
+    @overload
+    def iter_pools(self) -> ZFSResourceIterator[ZFSPool]: ...
+    @overload
+    def iter_root_filesystems(self, *, callback: Any, state: Any = ..., batch_size: int = ...) -> bool: ...
+    @overload
+    def iter_root_filesystems(self) -> ZFSResourceIterator[ZFSDataset]: ...
+    def query(
+        self,
+        *,
+        root: str | None = None,
+        properties: set[ZFSProperty] | frozenset[ZFSProperty] | ZFSPropertySelector | None = None,
+        get_source: bool = False,
+        get_user_properties: bool = False,
+        recursive: bool = False,
+        types: Iterable[ZFSType] | None = None,
+        select: Iterable[Literal['name', 'pool', 'type', 'type_enum', 'createtxg', 'guid', 'properties', 'user_properties']] | None = None,
+        filter: ZFSFilter | None = None,
+    ) -> list[dict[str, Any]]: ...
+    def query_json(
+        self,
+        *,
+        root: str | None = None,
+        properties: set[ZFSProperty] | frozenset[ZFSProperty] | ZFSPropertySelector | None = None,
+        get_source: bool = False,
+        get_user_properties: bool = False,
+        recursive: bool = False,
+        types: Iterable[ZFSType] | None = None,
+        select: Iterable[Literal['name', 'pool', 'type', 'type_enum', 'createtxg', 'guid', 'properties', 'user_properties']] | None = None,
+        filter: ZFSFilter | None = None,
+    ) -> bytes: ...
+    def set_properties_bulk(
+        self,
+        *,
+        properties: dict[str, dict[Any, Any]],
+        remount: bool = ...,
+    ) -> dict[str, tuple[int, str]]: ...
     def resource_cryptography_config(self, *, keyformat: str | None = None, keylocation: str | None = None, pbkdf2iters: int | None = None, key: str | bytes | None = None) -> Any: ...
     def zpool_events(self, *, blocking: bool = False, skip_existing_events: bool = False) -> Iterator[dict[str, Any]]: ...
     def import_pool_find(self, *, cache_file: str | None = None, device: str | None = None) -> list[struct_zpool_status]: ...
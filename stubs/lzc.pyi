@@ -1,6 +1,6 @@
 import enum
-from collections.abc import Callable, Collection
-from typing import Any
+from collections.abc import Callable, Collection, Sequence
+from typing import Any, overload
 
 class SendFlags(enum.IntFlag):
     EMBED_DATA = 1
@@ -36,6 +36,7 @@ class ChannelProgramEnum(enum.StrEnum):
     DESTROY_SNAPSHOTS = "DESTROY_SNAPSHOTS"
     TAKE_SNAPSHOTS = "TAKE_SNAPSHOTS"
     ROLLBACK_TO_TXG = "ROLLBACK_TO_TXG"
+    LIST_TREE = "LIST_TREE"
 
 class ZFSCoreException(RuntimeError):
     code: int
@@ -45,6 +46,7 @@ class ZFSCoreException(RuntimeError):
 
 def create_holds(*, holds: Collection[tuple[str, str]], cleanup_fd: int | bool = False) -> tuple[Any, ...]: ...
 def create_snapshots(*, snapshot_names: Collection[str], user_properties: dict[str, Any] | None = None) -> None: ...
+def create_snapshots_multi(*, snapshot_names: Collection[str], user_properties: dict[str, Any] | None = None) -> None: ...
 def destroy_snapshots(*, snapshot_names: Collection[str], defer_destroy: bool = False) -> None: ...
 def release_holds(*, holds: Collection[tuple[str, str]]) -> None: ...
 def rollback(*, resource_name: str, snapshot_name: str | None = None) -> str: ...
@@ -58,6 +60,15 @@ def run_channel_program(
     memory_limit: int = 10485760,
     readonly: bool = True,
 ) -> dict[str, Any]: ...
+def list_tree(
+    *,
+    root: str,
+    properties: Collection[str | int] | None = None,
+    snapshots: bool = False,
+    max_depth: int | None = None,
+    instruction_limit: int = 10000000,
+    memory_limit: int = 10485760,
+) -> dict[str, dict[str, dict[str, Any]]]: ...
 def wait(*, pool_name: str, activity: ZpoolWaitActivity | int, tag: int | None = None) -> bool: ...
 def send(
     *,
@@ -74,6 +85,24 @@ def send_space(
     flags: SendFlags | int = 0,
 ) -> int: ...
 def send_progress(*, snapshot_name: str, fd: int) -> tuple[int, int]: ...
+@overload
+def snaprange_space_matrix(
+    *,
+    dataset: str,
+    snapshots: Sequence[str],
+    max_span: int = 64,
+    candidates: None = None,
+    workers: int = 4,
+) -> memoryview: ...
+@overload
+def snaprange_space_matrix(
+    *,
+    dataset: str,
+    snapshots: Sequence[str],
+    max_span: int = 64,
+    candidates: Sequence[Sequence[int]],
+    workers: int = 4,
+) -> tuple[memoryview, memoryview]: ...
 def receive(
     *,
     snapname: str,
@@ -0,0 +1,157 @@
+"""
+Tests for ZFS.aio.
+
+Covers:
+  - open_resource / get_properties / asdict results equal the sync methods
+  - iteration methods return lists matching the sync iterators
+  - pool_status returns the same as ZFSPool.status()
+  - libzfs errors are raised from the awaited future
+  - futures cancelled before a worker runs them do not complete
+  - a full queue raises BlockingIOError
+  - calls outside of a running event loop raise RuntimeError
+  - argument validation
+"""
+
+import asyncio
+
+import pytest
+import truenas_pylibzfs
+
+POOL_NAME = 'testpool_aio'
+ZFSType = truenas_pylibzfs.ZFSType
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+ZFSException = truenas_pylibzfs.ZFSException
+
+CHILDREN = [f'{POOL_NAME}/c{i}' for i in range(4)]
+PROPS = {ZFSProperty.USED, ZFSProperty.COMPRESSION, ZFSProperty.MOUNTPOINT}
+
+
+@pytest.fixture
+def pool_with_children(make_pool):
+    lz, p, root = make_pool(POOL_NAME)
+    for name in CHILDREN:
+        lz.create_resource(name=name, type=ZFSType.ZFS_TYPE_FILESYSTEM)
+
+    truenas_pylibzfs.lzc.create_snapshots(snapshot_names=[f'{CHILDREN[0]}@s1'])
+    yield lz, p
+
+
+def test_open_and_properties(pool_with_children):
+    lz, p = pool_with_children
+
+    async def run():
+        rsrc = await lz.aio.open_resource(name=CHILDREN[0])
+        props = await lz.aio.get_properties(resource=rsrc, properties=PROPS)
+        data = await lz.aio.asdict(resource=rsrc, properties=PROPS)
+        return rsrc, props, data
+
+    rsrc, props, data = asyncio.run(run())
+    assert rsrc.name == CHILDREN[0]
+    assert props == rsrc.get_properties(properties=PROPS)
+    assert data == rsrc.asdict(properties=PROPS)
+
+
+def test_iterators(pool_with_children):
+    lz, p = pool_with_children
+    root = lz.open_resource(name=POOL_NAME)
+    ds = lz.open_resource(name=CHILDREN[0])
+
+    async def run():
+        return await asyncio.gather(
+            lz.aio.iter_filesystems(resource=root),
+            lz.aio.iter_snapshots(resource=ds),
+            lz.aio.iter_root_filesystems(),
+            lz.aio.iter_pools(),
+        )
+
+    children, snaps, roots, pools = asyncio.run(run())
+    assert sorted(c.name for c in children) == sorted(CHILDREN)
+    assert [s.name for s in snaps] == [f'{CHILDREN[0]}@s1']
+    assert POOL_NAME in [r.name for r in roots]
+    assert POOL_NAME in [x.name for x in pools]
+
+
+def test_pool_status(pool_with_children):
+    lz, p = pool_with_children
+    status = asyncio.run(lz.aio.pool_status(pool=p))
+    assert status.status == p.status().status
+
+
+def test_error_raised_from_future(pool_with_children):
+    lz, p = pool_with_children
+
+    async def run():
+        await lz.aio.open_resource(name=f'{POOL_NAME}/nonexistent')
+
+    with pytest.raises(ZFSException):
+        asyncio.run(run())
+
+
+def test_cancelled_before_run(pool_with_children):
+    lz, p = pool_with_children
+    hdl = truenas_pylibzfs.open_handle(aio_workers=1)
+
+    async def run():
+        futs = [hdl.aio.open_resource(name=n) for n in CHILDREN * 4]
+        futs[-1].cancel()
+        done = await asyncio.gather(*futs, return_exceptions=True)
+        return futs[-1], done
+
+    last, done = asyncio.run(run())
+    assert last.cancelled()
+    assert isinstance(done[-1], asyncio.CancelledError)
+    assert [r.name for r in done[:-1]] == (CHILDREN * 4)[:-1]
+
+
+def test_queue_full(pool_with_children):
+    lz, p = pool_with_children
+    hdl = truenas_pylibzfs.open_handle(aio_workers=1, aio_queue_depth=1)
+
+    async def run():
+        futs = []
+        try:
+            with pytest.raises(BlockingIOError):
+                for i in range(1000):
+                    futs.append(hdl.aio.asdict(
+                        resource=hdl.open_resource(name=CHILDREN[0]),
+                        properties=PROPS,
+                    ))
+        finally:
+            await asyncio.gather(*futs, return_exceptions=True)
+
+    asyncio.run(run())
+
+
+def test_no_running_loop(pool_with_children):
+    lz, p = pool_with_children
+    with pytest.raises(RuntimeError):
+        lz.aio.open_resource(name=CHILDREN[0])
+
+
+def test_bad_arguments(pool_with_children):
+    lz, p = pool_with_children
+    rsrc = lz.open_resource(name=CHILDREN[0])
+
+    async def run():
+        with pytest.raises(ValueError):
+            lz.aio.get_properties(properties=PROPS)
+
+        with pytest.raises(TypeError):
+            lz.aio.pool_status(pool=rsrc)
+
+        with pytest.raises(TypeError):
+            lz.aio.asdict(rsrc)
+
+        with pytest.raises(ValueError):
+            lz.aio.iter_snapshots(resource=rsrc, callback=lambda x: True)
+
+    asyncio.run(run())
+
+
+@pytest.mark.parametrize('kwargs', [
+    {'aio_workers': 0},
+    {'aio_queue_depth': 0},
+])
+def test_open_handle_invalid(kwargs):
+    with pytest.raises(ValueError):
+        truenas_pylibzfs.open_handle(**kwargs)
@@ -0,0 +1,123 @@
+"""
+Tests for ZFSResource.asdict_json() and ZFS.query_json().
+
+Covers:
+  - asdict_json() output equals json.dumps() of asdict() for the same args
+  - raw=False numeric properties and get_source
+  - user properties containing characters that require escaping
+  - get_crypto on an unencrypted dataset is null
+  - property not valid for the resource type raises ValueError
+  - query_json() output equals json.dumps() of query() including select
+"""
+
+import json
+
+import pytest
+import truenas_pylibzfs
+
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+ZFSType = truenas_pylibzfs.ZFSType
+
+PROPS = {
+    ZFSProperty.USED,
+    ZFSProperty.AVAILABLE,
+    ZFSProperty.COMPRESSION,
+    ZFSProperty.COMPRESSRATIO,
+    ZFSProperty.MOUNTED,
+    ZFSProperty.MOUNTPOINT,
+    ZFSProperty.QUOTA,
+    ZFSProperty.READONLY,
+}
+
+
+def _roundtrip(obj):
+    """Enums serialize as ints, which is also what asdict_json() writes."""
+    return json.loads(json.dumps(obj))
+
+
+@pytest.mark.parametrize('get_source', [False, True])
+@pytest.mark.parametrize('raw', [True, False])
+def test_asdict_json_matches_asdict(dataset, get_source, raw):
+    lz, root, ds = dataset
+    out = ds.asdict_json(properties=PROPS, get_source=get_source, raw=raw)
+    assert isinstance(out, bytes)
+
+    expected = ds.asdict(properties=PROPS, get_source=get_source, raw=raw)
+    assert json.loads(out) == _roundtrip(expected)
+
+
+def test_asdict_json_no_properties(dataset):
+    lz, root, ds = dataset
+    data = json.loads(ds.asdict_json())
+    assert data['name'] == ds.name
+    assert data['type_enum'] == int(ZFSType.ZFS_TYPE_FILESYSTEM)
+    assert data['properties'] is None
+    assert data['user_properties'] is None
+    assert data['crypto'] is None
+
+
+def test_asdict_json_selector(dataset):
+    lz, root, ds = dataset
+    sel = truenas_pylibzfs.create_property_selector(properties=PROPS)
+    assert json.loads(ds.asdict_json(properties=sel)) == \
+        json.loads(ds.asdict_json(properties=PROPS))
+
+
+def test_asdict_json_user_properties_escaped(dataset):
+    lz, root, ds = dataset
+    value = 'quote " backslash \\ tab \t newline \n \b \x7f unicode é 日 😀'
+    ds.set_user_properties(user_properties={'org.truenas:json': value})
+
+    out = ds.asdict_json(get_user_properties=True)
+    # non-ASCII is escaped as with json.dumps(ensure_ascii=True)
+    assert out.isascii()
+    assert json.dumps(value).encode() in out
+
+    data = json.loads(out)
+    assert data['user_properties']['org.truenas:json'] == value
+    assert data['user_properties'] == ds.get_user_properties()
+
+
+def test_asdict_json_crypto_unencrypted(dataset):
+    lz, root, ds = dataset
+    data = json.loads(ds.asdict_json(get_crypto=True))
+    assert data['crypto'] is None
+
+
+def test_asdict_json_invalid_for_type(dataset):
+    lz, root, ds = dataset
+    with pytest.raises(ValueError):
+        ds.asdict_json(properties={ZFSProperty.VOLSIZE})
+
+
+def test_asdict_json_bad_properties_type(dataset):
+    lz, root, ds = dataset
+    with pytest.raises(TypeError):
+        ds.asdict_json(properties=[ZFSProperty.USED])
+
+
+@pytest.mark.parametrize('select', [
+    None,
+    ['name', 'guid'],
+    ['properties', 'user_properties', 'type', 'type_enum'],
+])
+def test_query_json_matches_query(dataset, select):
+    lz, root, ds = dataset
+    ds.set_user_properties(user_properties={'org.truenas:q': 'x"y'})
+    kwargs = dict(
+        root=root.name,
+        recursive=True,
+        properties=PROPS,
+        get_source=True,
+        get_user_properties=True,
+        select=select,
+    )
+    out = lz.query_json(**kwargs)
+    assert isinstance(out, bytes)
+    assert json.loads(out) == _roundtrip(lz.query(**kwargs))
+
+
+def test_query_json_empty(dataset):
+    lz, root, ds = dataset
+    out = lz.query_json(root=root.name, types=[ZFSType.ZFS_TYPE_VOLUME])
+    assert out == b'[]'
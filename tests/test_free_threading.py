@@ -0,0 +1,131 @@
+"""
+Stress tests for concurrent use of shared objects from many threads.
+
+These run on regular builds as well, but are primarily meant for
+free-threaded (3.13t / 3.14t) builds where the module runs without the GIL.
+
+Covers:
+  - module does not re-enable the GIL on free-threaded builds
+  - shared ZFS handle: open_resource / get_properties / query in parallel
+  - shared handle pool (pool_size > 1) under the same load
+  - shared resource object: get_properties, asdict, name while renaming
+  - shared ZFSPropertyView: concurrent attribute access
+  - shared ZFSResourceIterator consumed by several threads
+"""
+
+import sys
+import sysconfig
+import threading
+
+import pytest
+import truenas_pylibzfs
+
+POOL_NAME = 'testpool_ftstress'
+NTHREADS = 16
+ITERATIONS = 50
+ZFSType = truenas_pylibzfs.ZFSType
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+
+CHILDREN = [f'{POOL_NAME}/c{i}' for i in range(NTHREADS)]
+PROPS = {ZFSProperty.USED, ZFSProperty.AVAILABLE, ZFSProperty.COMPRESSION,
+         ZFSProperty.MOUNTPOINT, ZFSProperty.RECORDSIZE}
+
+
+def _run(target, args_list):
+    errors = []
+    barrier = threading.Barrier(len(args_list))
+
+    def wrapper(*args):
+        barrier.wait()
+        try:
+            target(*args)
+        except Exception as e:
+            errors.append(e)
+
+    threads = [threading.Thread(target=wrapper, args=args)
+               for args in args_list]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    assert errors == []
+
+
+@pytest.fixture
+def stress_pool(make_pool):
+    lz, p, root = make_pool(POOL_NAME)
+    for name in CHILDREN:
+        lz.create_resource(name=name, type=ZFSType.ZFS_TYPE_FILESYSTEM)
+    yield lz
+
+
+@pytest.mark.skipif(not sysconfig.get_config_var('Py_GIL_DISABLED'),
+                    reason='requires free-threaded build')
+def test_gil_not_enabled():
+    assert not sys._is_gil_enabled()
+
+
+@pytest.mark.parametrize('pool_size', [1, 4])
+def test_shared_handle(stress_pool, pool_size):
+    lz = truenas_pylibzfs.open_handle(pool_size=pool_size)
+
+    def worker(name):
+        for _ in range(ITERATIONS):
+            rsrc = lz.open_resource(name=name)
+            props = rsrc.get_properties(properties=PROPS)
+            assert props.used.value > 0
+            assert lz.query(root=name, select=['name'])[0]['name'] == name
+
+    _run(worker, [(name,) for name in CHILDREN])
+
+
+def test_shared_resource(stress_pool):
+    lz = stress_pool
+    rsrc = lz.open_resource(name=CHILDREN[0])
+    names = [CHILDREN[0], f'{CHILDREN[0]}_renamed']
+
+    def reader():
+        for _ in range(ITERATIONS):
+            rsrc.get_properties(properties=PROPS)
+            rsrc.asdict(properties=PROPS)
+            assert rsrc.name in names
+
+    def renamer():
+        # even number of renames so that the original name is restored
+        for i in range(10):
+            rsrc.rename(new_name=names[(i + 1) % 2])
+
+    _run(lambda fn: fn(), [(renamer,)] + [(reader,)] * (NTHREADS - 1))
+    assert rsrc.name == CHILDREN[0]
+
+
+def test_shared_lazy_view(stress_pool):
+    lz = stress_pool
+    rsrc = lz.open_resource(name=CHILDREN[0])
+    view = rsrc.get_properties(properties=PROPS, lazy=True)
+    expected = rsrc.get_properties(properties=PROPS)
+
+    def worker():
+        for _ in range(ITERATIONS):
+            assert view.compression.value == expected.compression.value
+            assert view.recordsize.value == expected.recordsize.value
+            view.materialize()
+
+    _run(worker, [()] * NTHREADS)
+
+
+def test_shared_resource_iterator(stress_pool):
+    lz = stress_pool
+    root = lz.open_resource(name=POOL_NAME)
+    it = root.iter_filesystems()
+    seen = []
+    lock = threading.Lock()
+
+    def worker():
+        for rsrc in it:
+            with lock:
+                seen.append(rsrc.name)
+
+    _run(worker, [()] * NTHREADS)
+    assert sorted(seen) == sorted(CHILDREN)
@@ -0,0 +1,164 @@
+"""
+Tests for ZFSResource.get_properties() reading several properties at once.
+
+Covers:
+  - bulk read of a full property set matches reading each property alone
+  - unrequested properties are None
+  - property invalid for the resource type raises ValueError
+  - empty property set returns all-None struct
+  - raw=False reads numeric properties without a raw string
+  - lazy=True view reads properties on first attribute access
+"""
+
+import pytest
+import truenas_pylibzfs
+
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+FS_PROPS = truenas_pylibzfs.property_sets.ZFS_FILESYSTEM_PROPERTIES
+# values of these change as a side effect of reading the others
+VOLATILE = {'used', 'usedbydataset', 'referenced', 'logicalused',
+            'logicalreferenced', 'written', 'available'}
+
+
+def test_bulk_matches_single(dataset):
+    lz, root, ds = dataset
+    bulk = ds.get_properties(properties=FS_PROPS, get_source=True)
+
+    for prop in FS_PROPS:
+        key = prop.name.lower()
+        if key in VOLATILE:
+            continue
+
+        single = ds.get_properties(properties={prop}, get_source=True)
+        assert getattr(bulk, key) == getattr(single, key), key
+
+
+def test_unrequested_are_none(dataset):
+    lz, root, ds = dataset
+    props = ds.get_properties(properties={ZFSProperty.COMPRESSION,
+                                          ZFSProperty.READONLY})
+    assert props.compression is not None
+    assert props.readonly.value == 'off'
+    assert props.volsize is None
+    assert props.mountpoint is None
+
+
+def test_invalid_for_type_raises(dataset):
+    lz, root, ds = dataset
+    with pytest.raises(ValueError):
+        ds.get_properties(properties={ZFSProperty.COMPRESSION,
+                                      ZFSProperty.VOLSIZE})
+
+
+def test_empty_set(dataset):
+    lz, root, ds = dataset
+    props = ds.get_properties(properties=set())
+    assert props.compression is None
+
+
+# ---------------------------------------------------------------------------
+# raw=False numeric fast path
+# ---------------------------------------------------------------------------
+
+SPACE = truenas_pylibzfs.property_sets.ZFS_SPACE_PROPERTIES
+
+
+def test_numeric_raw_false(dataset):
+    lz, root, ds = dataset
+    props = ds.get_properties(properties={ZFSProperty.CREATETXG,
+                                          ZFSProperty.QUOTA,
+                                          ZFSProperty.COMPRESSION},
+                              raw=False)
+    assert props.createtxg.raw is None
+    assert props.createtxg.value == ds.createtxg
+    # quota of zero is reported as 0 as with raw=True
+    assert props.quota.value == 0
+    # non-numeric properties are unaffected
+    assert props.compression.raw is not None
+
+
+def test_numeric_raw_false_matches(dataset):
+    lz, root, ds = dataset
+    ds.set_properties(properties={ZFSProperty.QUOTA: 1024 ** 3})
+    fast = ds.get_properties(properties=SPACE | {ZFSProperty.QUOTA},
+                             get_source=True, raw=False)
+    slow = ds.get_properties(properties=SPACE | {ZFSProperty.QUOTA},
+                             get_source=True)
+
+    assert fast.quota.value == slow.quota.value == 1024 ** 3
+    assert fast.quota.source == slow.quota.source
+    for prop in SPACE:
+        key = prop.name.lower()
+        assert isinstance(getattr(fast, key).value, type(getattr(slow, key).value)), key
+
+
+def test_numeric_raw_false_unset_values(dataset):
+    lz, root, ds = dataset
+    props = {ZFSProperty.QUOTA, ZFSProperty.REFRESERVATION,
+             ZFSProperty.FILESYSTEM_LIMIT, ZFSProperty.SNAPSHOT_LIMIT}
+    fast = ds.get_properties(properties=props, raw=False)
+    slow = ds.get_properties(properties=props)
+    view = ds.get_properties(properties=props, raw=False, lazy=True)
+
+    for prop in props:
+        key = prop.name.lower()
+        assert getattr(fast, key).value == getattr(slow, key).value, key
+        assert getattr(view, key).value == getattr(slow, key).value, key
+
+    # zero quota stays 0, unset limits are None
+    assert fast.quota.value == 0
+    assert fast.filesystem_limit.value is None
+
+
+def test_asdict_raw_false(dataset):
+    lz, root, ds = dataset
+    out = ds.asdict(properties={ZFSProperty.CREATETXG}, raw=False)
+    assert out['properties']['createtxg'] == {
+        'value': ds.createtxg, 'raw': None, 'source': None,
+    }
+
+
+# ---------------------------------------------------------------------------
+# lazy=True
+# ---------------------------------------------------------------------------
+
+def test_lazy_matches_eager(dataset):
+    lz, root, ds = dataset
+    props = {ZFSProperty.COMPRESSION, ZFSProperty.READONLY, ZFSProperty.ATIME}
+    view = ds.get_properties(properties=props, get_source=True, lazy=True)
+    eager = ds.get_properties(properties=props, get_source=True)
+
+    assert isinstance(view, truenas_pylibzfs.libzfs_types.ZFSPropertyView)
+    assert view.compression == eager.compression
+    assert view.compression is view.compression  # cached
+    assert view.volsize is None
+    assert view.materialize() == eager
+
+
+def test_lazy_value_read_on_access(dataset):
+    lz, root, ds = dataset
+    view = ds.get_properties(properties={ZFSProperty.READONLY}, lazy=True)
+    ds.set_properties(properties={ZFSProperty.READONLY: 'on'})
+    assert view.readonly.value == 'on'
+
+
+def test_lazy_invalid_for_type_raises_on_access(dataset):
+    lz, root, ds = dataset
+    view = ds.get_properties(properties={ZFSProperty.VOLSIZE}, lazy=True)
+    with pytest.raises(ValueError):
+        view.volsize
+
+
+def test_lazy_unknown_attribute(dataset):
+    lz, root, ds = dataset
+    view = ds.get_properties(properties={ZFSProperty.READONLY}, lazy=True)
+    with pytest.raises(AttributeError):
+        view.not_a_property
+
+
+def test_lazy_selector(dataset):
+    lz, root, ds = dataset
+    sel = truenas_pylibzfs.create_property_selector(properties={ZFSProperty.ATIME})
+    view = ds.get_properties(properties=sel, lazy=True)
+    assert view.atime is not None
+    assert view.readonly is None
@@ -0,0 +1,124 @@
+"""
+Tests for open_handle(pool_size=N).
+
+Covers:
+  - resources and pools opened through a pooled handle are usable
+  - resources created on one pooled handle are visible through the others
+  - query() and iterators return the same results as a single handle
+  - concurrent property reads from several threads
+  - mounts and unmounts through one handle are seen by the others
+  - pool_size < 1 and pool_size combined with property_cache_ttl or
+    mnttab_cache=True raise
+"""
+
+import threading
+
+import pytest
+import truenas_pylibzfs
+
+POOL_NAME = 'testpool_hdlpool'
+POOL_SIZE = 4
+ZFSType = truenas_pylibzfs.ZFSType
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+
+CHILDREN = [f'{POOL_NAME}/c{i}' for i in range(8)]
+
+
+@pytest.fixture
+def pooled(make_pool):
+    lz, p, root = make_pool(POOL_NAME)
+    for name in CHILDREN:
+        lz.create_resource(name=name, type=ZFSType.ZFS_TYPE_FILESYSTEM)
+
+    yield truenas_pylibzfs.open_handle(pool_size=POOL_SIZE)
+
+
+def test_open_resource_round_robin(pooled):
+    # Open more resources than there are handles so each handle is used
+    for name in CHILDREN * 2:
+        rsrc = pooled.open_resource(name=name)
+        assert rsrc.name == name
+        props = rsrc.get_properties(properties={ZFSProperty.USED})
+        assert props.used.value > 0
+
+
+def test_create_visible_on_all_handles(pooled):
+    name = f'{POOL_NAME}/new'
+    pooled.create_resource(name=name, type=ZFSType.ZFS_TYPE_FILESYSTEM)
+    for _ in range(POOL_SIZE):
+        assert pooled.open_resource(name=name).name == name
+
+
+def test_open_pool(pooled):
+    for _ in range(POOL_SIZE):
+        assert pooled.open_pool(name=POOL_NAME).name == POOL_NAME
+
+
+def test_query_matches_single_handle(pooled):
+    single = truenas_pylibzfs.open_handle()
+    expected = single.query(root=POOL_NAME, recursive=True,
+                            select=['name'])
+    for _ in range(POOL_SIZE):
+        assert pooled.query(root=POOL_NAME, recursive=True,
+                            select=['name']) == expected
+
+
+def test_iterators(pooled):
+    for _ in range(POOL_SIZE):
+        names = [r.name for r in pooled.iter_root_filesystems()]
+        assert POOL_NAME in names
+        pools = [p.name for p in pooled.iter_pools()]
+        assert POOL_NAME in pools
+
+
+def test_concurrent_reads(pooled):
+    errors = []
+
+    def worker(name):
+        try:
+            for _ in range(20):
+                rsrc = pooled.open_resource(name=name)
+                rsrc.get_properties(properties={ZFSProperty.USED,
+                                                ZFSProperty.AVAILABLE})
+        except Exception as e:
+            errors.append(e)
+
+    threads = [threading.Thread(target=worker, args=(name,))
+               for name in CHILDREN]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    assert errors == []
+
+
+def test_mount_state_shared(pooled):
+    # consecutive opens land on different handles
+    first, second = [pooled.open_resource(name=CHILDREN[0])
+                     for _ in range(2)]
+    first.mount()
+    try:
+        assert second.get_mountpoint() is not None
+    finally:
+        first.unmount()
+
+    assert second.get_mountpoint() is None
+
+
+@pytest.mark.parametrize('pool_size', [0, -1])
+def test_invalid_pool_size(pool_size):
+    with pytest.raises(ValueError):
+        truenas_pylibzfs.open_handle(pool_size=pool_size)
+
+
+def test_pool_size_with_cache():
+    with pytest.raises(ValueError):
+        truenas_pylibzfs.open_handle(pool_size=2, property_cache_ttl=1.0)
+
+
+def test_pool_size_with_mnttab_cache():
+    with pytest.raises(ValueError):
+        truenas_pylibzfs.open_handle(pool_size=2, mnttab_cache=True)
+
+    truenas_pylibzfs.open_handle(pool_size=2, mnttab_cache=False)
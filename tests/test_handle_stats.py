@@ -0,0 +1,99 @@
+"""
+Tests for ZFS.stats() and ZFS.reset_stats().
+
+Covers:
+  - structure of the returned dict
+  - lock acquisitions and histograms advance with operations
+  - per-operation counters for open, prop_get, prop_set, iter and mount
+  - reset_stats() zeroes all counters
+  - counters of a handle pool are combined
+"""
+
+import pytest
+import truenas_pylibzfs
+
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+OPS = ('open', 'prop_get', 'prop_set', 'iter', 'mount', 'send')
+LOCK_KEYS = ('acquisitions', 'wait_total_ns', 'wait_max_ns',
+             'hold_total_ns', 'hold_max_ns')
+
+
+def _op(lz, name):
+    return lz.stats()['operations'][name]['count']
+
+
+def test_stats_structure():
+    lz = truenas_pylibzfs.open_handle()
+    st = lz.stats()
+    assert st['handles'] == 1
+    for key in LOCK_KEYS:
+        assert isinstance(st['lock'][key], int)
+
+    assert len(st['lock']['wait_histogram']) == 32
+    assert len(st['lock']['hold_histogram']) == 32
+    assert set(st['operations']) == set(OPS)
+    for op in st['operations'].values():
+        assert set(op) == {'count', 'total_ns', 'max_ns'}
+
+
+def test_lock_counters(dataset):
+    lz, root, ds = dataset
+    lz.reset_stats()
+    before = lz.stats()['lock']['acquisitions']
+    lz.open_resource(name=ds.name)
+    lock = lz.stats()['lock']
+
+    assert lock['acquisitions'] > before
+    assert sum(lock['wait_histogram']) == lock['acquisitions']
+    assert sum(lock['hold_histogram']) == lock['acquisitions']
+    assert lock['hold_max_ns'] <= lock['hold_total_ns']
+
+
+def test_operation_counters(dataset):
+    lz, root, ds = dataset
+    lz.reset_stats()
+
+    rsrc = lz.open_resource(name=ds.name)
+    assert _op(lz, 'open') == 1
+
+    rsrc.get_properties(properties={ZFSProperty.USED})
+    assert _op(lz, 'prop_get') == 1
+
+    rsrc.set_user_properties(user_properties={'org.truenas:stats': 'x'})
+    assert _op(lz, 'prop_set') == 1
+
+    rsrc.iter_filesystems(callback=lambda hdl: True)
+    assert _op(lz, 'iter') == 1
+
+    rsrc.mount()
+    rsrc.unmount()
+    assert _op(lz, 'mount') == 2
+
+    op = lz.stats()['operations']['open']
+    assert op['max_ns'] <= op['total_ns']
+
+
+def test_reset(dataset):
+    lz, root, ds = dataset
+    lz.open_resource(name=ds.name)
+    lz.reset_stats()
+    st = lz.stats()
+    # stats() itself does not take the lock
+    assert all(st['lock'][key] == 0 for key in LOCK_KEYS)
+    assert sum(st['lock']['wait_histogram']) == 0
+    assert all(op['count'] == 0 for op in st['operations'].values())
+
+
+@pytest.mark.parametrize('pool_size', [3])
+def test_handle_pool_combined(dataset, pool_size):
+    lz, root, ds = dataset
+    pooled = truenas_pylibzfs.open_handle(pool_size=pool_size)
+    for _ in range(pool_size):
+        pooled.open_resource(name=ds.name)
+
+    st = pooled.stats()
+    assert st['handles'] == pool_size
+    assert st['operations']['open']['count'] == pool_size
+
+    pooled.reset_stats()
+    assert pooled.stats()['operations']['open']['count'] == 0
@@ -0,0 +1,98 @@
+"""
+Tests for lzc.create_snapshots_multi().
+
+Covers:
+  - snapshots spanning several pools are created in one call
+  - user properties are applied in every pool
+  - one history entry is written per pool
+  - a failing pool does not prevent other pools' snapshots; errors are merged
+  - validation errors (empty, duplicate dataset, invalid name, keyword-only)
+"""
+
+import errno
+
+import pytest
+import truenas_pylibzfs
+from truenas_pylibzfs import lzc
+
+POOLS = ['testpool_msnap_a', 'testpool_msnap_b', 'testpool_msnap_c']
+HIST_PREFIX = 'truenas_pylibzfs: lzc_snapshot()'
+
+
+@pytest.fixture
+def pools(make_pool):
+    out = [make_pool(name) for name in POOLS]
+    lz = out[0][0]
+    for name in POOLS:
+        lz.create_resource(name=f'{name}/ds',
+                           type=truenas_pylibzfs.ZFSType.ZFS_TYPE_FILESYSTEM)
+    yield lz, [p for _, p, _ in out]
+
+
+def _exists(lz, name):
+    try:
+        lz.open_resource(name=name)
+    except truenas_pylibzfs.ZFSException:
+        return False
+    return True
+
+
+def test_multiple_pools(pools):
+    lz, pool_hdls = pools
+    snaps = [f'{p}@m1' for p in POOLS] + [f'{p}/ds@m1' for p in POOLS]
+
+    assert lzc.create_snapshots_multi(
+        snapshot_names=snaps,
+        user_properties={'org.truenas:test': 'value'},
+    ) is None
+
+    for name in snaps:
+        rsrc = lz.open_resource(name=name)
+        assert rsrc.get_user_properties()['org.truenas:test'] == 'value'
+
+    for p in pool_hdls:
+        cmds = [
+            rec['history command'] for rec in p.iter_history()
+            if 'history command' in rec
+        ]
+        assert any(
+            c.startswith(f'{HIST_PREFIX} 2 snapshots') and p.name in c
+            for c in cmds
+        )
+
+
+def test_single_pool(pools):
+    lz, pool_hdls = pools
+    lzc.create_snapshots_multi(snapshot_names={f'{POOLS[0]}/ds@single'})
+    assert _exists(lz, f'{POOLS[0]}/ds@single')
+
+
+def test_partial_failure(pools):
+    lz, pool_hdls = pools
+    good = [f'{POOLS[0]}/ds@pf', f'{POOLS[2]}/ds@pf']
+    bad = f'{POOLS[1]}/missing@pf'
+
+    with pytest.raises(lzc.ZFSCoreException) as ce:
+        lzc.create_snapshots_multi(snapshot_names=good + [bad])
+
+    assert ce.value.code == errno.ENOENT
+    assert bad in [name for name, err in ce.value.errors]
+    for name in good:
+        assert _exists(lz, name)
+
+
+@pytest.mark.parametrize('names,exc', [
+    ([], ValueError),
+    ([f'{POOLS[0]}/ds@a', f'{POOLS[0]}/ds@b'], ValueError),
+    ([f'{POOLS[0]}/ds'], TypeError),
+    ([1], TypeError),
+    (1, TypeError),
+])
+def test_invalid(names, exc):
+    with pytest.raises(exc):
+        lzc.create_snapshots_multi(snapshot_names=names)
+
+
+def test_keyword_only():
+    with pytest.raises(TypeError):
+        lzc.create_snapshots_multi([f'{POOLS[0]}@kw'])
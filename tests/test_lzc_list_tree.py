@@ -0,0 +1,141 @@
+"""
+Tests for lzc.list_tree().
+
+Covers:
+  - root and all descendants are listed, root included
+  - max_depth limits descent
+  - snapshots=True includes snapshots
+  - properties accepted as str (including user properties) and ZFSProperty
+  - property values match zfs.get_prop() via run_channel_program
+  - properties not valid for a type are omitted
+  - low limits still return the complete listing (chunked)
+  - a limit too low for a single entry raises ZFSCoreException
+  - nonexistent root raises ZFSCoreException
+  - argument validation
+"""
+
+import pytest
+import truenas_pylibzfs
+from truenas_pylibzfs import lzc
+
+POOL_NAME = 'testpool_listtree'
+ZFSType = truenas_pylibzfs.ZFSType
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+
+FILESYSTEMS = [
+    f'{POOL_NAME}/a',
+    f'{POOL_NAME}/a/b',
+    f'{POOL_NAME}/a/b/c',
+    f'{POOL_NAME}/d',
+]
+VOLUME = f'{POOL_NAME}/vol'
+SNAPSHOT = f'{POOL_NAME}/a@s1'
+
+
+@pytest.fixture
+def pool_with_tree(make_pool):
+    lz, p, root = make_pool(POOL_NAME)
+    for name in FILESYSTEMS:
+        lz.create_resource(name=name, type=ZFSType.ZFS_TYPE_FILESYSTEM)
+
+    lz.create_resource(
+        name=VOLUME,
+        type=ZFSType.ZFS_TYPE_VOLUME,
+        properties={ZFSProperty.VOLSIZE: 1048576},
+    )
+    lz.open_resource(name=f'{POOL_NAME}/a').set_user_properties(
+        user_properties={'org.truenas:test': 'yes'}
+    )
+    lzc.create_snapshots(snapshot_names=[SNAPSHOT])
+    yield lz
+
+
+def test_list_all(pool_with_tree):
+    out = lzc.list_tree(root=POOL_NAME)
+    assert sorted(out) == sorted([POOL_NAME, VOLUME] + FILESYSTEMS)
+    assert all(v == {} for v in out.values())
+
+
+def test_subtree(pool_with_tree):
+    out = lzc.list_tree(root=f'{POOL_NAME}/a')
+    assert sorted(out) == sorted(FILESYSTEMS[:3])
+
+
+@pytest.mark.parametrize('depth,expected', [
+    (0, [POOL_NAME]),
+    (1, [POOL_NAME, f'{POOL_NAME}/a', f'{POOL_NAME}/d', VOLUME]),
+    (2, [POOL_NAME, f'{POOL_NAME}/a', f'{POOL_NAME}/a/b', f'{POOL_NAME}/d',
+         VOLUME]),
+])
+def test_max_depth(pool_with_tree, depth, expected):
+    out = lzc.list_tree(root=POOL_NAME, max_depth=depth)
+    assert sorted(out) == sorted(expected)
+
+
+def test_snapshots(pool_with_tree):
+    out = lzc.list_tree(root=f'{POOL_NAME}/a', snapshots=True, max_depth=0)
+    assert sorted(out) == sorted([f'{POOL_NAME}/a', SNAPSHOT])
+
+
+def test_properties(pool_with_tree):
+    out = lzc.list_tree(
+        root=POOL_NAME,
+        properties=[ZFSProperty.USED, 'org.truenas:test', 'volsize'],
+    )
+
+    expected = lzc.run_channel_program(
+        pool_name=POOL_NAME,
+        script='local args = ... '
+               'local v, s = zfs.get_prop(args.argv[1], "used") '
+               'return {value = v, source = s}',
+        script_arguments=[f'{POOL_NAME}/a'],
+    )['return']
+
+    assert out[f'{POOL_NAME}/a']['used'] == expected
+    assert out[f'{POOL_NAME}/a']['org.truenas:test']['value'] == 'yes'
+    assert out[f'{POOL_NAME}/a/b']['org.truenas:test']['value'] == 'yes'
+    assert 'volsize' not in out[f'{POOL_NAME}/a']
+    assert out[VOLUME]['volsize']['value'] == 1048576
+
+
+def test_low_limits_complete(pool_with_tree):
+    props = ['used', 'available', 'referenced', 'compression', 'atime',
+             'mountpoint', 'quota', 'recordsize']
+    full = lzc.list_tree(root=POOL_NAME, properties=props, snapshots=True)
+    chunked = lzc.list_tree(
+        root=POOL_NAME,
+        properties=props,
+        snapshots=True,
+        instruction_limit=2000,
+    )
+    assert chunked.keys() == full.keys()
+
+
+def test_limit_too_low_for_one_entry(pool_with_tree):
+    with pytest.raises(lzc.ZFSCoreException):
+        lzc.list_tree(
+            root=POOL_NAME,
+            properties=['used', 'available'],
+            snapshots=True,
+            instruction_limit=100,
+        )
+
+
+def test_nonexistent_root(pool_with_tree):
+    with pytest.raises(lzc.ZFSCoreException):
+        lzc.list_tree(root=f'{POOL_NAME}/nonexistent')
+
+
+def test_root_required():
+    with pytest.raises(ValueError):
+        lzc.list_tree()
+
+
+def test_negative_depth(pool_with_tree):
+    with pytest.raises(ValueError):
+        lzc.list_tree(root=POOL_NAME, max_depth=-1)
+
+
+def test_bad_property_type(pool_with_tree):
+    with pytest.raises(TypeError):
+        lzc.list_tree(root=POOL_NAME, properties=[1.5])
@@ -0,0 +1,175 @@
+"""
+Tests for lzc.snaprange_space_matrix().
+
+Covers:
+  - single-snapshot ranges equal the snapshot's used property
+  - matrix shape follows max_span and entries past the end are zero
+  - candidate sets are the sum of their contiguous runs
+  - short and full snapshot names give the same result
+  - results do not depend on the number of workers
+  - snapshots out of order or with gaps raise ZFSCoreException (EINVAL)
+  - a slice of consecutive snapshots is accepted
+  - argument validation
+"""
+
+import errno
+import os
+
+import pytest
+import truenas_pylibzfs
+from truenas_pylibzfs import lzc
+
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+MIB = 1024 * 1024
+SNAPS = ['s0', 's1', 's2', 's3']
+
+
+@pytest.fixture
+def snapped(dataset):
+    """
+    s0: a          (a shared with s1)
+    s1: a, b       (b unique to s1)
+    s2: c          (c unique to s2)
+    s3: (empty)
+    """
+    lz, root, ds = dataset
+    ds.mount()
+    try:
+        mp = ds.get_mountpoint()
+
+        def write(name):
+            with open(os.path.join(mp, name), 'wb') as f:
+                f.write(os.urandom(MIB))
+
+        def snap(name):
+            lzc.create_snapshots(snapshot_names=[f'{ds.name}@{name}'])
+
+        write('a')
+        snap('s0')
+        write('b')
+        snap('s1')
+        os.unlink(os.path.join(mp, 'a'))
+        os.unlink(os.path.join(mp, 'b'))
+        write('c')
+        snap('s2')
+        os.unlink(os.path.join(mp, 'c'))
+        snap('s3')
+        yield lz, ds
+    finally:
+        ds.unmount()
+
+
+def test_single_ranges_match_used(snapped):
+    lz, ds = snapped
+    m = lzc.snaprange_space_matrix(dataset=ds.name, snapshots=SNAPS)
+
+    assert m.format == 'Q'
+    assert m.shape == (len(SNAPS), len(SNAPS))
+    for i, name in enumerate(SNAPS):
+        snap = lz.open_resource(name=f'{ds.name}@{name}')
+        used = snap.get_properties(properties={ZFSProperty.USED}).used.value
+        assert m[i, 0] == used
+
+    assert m[1, 0] >= MIB
+    assert m[2, 0] >= MIB
+    assert m[0, 1] >= 2 * MIB
+    assert m[0, 1] > m[0, 0] + m[1, 0]
+
+
+def test_max_span(snapped):
+    lz, ds = snapped
+    full = lzc.snaprange_space_matrix(dataset=ds.name, snapshots=SNAPS)
+    m = lzc.snaprange_space_matrix(dataset=ds.name, snapshots=SNAPS,
+                                   max_span=2)
+
+    assert m.shape == (len(SNAPS), 2)
+    assert m[len(SNAPS) - 1, 1] == 0
+    for i in range(len(SNAPS)):
+        for k in range(2):
+            assert m[i, k] == full[i, k]
+
+
+def test_candidates(snapped):
+    lz, ds = snapped
+    m, sets = lzc.snaprange_space_matrix(
+        dataset=ds.name,
+        snapshots=SNAPS,
+        max_span=1,
+        candidates=[[1, 0], [0, 2], [3], [], [2, 2]],
+    )
+
+    full = lzc.snaprange_space_matrix(dataset=ds.name, snapshots=SNAPS)
+    assert sets.format == 'Q'
+    assert list(sets) == [
+        full[0, 1],
+        full[0, 0] + full[2, 0],
+        full[3, 0],
+        0,
+        full[2, 0],
+    ]
+
+
+def test_full_names_and_workers(snapped):
+    lz, ds = snapped
+    short = lzc.snaprange_space_matrix(dataset=ds.name, snapshots=SNAPS)
+    full = lzc.snaprange_space_matrix(
+        dataset=ds.name,
+        snapshots=[f'{ds.name}@{s}' for s in SNAPS],
+        workers=1,
+    )
+    assert short.tolist() == full.tolist()
+
+
+def test_out_of_order(snapped):
+    lz, ds = snapped
+    with pytest.raises(lzc.ZFSCoreException) as ce:
+        lzc.snaprange_space_matrix(dataset=ds.name,
+                                   snapshots=list(reversed(SNAPS)))
+
+    assert ce.value.code == errno.EINVAL
+    assert '%' in ce.value.errors[0][0]
+
+
+def test_gap_rejected(snapped):
+    lz, ds = snapped
+    with pytest.raises(lzc.ZFSCoreException) as ce:
+        lzc.snaprange_space_matrix(dataset=ds.name, snapshots=['s0', 's2'])
+
+    assert ce.value.code == errno.EINVAL
+    assert ce.value.errors[0][0] == f'{ds.name}@s0%s2'
+
+
+def test_consecutive_slice(snapped):
+    lz, ds = snapped
+    full = lzc.snaprange_space_matrix(dataset=ds.name, snapshots=SNAPS)
+    m = lzc.snaprange_space_matrix(dataset=ds.name, snapshots=SNAPS[1:3])
+
+    assert m.shape == (2, 2)
+    assert m[0, 1] == full[1, 1]
+
+
+def test_missing_snapshot(snapped):
+    lz, ds = snapped
+    with pytest.raises(lzc.ZFSCoreException) as ce:
+        lzc.snaprange_space_matrix(dataset=ds.name,
+                                   snapshots=['s0', 'nonexistent'])
+
+    assert ce.value.code == errno.ENOENT
+
+
+@pytest.mark.parametrize('kwargs,exc', [
+    ({'snapshots': SNAPS}, ValueError),
+    ({'dataset': 'x/y'}, ValueError),
+    ({'dataset': 'x/y', 'snapshots': []}, ValueError),
+    ({'dataset': 'x/y', 'snapshots': ['z/w@s0']}, ValueError),
+    ({'dataset': 'x/y', 'snapshots': [1]}, TypeError),
+    ({'dataset': 'x/y', 'snapshots': SNAPS, 'max_span': -1}, ValueError),
+    ({'dataset': 'x/y', 'snapshots': SNAPS, 'max_span': 0}, ValueError),
+    ({'dataset': 'x/y', 'snapshots': SNAPS, 'workers': 0}, ValueError),
+    ({'dataset': 'x/y', 'snapshots': SNAPS, 'workers': 65}, ValueError),
+    ({'dataset': 'x/y', 'snapshots': SNAPS, 'candidates': [[4]]}, ValueError),
+    ({'dataset': 'x/y', 'snapshots': SNAPS, 'candidates': [['a']]}, TypeError),
+])
+def test_bad_arguments(kwargs, exc):
+    with pytest.raises(exc):
+        lzc.snaprange_space_matrix(**kwargs)
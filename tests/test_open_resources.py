@@ -0,0 +1,94 @@
+"""
+Tests for ZFS.open_resources().
+
+Covers:
+  - filesystems, volumes and snapshots are opened with the correct type
+  - missing names are returned in the missing list (missing_ok=True)
+  - missing name raises ZFSException when missing_ok=False
+  - invalid dataset name raises ZFSException
+  - empty input and argument validation
+"""
+
+import pytest
+import truenas_pylibzfs
+
+POOL_NAME = 'testpool_openmany'
+ZFSType = truenas_pylibzfs.ZFSType
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+ZFSException = truenas_pylibzfs.ZFSException
+
+CHILDREN = [f'{POOL_NAME}/c{i}' for i in range(10)]
+VOLUME = f'{POOL_NAME}/vol'
+SNAPSHOT = f'{POOL_NAME}/c0@s1'
+
+
+@pytest.fixture
+def pool_with_children(make_pool):
+    lz, p, root = make_pool(POOL_NAME)
+    for name in CHILDREN:
+        lz.create_resource(name=name, type=ZFSType.ZFS_TYPE_FILESYSTEM)
+
+    lz.create_resource(
+        name=VOLUME,
+        type=ZFSType.ZFS_TYPE_VOLUME,
+        properties={ZFSProperty.VOLSIZE: 1048576},
+    )
+    truenas_pylibzfs.lzc.create_snapshots(snapshot_names=[SNAPSHOT])
+    yield lz
+
+
+def test_open_all(pool_with_children):
+    lz = pool_with_children
+    found, missing = lz.open_resources(names=CHILDREN + [VOLUME, SNAPSHOT])
+
+    assert missing == []
+    assert sorted(found) == sorted(CHILDREN + [VOLUME, SNAPSHOT])
+    for name, rsrc in found.items():
+        assert rsrc.name == name
+        assert rsrc.guid == lz.open_resource(name=name).guid
+
+    assert found[CHILDREN[0]].type == ZFSType.ZFS_TYPE_FILESYSTEM
+    assert found[VOLUME].type == ZFSType.ZFS_TYPE_VOLUME
+    assert found[SNAPSHOT].type == ZFSType.ZFS_TYPE_SNAPSHOT
+
+
+def test_missing_ok(pool_with_children):
+    lz = pool_with_children
+    gone = [f'{POOL_NAME}/gone1', f'{POOL_NAME}/gone2']
+    found, missing = lz.open_resources(names=(n for n in gone + CHILDREN))
+
+    assert missing == gone
+    assert sorted(found) == sorted(CHILDREN)
+
+
+def test_missing_raises(pool_with_children):
+    lz = pool_with_children
+    with pytest.raises(ZFSException):
+        lz.open_resources(
+            names=CHILDREN + [f'{POOL_NAME}/gone'],
+            missing_ok=False,
+        )
+
+
+def test_invalid_name_raises(pool_with_children):
+    lz = pool_with_children
+    with pytest.raises(ZFSException):
+        lz.open_resources(names=[CHILDREN[0], f'{POOL_NAME}/bad name!'])
+
+
+def test_empty(pool_with_children):
+    lz = pool_with_children
+    assert lz.open_resources(names=[]) == ({}, [])
+
+
+def test_names_required(pool_with_children):
+    lz = pool_with_children
+    with pytest.raises(ValueError):
+        lz.open_resources()
+
+
+@pytest.mark.parametrize('names', [None, [CHILDREN[0], 1]])
+def test_bad_names_type(pool_with_children, names):
+    lz = pool_with_children
+    with pytest.raises(TypeError):
+        lz.open_resources(names=names)
@@ -0,0 +1,126 @@
+"""
+Tests for the per-handle property cache (open_handle(property_cache_ttl=...)).
+
+Covers:
+  - cache is disabled by default
+  - repeated reads are served from the cache and match uncached reads
+  - requesting a property that is not cached is a miss
+  - set_properties / inherit_property through the handle invalidate the
+    dataset and its descendants
+  - entries expire after the TTL
+  - clear_property_cache() drops all entries
+  - negative TTL raises ValueError
+"""
+
+import time
+
+import pytest
+import truenas_pylibzfs
+
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+ZFSType = truenas_pylibzfs.ZFSType
+PROPS = {ZFSProperty.COMPRESSION, ZFSProperty.READONLY, ZFSProperty.QUOTA}
+
+
+@pytest.fixture
+def cached(dataset):
+    lz, root, ds = dataset
+    clz = truenas_pylibzfs.open_handle(property_cache_ttl=60)
+    return clz, clz.open_resource(name=ds.name)
+
+
+def test_disabled_by_default(dataset):
+    lz, root, ds = dataset
+    ds.get_properties(properties=PROPS)
+    ds.get_properties(properties=PROPS)
+    stats = lz.property_cache_stats()
+    assert stats['ttl'] == 0
+    assert stats['hits'] == 0
+    assert stats['entries'] == 0
+
+
+def test_hit(cached, dataset):
+    clz, ds = cached
+    first = ds.get_properties(properties=PROPS, get_source=True)
+    second = ds.get_properties(properties=PROPS, get_source=True)
+    assert first == second
+    assert second == dataset[2].get_properties(properties=PROPS, get_source=True)
+
+    stats = clz.property_cache_stats()
+    assert stats['misses'] == 1
+    assert stats['hits'] == 1
+    assert stats['entries'] == 1
+
+
+def test_hit_raw_false(cached, dataset):
+    clz, ds = cached
+    miss = ds.get_properties(properties=PROPS, raw=False)
+    hit = ds.get_properties(properties=PROPS, raw=False)
+    assert clz.property_cache_stats()['hits'] == 1
+    assert hit == miss
+    assert hit == dataset[2].get_properties(properties=PROPS, raw=False)
+    assert hit.quota.value == 0
+    assert hit.quota.raw is None
+    assert hit.compression.raw is not None
+
+
+def test_uncached_property_is_miss(cached):
+    clz, ds = cached
+    ds.get_properties(properties={ZFSProperty.READONLY})
+    ds.get_properties(properties={ZFSProperty.READONLY, ZFSProperty.ATIME})
+    ds.get_properties(properties={ZFSProperty.ATIME})
+    stats = clz.property_cache_stats()
+    assert stats['misses'] == 2
+    assert stats['hits'] == 1
+
+
+def test_set_properties_invalidates(cached):
+    clz, ds = cached
+    assert ds.get_properties(properties=PROPS).readonly.value == 'off'
+    ds.set_properties(properties={ZFSProperty.READONLY: 'on'})
+    assert ds.get_properties(properties=PROPS).readonly.value == 'on'
+    assert clz.property_cache_stats()['invalidations'] == 1
+
+
+def test_parent_change_invalidates_child(cached):
+    clz, ds = cached
+    child_name = f'{ds.name}/child'
+    clz.create_resource(name=child_name, type=ZFSType.ZFS_TYPE_FILESYSTEM)
+    try:
+        child = clz.open_resource(name=child_name)
+        assert child.get_properties(properties=PROPS).readonly.value == 'off'
+
+        ds.set_properties(properties={ZFSProperty.READONLY: 'on'})
+        assert child.get_properties(properties=PROPS).readonly.value == 'on'
+
+        ds.inherit_property(property=ZFSProperty.READONLY)
+        assert child.get_properties(properties=PROPS).readonly.value == 'off'
+    finally:
+        clz.destroy_resource(name=child_name)
+
+
+def test_ttl_expiry(dataset):
+    lz, root, ds = dataset
+    clz = truenas_pylibzfs.open_handle(property_cache_ttl=0.1)
+    rsrc = clz.open_resource(name=ds.name)
+    rsrc.get_properties(properties=PROPS)
+    time.sleep(0.2)
+    rsrc.get_properties(properties=PROPS)
+    stats = clz.property_cache_stats()
+    assert stats['hits'] == 0
+    assert stats['misses'] == 2
+
+
+def test_clear(cached):
+    clz, ds = cached
+    ds.get_properties(properties=PROPS)
+    clz.clear_property_cache()
+    ds.get_properties(properties=PROPS)
+    stats = clz.property_cache_stats()
+    assert stats['misses'] == 2
+    assert stats['invalidations'] == 1
+
+
+def test_negative_ttl():
+    with pytest.raises(ValueError):
+        truenas_pylibzfs.open_handle(property_cache_ttl=-1)
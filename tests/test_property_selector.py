@@ -0,0 +1,91 @@
+"""
+Tests for truenas_pylibzfs.create_property_selector() and passing the
+resulting ZFSPropertySelector as `properties`.
+
+Covers:
+  - selector built from a set / property_sets constant / generator
+  - len / contains / iter / properties attribute
+  - get_properties and asdict results match those for the equivalent set
+  - ZFS.query accepts a selector
+  - invalid arguments raise TypeError / ValueError
+"""
+
+import pytest
+import truenas_pylibzfs
+
+POOL_NAME = 'testpool_propsel'
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+SPACE = truenas_pylibzfs.property_sets.ZFS_SPACE_PROPERTIES
+
+
+@pytest.fixture
+def pool(make_pool):
+    return make_pool(POOL_NAME)
+
+
+class TestSelector:
+    def test_from_property_set(self):
+        sel = truenas_pylibzfs.create_property_selector(properties=SPACE)
+        assert isinstance(sel, truenas_pylibzfs.libzfs_types.ZFSPropertySelector)
+        assert sel.properties == SPACE
+        assert len(sel) == len(SPACE)
+        assert set(sel) == set(SPACE)
+        assert ZFSProperty.USED in sel
+        assert ZFSProperty.COMPRESSION not in sel
+
+    def test_from_list(self):
+        sel = truenas_pylibzfs.create_property_selector(
+            properties=[ZFSProperty.USED, ZFSProperty.USED]
+        )
+        assert len(sel) == 1
+
+    def test_from_generator(self):
+        sel = truenas_pylibzfs.create_property_selector(
+            properties=(prop for prop in SPACE)
+        )
+        assert sel.properties == SPACE
+
+    def test_invalid_member(self):
+        with pytest.raises(TypeError):
+            truenas_pylibzfs.create_property_selector(properties={'used'})
+
+    def test_missing_properties(self):
+        with pytest.raises(ValueError):
+            truenas_pylibzfs.create_property_selector()
+
+    def test_keyword_only(self):
+        with pytest.raises(TypeError):
+            truenas_pylibzfs.create_property_selector(SPACE)
+
+
+class TestSelectorUse:
+    def test_get_properties(self, pool):
+        lz, p, root = pool
+        props = {ZFSProperty.COMPRESSION, ZFSProperty.READONLY, ZFSProperty.ATIME}
+        sel = truenas_pylibzfs.create_property_selector(properties=props)
+        assert root.get_properties(properties=sel, get_source=True) == \
+            root.get_properties(properties=props, get_source=True)
+
+    def test_asdict(self, pool):
+        lz, p, root = pool
+        props = {ZFSProperty.COMPRESSION, ZFSProperty.CHECKSUM}
+        sel = truenas_pylibzfs.create_property_selector(properties=props)
+        assert root.asdict(properties=sel) == root.asdict(properties=props)
+
+    def test_query(self, pool):
+        lz, p, root = pool
+        props = {ZFSProperty.COMPRESSION}
+        sel = truenas_pylibzfs.create_property_selector(properties=props)
+        assert lz.query(root=POOL_NAME, properties=sel) == \
+            lz.query(root=POOL_NAME, properties=props)
+
+    def test_asdict_json(self, pool):
+        lz, p, root = pool
+        sel = truenas_pylibzfs.create_property_selector(properties=SPACE)
+        assert root.asdict_json(properties=sel) == \
+            root.asdict_json(properties=SPACE)
+
+    def test_invalid_properties_type(self, pool):
+        lz, p, root = pool
+        with pytest.raises(TypeError):
+            root.get_properties(properties=[ZFSProperty.COMPRESSION])
@@ -0,0 +1,182 @@
+"""
+Tests for ZFS.query().
+
+Covers:
+  - root only vs recursive walk, root is included in the result
+  - no root walks all imported pools
+  - result dict matches ZFSResource.asdict() for requested properties
+  - get_source and get_user_properties
+  - properties not valid for a resource type are omitted
+  - types selects filesystems / volumes / snapshots
+  - select limits the keys of each result dict
+  - filter is applied
+  - invalid arguments raise ValueError / TypeError
+  - nonexistent root raises ZFSException
+"""
+
+import pytest
+import truenas_pylibzfs
+from truenas_pylibzfs import lzc
+
+POOL_NAME = 'testpool_query'
+ZFSType = truenas_pylibzfs.ZFSType
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+
+
+@pytest.fixture
+def pool(make_pool):
+    return make_pool(POOL_NAME)
+
+
+@pytest.fixture
+def pool_with_tree(pool):
+    """Pool with a / a/b filesystems, a volume, and a snapshot of a."""
+    lz, p, root = pool
+    names = [f'{POOL_NAME}/a', f'{POOL_NAME}/a/b']
+    for name in names:
+        lz.create_resource(name=name, type=ZFSType.ZFS_TYPE_FILESYSTEM)
+
+    vol = f'{POOL_NAME}/vol'
+    lz.create_resource(
+        name=vol,
+        type=ZFSType.ZFS_TYPE_VOLUME,
+        properties={ZFSProperty.VOLSIZE: 1048576},
+    )
+    lz.open_resource(name=f'{POOL_NAME}/a').set_user_properties(
+        user_properties={'org.truenas:test': 'yes'}
+    )
+    lzc.create_snapshots(snapshot_names=[f'{POOL_NAME}/a@s1'])
+    try:
+        yield lz, p, root
+    finally:
+        try:
+            lzc.destroy_snapshots(snapshot_names=[f'{POOL_NAME}/a@s1'])
+        except Exception:
+            pass
+        for name in [vol] + list(reversed(names)):
+            try:
+                lz.destroy_resource(name=name)
+            except Exception:
+                pass
+
+
+def _names(rows):
+    return sorted(r['name'] for r in rows)
+
+
+class TestQueryWalk:
+    def test_root_only(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        rows = lz.query(root=POOL_NAME)
+        assert _names(rows) == [POOL_NAME]
+
+    def test_recursive(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        rows = lz.query(root=POOL_NAME, recursive=True)
+        assert _names(rows) == [
+            POOL_NAME, f'{POOL_NAME}/a', f'{POOL_NAME}/a/b', f'{POOL_NAME}/vol'
+        ]
+
+    def test_subtree(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        rows = lz.query(root=f'{POOL_NAME}/a', recursive=True)
+        assert _names(rows) == [f'{POOL_NAME}/a', f'{POOL_NAME}/a/b']
+
+    def test_all_pools(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        assert POOL_NAME in _names(lz.query())
+
+    def test_nonexistent_root(self, pool):
+        lz, p, root = pool
+        with pytest.raises(truenas_pylibzfs.ZFSException):
+            lz.query(root=f'{POOL_NAME}/nonexistent')
+
+
+class TestQueryContents:
+    def test_matches_asdict(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        props = {ZFSProperty.USED, ZFSProperty.COMPRESSION, ZFSProperty.READONLY}
+        name = f'{POOL_NAME}/a'
+        row, = lz.query(root=name, properties=props, get_source=True,
+                        get_user_properties=True)
+
+        expected = lz.open_resource(name=name).asdict(
+            properties=props, get_source=True, get_user_properties=True
+        )
+        expected.pop('crypto')
+        assert row == expected
+
+    def test_no_properties(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        row, = lz.query(root=POOL_NAME)
+        assert row['properties'] is None
+        assert row['user_properties'] is None
+        assert row['type_enum'] == ZFSType.ZFS_TYPE_FILESYSTEM
+
+    def test_user_properties(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        row, = lz.query(root=f'{POOL_NAME}/a', get_user_properties=True)
+        assert row['user_properties'] == {'org.truenas:test': 'yes'}
+
+    def test_invalid_property_for_type_omitted(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        rows = lz.query(root=POOL_NAME, recursive=True,
+                        properties={ZFSProperty.VOLSIZE})
+        by_name = {r['name']: r for r in rows}
+        assert by_name[f'{POOL_NAME}/vol']['properties']['volsize']['value'] == 1048576
+        assert by_name[f'{POOL_NAME}/a']['properties'] == {}
+
+    def test_select(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        rows = lz.query(root=POOL_NAME, recursive=True, select=['name', 'guid'])
+        assert all(set(r) == {'name', 'guid'} for r in rows)
+
+
+class TestQueryTypes:
+    def test_volumes(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        rows = lz.query(root=POOL_NAME, recursive=True,
+                        types=[ZFSType.ZFS_TYPE_VOLUME])
+        assert _names(rows) == [f'{POOL_NAME}/vol']
+
+    def test_snapshots(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        rows = lz.query(root=POOL_NAME, recursive=True,
+                        types=[ZFSType.ZFS_TYPE_SNAPSHOT])
+        assert _names(rows) == [f'{POOL_NAME}/a@s1']
+
+    def test_filter(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        flt = truenas_pylibzfs.create_filter(
+            user_properties={'org.truenas:test': 'yes'}
+        )
+        rows = lz.query(root=POOL_NAME, recursive=True, filter=flt)
+        # a/b inherits the user property
+        assert _names(rows) == [f'{POOL_NAME}/a', f'{POOL_NAME}/a/b']
+
+
+class TestQueryErrors:
+    def test_invalid_select(self, pool):
+        lz, p, root = pool
+        with pytest.raises(ValueError):
+            lz.query(root=POOL_NAME, select=['nope'])
+
+    def test_select_str(self, pool):
+        lz, p, root = pool
+        with pytest.raises(TypeError):
+            lz.query(root=POOL_NAME, select='name')
+
+    def test_properties_not_set(self, pool):
+        lz, p, root = pool
+        with pytest.raises(TypeError):
+            lz.query(root=POOL_NAME, properties=[ZFSProperty.USED])
+
+    def test_invalid_filter(self, pool):
+        lz, p, root = pool
+        with pytest.raises(TypeError):
+            lz.query(root=POOL_NAME, filter='*')
+
+    def test_keyword_only(self, pool):
+        lz, p, root = pool
+        with pytest.raises(TypeError):
+            lz.query(POOL_NAME)
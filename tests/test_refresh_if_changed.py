@@ -0,0 +1,165 @@
+"""
+Tests for ZFSResource.refresh_properties(if_changed=True).
+
+Covers:
+  - default refresh always refreshes and returns True
+  - idle mounted filesystem is skipped once two refreshes saw no change
+  - idle datasets stay skipped across txg syncs of an idle pool
+  - writing data or changing a property forces a refresh
+  - snapshots made outside this module and data written to a child are
+    picked up once the pool syncs
+  - unmounted filesystems and snapshots are always refreshed
+  - max_age forces a refresh of an idle dataset
+  - negative max_age raises ValueError
+"""
+
+import os
+import time
+
+import pytest
+import truenas_pylibzfs
+
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+
+
+@pytest.fixture
+def mounted(dataset):
+    lz, root, ds = dataset
+    ds.mount()
+    try:
+        yield lz, ds
+    finally:
+        ds.unmount()
+
+
+def test_default_refresh(dataset):
+    lz, root, ds = dataset
+    assert ds.refresh_properties() is True
+    assert ds.refresh_properties() is True
+
+
+def _sync(lz, ds):
+    lz.open_pool(name=ds.name.split('/')[0]).sync_pool()
+
+
+def _settle(lz, ds):
+    # Flush pending writes so that only idle txgs follow. Two unchanged
+    # samples are needed before a refresh is skipped.
+    _sync(lz, ds)
+    for i in range(3):
+        if not ds.refresh_properties(if_changed=True):
+            return
+
+    pytest.fail('refresh_properties(if_changed=True) did not settle')
+
+
+def _txg_timeout():
+    try:
+        with open('/sys/module/zfs/parameters/zfs_txg_timeout') as f:
+            return int(f.read())
+    except (OSError, ValueError):
+        return 5
+
+
+def test_idle_skipped(mounted):
+    lz, ds = mounted
+    assert ds.refresh_properties(if_changed=True) is True
+    assert ds.refresh_properties(if_changed=True) is True
+    _settle(lz, ds)
+
+
+def test_idle_across_txg_timeout(mounted):
+    lz, ds = mounted
+    lz.create_resource(name=f'{ds.name}/idle',
+                       type=truenas_pylibzfs.ZFSType.ZFS_TYPE_FILESYSTEM)
+    child = lz.open_resource(name=f'{ds.name}/idle')
+    child.mount()
+    try:
+        _settle(lz, ds)
+        _settle(lz, child)
+        # The pool syncs empty txgs in the meantime
+        time.sleep(_txg_timeout() + 2)
+        assert ds.refresh_properties(if_changed=True) is False
+        assert child.refresh_properties(if_changed=True) is False
+    finally:
+        child.unmount()
+
+
+def test_write_detected(mounted):
+    lz, ds = mounted
+    _settle(lz, ds)
+
+    path = os.path.join(ds.get_mountpoint(), 'file')
+    with open(path, 'wb') as f:
+        f.write(b'x' * 131072)
+
+    assert ds.refresh_properties(if_changed=True) is True
+    _sync(lz, ds)
+    assert ds.refresh_properties(if_changed=True) is True
+    _settle(lz, ds)
+
+
+def test_external_snapshot_detected(mounted):
+    lz, ds = mounted
+    _settle(lz, ds)
+    # lzc does not go through the property change tracking
+    truenas_pylibzfs.lzc.create_snapshots(snapshot_names=[f'{ds.name}@ext'])
+
+    assert ds.refresh_properties(if_changed=True) is True
+
+
+def test_child_write_detected(mounted):
+    lz, ds = mounted
+    lz.create_resource(name=f'{ds.name}/child',
+                       type=truenas_pylibzfs.ZFSType.ZFS_TYPE_FILESYSTEM)
+    child = lz.open_resource(name=f'{ds.name}/child')
+    child.mount()
+    try:
+        _settle(lz, ds)
+        path = os.path.join(child.get_mountpoint(), 'file')
+        with open(path, 'wb') as f:
+            f.write(b'x' * 131072)
+
+        _sync(lz, ds)
+        assert ds.refresh_properties(if_changed=True) is True
+    finally:
+        child.unmount()
+
+
+def test_property_change_detected(mounted):
+    lz, ds = mounted
+    _settle(lz, ds)
+    ds.set_properties(properties={ZFSProperty.ATIME: 'off'})
+
+    assert ds.refresh_properties(if_changed=True) is True
+    props = ds.get_properties(properties={ZFSProperty.ATIME})
+    assert props.atime.value == 'off'
+
+
+def test_unmounted_always_refreshed(dataset):
+    lz, root, ds = dataset
+    assert ds.refresh_properties(if_changed=True) is True
+    assert ds.refresh_properties(if_changed=True) is True
+
+
+def test_snapshot_always_refreshed(dataset):
+    lz, root, ds = dataset
+    snap_name = f'{ds.name}@refresh'
+    truenas_pylibzfs.lzc.create_snapshots(snapshot_names=[snap_name])
+    snap = lz.open_resource(name=snap_name)
+
+    assert snap.refresh_properties(if_changed=True) is True
+    assert snap.refresh_properties(if_changed=True) is True
+
+
+def test_max_age(mounted):
+    lz, ds = mounted
+    _settle(lz, ds)
+    time.sleep(0.1)
+    assert ds.refresh_properties(if_changed=True, max_age=0.05) is True
+
+
+def test_negative_max_age(dataset):
+    lz, root, ds = dataset
+    with pytest.raises(ValueError):
+        ds.refresh_properties(if_changed=True, max_age=-1)
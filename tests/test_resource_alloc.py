@@ -0,0 +1,99 @@
+"""
+Tests for reuse of resource objects and shared pool name strings.
+
+Covers:
+  - objects reused after callback iteration report their own attributes
+  - objects kept alive across iterations are unaffected by reuse
+  - resources of one pool share the pool_name string
+  - datasets, volumes and snapshots are each reused as the right type
+"""
+
+import pytest
+import truenas_pylibzfs
+
+POOL_NAME = 'testpool_rsrcalloc'
+ZFSType = truenas_pylibzfs.ZFSType
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+
+CHILDREN = [f'{POOL_NAME}/c{i}' for i in range(5)]
+VOLUME = f'{POOL_NAME}/vol'
+SNAPSHOTS = [f'{CHILDREN[0]}@s{i}' for i in range(20)]
+
+
+@pytest.fixture
+def pool_with_snapshots(make_pool):
+    lz, p, root = make_pool(POOL_NAME)
+    for name in CHILDREN:
+        lz.create_resource(name=name, type=ZFSType.ZFS_TYPE_FILESYSTEM)
+
+    lz.create_resource(
+        name=VOLUME,
+        type=ZFSType.ZFS_TYPE_VOLUME,
+        properties={ZFSProperty.VOLSIZE: 1048576},
+    )
+    truenas_pylibzfs.lzc.create_snapshots(snapshot_names=SNAPSHOTS)
+    yield lz
+
+
+def _snapshot_attrs(lz):
+    seen = []
+
+    def cb(snap, state):
+        state.append((snap.name, snap.guid, snap.createtxg, snap.type))
+        return True
+
+    lz.open_resource(name=CHILDREN[0]).iter_snapshots(callback=cb, state=seen)
+    return seen
+
+
+def test_reused_objects_have_own_attributes(pool_with_snapshots):
+    lz = pool_with_snapshots
+    first = _snapshot_attrs(lz)
+    second = _snapshot_attrs(lz)
+
+    assert sorted(n for n, *_ in first) == sorted(SNAPSHOTS)
+    assert len({guid for _, guid, *_ in first}) == len(SNAPSHOTS)
+    assert first == second
+    for name, guid, createtxg, type in first:
+        snap = lz.open_resource(name=name)
+        assert (snap.guid, snap.createtxg, snap.type) == (guid, createtxg,
+                                                          type)
+
+
+def test_kept_objects_unaffected(pool_with_snapshots):
+    lz = pool_with_snapshots
+    kept = list(lz.open_resource(name=POOL_NAME).iter_filesystems())
+    names = [r.name for r in kept]
+
+    for i in range(3):
+        _snapshot_attrs(lz)
+        for name in CHILDREN + [VOLUME]:
+            lz.open_resource(name=name)
+
+    assert [r.name for r in kept] == names
+    assert all(r.pool_name == POOL_NAME for r in kept)
+
+
+def test_pool_name_shared(pool_with_snapshots):
+    lz = pool_with_snapshots
+    rsrcs = list(lz.open_resource(name=POOL_NAME).iter_filesystems())
+    assert len(rsrcs) > 1
+    assert all(r.pool_name is rsrcs[0].pool_name for r in rsrcs)
+
+
+def test_reuse_across_types(pool_with_snapshots):
+    lz = pool_with_snapshots
+    for i in range(3):
+        vol = lz.open_resource(name=VOLUME)
+        assert isinstance(vol, truenas_pylibzfs.libzfs_types.ZFSVolume)
+        assert vol.type == ZFSType.ZFS_TYPE_VOLUME
+        del vol
+
+        ds = lz.open_resource(name=CHILDREN[1])
+        assert isinstance(ds, truenas_pylibzfs.libzfs_types.ZFSDataset)
+        assert ds.name == CHILDREN[1]
+        del ds
+
+        snap = lz.open_resource(name=SNAPSHOTS[1])
+        assert isinstance(snap, truenas_pylibzfs.libzfs_types.ZFSSnapshot)
+        assert snap.name == SNAPSHOTS[1]
@@ -0,0 +1,240 @@
+"""
+Tests for truenas_pylibzfs.create_filter() and the `filter` argument of
+ZFSResource.iter_filesystems() / ZFSResource.iter_snapshots().
+
+Covers:
+  - name_prefix and name_glob filtering
+  - types filtering (filesystem vs volume)
+  - numeric, index, and string property comparisons
+  - user property equality
+  - multiple criteria are combined with AND
+  - filter applies to snapshots, batched, recursive and iterator modes
+  - recursive walk visits children of non-matching datasets
+  - invalid filter arguments raise ValueError / TypeError
+  - property filters are rejected with fast=True
+"""
+
+import pytest
+import truenas_pylibzfs
+from truenas_pylibzfs import lzc
+
+POOL_NAME = 'testpool_filter'
+ZFSType = truenas_pylibzfs.ZFSType
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+
+
+@pytest.fixture
+def pool(make_pool):
+    return make_pool(POOL_NAME)
+
+
+@pytest.fixture
+def pool_with_datasets(pool):
+    """Pool with mixed filesystems, a volume, user properties and snapshots."""
+    lz, p, root = pool
+    names = [f'{POOL_NAME}/{n}' for n in ('app1', 'app1/data', 'app2', 'backup')]
+    for name in names:
+        lz.create_resource(name=name, type=ZFSType.ZFS_TYPE_FILESYSTEM)
+
+    vol = f'{POOL_NAME}/vol1'
+    lz.create_resource(
+        name=vol,
+        type=ZFSType.ZFS_TYPE_VOLUME,
+        properties={ZFSProperty.VOLSIZE: 1048576},
+    )
+
+    lz.open_resource(name=f'{POOL_NAME}/app1').set_properties(
+        properties={ZFSProperty.READONLY: 'on'}
+    )
+    lz.open_resource(name=f'{POOL_NAME}/app1').set_user_properties(
+        user_properties={'org.truenas:role': 'app'}
+    )
+    lz.open_resource(name=f'{POOL_NAME}/app2').set_user_properties(
+        user_properties={'org.truenas:role': 'app'}
+    )
+    snaps = [f'{POOL_NAME}@auto-1', f'{POOL_NAME}@auto-2', f'{POOL_NAME}@manual']
+    lzc.create_snapshots(snapshot_names=snaps)
+    try:
+        yield lz, p, root
+    finally:
+        try:
+            lzc.destroy_snapshots(snapshot_names=snaps)
+        except Exception:
+            pass
+        for name in [vol] + list(reversed(names)):
+            try:
+                lz.destroy_resource(name=name)
+            except Exception:
+                pass
+
+
+def _names(root, flt, **kwargs):
+    seen = []
+
+    def cb(hdl, state):
+        state.append(hdl.name.removeprefix(f'{POOL_NAME}/'))
+        return True
+
+    assert root.iter_filesystems(callback=cb, state=seen, filter=flt, **kwargs) is True
+    return sorted(seen)
+
+
+class TestFilterName:
+    def test_prefix(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(name_prefix=f'{POOL_NAME}/app')
+        assert _names(root, flt) == ['app1', 'app2']
+
+    def test_glob(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(name_glob=f'{POOL_NAME}/*1')
+        assert _names(root, flt) == ['app1', 'vol1']
+
+    def test_glob_fast(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(name_glob=f'{POOL_NAME}/b*')
+        assert _names(root, flt, fast=True) == ['backup']
+
+    def test_no_match(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(name_prefix='nonexistent')
+        assert _names(root, flt) == []
+
+
+class TestFilterType:
+    def test_volume(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(types=[ZFSType.ZFS_TYPE_VOLUME])
+        assert _names(root, flt) == ['vol1']
+
+    def test_filesystem(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(types=[ZFSType.ZFS_TYPE_FILESYSTEM])
+        assert _names(root, flt) == ['app1', 'app2', 'backup']
+
+
+class TestFilterProperties:
+    def test_index_property(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(
+            properties=[(ZFSProperty.READONLY, '==', True)]
+        )
+        assert _names(root, flt) == ['app1']
+
+    def test_string_property(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(
+            properties=[('readonly', '!=', 'on')]
+        )
+        assert _names(root, flt) == ['app2', 'backup', 'vol1']
+
+    def test_string_compare_is_literal(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        # Compared against the value get_properties() returns, not the
+        # human-readable form ("1M").
+        flt = truenas_pylibzfs.create_filter(
+            properties=[(ZFSProperty.VOLSIZE, '==', '1048576')]
+        )
+        assert _names(root, flt) == ['vol1']
+
+    def test_numeric_property(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(
+            properties=[(ZFSProperty.VOLSIZE, '>=', 1048576)]
+        )
+        # volsize is not applicable to filesystems
+        assert _names(root, flt) == ['vol1']
+
+    def test_user_property(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(
+            user_properties={'org.truenas:role': 'app'}
+        )
+        assert _names(root, flt) == ['app1', 'app2']
+
+    def test_combined(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(
+            name_glob=f'{POOL_NAME}/app*',
+            properties=[(ZFSProperty.READONLY, '==', False)],
+            user_properties={'org.truenas:role': 'app'},
+        )
+        assert _names(root, flt) == ['app2']
+
+
+class TestFilterModes:
+    def test_snapshots(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(name_glob='*@auto-*')
+        seen = []
+
+        def cb(snap, state):
+            state.append(snap.name)
+            return True
+
+        root.iter_snapshots(callback=cb, state=seen, filter=flt)
+        assert sorted(seen) == [f'{POOL_NAME}@auto-1', f'{POOL_NAME}@auto-2']
+
+    def test_batched(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(name_prefix=f'{POOL_NAME}/app')
+        batches = []
+
+        def cb(hdls, state):
+            state.append([h.name for h in hdls])
+            return True
+
+        root.iter_filesystems(callback=cb, state=batches, batch_size=10, filter=flt)
+        assert len(batches) == 1
+        assert sorted(batches[0]) == [f'{POOL_NAME}/app1', f'{POOL_NAME}/app2']
+
+    def test_iterator(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(types=[ZFSType.ZFS_TYPE_VOLUME])
+        assert [v.name for v in root.iter_filesystems(filter=flt)] == [f'{POOL_NAME}/vol1']
+
+    def test_recursive_descends_non_matching(self, pool_with_datasets):
+        lz, p, root = pool_with_datasets
+        flt = truenas_pylibzfs.create_filter(name_glob='*/data')
+        assert _names(root, flt, recursive=True) == ['app1/data']
+
+
+class TestFilterErrors:
+    def test_invalid_operator(self):
+        with pytest.raises(ValueError):
+            truenas_pylibzfs.create_filter(properties=[('readonly', '=~', 'on')])
+
+    def test_invalid_property(self):
+        with pytest.raises(ValueError):
+            truenas_pylibzfs.create_filter(properties=[('notaprop', '==', 'on')])
+
+    def test_malformed_tuple(self):
+        with pytest.raises(TypeError):
+            truenas_pylibzfs.create_filter(properties=[('readonly', '==')])
+
+    def test_numeric_on_string_property(self):
+        with pytest.raises(TypeError):
+            truenas_pylibzfs.create_filter(properties=[(ZFSProperty.MOUNTPOINT, '==', 1)])
+
+    def test_invalid_user_property(self):
+        with pytest.raises(ValueError):
+            truenas_pylibzfs.create_filter(user_properties={'nocolon': 'x'})
+
+    def test_invalid_type(self):
+        with pytest.raises(TypeError):
+            truenas_pylibzfs.create_filter(types=['filesystem'])
+
+    def test_not_a_filter(self, pool):
+        lz, p, root = pool
+        with pytest.raises(TypeError):
+            root.iter_filesystems(callback=lambda hdl: True, filter={'name_glob': '*'})
+
+    def test_property_filter_fast(self, pool):
+        lz, p, root = pool
+        flt = truenas_pylibzfs.create_filter(properties=[('readonly', '==', True)])
+        with pytest.raises(ValueError):
+            root.iter_filesystems(callback=lambda hdl: True, fast=True, filter=flt)
+
+    def test_keyword_only(self):
+        with pytest.raises(TypeError):
+            truenas_pylibzfs.create_filter('tank/*')
@@ -13,6 +13,15 @@ Covers:
   - iter_pools sees the test pool
   - iter_pools state passed through
   - iter_root_filesystems sees the root FS of the test pool
+  - batch_size delivers lists of objects to the callback for all iterators
+  - batch_size callback returning False stops iteration
+  - negative batch_size raises ValueError
+  - omitting callback returns a ZFSResourceIterator for all iterators
+  - ZFSResourceIterator supports early break and is exhausted after use
+  - state / batch_size without callback raises ValueError
+  - recursive walk in pre / post / bfs order, max_depth, include_snapshots
+  - recursive walk stop, and invalid recursion arguments
+  - list_filesystem_names / list_snapshot_names (recursive, createtxg)
 """
 
 import pytest
@@ -326,3 +335,308 @@ class TestIterRootFilesystems:
 
         with pytest.raises(TypeError):
             lz.iter_root_filesystems(cb, None)
+
+
+# ---------------------------------------------------------------------------
+# batch_size
+# ---------------------------------------------------------------------------
+
+class TestBatchedIteration:
+    def test_filesystems_batches(self, pool_with_children):
+        lz, p, root = pool_with_children
+        batches = []
+
+        def cb(items, state):
+            assert isinstance(items, list)
+            state.append([ds.name for ds in items])
+            return True
+
+        result = root.iter_filesystems(callback=cb, state=batches, batch_size=1)
+        assert result is True
+        assert all(len(b) == 1 for b in batches)
+        names = [n for b in batches for n in b]
+        assert f'{POOL_NAME}/child1' in names
+        assert f'{POOL_NAME}/child2' in names
+
+    def test_filesystems_single_batch(self, pool_with_children):
+        lz, p, root = pool_with_children
+        batches = []
+
+        def cb(items, state):
+            state.append([ds.name for ds in items])
+            return True
+
+        root.iter_filesystems(callback=cb, state=batches, batch_size=100, fast=True)
+        assert len(batches) == 1
+        assert sorted(batches[0]) == [f'{POOL_NAME}/child1', f'{POOL_NAME}/child2']
+
+    def test_filesystems_batch_stop(self, pool_with_children):
+        lz, p, root = pool_with_children
+        batches = []
+
+        def cb(items, state):
+            state.append(items)
+            return False
+
+        result = root.iter_filesystems(callback=cb, state=batches, batch_size=1)
+        assert result is False
+        assert len(batches) == 1
+
+    def test_filesystems_no_children(self, pool):
+        lz, p, root = pool
+        batches = []
+
+        def cb(items, state):
+            state.append(items)
+            return True
+
+        assert root.iter_filesystems(callback=cb, state=batches, batch_size=10) is True
+        assert batches == []
+
+    def test_snapshots_batches(self, pool_with_snapshots):
+        lz, p, root = pool_with_snapshots
+        batches = []
+
+        def cb(items, state):
+            state.append([snap.name for snap in items])
+            return True
+
+        result = root.iter_snapshots(
+            callback=cb,
+            state=batches,
+            order_by_transaction_group=True,
+            batch_size=10,
+        )
+        assert result is True
+        assert batches == [[f'{POOL_NAME}@snap1', f'{POOL_NAME}@snap2']]
+
+    def test_pools_batches(self, pool):
+        lz, p, root = pool
+        batches = []
+
+        def cb(items, state):
+            state.append([pool_obj.name for pool_obj in items])
+            return True
+
+        assert lz.iter_pools(callback=cb, state=batches, batch_size=4) is True
+        assert POOL_NAME in [n for b in batches for n in b]
+
+    def test_root_filesystems_batches(self, pool):
+        lz, p, root = pool
+        batches = []
+
+        def cb(items, state):
+            state.append([ds.name for ds in items])
+            return True
+
+        assert lz.iter_root_filesystems(callback=cb, state=batches, batch_size=4) is True
+        assert POOL_NAME in [n for b in batches for n in b]
+
+    def test_negative_batch_size(self, pool):
+        lz, p, root = pool
+
+        def cb(items, state):
+            return True
+
+        with pytest.raises(ValueError):
+            root.iter_filesystems(callback=cb, state=None, batch_size=-1)
+
+
+# ---------------------------------------------------------------------------
+# ZFSResourceIterator (no callback)
+# ---------------------------------------------------------------------------
+
+class TestResourceIterator:
+    def test_filesystems(self, pool_with_children):
+        lz, p, root = pool_with_children
+        it = root.iter_filesystems()
+        assert isinstance(it, truenas_pylibzfs.libzfs_types.ZFSResourceIterator)
+        names = [ds.name for ds in it]
+        assert sorted(names) == [f'{POOL_NAME}/child1', f'{POOL_NAME}/child2']
+
+    def test_exhausted(self, pool_with_children):
+        lz, p, root = pool_with_children
+        it = root.iter_filesystems(fast=True)
+        assert len(list(it)) == 2
+        assert list(it) == []
+
+    def test_early_break(self, pool_with_children):
+        lz, p, root = pool_with_children
+        seen = []
+        for ds in root.iter_filesystems():
+            seen.append(ds.name)
+            break
+
+        assert len(seen) == 1
+        # handle lock must have been released by producer thread
+        root.get_properties(properties={truenas_pylibzfs.ZFSProperty.USED})
+
+    def test_libzfs_ops_in_loop(self, pool_with_children):
+        lz, p, root = pool_with_children
+        for ds in root.iter_filesystems():
+            props = ds.get_properties(properties={truenas_pylibzfs.ZFSProperty.USED})
+            assert props.used is not None
+
+    def test_snapshots(self, pool_with_snapshots):
+        lz, p, root = pool_with_snapshots
+        names = [s.name for s in root.iter_snapshots(order_by_transaction_group=True)]
+        assert names == [f'{POOL_NAME}@snap1', f'{POOL_NAME}@snap2']
+
+    def test_pools(self, pool):
+        lz, p, root = pool
+        assert POOL_NAME in [pool_obj.name for pool_obj in lz.iter_pools()]
+
+    def test_root_filesystems(self, pool):
+        lz, p, root = pool
+        assert POOL_NAME in [ds.name for ds in lz.iter_root_filesystems()]
+
+    def test_state_requires_callback(self, pool):
+        lz, p, root = pool
+        with pytest.raises(ValueError):
+            root.iter_filesystems(state=[])
+
+        with pytest.raises(ValueError):
+            lz.iter_pools(batch_size=10)
+
+
+# ---------------------------------------------------------------------------
+# recursive=True
+# ---------------------------------------------------------------------------
+
+@pytest.fixture
+def pool_with_tree(pool):
+    """Pool with a / a/b / a/b/c / d tree and a snapshot of a/b."""
+    lz, p, root = pool
+    names = [f'{POOL_NAME}/{n}' for n in ('a', 'a/b', 'a/b/c', 'd')]
+    for name in names:
+        lz.create_resource(name=name, type=truenas_pylibzfs.ZFSType.ZFS_TYPE_FILESYSTEM)
+    lzc.create_snapshots(snapshot_names=[f'{POOL_NAME}/a/b@s1'])
+    try:
+        yield lz, p, root
+    finally:
+        try:
+            lzc.destroy_snapshots(snapshot_names=[f'{POOL_NAME}/a/b@s1'])
+        except Exception:
+            pass
+        for name in reversed(names):
+            try:
+                lz.destroy_resource(name=name)
+            except Exception:
+                pass
+
+
+def _walk(root, **kwargs):
+    seen = []
+
+    def cb(hdl, state):
+        state.append(hdl.name)
+        return True
+
+    assert root.iter_filesystems(callback=cb, state=seen, recursive=True, **kwargs) is True
+    return [n.removeprefix(f'{POOL_NAME}/') for n in seen]
+
+
+class TestRecursiveIteration:
+    def test_pre_order(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        seen = _walk(root)
+        assert sorted(seen) == ['a', 'a/b', 'a/b/c', 'd']
+        assert seen.index('a') < seen.index('a/b') < seen.index('a/b/c')
+
+    def test_post_order(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        seen = _walk(root, order='post')
+        assert sorted(seen) == ['a', 'a/b', 'a/b/c', 'd']
+        assert seen.index('a/b/c') < seen.index('a/b') < seen.index('a')
+
+    def test_bfs_order(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        seen = _walk(root, order='bfs')
+        assert sorted(seen[:2]) == ['a', 'd']
+        assert seen[2:] == ['a/b', 'a/b/c']
+
+    def test_max_depth(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        assert sorted(_walk(root, max_depth=1)) == ['a', 'd']
+        assert sorted(_walk(root, max_depth=2)) == ['a', 'a/b', 'd']
+
+    def test_include_snapshots(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        seen = _walk(root, include_snapshots=True)
+        assert seen.index('a/b') < seen.index('a/b@s1') < seen.index('a/b/c')
+
+        seen = _walk(root, include_snapshots=True, order='post')
+        assert seen.index('a/b/c') < seen.index('a/b@s1') < seen.index('a/b')
+
+    def test_stop(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        seen = []
+
+        def cb(hdl, state):
+            state.append(hdl.name)
+            return len(state) < 2
+
+        result = root.iter_filesystems(callback=cb, state=seen, recursive=True)
+        assert result is False
+        assert len(seen) == 2
+
+    def test_invalid_arguments(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+
+        def cb(hdl, state):
+            return True
+
+        with pytest.raises(ValueError):
+            root.iter_filesystems(callback=cb, recursive=True, order='inorder')
+
+        with pytest.raises(ValueError):
+            root.iter_filesystems(callback=cb, max_depth=2)
+
+        with pytest.raises(ValueError):
+            root.iter_filesystems(callback=cb, recursive=True, batch_size=10)
+
+        with pytest.raises(ValueError):
+            root.iter_filesystems(recursive=True)
+
+
+# ---------------------------------------------------------------------------
+# list_filesystem_names / list_snapshot_names
+# ---------------------------------------------------------------------------
+
+class TestNameListing:
+    def test_filesystem_names(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        names = root.list_filesystem_names()
+        assert isinstance(names, tuple)
+        assert sorted(names) == [f'{POOL_NAME}/a', f'{POOL_NAME}/d']
+
+    def test_filesystem_names_recursive(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        names = [n.removeprefix(f'{POOL_NAME}/') for n in root.list_filesystem_names(recursive=True)]
+        assert sorted(names) == ['a', 'a/b', 'a/b/c', 'd']
+        assert names.index('a') < names.index('a/b') < names.index('a/b/c')
+
+    def test_snapshot_names(self, pool_with_snapshots):
+        lz, p, root = pool_with_snapshots
+        names = root.list_snapshot_names(order_by_transaction_group=True)
+        assert names == (f'{POOL_NAME}@snap1', f'{POOL_NAME}@snap2')
+
+    def test_snapshot_names_createtxg(self, pool_with_snapshots):
+        lz, p, root = pool_with_snapshots
+        names, txgs = root.list_snapshot_names(
+            order_by_transaction_group=True, get_createtxg=True,
+        )
+        assert len(names) == len(txgs) == 2
+        assert txgs[0] < txgs[1]
+        snap = lz.open_resource(name=names[1])
+        assert snap.createtxg == txgs[1]
+
+    def test_snapshot_names_recursive(self, pool_with_tree):
+        lz, p, root = pool_with_tree
+        assert root.list_snapshot_names() == ()
+        assert root.list_snapshot_names(recursive=True) == (f'{POOL_NAME}/a/b@s1',)
+
+    def test_keyword_only(self, pool):
+        lz, p, root = pool
+        with pytest.raises(TypeError):
+            root.list_snapshot_names(True)
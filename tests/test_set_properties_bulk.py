@@ -0,0 +1,146 @@
+"""
+Tests for ZFS.set_properties_bulk().
+
+Covers:
+  - properties applied to every dataset, filesystems and volumes
+  - nonexistent dataset reported in result without blocking other updates
+  - libzfs failure for one dataset reported with ZFSError code
+  - unchanged volsize does not fail on a readonly volume
+  - readonly / wrong-type property raises before any change is made
+  - argument type validation
+  - empty dict is a no-op
+"""
+
+import pytest
+import truenas_pylibzfs
+
+POOL_NAME = 'testpool_bulkset'
+ZFSType = truenas_pylibzfs.ZFSType
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+ZFSError = truenas_pylibzfs.ZFSError
+
+CHILDREN = [f'{POOL_NAME}/c{i}' for i in range(5)]
+VOLUME = f'{POOL_NAME}/vol'
+
+
+@pytest.fixture
+def pool_with_children(make_pool):
+    lz, p, root = make_pool(POOL_NAME)
+    for name in CHILDREN:
+        lz.create_resource(name=name, type=ZFSType.ZFS_TYPE_FILESYSTEM)
+
+    lz.create_resource(
+        name=VOLUME,
+        type=ZFSType.ZFS_TYPE_VOLUME,
+        properties={ZFSProperty.VOLSIZE: 1048576},
+    )
+    yield lz
+
+
+def _get(lz, name, prop):
+    props = lz.open_resource(name=name).get_properties(properties={prop})
+    return getattr(props, prop.name.lower()).value
+
+
+def test_bulk_set_all(pool_with_children):
+    lz = pool_with_children
+    failed = lz.set_properties_bulk(properties={
+        name: {ZFSProperty.ATIME: 'off', ZFSProperty.COMPRESSION: 'zstd'}
+        for name in CHILDREN
+    })
+    assert failed == {}
+
+    for name in CHILDREN:
+        assert _get(lz, name, ZFSProperty.ATIME) == 'off'
+        assert _get(lz, name, ZFSProperty.COMPRESSION) == 'zstd'
+
+
+def test_bulk_set_mixed_types(pool_with_children):
+    lz = pool_with_children
+    failed = lz.set_properties_bulk(properties={
+        CHILDREN[0]: {ZFSProperty.ATIME: 'off'},
+        VOLUME: {'compression': 'lz4'},
+    })
+    assert failed == {}
+    assert _get(lz, CHILDREN[0], ZFSProperty.ATIME) == 'off'
+    assert _get(lz, VOLUME, ZFSProperty.COMPRESSION) == 'lz4'
+
+
+def test_bulk_set_missing_dataset(pool_with_children):
+    lz = pool_with_children
+    missing = f'{POOL_NAME}/nonexistent'
+    failed = lz.set_properties_bulk(properties={
+        missing: {ZFSProperty.ATIME: 'off'},
+        CHILDREN[1]: {ZFSProperty.ATIME: 'off'},
+    })
+
+    assert list(failed) == [missing]
+    code, desc = failed[missing]
+    assert code == ZFSError.EZFS_NOENT
+    assert isinstance(desc, str)
+    assert _get(lz, CHILDREN[1], ZFSProperty.ATIME) == 'off'
+
+
+def test_bulk_set_libzfs_failure(pool_with_children):
+    lz = pool_with_children
+    failed = lz.set_properties_bulk(properties={
+        CHILDREN[0]: {ZFSProperty.RECORDSIZE: '3K'},
+        CHILDREN[1]: {ZFSProperty.ATIME: 'off'},
+    })
+
+    assert list(failed) == [CHILDREN[0]]
+    assert _get(lz, CHILDREN[1], ZFSProperty.ATIME) == 'off'
+
+
+def test_bulk_set_unchanged_volsize_readonly(pool_with_children):
+    lz = pool_with_children
+    lz.open_resource(name=VOLUME).set_properties(
+        properties={ZFSProperty.READONLY: 'on'})
+
+    failed = lz.set_properties_bulk(properties={
+        VOLUME: {ZFSProperty.VOLSIZE: 1048576, ZFSProperty.COMPRESSION: 'lz4'},
+    })
+    assert failed == {}
+    assert _get(lz, VOLUME, ZFSProperty.COMPRESSION) == 'lz4'
+
+
+def test_bulk_set_wrong_type_no_changes(pool_with_children):
+    lz = pool_with_children
+    before = _get(lz, CHILDREN[2], ZFSProperty.ATIME)
+    with pytest.raises(ValueError):
+        lz.set_properties_bulk(properties={
+            CHILDREN[2]: {ZFSProperty.ATIME: 'off' if before == 'on' else 'on'},
+            CHILDREN[3]: {ZFSProperty.VOLBLOCKSIZE: '16K'},
+        })
+
+    assert _get(lz, CHILDREN[2], ZFSProperty.ATIME) == before
+
+
+def test_bulk_set_readonly_property(pool_with_children):
+    lz = pool_with_children
+    with pytest.raises(ValueError):
+        lz.set_properties_bulk(properties={
+            CHILDREN[0]: {ZFSProperty.USED: '0'},
+        })
+
+
+@pytest.mark.parametrize('properties', [
+    [(CHILDREN[0], {'atime': 'off'})],
+    {1: {'atime': 'off'}},
+    {CHILDREN[0]: ['atime']},
+])
+def test_bulk_set_bad_types(pool_with_children, properties):
+    lz = pool_with_children
+    with pytest.raises(TypeError):
+        lz.set_properties_bulk(properties=properties)
+
+
+def test_bulk_set_empty(pool_with_children):
+    lz = pool_with_children
+    assert lz.set_properties_bulk(properties={}) == {}
+
+
+def test_bulk_set_required(pool_with_children):
+    lz = pool_with_children
+    with pytest.raises(ValueError):
+        lz.set_properties_bulk()
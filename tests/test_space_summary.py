@@ -0,0 +1,129 @@
+"""
+Tests for ZFSResource.space_summary().
+
+Covers:
+  - one entry per filesystem / volume in the subtree, parents first
+  - dataset and snapshot counts are aggregated per subtree
+  - leaf values equal the dataset's own properties
+  - subtree sums account for the parent's used
+  - recursive=False and include_snapshots=False
+  - snapshots raise ValueError
+"""
+
+import pytest
+import truenas_pylibzfs
+
+POOL_NAME = 'testpool_space'
+ZFSType = truenas_pylibzfs.ZFSType
+ZFSProperty = truenas_pylibzfs.ZFSProperty
+
+PARENT = f'{POOL_NAME}/a'
+CHILD = f'{PARENT}/b'
+VOLUME = f'{PARENT}/vol'
+OTHER = f'{POOL_NAME}/c'
+
+SPACE_PROPS = {
+    ZFSProperty.USED,
+    ZFSProperty.USEDBYCHILDREN,
+    ZFSProperty.REFERENCED,
+    ZFSProperty.USEDBYDATASET,
+    ZFSProperty.USEDBYSNAPSHOTS,
+    ZFSProperty.USEDBYREFRESERVATION,
+}
+
+
+@pytest.fixture
+def tree(make_pool):
+    lz, p, root = make_pool(POOL_NAME)
+    for name in (PARENT, CHILD, OTHER):
+        lz.create_resource(name=name, type=ZFSType.ZFS_TYPE_FILESYSTEM)
+
+    lz.create_resource(
+        name=VOLUME,
+        type=ZFSType.ZFS_TYPE_VOLUME,
+        properties={ZFSProperty.VOLSIZE: 1048576},
+    )
+    truenas_pylibzfs.lzc.create_snapshots(snapshot_names=[
+        f'{PARENT}@s1', f'{CHILD}@s1', f'{CHILD}@s2', f'{VOLUME}@s1',
+    ])
+    yield lz, root
+
+
+def test_entries(tree):
+    lz, root = tree
+    summary = root.space_summary()
+
+    assert set(summary) == {POOL_NAME, PARENT, CHILD, VOLUME, OTHER}
+    names = list(summary)
+    assert names[0] == POOL_NAME
+    assert names.index(PARENT) < names.index(CHILD)
+    assert names.index(PARENT) < names.index(VOLUME)
+    assert isinstance(
+        summary[POOL_NAME],
+        truenas_pylibzfs.libzfs_types.struct_zfs_space_summary
+    )
+
+
+def test_counts(tree):
+    lz, root = tree
+    summary = root.space_summary()
+
+    assert summary[POOL_NAME].datasets == 5
+    assert summary[POOL_NAME].snapshots == 4
+    assert summary[PARENT].datasets == 3
+    assert summary[PARENT].snapshots == 4
+    assert summary[CHILD].datasets == 1
+    assert summary[CHILD].snapshots == 2
+    assert summary[OTHER].snapshots == 0
+
+
+def test_leaf_matches_properties(tree):
+    lz, root = tree
+    summary = root.space_summary()
+
+    for name in (CHILD, VOLUME, OTHER):
+        props = lz.open_resource(name=name).get_properties(
+            properties=SPACE_PROPS
+        )
+        entry = summary[name]
+        assert entry.used == props.used.value
+        assert entry.usedbychildren == props.usedbychildren.value
+        assert entry.referenced == props.referenced.value
+        assert entry.usedbydataset == props.usedbydataset.value
+        assert entry.usedbysnapshots == props.usedbysnapshots.value
+        assert entry.usedbyrefreservation == props.usedbyrefreservation.value
+
+
+def test_sums_cover_used(tree):
+    lz, root = tree
+    parent = lz.open_resource(name=PARENT)
+    entry = parent.space_summary()[PARENT]
+
+    # used of a dataset is the space charged to every dataset below it
+    assert entry.usedbyrefreservation > 0
+    assert entry.used == (
+        entry.usedbydataset +
+        entry.usedbysnapshots +
+        entry.usedbyrefreservation
+    )
+
+
+def test_non_recursive(tree):
+    lz, root = tree
+    parent = lz.open_resource(name=PARENT)
+
+    summary = parent.space_summary(recursive=False)
+    assert list(summary) == [PARENT]
+    assert summary[PARENT].datasets == 1
+    assert summary[PARENT].snapshots == 1
+
+    summary = parent.space_summary(include_snapshots=False)
+    assert set(summary) == {PARENT, CHILD, VOLUME}
+    assert all(entry.snapshots == 0 for entry in summary.values())
+
+
+def test_snapshot_rejected(tree):
+    lz, root = tree
+    snap = lz.open_resource(name=f'{CHILD}@s1')
+    with pytest.raises(ValueError):
+        snap.space_summary()
@@ -6,6 +6,8 @@ Covers:
   - set_userquotas sets a USER_QUOTA for uid 0, verifiable via iter_userspace
   - set_userquotas quota=0 removes the quota
   - set_userquotas GROUP_QUOTA type
+  - get_userspace_columns merges quota types into parallel columns
+  - get_userspace_columns argument validation
   - Missing quotas arg raises ValueError
   - keyword-only enforcement for both methods
 """
@@ -201,3 +203,71 @@ def test_set_userquotas_iterable_raises_midway_applies_nothing(dataset):
     # The valid first entry must not have been committed.
     entries = _collect_userspace(ds, truenas_pylibzfs.ZFSUserQuota.USER_QUOTA)
     assert [e for e in entries if e['xid'] == 0] == []
+
+
+# ---------------------------------------------------------------------------
+# get_userspace_columns
+# ---------------------------------------------------------------------------
+
+def test_get_userspace_columns_default(dataset):
+    lz, ds = dataset
+    cols = ds.get_userspace_columns()
+    assert set(cols) == {'xid', 'used', 'quota', 'objused', 'objquota'}
+    lengths = {len(c) for c in cols.values()}
+    assert len(lengths) == 1
+    assert all(c.format == 'Q' and c.readonly for c in cols.values())
+
+
+def test_get_userspace_columns_merges_quota(dataset):
+    lz, ds = dataset
+    quota_size = 100 * 1024 * 1024
+    ds.set_userquotas(quotas=[{
+        'quota_type': truenas_pylibzfs.ZFSUserQuota.USER_QUOTA,
+        'xid': 1001,
+        'value': quota_size,
+    }])
+    cols = ds.get_userspace_columns(quota_types=[
+        truenas_pylibzfs.ZFSUserQuota.USER_USED,
+        truenas_pylibzfs.ZFSUserQuota.USER_QUOTA,
+    ])
+    assert set(cols) == {'xid', 'used', 'quota'}
+    xids = cols['xid'].tolist()
+    assert xids.count(1001) == 1
+    row = xids.index(1001)
+    assert cols['quota'][row] == quota_size
+    assert cols['used'][row] == 0
+
+    # matches iter_userspace
+    expected = {
+        e['xid']: e['value']
+        for e in _collect_userspace(ds, truenas_pylibzfs.ZFSUserQuota.USER_USED)
+    }
+    got = dict(zip(xids, cols['used'].tolist()))
+    assert {x: got[x] for x in expected} == expected
+
+
+def test_get_userspace_columns_mixed_id_space_raises(dataset):
+    lz, ds = dataset
+    with pytest.raises(ValueError):
+        ds.get_userspace_columns(quota_types=[
+            truenas_pylibzfs.ZFSUserQuota.USER_USED,
+            truenas_pylibzfs.ZFSUserQuota.GROUP_USED,
+        ])
+
+
+def test_get_userspace_columns_empty_raises(dataset):
+    lz, ds = dataset
+    with pytest.raises(ValueError):
+        ds.get_userspace_columns(quota_types=[])
+
+
+def test_get_userspace_columns_invalid_type_raises(dataset):
+    lz, ds = dataset
+    with pytest.raises(TypeError):
+        ds.get_userspace_columns(quota_types=['USER_USED'])
+
+
+def test_get_userspace_columns_keyword_only(dataset):
+    lz, ds = dataset
+    with pytest.raises(TypeError):
+        ds.get_userspace_columns([truenas_pylibzfs.ZFSUserQuota.USER_USED])
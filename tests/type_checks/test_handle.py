@@ -171,6 +171,25 @@ def check_dataset_crypto(ds: libzfs_types.ZFSDataset) -> None:
     _ = crypto
 
 
+def check_dataset_iter_filesystems(ds: libzfs_types.ZFSDataset) -> None:
+    for child in ds.iter_filesystems(fast=True):
+        name: str = child.name
+        _ = name
+
+    def cb(items: list[libzfs_types.ZFSDataset], state: list[str]) -> bool:
+        state.extend(item.name for item in items)
+        return True
+
+    done: bool = ds.iter_filesystems(callback=cb, state=[], batch_size=64)
+    _ = done
+
+
+def check_dataset_iter_snapshots(ds: libzfs_types.ZFSDataset) -> None:
+    for snap in ds.iter_snapshots(order_by_transaction_group=True):
+        name: str = snap.name
+        _ = name
+
+
 def check_crypto_info(crypto: libzfs_types.ZFSCrypto) -> None:
     info: libzfs_types.struct_zfs_crypto_info = crypto.info()
     is_root: bool = info.is_root
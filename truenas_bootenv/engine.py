@@ -114,13 +114,8 @@ def _translating_zfs_errors(fn: Callable[P, R]) -> Callable[P, R]:
 
 
 def _collect_topdown(hdl: Any, state: list[Any]) -> bool:
-    """iter_filesystems() callback: append hdl to state, then recurse.
-
-    iter_filesystems() only visits direct children, so the callback
-    re-runs it on each child (zectl's C callbacks do the same).
-    """
+    """iter_filesystems() callback: append hdl to state."""
     state.append(hdl)
-    hdl.iter_filesystems(callback=_collect_topdown, state=state)
     return True
 
 
@@ -128,9 +123,13 @@ def _walk_topdown(dataset: Any, collected: list[Any]) -> list[Any]:
     """Collect dataset and all descendant filesystems, parents first.
 
     create clones parents before children; destroy reverses the list
-    for leaf-first teardown.
+    for leaf-first teardown. The pre-order walk of the descendants is
+    done by the library in a single call.
     """
-    _collect_topdown(dataset, collected)
+    collected.append(dataset)
+    dataset.iter_filesystems(
+        callback=_collect_topdown, state=collected, recursive=True,
+    )
     return collected
 
 